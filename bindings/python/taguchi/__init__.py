@@ -44,6 +44,14 @@ Async Support:
         async_taguchi = AsyncTaguchi()
         arrays = await async_taguchi.list_arrays_async()
         return arrays
+
+Parallel Runs:
+    def evaluate(factors):          # module-level, so worker processes can load it
+        return train(**factors)
+
+    result = exp.run(evaluate, workers=8, replicates=2, timeout=600)
+    print(result.main_effects())
+    print(result.to_analyzer().summary())
 """
 
 # Import original modules for backward compatibility
@@ -60,6 +68,7 @@ from .errors import (
 from .core_enhanced import Taguchi, AsyncTaguchi
 from .experiment_enhanced import Experiment
 from .analyzer_enhanced import Analyzer
+from .parallel import RunResult
 
 # For backward compatibility, make sure the enhanced error inherits from original
 # This ensures existing exception handling continues to work
@@ -80,6 +89,7 @@ __all__ = [
     "TaguchiError",
     "Experiment", 
     "Analyzer",
+    "RunResult",
     
     # Enhanced configuration and error handling
     "TaguchiConfig",
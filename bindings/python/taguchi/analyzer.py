@@ -2,19 +2,63 @@
 Analyzer class for Taguchi experimental results.
 """
 
-import tempfile
-import os
+import io
 import csv
 import re
 from typing import Dict, List, Optional, Any
 from .core import Taguchi, TaguchiError
 
 
+def parse_effects(output: str) -> List[Dict]:
+    """
+    Parse the main-effects table from CLI output.
+
+    Expected line format:
+        depth    0.026   L1=1.050, L2=1.024, L3=1.037
+
+    Handles:
+    - Negative level means (e.g. L1=-0.5)
+    - Extra whitespace / header/footer lines (silently skipped)
+    """
+    effects = []
+    for line in output.strip().split('\n'):
+        # Factor name (word chars), range (number), then level means
+        match = re.match(r'\s*(\w+)\s+([\d.]+)\s+(.+)', line)
+        if not match:
+            continue
+
+        factor = match.group(1)
+        try:
+            range_val = float(match.group(2))
+        except ValueError:
+            continue
+
+        means_str = match.group(3)
+        # Match L<n>=<signed float> — handles negatives and scientific notation
+        level_matches = re.findall(r'L\d+=(-?[\d.]+(?:[eE][+-]?\d+)?)', means_str)
+        means = []
+        for m in level_matches:
+            try:
+                means.append(float(m))
+            except ValueError:
+                pass
+
+        if means:
+            effects.append({
+                'factor': factor,
+                'range': range_val,
+                'level_means': means,
+            })
+
+    return effects
+
+
 class Analyzer:
     """
     Collect results from a Taguchi experiment and compute main effects.
 
-    Use as a context manager to ensure the temporary results CSV is cleaned up:
+    Results are piped to the CLI without temporary files; the context-manager
+    form is still supported:
 
         with Analyzer(exp, metric_name="accuracy") as analyzer:
             analyzer.add_results_from_dict({1: 0.92, 2: 0.87, ...})
@@ -27,7 +71,6 @@ class Analyzer:
         self._metric_name = metric_name
         self._results: Dict[int, float] = {}
         self._effects: Optional[List[Dict]] = None
-        self._csv_path: Optional[str] = None
 
     # ------------------------------------------------------------------
     # Result collection
@@ -37,7 +80,6 @@ class Analyzer:
         """Record the measured response for a run. Returns self for chaining."""
         self._results[run_id] = float(value)
         self._effects = None   # invalidate cached analysis
-        self._csv_path = None  # invalidate cached CSV
         return self
 
     def add_results_from_dict(self, results: Dict[int, float]) -> "Analyzer":
@@ -50,77 +92,29 @@ class Analyzer:
     # Internal helpers
     # ------------------------------------------------------------------
 
-    def _ensure_files(self) -> tuple:
-        """Write the results CSV if needed; return (tgu_path, csv_path)."""
+    def _results_csv(self) -> str:
+        """Render the collected results as CSV text for the CLI."""
         if not self._results:
             raise TaguchiError(
                 "No results added. Call add_result() before analyzing."
             )
 
-        if self._csv_path is None:
-            fd, path = tempfile.mkstemp(suffix='.csv')
-            with os.fdopen(fd, 'w', newline='') as f:
-                writer = csv.writer(f)
-                writer.writerow(['run_id', self._metric_name])
-                for run_id, value in sorted(self._results.items()):
-                    writer.writerow([run_id, value])
-            self._csv_path = path
-
-        # Use the public API — no private method access
-        tgu_path = self._experiment.get_tgu_path()
-        return tgu_path, self._csv_path
+        buf = io.StringIO()
+        writer = csv.writer(buf)
+        writer.writerow(['run_id', self._metric_name])
+        for run_id, value in sorted(self._results.items()):
+            writer.writerow([run_id, value])
+        return buf.getvalue()
 
     def _parse_effects(self, output: str) -> List[Dict]:
-        """
-        Parse the main-effects table from CLI output.
-
-        Expected line format:
-            depth    0.026   L1=1.050, L2=1.024, L3=1.037
-
-        Handles:
-        - Negative level means (e.g. L1=-0.5)
-        - Extra whitespace / header/footer lines (silently skipped)
-        """
-        effects = []
-        for line in output.strip().split('\n'):
-            # Factor name (word chars), range (number), then level means
-            match = re.match(r'\s*(\w+)\s+([\d.]+)\s+(.+)', line)
-            if not match:
-                continue
-
-            factor = match.group(1)
-            try:
-                range_val = float(match.group(2))
-            except ValueError:
-                continue
-
-            means_str = match.group(3)
-            # Match L<n>=<signed float> — handles negatives and scientific notation
-            level_matches = re.findall(r'L\d+=(-?[\d.]+(?:[eE][+-]?\d+)?)', means_str)
-            means = []
-            for m in level_matches:
-                try:
-                    means.append(float(m))
-                except ValueError:
-                    pass
-
-            if means:
-                effects.append({
-                    'factor': factor,
-                    'range': range_val,
-                    'level_means': means,
-                })
-
-        return effects
+        """Parse the main-effects table from CLI output (see parse_effects)."""
+        return parse_effects(output)
 
     def cleanup(self) -> None:
-        """Delete the temporary results CSV if one was created."""
-        if self._csv_path and os.path.exists(self._csv_path):
-            try:
-                os.unlink(self._csv_path)
-            except OSError:
-                pass
-        self._csv_path = None
+        """
+        Release analysis resources.  Results are piped to the CLI, so no
+        files are left behind; kept for the context-manager protocol.
+        """
 
     # ------------------------------------------------------------------
     # Analysis API
@@ -134,9 +128,10 @@ class Analyzer:
                                     'level_means': [float, ...]}, ...]
         """
         if self._effects is None:
-            tgu_path, csv_path = self._ensure_files()
-            output = self._taguchi.effects(
-                tgu_path, csv_path, metric=self._metric_name
+            # Definition and results travel to the CLI as one framed stream
+            results_csv = self._results_csv()
+            output = self._taguchi.effects_text(
+                self._experiment.tgu_content(), results_csv, metric=self._metric_name
             )
             self._effects = self._parse_effects(output)
             if not self._effects:
@@ -230,11 +225,3 @@ class Analyzer:
 
     def __exit__(self, exc_type, exc_val, exc_tb) -> None:
         self.cleanup()
-
-    def __del__(self) -> None:
-        try:
-            path = self.__dict__.get('_csv_path')
-            if path and os.path.exists(path):
-                os.unlink(path)
-        except Exception:
-            pass
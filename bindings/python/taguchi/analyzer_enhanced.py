@@ -4,8 +4,7 @@ Enhanced Analyzer class with dependency injection and improved error handling.
 Provides Phase 2 improvements while maintaining backward compatibility.
 """
 
-import tempfile
-import os
+import io
 import csv
 import re
 from typing import Dict, List, Optional, Any, Union
@@ -22,7 +21,8 @@ class Analyzer:
     Provides dependency injection, improved validation, and better error
     handling while maintaining full backward compatibility.
 
-    Use as a context manager to ensure the temporary results CSV is cleaned up:
+    Results are piped to the CLI without temporary files; the context-manager
+    form is still supported:
 
         with Analyzer(exp, metric_name="accuracy") as analyzer:
             analyzer.add_results_from_dict({1: 0.92, 2: 0.87, ...})
@@ -63,7 +63,6 @@ class Analyzer:
         self._metric_name = metric_name
         self._results: Dict[int, float] = {}
         self._effects: Optional[List[Dict]] = None
-        self._csv_path: Optional[str] = None
         self._validation_cache: Optional[List[str]] = None
 
     # ------------------------------------------------------------------
@@ -217,7 +216,6 @@ class Analyzer:
         
         # Invalidate caches
         self._effects = None
-        self._csv_path = None
         self._validation_cache = None
         
         return self
@@ -265,7 +263,6 @@ class Analyzer:
         
         # Invalidate caches
         self._effects = None
-        self._csv_path = None
         self._validation_cache = None
         
         return self
@@ -276,7 +273,6 @@ class Analyzer:
         
         # Invalidate caches
         self._effects = None
-        self._csv_path = None
         self._validation_cache = None
         
         return self
@@ -285,25 +281,19 @@ class Analyzer:
     # Internal helpers
     # ------------------------------------------------------------------
 
-    def _ensure_files(self) -> tuple:
-        """Write the results CSV if needed; return (tgu_path, csv_path)."""
+    def _results_csv(self) -> str:
+        """Render the collected results as CSV text for the CLI."""
         if not self._results:
             raise TaguchiError(
                 "No results added. Call add_result() before analyzing."
             )
 
-        if self._csv_path is None:
-            fd, path = tempfile.mkstemp(suffix='.csv')
-            with os.fdopen(fd, 'w', newline='') as f:
-                writer = csv.writer(f)
-                writer.writerow(['run_id', self._metric_name])
-                for run_id, value in sorted(self._results.items()):
-                    writer.writerow([run_id, value])
-            self._csv_path = path
-
-        # Use the public API — no private method access
-        tgu_path = self._experiment.get_tgu_path()
-        return tgu_path, self._csv_path
+        buf = io.StringIO()
+        writer = csv.writer(buf)
+        writer.writerow(['run_id', self._metric_name])
+        for run_id, value in sorted(self._results.items()):
+            writer.writerow([run_id, value])
+        return buf.getvalue()
 
     def _parse_effects(self, output: str) -> List[Dict]:
         """
@@ -349,13 +339,10 @@ class Analyzer:
         return effects
 
     def cleanup(self) -> None:
-        """Delete the temporary results CSV if one was created."""
-        if self._csv_path and os.path.exists(self._csv_path):
-            try:
-                os.unlink(self._csv_path)
-            except OSError:
-                pass
-        self._csv_path = None
+        """
+        Release analysis resources.  Results are piped to the CLI, so no
+        files are left behind; kept for the context-manager protocol.
+        """
 
     # ------------------------------------------------------------------
     # Analysis API (enhanced)
@@ -372,9 +359,10 @@ class Analyzer:
         self.validate_and_raise()
         
         if self._effects is None:
-            tgu_path, csv_path = self._ensure_files()
-            output = self._taguchi.effects(
-                tgu_path, csv_path, metric=self._metric_name
+            # Definition and results travel to the CLI as one framed stream
+            results_csv = self._results_csv()
+            output = self._taguchi.effects_text(
+                self._experiment.tgu_content(), results_csv, metric=self._metric_name
             )
             self._effects = self._parse_effects(output)
             if not self._effects:
@@ -384,7 +372,7 @@ class Analyzer:
                     operation="effects_calculation",
                     suggestions=[
                         "Verify all run IDs in results match experiment run IDs",
-                        "Check that CSV file was created correctly",
+                        "Check that the metric values are numeric",
                         "Ensure CLI is functioning properly",
                     ],
                     diagnostic_info={
@@ -621,14 +609,6 @@ class Analyzer:
 
     def __exit__(self, exc_type, exc_val, exc_tb) -> None:
         self.cleanup()
-
-    def __del__(self) -> None:
-        try:
-            path = self.__dict__.get('_csv_path')
-            if path and os.path.exists(path):
-                os.unlink(path)
-        except Exception:
-            pass
     
     # ------------------------------------------------------------------
     # String representation
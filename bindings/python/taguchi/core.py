@@ -4,7 +4,6 @@ Core Taguchi library interface using shell commands.
 
 import shutil
 import subprocess
-import tempfile
 import os
 import re
 from pathlib import Path
@@ -19,6 +18,19 @@ class TaguchiError(Exception):
     pass
 
 
+def frame_stream(definition: str, results_csv: Optional[str] = None) -> bytes:
+    """
+    Pack .tgu content and optional results CSV into one framed stream, the
+    form the CLI reads when given the same input twice (e.g. `effects - -`).
+    """
+    def_bytes = definition.encode()
+    parts = [b"TAGUCHI-STREAM 1\n", b"definition %d\n" % len(def_bytes), def_bytes]
+    if results_csv is not None:
+        res_bytes = results_csv.encode()
+        parts += [b"results %d\n" % len(res_bytes), res_bytes]
+    return b"".join(parts)
+
+
 class Taguchi:
     """
     Python interface to the Taguchi orthogonal array CLI tool.
@@ -60,24 +72,26 @@ class Taguchi:
 
         raise TaguchiError("Could not find taguchi CLI. Build with 'make' first.")
 
-    def _run_command(self, args: List[str]) -> str:
-        """Run a taguchi command and return stdout."""
+    def _run_command(self, args: List[str], input_data: Optional[bytes] = None) -> str:
+        """Run a taguchi command, feeding input_data on stdin, and return stdout."""
         cmd = [self._cli_path] + args
         try:
             result = subprocess.run(
                 cmd,
+                input=input_data if input_data is not None else b"",
                 capture_output=True,
-                text=True,
                 timeout=_CLI_TIMEOUT,
             )
         except subprocess.TimeoutExpired:
             raise TaguchiError(
                 f"Taguchi command timed out after {_CLI_TIMEOUT}s: {' '.join(args)}"
             )
+        stdout = result.stdout.decode(errors="replace")
         if result.returncode != 0:
-            error_msg = result.stderr.strip() or result.stdout.strip() or "Unknown error"
+            stderr = result.stderr.decode(errors="replace")
+            error_msg = stderr.strip() or stdout.strip() or "Unknown error"
             raise TaguchiError(f"Taguchi command failed: {error_msg}")
-        return result.stdout
+        return stdout
 
     def _get_arrays_info(self) -> List[Dict]:
         """Return cached array metadata."""
@@ -153,16 +167,8 @@ class Taguchi:
         if os.path.exists(tgu_path):
             output = self._run_command(["generate", tgu_path])
         else:
-            # Treat the argument as raw .tgu content
-            with tempfile.NamedTemporaryFile(
-                mode='w', suffix='.tgu', delete=False
-            ) as f:
-                f.write(tgu_path)
-                temp_path = f.name
-            try:
-                output = self._run_command(["generate", temp_path])
-            finally:
-                os.unlink(temp_path)
+            # Treat the argument as raw .tgu content and pipe it in
+            output = self._run_command(["generate", "-"], input_data=tgu_path.encode())
 
         runs = []
         for line in output.strip().split("\n"):
@@ -195,3 +201,17 @@ class Taguchi:
         return self._run_command(
             ["effects", tgu_path, results_csv, "--metric", metric]
         )
+
+    def analyze_text(self, definition: str, results_csv: str, metric: str = "response") -> str:
+        """Like analyze(), from in-memory .tgu content and CSV (no files written)."""
+        return self._run_command(
+            ["analyze", "-", "-", "--metric", metric],
+            input_data=frame_stream(definition, results_csv),
+        )
+
+    def effects_text(self, definition: str, results_csv: str, metric: str = "response") -> str:
+        """Like effects(), from in-memory .tgu content and CSV (no files written)."""
+        return self._run_command(
+            ["effects", "-", "-", "--metric", metric],
+            input_data=frame_stream(definition, results_csv),
+        )
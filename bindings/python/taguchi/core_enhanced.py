@@ -12,12 +12,12 @@ import os
 import re
 import shutil
 import subprocess
-import tempfile
 import time
 from pathlib import Path
 from typing import List, Optional, Dict, Any, Union
 
 from .config import TaguchiConfig, ConfigManager
+from .core import frame_stream
 from .errors import (
     TaguchiError, BinaryDiscoveryError, CommandExecutionError,
     TimeoutError, ValidationError
@@ -28,6 +28,28 @@ from .errors import (
 logger = logging.getLogger(__name__)
 
 
+def _parse_generate_output(output: str) -> List[Dict[str, Any]]:
+    """Parse ``taguchi generate`` output into [{'run_id': int, 'factors': {...}}]."""
+    runs = []
+    for line in output.strip().split("\n"):
+        if not line.startswith("Run "):
+            continue
+        parts = line.split(": ", 1)
+        if len(parts) < 2:
+            continue
+        try:
+            run_id = int(parts[0][4:].strip())
+        except ValueError:
+            continue
+        factors: Dict[str, str] = {}
+        for pair in parts[1].split(", "):
+            if "=" in pair:
+                key, _, value = pair.partition("=")
+                factors[key.strip()] = value.strip()
+        runs.append({"run_id": run_id, "factors": factors})
+    return runs
+
+
 class Taguchi:
     """
     Enhanced Python interface to the Taguchi orthogonal array CLI tool.
@@ -135,13 +157,15 @@ class Taguchi:
             path_env=os.getenv("PATH"),
         )
 
-    def _run_command(self, args: List[str], operation: Optional[str] = None) -> str:
+    def _run_command(self, args: List[str], operation: Optional[str] = None,
+                     input_data: Optional[bytes] = None) -> str:
         """
         Run a taguchi command with enhanced error handling and retry logic.
         
         Args:
             args: Command arguments (without the binary name)
             operation: High-level operation description for error context
+            input_data: Bytes fed to the command's stdin (e.g. a framed stream)
             
         Returns:
             Command stdout output
@@ -170,8 +194,10 @@ class Taguchi:
             try:
                 result = subprocess.run(
                     cmd,
+                    input=input_data.decode('utf-8') if input_data is not None else "",
                     capture_output=True,
                     text=True,
+                    encoding='utf-8',
                     timeout=self._config.cli_timeout,
                     cwd=self._config.working_directory,
                     env=env,
@@ -456,41 +482,18 @@ class Taguchi:
 
         Returns a list of dicts: [{'run_id': int, 'factors': {name: value}}, ...]
         """
-        temp_path = None
         try:
             if os.path.exists(tgu_path):
-                file_path = tgu_path
                 operation = "experiment_generation_from_file"
+                output = self._run_command(["generate", tgu_path], operation=operation)
             else:
-                # Treat the argument as raw .tgu content
-                with tempfile.NamedTemporaryFile(
-                    mode='w', suffix='.tgu', delete=False
-                ) as f:
-                    f.write(tgu_path)
-                    temp_path = f.name
-                file_path = temp_path
+                # Treat the argument as raw .tgu content and pipe it in
                 operation = "experiment_generation_from_content"
+                output = self._run_command(
+                    ["generate", "-"], operation=operation, input_data=tgu_path.encode()
+                )
 
-            output = self._run_command(["generate", file_path], operation=operation)
-
-            runs = []
-            for line in output.strip().split("\n"):
-                if not line.startswith("Run "):
-                    continue
-                parts = line.split(": ", 1)
-                if len(parts) < 2:
-                    continue
-                try:
-                    run_id = int(parts[0][4:].strip())
-                except ValueError:
-                    continue
-                factors: Dict[str, str] = {}
-                for pair in parts[1].split(", "):
-                    if "=" in pair:
-                        key, _, value = pair.partition("=")
-                        factors[key.strip()] = value.strip()
-                runs.append({"run_id": run_id, "factors": factors})
-
+            runs = _parse_generate_output(output)
             if not runs:
                 raise TaguchiError(
                     "No runs generated from .tgu file",
@@ -513,12 +516,6 @@ class Taguchi:
                 operation="experiment_generation",
                 suggestions=["Check .tgu file format and permissions"],
             )
-        finally:
-            if temp_path and os.path.exists(temp_path):
-                try:
-                    os.unlink(temp_path)
-                except OSError:
-                    pass
 
     def analyze(self, tgu_path: str, results_csv: str, metric: str = "response") -> str:
         """Run full analysis with main effects and optimal recommendations."""
@@ -534,6 +531,22 @@ class Taguchi:
             operation="effects_calculation"
         )
 
+    def analyze_text(self, definition: str, results_csv: str, metric: str = "response") -> str:
+        """Like analyze(), from in-memory .tgu content and CSV (no files written)."""
+        return self._run_command(
+            ["analyze", "-", "-", "--metric", metric],
+            operation="full_analysis",
+            input_data=frame_stream(definition, results_csv),
+        )
+
+    def effects_text(self, definition: str, results_csv: str, metric: str = "response") -> str:
+        """Like effects(), from in-memory .tgu content and CSV (no files written)."""
+        return self._run_command(
+            ["effects", "-", "-", "--metric", metric],
+            operation="effects_calculation",
+            input_data=frame_stream(definition, results_csv),
+        )
+
 
 class AsyncTaguchi:
     """
@@ -547,8 +560,9 @@ class AsyncTaguchi:
         """Initialize async Taguchi interface."""
         self._taguchi = Taguchi(cli_path=cli_path, config=config)
     
-    async def _run_command_async(self, args: List[str], operation: Optional[str] = None) -> str:
-        """Run command asynchronously."""
+    async def _run_command_async(self, args: List[str], operation: Optional[str] = None,
+                                 input_data: Optional[bytes] = None) -> str:
+        """Run command asynchronously, feeding input_data on stdin."""
         cmd = [self._taguchi._cli_path] + args
         
         if self._taguchi._config.log_commands or self._taguchi._config.debug_mode:
@@ -561,6 +575,7 @@ class AsyncTaguchi:
         # Create subprocess
         process = await asyncio.create_subprocess_exec(
             *cmd,
+            stdin=asyncio.subprocess.PIPE,
             stdout=asyncio.subprocess.PIPE,
             stderr=asyncio.subprocess.PIPE,
             cwd=self._taguchi._config.working_directory,
@@ -569,7 +584,7 @@ class AsyncTaguchi:
         
         try:
             stdout, stderr = await asyncio.wait_for(
-                process.communicate(),
+                process.communicate(input_data if input_data is not None else b""),
                 timeout=self._taguchi._config.cli_timeout
             )
             
@@ -595,6 +610,13 @@ class AsyncTaguchi:
             
             return stdout
             
+        except asyncio.CancelledError:
+            # The awaiting task was cancelled: do not leave the CLI running
+            if process.returncode is None:
+                process.kill()
+                await process.wait()
+            raise
+
         except asyncio.TimeoutError:
             # Kill the process
             process.kill()
@@ -624,10 +646,28 @@ class AsyncTaguchi:
         return arrays
     
     async def generate_runs_async(self, tgu_path: str) -> List[Dict[str, Any]]:
-        """Generate runs asynchronously."""
-        # For simplicity, delegate to sync version in thread pool
-        loop = asyncio.get_event_loop()
-        return await loop.run_in_executor(None, self._taguchi.generate_runs, tgu_path)
+        """
+        Generate runs asynchronously from a .tgu path or raw .tgu content.
+
+        Runs the CLI as an asyncio subprocess (no executor thread); cancelling
+        the awaiting task kills the child process.
+        """
+        if os.path.exists(tgu_path):
+            output = await self._run_command_async(
+                ["generate", tgu_path], "experiment_generation"
+            )
+        else:
+            output = await self._run_command_async(
+                ["generate", "-"], "experiment_generation", input_data=tgu_path.encode()
+            )
+        runs = _parse_generate_output(output)
+        if not runs:
+            raise TaguchiError(
+                "No runs generated from .tgu file",
+                operation="experiment_generation",
+                suggestions=["Check .tgu file format and syntax"],
+            )
+        return runs
     
     async def analyze_async(self, tgu_path: str, results_csv: str, metric: str = "response") -> str:
         """Run analysis asynchronously."""
@@ -7,11 +7,13 @@ Provides Phase 2 improvements while maintaining backward compatibility.
 import tempfile
 import os
 import re
-from typing import Dict, List, Optional, Any, Union
+from typing import Any, Callable, Dict, List, Optional, Union
 
 from .core_enhanced import Taguchi
 from .config import TaguchiConfig
 from .errors import TaguchiError, ValidationError
+from .analyzer_enhanced import Analyzer
+from .parallel import RunResult, run_experiment
 
 
 # Characters that are illegal in factor names because they break environment
@@ -357,10 +359,38 @@ class Experiment:
     def generate(self) -> List[Dict[str, Any]]:
         """Generate and cache experiment runs."""
         if self._runs is None:
-            tgu_path = self.get_tgu_path()
-            self._runs = self._taguchi.generate_runs(tgu_path)
+            self._runs = self._taguchi.generate_runs(self.tgu_content())
         return self._runs
 
+    def run(
+        self,
+        fn: Callable[[Dict[str, str]], Any],
+        workers: Optional[int] = None,
+        backend: str = "process",
+        replicates: int = 1,
+        timeout: Optional[float] = None,
+        metric_name: str = "response",
+        on_result: Optional[Callable[[RunResult, int, float], None]] = None,
+    ) -> RunResult:
+        """
+        Evaluate fn(factors) for every run on a pool of `workers` (default:
+        all CPUs) and collect the responses.
+
+        fn receives a run's factors as {name: level} and returns a number (or
+        a dict holding `metric_name`).  backend="process" needs a picklable,
+        module-level fn; backend="thread" suits I/O-bound or GIL-releasing
+        work.  Each run is evaluated `replicates` times; an evaluation taking
+        longer than `timeout` seconds is recorded as a failure.  Responses
+        stream into the returned RunResult as they complete, and
+        on_result(result, run_id, value) can inspect result.main_effects()
+        while the sweep is running.
+        """
+        return run_experiment(
+            self, fn, self._taguchi, workers=workers, backend=backend,
+            replicates=replicates, timeout=timeout, metric_name=metric_name,
+            on_result=on_result, analyzer_cls=Analyzer,
+        )
+
     # ------------------------------------------------------------------
     # Properties
     # ------------------------------------------------------------------
@@ -453,6 +483,16 @@ class Experiment:
         self._initialize()
         return self._generate_tgu()
 
+    def tgu_content(self) -> str:
+        """
+        The .tgu text handed to the CLI (over stdin): the source file's
+        contents for experiments loaded with from_tgu(), otherwise to_tgu().
+        """
+        if self._tgu_path is not None and os.path.exists(self._tgu_path):
+            with open(self._tgu_path, 'r') as f:
+                return f.read()
+        return self.to_tgu()
+
     def save(self, path: str) -> None:
         """Save experiment definition to a .tgu file."""
         self._initialize()
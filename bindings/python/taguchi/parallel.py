@@ -0,0 +1,242 @@
+"""
+Parallel execution of Python callables over an experiment's runs.
+
+Experiment.run() hands each (run, replicate) to a process or thread pool and
+streams every measured response into a RunResult as it completes, so main
+effects can be inspected while the sweep is still going.
+"""
+
+import csv
+import io
+import multiprocessing
+import multiprocessing.pool
+import numbers
+import os
+import queue
+import time
+from collections import deque
+from typing import Any, Callable, Dict, List, Optional, Tuple
+
+from .core import TaguchiError
+from .analyzer import parse_effects
+
+_BACKENDS = ("process", "thread")
+
+
+class RunResult:
+    """
+    Observations collected by Experiment.run().
+
+    Every completed (run, replicate) adds one observation; failures (an
+    exception, a non-numeric return value or a timeout) are recorded in
+    `failures` instead.  All replicates of a run are analysed as separate
+    observations, which is equivalent to averaging them when every run has
+    the same replicate count.
+    """
+
+    def __init__(self, experiment: Any, taguchi: Any, metric_name: str,
+                 total: int, analyzer_cls: Optional[type] = None):
+        self._experiment = experiment
+        self._taguchi = taguchi
+        self._analyzer_cls = analyzer_cls
+        self.metric_name = metric_name
+        self.total = total
+        self.observations: List[Tuple[int, int, float]] = []  # (run_id, replicate, value)
+        self.failures: Dict[Tuple[int, int], str] = {}
+        self.elapsed = 0.0
+
+    @property
+    def completed(self) -> int:
+        """Number of (run, replicate) evaluations finished, failed or not."""
+        return len(self.observations) + len(self.failures)
+
+    def results_csv(self) -> str:
+        """Observations so far as a results CSV (one row per observation)."""
+        buf = io.StringIO()
+        writer = csv.writer(buf)
+        writer.writerow(['run_id', self.metric_name])
+        for run_id, _, value in sorted(list(self.observations)):
+            writer.writerow([run_id, value])
+        return buf.getvalue()
+
+    def run_means(self) -> Dict[int, float]:
+        """Mean response of every run with at least one observation."""
+        sums: Dict[int, List[float]] = {}
+        for run_id, _, value in list(self.observations):
+            acc = sums.setdefault(run_id, [0.0, 0])
+            acc[0] += value
+            acc[1] += 1
+        return {run_id: total / count for run_id, (total, count) in sorted(sums.items())}
+
+    def main_effects(self) -> List[Dict[str, Any]]:
+        """
+        Main effects of the observations collected so far.
+
+        Safe to call from an on_result callback for live effects; levels with
+        no observations yet report a mean of 0.
+        """
+        if not self.observations:
+            raise TaguchiError("No observations yet; nothing to analyze")
+        output = self._taguchi.effects_text(
+            self._experiment.tgu_content(), self.results_csv(), metric=self.metric_name
+        )
+        return parse_effects(output)
+
+    def to_analyzer(self) -> Any:
+        """An Analyzer for the experiment holding each run's mean response."""
+        if self._analyzer_cls is None:
+            from .analyzer import Analyzer
+            analyzer_cls = Analyzer
+        else:
+            analyzer_cls = self._analyzer_cls
+        analyzer = analyzer_cls(self._experiment, metric_name=self.metric_name)
+        analyzer.add_results_from_dict(self.run_means())
+        return analyzer
+
+    def __repr__(self) -> str:
+        return (f"RunResult(metric={self.metric_name!r}, observations={len(self.observations)}, "
+                f"failures={len(self.failures)}, total={self.total})")
+
+
+def _make_pool(backend: str, workers: int) -> multiprocessing.pool.Pool:
+    if backend == "process":
+        return multiprocessing.Pool(processes=workers)
+    return multiprocessing.pool.ThreadPool(processes=workers)
+
+
+def _response_value(value: Any, metric_name: str) -> float:
+    """Accept a number, or a mapping holding metric_name."""
+    if isinstance(value, dict):
+        if metric_name not in value:
+            raise TypeError(f"result has no '{metric_name}' key")
+        value = value[metric_name]
+    if isinstance(value, bool) or not isinstance(value, numbers.Real):
+        raise TypeError(f"expected a number, got {type(value).__name__}")
+    return float(value)
+
+
+def run_experiment(
+    experiment: Any,
+    fn: Callable[[Dict[str, str]], Any],
+    taguchi: Any,
+    workers: Optional[int] = None,
+    backend: str = "process",
+    replicates: int = 1,
+    timeout: Optional[float] = None,
+    metric_name: str = "response",
+    on_result: Optional[Callable[[RunResult, int, float], None]] = None,
+    analyzer_cls: Optional[type] = None,
+) -> RunResult:
+    """
+    Evaluate fn(factors) for every run and replicate of experiment on a pool.
+
+    Only `workers` evaluations are in flight at a time, so a timeout is
+    measured from the moment an evaluation is handed to a worker.  A timed-out
+    process worker is killed (its pool is replaced and the other in-flight
+    evaluations are resubmitted); a timed-out thread cannot be interrupted, so
+    it is abandoned and its eventual result ignored.
+
+    on_result(result, run_id, value) is called on the calling thread after
+    each observation is recorded.
+    """
+    if backend not in _BACKENDS:
+        raise TaguchiError(f"backend must be one of {_BACKENDS}, got '{backend}'")
+    if replicates < 1:
+        raise TaguchiError("replicates must be at least 1")
+    if timeout is not None and timeout <= 0:
+        raise TaguchiError("timeout must be positive")
+    if workers is None:
+        workers = os.cpu_count() or 1
+    if workers < 1:
+        raise TaguchiError("workers must be at least 1")
+
+    runs = experiment.generate()
+    pending = deque(
+        (run["run_id"], rep, dict(run["factors"]))
+        for rep in range(replicates) for run in runs
+    )
+    result = RunResult(experiment, taguchi, metric_name, len(pending), analyzer_cls)
+
+    # Pool callbacks run on the pool's result thread; they only enqueue.
+    # Each submission gets a fresh token so completions from a replaced pool
+    # or an abandoned thread are recognised and dropped.
+    done: "queue.Queue[Tuple[int, bool, Any]]" = queue.Queue()
+    inflight: Dict[int, Tuple[int, int, Dict[str, str], Optional[float]]] = {}
+    next_token = 0
+    start = time.monotonic()
+    pool = _make_pool(backend, workers)
+
+    def submit(run_id: int, rep: int, factors: Dict[str, str]) -> None:
+        nonlocal next_token
+        token = next_token
+        next_token += 1
+        deadline = time.monotonic() + timeout if timeout is not None else None
+        inflight[token] = (run_id, rep, factors, deadline)
+        pool.apply_async(
+            fn, (dict(factors),),
+            callback=lambda value, t=token: done.put((t, True, value)),
+            error_callback=lambda exc, t=token: done.put((t, False, exc)),
+        )
+
+    try:
+        while pending or inflight:
+            while pending and len(inflight) < workers:
+                submit(*pending.popleft())
+
+            wait = None
+            if timeout is not None:
+                nearest = min(entry[3] for entry in inflight.values())
+                wait = max(0.0, nearest - time.monotonic())
+            try:
+                token, ok, payload = done.get(timeout=wait)
+            except queue.Empty:
+                now = time.monotonic()
+                expired = [t for t, entry in inflight.items() if entry[3] <= now]
+                if not expired:
+                    continue
+                for t in expired:
+                    run_id, rep, _, _ = inflight.pop(t)
+                    result.failures[(run_id, rep)] = f"timed out after {timeout:g}s"
+                if backend == "process":
+                    # Kill the stuck worker; survivors restart on the new pool
+                    pool.terminate()
+                    for t in sorted(inflight, reverse=True):
+                        run_id, rep, factors, _ = inflight.pop(t)
+                        pending.appendleft((run_id, rep, factors))
+                else:
+                    # Leave the stuck thread behind on its old pool; the
+                    # other evaluations there still report back
+                    pool.close()
+                pool = _make_pool(backend, workers)
+                continue
+
+            entry = inflight.pop(token, None)
+            if entry is None:
+                continue
+            run_id, rep, _, _ = entry
+            if not ok:
+                result.failures[(run_id, rep)] = f"{type(payload).__name__}: {payload}"
+                continue
+            try:
+                value = _response_value(payload, metric_name)
+            except TypeError as e:
+                result.failures[(run_id, rep)] = str(e)
+                continue
+            result.observations.append((run_id, rep, value))
+            if on_result is not None:
+                on_result(result, run_id, value)
+    except BaseException:
+        pool.terminate()
+        raise
+    else:
+        pool.close()
+        pool.join()
+    finally:
+        result.elapsed = time.monotonic() - start
+
+    if not result.observations and result.failures:
+        first = next(iter(result.failures.values()))
+        hint = " (backend='process' needs a picklable, module-level fn)" \
+            if backend == "process" else ""
+        raise TaguchiError(f"Every run failed; first error: {first}{hint}")
+    return result
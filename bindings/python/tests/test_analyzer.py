@@ -2,7 +2,7 @@
 Tests for taguchi.analyzer — Analyzer class.
 """
 
-import os
+import tempfile
 import pytest
 from taguchi.experiment import Experiment
 from taguchi.analyzer import Analyzer
@@ -85,11 +85,8 @@ class TestMetricPassthrough:
         """The metric name must appear as the CSV header column."""
         a = Analyzer(two_factor_exp, metric_name="my_score")
         a.add_result(1, 1.0)
-        _, csv_path = a._ensure_files()
-        with open(csv_path) as f:
-            header = f.readline()
+        header = a._results_csv().splitlines()[0]
         assert "my_score" in header
-        a.cleanup()
 
 
 class TestParseEffects:
@@ -120,15 +117,15 @@ class TestParseEffects:
 
 
 class TestCleanup:
-    def test_cleanup_removes_csv(self, two_factor_exp):
+    def test_analysis_writes_no_temp_files(self, two_factor_exp, monkeypatch):
+        """Definition and results are piped to the CLI, never written to disk."""
+        def no_temp_files(*args, **kwargs):
+            raise AssertionError("temporary file created")
+        monkeypatch.setattr(tempfile, "mkstemp", no_temp_files)
+        monkeypatch.setattr(tempfile, "NamedTemporaryFile", no_temp_files)
         a = Analyzer(two_factor_exp)
-        a.add_result(1, 1.0)
-        a._ensure_files()
-        path = a._csv_path
-        assert os.path.exists(path)
-        a.cleanup()
-        assert not os.path.exists(path)
-        assert a._csv_path is None
+        a.add_results_from_dict({i: float(i) for i in range(1, 10)})
+        assert a.main_effects()
 
     def test_cleanup_idempotent(self, two_factor_exp):
         a = Analyzer(two_factor_exp)
@@ -275,28 +272,16 @@ class TestSummary:
 
 
 class TestContextManager:
-    def test_cleans_up_csv_file(self, two_factor_exp):
-        saved_path = None
+    def test_context_manager_analyzes(self, two_factor_exp):
         with Analyzer(two_factor_exp, metric_name="score") as a:
             results = {1: 1.0, 2: 1.1, 3: 1.2,
                        4: 1.0, 5: 1.1, 6: 1.2,
                        7: 1.0, 8: 1.1, 9: 1.2}
             a.add_results_from_dict(results)
-            a.main_effects()  # forces CSV creation
-            saved_path = a._csv_path
-            assert saved_path is not None
-            assert os.path.exists(saved_path)
-        assert not os.path.exists(saved_path)
-
-    def test_cleans_up_on_exception(self, two_factor_exp):
-        saved_path = None
-        try:
+            assert len(a.main_effects()) == 2
+
+    def test_exception_propagates(self, two_factor_exp):
+        with pytest.raises(RuntimeError, match="simulated"):
             with Analyzer(two_factor_exp) as a:
                 a.add_result(1, 1.0)
-                a.main_effects()
-                saved_path = a._csv_path
                 raise RuntimeError("simulated")
-        except RuntimeError:
-            pass
-        if saved_path:
-            assert not os.path.exists(saved_path)
@@ -21,7 +21,7 @@ class TestAnalyzerEnhanced:
     def mock_taguchi(self):
         """Create a mock Taguchi instance for testing."""
         mock = Mock(spec=Taguchi)
-        mock.effects.return_value = """
+        mock.effects_text.return_value = """
         temp    0.050   L1=1.020, L2=1.070, L3=1.030
         pressure 0.030   L1=1.040, L2=1.010
         """
@@ -40,7 +40,7 @@ class TestAnalyzerEnhanced:
             "temp": ["low", "medium", "high"],
             "pressure": ["low", "high"]
         }
-        mock.get_tgu_path.return_value = "/tmp/test.tgu"
+        mock.tgu_content.return_value = "factors:\n  temp: low, medium, high\n"
         return mock
     
     def test_init_default(self, mock_experiment, mock_taguchi):
@@ -279,7 +279,7 @@ class TestAnalyzerEnhanced:
     
     def test_main_effects_no_parseable_output(self, mock_experiment, mock_taguchi):
         """Test main effects with unparseable output."""
-        mock_taguchi.effects.return_value = "Invalid output format"
+        mock_taguchi.effects_text.return_value = "Invalid output format"
         
         analyzer = Analyzer(mock_experiment, taguchi=mock_taguchi)
         analyzer.add_result(1, 0.95)
@@ -573,7 +573,7 @@ class TestAnalyzerIntegration:
     
     def test_error_propagation(self, mock_experiment, mock_taguchi):
         """Test that errors from Taguchi are properly propagated."""
-        mock_taguchi.effects.side_effect = TaguchiError("CLI error")
+        mock_taguchi.effects_text.side_effect = TaguchiError("CLI error")
         
         analyzer = Analyzer(mock_experiment, taguchi=mock_taguchi)
         analyzer.add_result(1, 0.95)
@@ -5,7 +5,7 @@ Tests for taguchi.core — Taguchi class (CLI subprocess wrapper).
 import os
 import pytest
 from unittest.mock import patch, MagicMock
-from taguchi.core import Taguchi, TaguchiError
+from taguchi.core import Taguchi, TaguchiError, frame_stream
 from .conftest import CLI_PATH
 
 
@@ -200,3 +200,35 @@ class TestEffectsParsing:
         output = t.effects(simple_tgu, simple_results_csv)
         assert "depth" in output
         assert "lr" in output
+
+
+class TestFramedStream:
+    """In-memory inputs piped to the CLI as one framed stream."""
+
+    def test_frame_stream_layout(self):
+        framed = frame_stream("factors:\n  a: 1, 2\n", "run_id,response\n1,2\n")
+        assert framed == (
+            b"TAGUCHI-STREAM 1\n"
+            b"definition 19\nfactors:\n  a: 1, 2\n"
+            b"results 20\nrun_id,response\n1,2\n"
+        )
+
+    def test_frame_stream_counts_bytes_not_characters(self):
+        framed = frame_stream("factors:\n  mode: café, tea\n")
+        assert framed.startswith(b"TAGUCHI-STREAM 1\ndefinition 28\n")
+
+    def test_effects_text_matches_file_inputs(self, cli_path, simple_tgu, simple_results_csv):
+        t = Taguchi(cli_path=cli_path)
+        with open(simple_tgu) as f:
+            definition = f.read()
+        with open(simple_results_csv) as f:
+            results = f.read()
+        assert t.effects_text(definition, results) == t.effects(simple_tgu, simple_results_csv)
+
+    def test_analyze_text_recommends(self, cli_path, simple_tgu, simple_results_csv):
+        t = Taguchi(cli_path=cli_path)
+        with open(simple_tgu) as f:
+            definition = f.read()
+        with open(simple_results_csv) as f:
+            results = f.read()
+        assert "Optimal Configuration" in t.analyze_text(definition, results)
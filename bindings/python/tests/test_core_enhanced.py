@@ -419,15 +419,17 @@ class TestAsyncTaguchi:
         config = TaguchiConfig(cli_path=mock_cli_binary)
         async_taguchi = AsyncTaguchi(config=config)
         
-        # Mock the sync method that does the actual work
+        # Generation runs the CLI as an asyncio subprocess, not in an executor
         expected_runs = [
             {"run_id": 1, "factors": {"A": "1", "B": "low"}},
             {"run_id": 2, "factors": {"A": "2", "B": "high"}},
         ]
+        mock_output = "Run 1: A=1, B=low\nRun 2: A=2, B=high\n"
         
-        with patch.object(async_taguchi._taguchi, 'generate_runs', return_value=expected_runs):
+        with patch.object(async_taguchi, '_run_command_async', return_value=mock_output) as mock_run:
             runs = await async_taguchi.generate_runs_async('test.tgu')
             assert runs == expected_runs
+            assert mock_run.call_args[0][0][0] == "generate"
     
     @pytest.mark.asyncio 
     async def test_analyze_async(self, mock_cli_binary):
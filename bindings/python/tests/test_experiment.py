@@ -283,31 +283,28 @@ class TestGetTguPath:
 
 
 class TestContextManager:
-    def test_context_manager_cleans_up_tgu_file(self):
-        saved_path = None
+    def test_generate_writes_no_tgu_file(self, monkeypatch):
+        """generate() pipes the definition to the CLI instead of a temp file."""
+        def no_temp_files(*args, **kwargs):
+            raise AssertionError("temporary file created")
+        monkeypatch.setattr(tempfile, "mkstemp", no_temp_files)
+        monkeypatch.setattr(tempfile, "NamedTemporaryFile", no_temp_files)
         with Experiment() as exp:
             exp.add_factor("a", ["1", "2", "3"])
             exp.add_factor("b", ["x", "y", "z"])
+            assert len(exp.generate()) == 9
+            assert exp._tgu_path is None
+
+    def test_context_manager_cleans_up_requested_tgu_file(self):
+        saved_path = None
+        with Experiment() as exp:
+            exp.add_factor("a", ["1", "2", "3"])
+            saved_path = exp.get_tgu_path()
             exp.generate()
-            saved_path = exp._tgu_path
-            assert saved_path is not None
             assert os.path.exists(saved_path)
         # After __exit__, file should be gone
         assert not os.path.exists(saved_path)
 
-    def test_context_manager_cleans_up_on_exception(self):
-        saved_path = None
-        try:
-            with Experiment() as exp:
-                exp.add_factor("a", ["1", "2", "3"])
-                exp.generate()
-                saved_path = exp._tgu_path
-                raise RuntimeError("simulated error")
-        except RuntimeError:
-            pass
-        if saved_path:
-            assert not os.path.exists(saved_path)
-
     def test_context_manager_returns_experiment(self):
         with Experiment() as exp:
             assert isinstance(exp, Experiment)
@@ -92,7 +92,7 @@ Run 3: temp=high, pressure=low
             {"run_id": 2, "factors": {"temp": "high"}},
         ]
         mock_experiment.factors = {"temp": ["low", "high"]}
-        mock_experiment.get_tgu_path.return_value = "/tmp/test.tgu"
+        mock_experiment.tgu_content.return_value = "factors:\n  temp: low, high\n"
         
         # Mock effects output
         effects_mock = Mock()
@@ -303,7 +303,7 @@ class TestDependencyInjectionIntegration:
             {"run_id": 1, "factors": {"temp": "low", "pressure": "low"}},
             {"run_id": 2, "factors": {"temp": "high", "pressure": "high"}},
         ]
-        mock_taguchi.effects.return_value = "temp    0.050   L1=1.020, L2=1.070"
+        mock_taguchi.effects_text.return_value = "temp    0.050   L1=1.020, L2=1.070"
         
         # Create experiment with injected Taguchi
         exp = Experiment(taguchi=mock_taguchi)
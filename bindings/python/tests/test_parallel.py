@@ -0,0 +1,136 @@
+"""
+Tests for Experiment.run() — parallel evaluation streamed into a RunResult.
+"""
+
+import os
+import threading
+import time
+import pytest
+from taguchi.experiment import Experiment
+from taguchi.experiment_enhanced import Experiment as EnhancedExperiment
+from taguchi.analyzer import Analyzer
+from taguchi.core import TaguchiError
+from .conftest import CLI_PATH
+
+
+@pytest.fixture(autouse=True)
+def use_cli(monkeypatch):
+    monkeypatch.setenv("TAGUCHI_CLI_PATH", CLI_PATH)
+    from taguchi import core
+    monkeypatch.setattr(core.Taguchi, "_find_cli", lambda self, _: CLI_PATH)
+
+
+@pytest.fixture
+def l9_exp():
+    exp = Experiment()
+    exp.add_factor("a", ["1", "2", "3"])
+    exp.add_factor("b", ["1", "2", "3"])
+    exp.add_factor("c", ["1", "2", "3"])
+    return exp
+
+
+# Module-level so the process backend can pickle them
+def additive(factors):
+    return 10 * int(factors["a"]) + int(factors["b"])
+
+
+def report_pid(factors):
+    time.sleep(0.05)
+    return float(os.getpid() % 1000)
+
+
+def hangs_on_a3(factors):
+    if factors["a"] == "3" and factors["b"] == "1":
+        time.sleep(30)
+    return 1.0
+
+
+def fails_on_b2(factors):
+    if factors["b"] == "2":
+        raise ValueError("bad b")
+    return {"response": 1.0, "other": 2.0}
+
+
+class TestRunBackends:
+    @pytest.mark.parametrize("backend", ["process", "thread"])
+    def test_effects_recover_additive_model(self, l9_exp, backend):
+        result = l9_exp.run(additive, workers=3, backend=backend)
+        assert len(result.observations) == 9
+        assert not result.failures
+        effects = {e["factor"]: e for e in result.main_effects()}
+        assert effects["a"]["level_means"] == pytest.approx([12.0, 22.0, 32.0])
+        assert effects["b"]["range"] == pytest.approx(2.0)
+        assert effects["c"]["range"] == pytest.approx(0.0)
+
+    def test_process_backend_uses_several_workers(self, l9_exp):
+        result = l9_exp.run(report_pid, workers=3, backend="process")
+        assert len({v for _, _, v in result.observations}) > 1
+
+    def test_lambda_with_process_backend_is_explained(self, l9_exp):
+        with pytest.raises(TaguchiError, match="picklable"):
+            l9_exp.run(lambda f: 1.0, workers=2, backend="process")
+
+    def test_invalid_arguments(self, l9_exp):
+        with pytest.raises(TaguchiError, match="backend"):
+            l9_exp.run(additive, backend="gpu")
+        with pytest.raises(TaguchiError, match="replicates"):
+            l9_exp.run(additive, replicates=0)
+        with pytest.raises(TaguchiError, match="timeout"):
+            l9_exp.run(additive, timeout=0)
+
+
+class TestReplicatesAndFailures:
+    def test_replicates_are_separate_observations(self, l9_exp):
+        result = l9_exp.run(additive, workers=4, backend="thread", replicates=3)
+        assert result.total == 27
+        assert len(result.observations) == 27
+        assert result.results_csv().count("\n") == 28
+        assert result.run_means()[1] == pytest.approx(11.0)
+
+    def test_exceptions_recorded_as_failures(self, l9_exp):
+        result = l9_exp.run(fails_on_b2, workers=2, backend="process")
+        assert len(result.failures) == 3
+        assert all("ValueError: bad b" in reason for reason in result.failures.values())
+        assert result.completed == 9
+
+    def test_dict_result_uses_metric_name(self, l9_exp):
+        result = l9_exp.run(fails_on_b2, workers=2, backend="thread", metric_name="other")
+        assert {v for _, _, v in result.observations} == {2.0}
+        assert "run_id,other" in result.results_csv()
+
+    @pytest.mark.parametrize("backend", ["process", "thread"])
+    def test_timeout_marks_run_failed(self, l9_exp, backend):
+        start = time.monotonic()
+        result = l9_exp.run(hangs_on_a3, workers=3, backend=backend, timeout=0.5)
+        assert time.monotonic() - start < 10
+        assert len(result.failures) == 1
+        assert "timed out" in next(iter(result.failures.values()))
+        assert len(result.observations) == 8
+
+
+class TestLiveEffects:
+    def test_on_result_sees_growing_effects(self, l9_exp):
+        seen = []
+
+        def on_result(result, run_id, value):
+            assert threading.current_thread() is threading.main_thread()
+            if len(result.observations) in (3, 9):
+                seen.append(len(result.observations))
+                assert result.main_effects()
+
+        l9_exp.run(additive, workers=2, backend="thread", on_result=on_result)
+        assert seen == [3, 9]
+
+    def test_to_analyzer_holds_run_means(self, l9_exp):
+        result = l9_exp.run(additive, workers=2, backend="thread", replicates=2)
+        analyzer = result.to_analyzer()
+        assert isinstance(analyzer, Analyzer)
+        assert analyzer.recommend_optimal()["a"] == "3"
+
+    def test_enhanced_experiment_run(self):
+        exp = EnhancedExperiment()
+        exp.add_factor("a", ["1", "2", "3"])
+        exp.add_factor("b", ["1", "2", "3"])
+        result = exp.run(additive, workers=2, backend="thread")
+        assert len(result.observations) == exp.num_runs
+        assert result.to_analyzer().recommend_optimal()["a"] == "3"
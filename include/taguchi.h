@@ -7,6 +7,7 @@ extern "C" {
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 /* Library version */
 #define TAGUCHI_VERSION_MAJOR 1
@@ -21,6 +22,10 @@ typedef struct taguchi_experiment_def taguchi_experiment_def_t;
 typedef struct taguchi_experiment_run taguchi_experiment_run_t;
 typedef struct taguchi_result_set taguchi_result_set_t;
 typedef struct taguchi_main_effect taguchi_main_effect_t;
+typedef struct taguchi_context taguchi_context_t;
+typedef struct taguchi_future taguchi_future_t;
+typedef struct taguchi_ingest taguchi_ingest_t;
+typedef struct taguchi_run_index taguchi_run_index_t;
 
 /*
  * ============================================================================
@@ -146,6 +151,221 @@ size_t taguchi_def_get_factor_count(const taguchi_experiment_def_t *def);
  */
 const char *taguchi_def_get_factor_name(const taguchi_experiment_def_t *def, size_t index);
 
+/**
+ * Get number of levels of a factor in experiment definition.
+ *
+ * @param def Experiment definition
+ * @param index Factor index (0-based)
+ * @return Level count, or 0 if index out of range
+ */
+size_t taguchi_def_get_level_count(const taguchi_experiment_def_t *def, size_t index);
+
+/*
+ * Level values are parsed once with the definition into the most specific
+ * type that fits every level of a factor.  The typed value of a run is
+ * levels[taguchi_run_get_level_index(run, index)], so numeric consumers
+ * never parse level strings.
+ */
+typedef enum {
+    TAGUCHI_LEVEL_STRING = 0,   /* anything else: use the level strings */
+    TAGUCHI_LEVEL_BOOL = 1,     /* true/false, yes/no or on/off, any case */
+    TAGUCHI_LEVEL_INT = 2,      /* integers, with binary size suffixes K, M, G, T applied */
+    TAGUCHI_LEVEL_FLOAT = 3     /* numbers, at least one not an integer ("0.5", "1e-3") */
+} taguchi_level_type_t;
+
+/**
+ * Get the type of a factor's level values.
+ *
+ * @param def Experiment definition
+ * @param index Factor index (0-based)
+ * @return Level type, or TAGUCHI_LEVEL_STRING if index out of range
+ */
+taguchi_level_type_t taguchi_def_get_level_type(const taguchi_experiment_def_t *def, size_t index);
+
+/**
+ * Get the name of a level type: "string", "bool", "int" or "float".
+ *
+ * @param type Level type
+ * @return Static name, or "string" for an unknown type
+ */
+const char *taguchi_level_type_name(taguchi_level_type_t type);
+
+/**
+ * Get a factor's level values as integers ("64M" is 67108864).
+ *
+ * @param def Experiment definition
+ * @param index Factor index (0-based)
+ * @return Level values (do not free; bools are 0 and 1), or NULL unless the
+ *         factor is TAGUCHI_LEVEL_INT or TAGUCHI_LEVEL_BOOL
+ */
+const int64_t *taguchi_def_get_int_levels(const taguchi_experiment_def_t *def, size_t index);
+
+/**
+ * Get a factor's level values as numbers.
+ *
+ * @param def Experiment definition
+ * @param index Factor index (0-based)
+ * @return Level values (do not free), or NULL unless the factor is
+ *         TAGUCHI_LEVEL_INT or TAGUCHI_LEVEL_FLOAT
+ */
+const double *taguchi_def_get_numeric_levels(const taguchi_experiment_def_t *def, size_t index);
+
+/**
+ * Get the changeover cost of a factor (cost of changing its level between
+ * consecutive runs; 0 means free to change).
+ *
+ * @param def Experiment definition
+ * @param index Factor index (0-based)
+ * @return Changeover cost, or 0 if index out of range
+ */
+double taguchi_def_get_changeover_cost(const taguchi_experiment_def_t *def, size_t index);
+
+/**
+ * Set the changeover cost of a factor.
+ *
+ * @param def Experiment definition
+ * @param index Factor index (0-based)
+ * @param cost Changeover cost (finite, >= 0)
+ * @param error_buf Buffer for error message
+ * @return 0 on success, -1 on error
+ */
+int taguchi_def_set_changeover_cost(
+    taguchi_experiment_def_t *def,
+    size_t index,
+    double cost,
+    char *error_buf
+);
+
+/*
+ * ============================================================================
+ * Runtime Context API
+ * ============================================================================
+ */
+
+/* Chunk callback for taguchi_context_parallel_for: process items [begin, end) */
+typedef void (*taguchi_range_fn)(void *arg, size_t begin, size_t end);
+
+/* Options for taguchi_context_create (initialize with taguchi_context_options_init) */
+typedef struct {
+    size_t max_workers;                      /* threads incl. caller; 0 = online CPUs */
+    void *(*alloc)(size_t size, void *user); /* scratch allocator; NULL = malloc */
+    void (*release)(void *ptr, void *user);  /* matching release; NULL = free */
+    void *alloc_user;                        /* passed to alloc/release */
+} taguchi_context_options_t;
+
+/**
+ * Initialize context options to defaults.
+ *
+ * @param opts Options to initialize
+ */
+void taguchi_context_options_init(taguchi_context_options_t *opts);
+
+/**
+ * Create a runtime context.
+ *
+ * A context owns a work-stealing thread pool (started on first parallel
+ * use), the design cache configuration and the allocator used for library
+ * scratch memory.  The array catalog is immutable and shared.  The worker
+ * count is always capped by the TAGUCHI_MAX_WORKERS environment variable.
+ *
+ * @param opts Options, or NULL for defaults
+ * @param error_buf Buffer for error message
+ * @return Context handle, or NULL on error
+ */
+taguchi_context_t *taguchi_context_create(
+    const taguchi_context_options_t *opts,
+    char *error_buf
+);
+
+/**
+ * Free a context and join its worker threads.  The default context is
+ * never freed.
+ *
+ * @param ctx Context to free
+ */
+void taguchi_context_free(taguchi_context_t *ctx);
+
+/**
+ * Get the default context, used by every API call without a context.
+ *
+ * @return Default context (do not free)
+ */
+taguchi_context_t *taguchi_default_context(void);
+
+/**
+ * Get the maximum number of threads (including the caller) a context uses.
+ *
+ * @param ctx Context, or NULL for the default context
+ * @return Worker count
+ */
+size_t taguchi_context_get_max_workers(const taguchi_context_t *ctx);
+
+/**
+ * Change the maximum number of threads of a context.  Must not be called
+ * while the context is running work.
+ *
+ * @param ctx Context, or NULL for the default context
+ * @param max_workers Threads including the caller; 0 = online CPUs
+ * @return 0 on success
+ */
+int taguchi_context_set_max_workers(taguchi_context_t *ctx, size_t max_workers);
+
+/**
+ * Run fn over [0, count) on the context's pool, in chunks of at least
+ * grain items.  The calling thread takes part, so calls may be nested.
+ * Returns when every chunk has completed.
+ *
+ * @param ctx Context, or NULL for the default context
+ * @param count Number of items
+ * @param grain Minimum items per chunk
+ * @param fn Chunk callback
+ * @param arg Passed to fn
+ */
+void taguchi_context_parallel_for(
+    taguchi_context_t *ctx,
+    size_t count,
+    size_t grain,
+    taguchi_range_fn fn,
+    void *arg
+);
+
+/*
+ * ============================================================================
+ * Design Cache API
+ * ============================================================================
+ */
+
+/**
+ * Enable the on-disk compiled-design cache.
+ *
+ * Generation and main-effects analysis compile a definition into an array
+ * choice, column map and level-index matrix.  With a cache directory set,
+ * compiled designs are stored there keyed by a hash of the normalized
+ * definition (array type and level counts) plus the library version, and
+ * later calls map the cached file instead of recompiling.  A conventional
+ * location is $XDG_CACHE_HOME/taguchi.  Applies to the default context.
+ *
+ * @param dir Cache directory (created if missing), or NULL to disable
+ * @param error_buf Buffer for error message
+ * @return 0 on success, -1 if the directory cannot be created
+ */
+int taguchi_set_design_cache_dir(const char *dir, char *error_buf);
+
+/**
+ * Set the design cache directory of a specific context (see
+ * taguchi_set_design_cache_dir, which applies to the default context).
+ *
+ * @param ctx Context, or NULL for the default context
+ * @param dir Cache directory (created if missing), or NULL to disable
+ * @param error_buf Buffer for error message
+ * @return 0 on success, -1 if the directory cannot be created
+ */
+int taguchi_context_set_design_cache_dir(
+    taguchi_context_t *ctx,
+    const char *dir,
+    char *error_buf
+);
+
 /*
  * ============================================================================
  * Generation API
@@ -168,6 +388,20 @@ int taguchi_generate_runs(
     char *error_buf
 );
 
+/**
+ * Generate experiment runs using a specific context.
+ *
+ * @param ctx Context, or NULL for the default context
+ * @see taguchi_generate_runs
+ */
+int taguchi_generate_runs_ctx(
+    taguchi_context_t *ctx,
+    const taguchi_experiment_def_t *def,
+    taguchi_experiment_run_t ***runs_out,
+    size_t *count_out,
+    char *error_buf
+);
+
 /**
  * Get run configuration value by factor name.
  *
@@ -210,6 +444,36 @@ size_t taguchi_run_get_factor_count(
  */
 size_t taguchi_run_get_id(const taguchi_experiment_run_t *run);
 
+/**
+ * Get the level index a run uses for a factor.
+ *
+ * Unlike the value string this is unambiguous when a factor repeats a
+ * level value.
+ *
+ * @param run Experiment run
+ * @param factor_index Factor index (0-based)
+ * @return Level index (0-based), or 0 if factor_index is out of range
+ */
+size_t taguchi_run_get_level_index(const taguchi_experiment_run_t *run, size_t factor_index);
+
+/**
+ * Get the level indices of all factors in a run.
+ *
+ * @param run Experiment run
+ * @return taguchi_run_get_factor_count() level indices in factor order
+ *         (do not free; valid until the runs are freed), or NULL
+ */
+const size_t *taguchi_run_get_level_indices(const taguchi_experiment_run_t *run);
+
+/**
+ * Get run configuration value by factor index.
+ *
+ * @param run Experiment run
+ * @param index Factor index (0-based)
+ * @return Factor value, or NULL if index out of range (do not free)
+ */
+const char *taguchi_run_get_value_at_index(const taguchi_experiment_run_t *run, size_t index);
+
 /**
  * Get all factor names in run.
  * 
@@ -221,11 +485,47 @@ const char **taguchi_run_get_factor_names(const taguchi_experiment_run_t *run);
 /**
  * Free experiment runs.
  * 
+ * The runs share one allocation, so free them together, with the array
+ * and count returned by taguchi_generate_runs (the order of the pointers
+ * may have been changed).
+ * 
  * @param runs Array of run pointers
  * @param count Number of runs
  */
 void taguchi_free_runs(taguchi_experiment_run_t **runs, size_t count);
 
+/*
+ * ============================================================================
+ * Run Ordering API
+ * ============================================================================
+ */
+
+/**
+ * Plan the order in which to execute runs so that hard-to-change factors
+ * change level as rarely as possible.
+ *
+ * Going from one run to the next costs the sum of the changeover costs of
+ * the factors whose level differs.  The order is found heuristically
+ * (nearest neighbour from several starts, then 2-opt) and is never worse
+ * than array order; with no costly factor it is array order.
+ *
+ * @param def Experiment definition
+ * @param order_out Output: 0-based indices into taguchi_generate_runs()
+ * @param count Size of order_out; must equal the number of runs
+ * @param cost_out Output for the planned order's cost (may be NULL)
+ * @param array_order_cost_out Output for array order's cost (may be NULL)
+ * @param error_buf Buffer for error message
+ * @return 0 on success, -1 on error
+ */
+int taguchi_plan_run_order(
+    const taguchi_experiment_def_t *def,
+    size_t *order_out,
+    size_t count,
+    double *cost_out,
+    double *array_order_cost_out,
+    char *error_buf
+);
+
 /*
  * ============================================================================
  * Results API
@@ -260,6 +560,38 @@ int taguchi_add_result(
     char *error_buf
 );
 
+/**
+ * Number of results added to a result set.
+ *
+ * @param results Result set
+ * @return Result count (replicates counted separately)
+ */
+size_t taguchi_result_count(const taguchi_result_set_t *results);
+
+/**
+ * Result at a position, in the order results were added.
+ *
+ * @param results Result set
+ * @param index Position (0 to taguchi_result_count() - 1)
+ * @param run_id_out Receives the run ID (may be NULL)
+ * @param response_out Receives the response value (may be NULL)
+ * @return 0 on success, -1 if index is out of range
+ */
+int taguchi_result_get(
+    const taguchi_result_set_t *results,
+    size_t index,
+    size_t *run_id_out,
+    double *response_out
+);
+
+/**
+ * Metric name a result set was created with.
+ *
+ * @param results Result set
+ * @return Metric name (owned by the result set)
+ */
+const char *taguchi_result_metric(const taguchi_result_set_t *results);
+
 /**
  * Free result set.
  * 
@@ -276,6 +608,9 @@ void taguchi_free_result_set(taguchi_result_set_t *results);
 /**
  * Calculate main effects from results.
  * 
+ * Several results for one run (replicates) are averaged first, so every
+ * run carries the same weight in the level means.
+ *
  * @param results Result set
  * @param effects_out Output: array of effect pointers (caller must free)
  * @param count_out Output: number of effects
@@ -289,6 +624,20 @@ int taguchi_calculate_main_effects(
     char *error_buf
 );
 
+/**
+ * Calculate main effects using a specific context.
+ *
+ * @param ctx Context, or NULL for the default context
+ * @see taguchi_calculate_main_effects
+ */
+int taguchi_calculate_main_effects_ctx(
+    taguchi_context_t *ctx,
+    const taguchi_result_set_t *results,
+    taguchi_main_effect_t ***effects_out,
+    size_t *count_out,
+    char *error_buf
+);
+
 /**
  * Get effect factor name.
  * 
@@ -345,18 +694,790 @@ int taguchi_recommend_optimal(
 
 /*
  * ============================================================================
- * Serialization API (for language bindings)
+ * Split-Plot Analysis API
  * ============================================================================
  */
 
+/* Error stratum of a split-plot ANOVA row */
+typedef enum {
+    TAGUCHI_STRATUM_WHOLE_PLOT = 0,  /* tested against whole-plot error */
+    TAGUCHI_STRATUM_SUB_PLOT = 1     /* tested against sub-plot error */
+} taguchi_stratum_t;
+
+/* One row of a split-plot ANOVA table */
+typedef struct {
+    char source[64];            /* factor name, or "error" */
+    taguchi_stratum_t stratum;
+    bool is_error;              /* the stratum's residual row */
+    double sum_squares;
+    size_t df;
+    double mean_square;         /* NAN when df is 0 */
+    double f_ratio;             /* NAN for error rows or without error df */
+    double p_value;             /* NAN for error rows or without error df */
+} taguchi_anova_row_t;
+
 /**
- * Serialize runs to JSON string.
- * 
- * @param runs Array of run pointers
- * @param count Number of runs
- * @return JSON string (caller must free with taguchi_free_string)
+ * Whether a definition is a split-plot design (has whole-plot factors).
+ *
+ * @param def Experiment definition
+ * @return true if any factor is listed under whole_plot
  */
-char *taguchi_runs_to_json(
+bool taguchi_def_is_split_plot(const taguchi_experiment_def_t *def);
+
+/**
+ * Whether a factor is a whole-plot (hard-to-change) factor.
+ *
+ * @param def Experiment definition
+ * @param index Factor index (0-based)
+ * @return true for whole-plot factors, false otherwise or if out of range
+ */
+bool taguchi_def_is_whole_plot_factor(const taguchi_experiment_def_t *def, size_t index);
+
+/**
+ * Get the whole plot of every run.  Runs of one whole plot are consecutive
+ * and share their whole-plot factor levels.
+ *
+ * @param def Experiment definition
+ * @param plot_out Output: whole-plot number (1-indexed) of each run, in run order
+ * @param count Size of plot_out; must equal the number of runs
+ * @param error_buf Buffer for error message
+ * @return Number of whole plots, or 0 on error
+ */
+size_t taguchi_get_whole_plots(
+    const taguchi_experiment_def_t *def,
+    size_t *plot_out,
+    size_t count,
+    char *error_buf
+);
+
+/**
+ * Split-plot ANOVA: whole-plot factors are tested against the variation
+ * between whole plots they do not explain, sub-plot factors against the
+ * variation within whole plots.  Rows are grouped by stratum, each ending
+ * with its error row.  Sums of squares are exact for balanced designs
+ * (every crossed layout, nested layouts whose sub-plot factors are balanced
+ * within whole plots).
+ *
+ * @param results Result set of a split-plot definition
+ * @param rows_out Output: ANOVA rows (free with taguchi_free_anova)
+ * @param count_out Output: number of rows
+ * @param error_buf Buffer for error message
+ * @return 0 on success, -1 on error
+ */
+int taguchi_split_plot_anova(
+    const taguchi_result_set_t *results,
+    taguchi_anova_row_t **rows_out,
+    size_t *count_out,
+    char *error_buf
+);
+
+/**
+ * Free ANOVA rows.
+ *
+ * @param rows Rows from taguchi_split_plot_anova
+ */
+void taguchi_free_anova(taguchi_anova_row_t *rows);
+
+/*
+ * ============================================================================
+ * Adaptive Replication API
+ * ============================================================================
+ */
+
+/* Options for taguchi_plan_replicates */
+typedef struct {
+    double confidence;          /* two-sided confidence level, e.g. 0.95 */
+    bool higher_is_better;      /* direction of the recommendation */
+    size_t top_factors;         /* factors (largest effect first) whose best level
+                                   must be resolved; 0 means all */
+} taguchi_replication_options_t;
+
+/* Where an adaptive campaign stands after taguchi_plan_replicates */
+typedef struct {
+    bool stable;                /* every top factor's best level is resolved */
+    size_t resolved;            /* top factors whose best level is resolved */
+    size_t top_factors;         /* factors considered */
+    size_t error_df;            /* replicate degrees of freedom */
+    double pooled_sd;           /* within-run standard deviation */
+} taguchi_replication_status_t;
+
+/**
+ * Initialize replication options: 95% confidence, higher is better, the
+ * three factors with the largest effects.
+ *
+ * @param opts Options to initialize
+ */
+void taguchi_replication_options_init(taguchi_replication_options_t *opts);
+
+/**
+ * Confidence intervals of a factor's level means.  Level means are averages
+ * of run means; the variance comes from the pooled spread of replicates
+ * within runs, so at least one run needs two results.
+ *
+ * @param results Result set
+ * @param factor_index Factor index (0-based)
+ * @param confidence Two-sided confidence level (0 < confidence < 1)
+ * @param means_out Output: level means (level_count entries)
+ * @param half_widths_out Output: interval half-widths (level_count entries;
+ *        INFINITY for levels without results)
+ * @param level_count Number of levels of the factor
+ * @param error_buf Buffer for error message
+ * @return 0 on success, -1 on error
+ */
+int taguchi_level_intervals(
+    const taguchi_result_set_t *results,
+    size_t factor_index,
+    double confidence,
+    double *means_out,
+    double *half_widths_out,
+    size_t level_count,
+    char *error_buf
+);
+
+/**
+ * Plan the next round of an adaptive replication campaign.
+ *
+ * A top factor is resolved when its best level beats the runner-up by more
+ * than the confidence interval of their difference.  Replicates go to the
+ * runs whose next result shrinks those intervals most, summed over the
+ * unresolved factors.  Runs without results, or no replicates at all, are
+ * scheduled first.
+ *
+ * @param results Results so far
+ * @param opts Options (NULL for defaults)
+ * @param run_ids_out Output: run IDs to replicate next, best first
+ * @param max_runs Room in run_ids_out (the round size)
+ * @param count_out Output: run IDs written (0 once the campaign is stable)
+ * @param status_out Output: campaign status (may be NULL)
+ * @param error_buf Buffer for error message
+ * @return 0 on success, -1 on error
+ */
+int taguchi_plan_replicates(
+    const taguchi_result_set_t *results,
+    const taguchi_replication_options_t *opts,
+    size_t *run_ids_out,
+    size_t max_runs,
+    size_t *count_out,
+    taguchi_replication_status_t *status_out,
+    char *error_buf
+);
+
+/*
+ * ============================================================================
+ * Campaign Comparison API
+ * ============================================================================
+ */
+
+/* Options for taguchi_compare_results */
+typedef struct {
+    size_t permutations;        /* randomization test with this many shuffles;
+                                   0 tests against the error estimate instead */
+    uint64_t seed;              /* shuffle stream; equal seeds give equal p-values */
+    double alpha;               /* family-wise level of the Holm-adjusted tests */
+} taguchi_compare_options_t;
+
+/* Where the variance of a run difference comes from */
+typedef enum {
+    TAGUCHI_COMPARE_ERROR_NONE = 0,        /* saturated, unreplicated: no estimate */
+    TAGUCHI_COMPARE_ERROR_REPLICATES = 1,  /* pooled spread of replicates within runs */
+    TAGUCHI_COMPARE_ERROR_RESIDUAL = 2     /* what the main effects leave unexplained */
+} taguchi_compare_error_t;
+
+/* How one factor's effect changed from campaign A to campaign B */
+typedef struct {
+    char factor[64];
+    size_t factor_index;        /* position in the definition */
+    size_t level_count;
+    double *delta;              /* per level: effect in B minus effect in A
+                                   (NAN for levels without aligned runs) */
+    double *std_error;          /* per level; NAN without an error estimate */
+    double range_a;             /* level-mean range over the aligned runs */
+    double range_b;
+    double sum_squares;         /* between-level sum of squares of the run differences */
+    size_t df;
+    double p_value;             /* F or permutation test; NAN if neither applies */
+    double adjusted_p;          /* Holm-adjusted across factors */
+    bool significant;           /* adjusted_p <= alpha */
+} taguchi_factor_change_t;
+
+/* Campaign-wide part of a comparison */
+typedef struct {
+    size_t runs;                /* runs with results in both campaigns */
+    double shift;               /* mean run difference, B - A */
+    double shift_se;            /* NAN without an error estimate */
+    taguchi_compare_error_t error_source;
+    double error_sd;            /* sd of one run difference (NAN without an estimate) */
+    size_t error_df;
+    size_t permutations;        /* shuffles behind the p-values, 0 for F tests */
+} taguchi_comparison_summary_t;
+
+/**
+ * Initialize comparison options: F tests (no permutations), seed 1,
+ * alpha 0.05.
+ *
+ * @param opts Options to initialize
+ */
+void taguchi_compare_options_init(taguchi_compare_options_t *opts);
+
+/**
+ * Compare the main effects of two campaigns run on the same design (same
+ * array, factor names and level counts; level values may differ).
+ *
+ * Runs are aligned by run ID and only runs with results in both campaigns
+ * take part.  Each run contributes the difference of its run means, B - A;
+ * a factor changed when those differences vary between its levels.  The
+ * test is an F test against the replicate (or else residual) variance, or
+ * with opts->permutations a randomization test that shuffles the run
+ * differences across runs, spread over the context's thread pool.  A
+ * saturated, unreplicated design has no error estimate and needs the
+ * randomization test.  Factors are returned most significant first.
+ *
+ * @param a Baseline results
+ * @param b Results to compare against the baseline
+ * @param opts Options (NULL for defaults)
+ * @param changes_out Output: one entry per factor (free with taguchi_free_factor_changes)
+ * @param count_out Output: number of entries
+ * @param summary_out Output: campaign-wide shift and error estimate (may be NULL)
+ * @param error_buf Buffer for error message
+ * @return 0 on success, -1 on error
+ */
+int taguchi_compare_results(
+    const taguchi_result_set_t *a,
+    const taguchi_result_set_t *b,
+    const taguchi_compare_options_t *opts,
+    taguchi_factor_change_t **changes_out,
+    size_t *count_out,
+    taguchi_comparison_summary_t *summary_out,
+    char *error_buf
+);
+
+/**
+ * Same as taguchi_compare_results, with the permutations on ctx.
+ */
+int taguchi_compare_results_ctx(
+    taguchi_context_t *ctx,
+    const taguchi_result_set_t *a,
+    const taguchi_result_set_t *b,
+    const taguchi_compare_options_t *opts,
+    taguchi_factor_change_t **changes_out,
+    size_t *count_out,
+    taguchi_comparison_summary_t *summary_out,
+    char *error_buf
+);
+
+/**
+ * Free factor changes.
+ *
+ * @param changes Entries from taguchi_compare_results
+ * @param count Number of entries
+ */
+void taguchi_free_factor_changes(taguchi_factor_change_t *changes, size_t count);
+
+/*
+ * ============================================================================
+ * Response Curve API
+ * ============================================================================
+ */
+
+/* Options for taguchi_fit_response_curves */
+typedef struct {
+    size_t degree;              /* degree of the fitted curve, 1 to 3 */
+    bool higher_is_better;      /* which end of the curve is the optimum */
+} taguchi_curve_options_t;
+
+/* Polynomial response curve of one numeric factor over its tested values */
+typedef struct {
+    char factor[64];
+    size_t factor_index;        /* position in the definition */
+    size_t points;              /* distinct tested values with results */
+    size_t degree;              /* degree fitted: opts->degree, at most points - 1 */
+    double contrast[3];         /* linear, quadratic, cubic contrast: signed square root
+                                   of its sum of squares (NAN beyond points - 1) */
+    double contrast_share[3];   /* share of the factor's between-level sum of squares */
+    double fit_share;           /* share explained by the fitted curve */
+    double low;                 /* tested range */
+    double high;
+    double center;              /* the curve is in u = (x - center) / scale */
+    double scale;
+    double coefficients[4];     /* curve = sum of coefficients[k] * u^k */
+    double optimum;             /* best value on the curve within [low, high] */
+    double predicted;           /* curve at optimum: predicted mean response */
+    bool interior;              /* optimum lies strictly between low and high */
+    size_t best_level;          /* best tested level, for comparison */
+    double best_level_mean;
+} taguchi_response_curve_t;
+
+/**
+ * Initialize curve options: quadratic curves, higher is better.
+ *
+ * @param opts Options to initialize
+ */
+void taguchi_curve_options_init(taguchi_curve_options_t *opts);
+
+/**
+ * Fit a response curve to each numeric factor's level means.
+ *
+ * Level means are means of run means, as in taguchi_calculate_main_effects,
+ * weighted by the runs behind them.  Orthogonal polynomials over the tested
+ * values split each factor's between-level sum of squares into linear,
+ * quadratic and cubic contrasts; the first opts->degree of them form the
+ * curve, whose best point within the tested range is the interpolated
+ * optimum.  Factors with non-numeric levels, or fewer than two distinct
+ * tested values, get no curve.
+ *
+ * @param results Result set
+ * @param opts Options (NULL for defaults)
+ * @param curves_out Output: curves in definition order (free with taguchi_free_response_curves)
+ * @param count_out Output: number of curves
+ * @param error_buf Buffer for error message
+ * @return 0 on success, -1 on error
+ */
+int taguchi_fit_response_curves(
+    const taguchi_result_set_t *results,
+    const taguchi_curve_options_t *opts,
+    taguchi_response_curve_t **curves_out,
+    size_t *count_out,
+    char *error_buf
+);
+
+/**
+ * Same as taguchi_fit_response_curves, compiling the design on ctx.
+ */
+int taguchi_fit_response_curves_ctx(
+    taguchi_context_t *ctx,
+    const taguchi_result_set_t *results,
+    const taguchi_curve_options_t *opts,
+    taguchi_response_curve_t **curves_out,
+    size_t *count_out,
+    char *error_buf
+);
+
+/**
+ * Predicted mean response of a curve at level value x.
+ *
+ * @param curve Curve from taguchi_fit_response_curves
+ * @param x Level value (meaningful within [low, high])
+ * @return Curve value
+ */
+double taguchi_curve_predict(const taguchi_response_curve_t *curve, double x);
+
+/**
+ * Free response curves.
+ *
+ * @param curves Curves from taguchi_fit_response_curves
+ */
+void taguchi_free_response_curves(taguchi_response_curve_t *curves);
+
+/*
+ * ============================================================================
+ * Run Index API
+ * ============================================================================
+ */
+
+/*
+ * Run sets are bitsets of taguchi_run_index_words() uint64_t words; bit
+ * (id - 1) % 64 of word (id - 1) / 64 stands for run id.  Bits past the
+ * last run are ignored.
+ */
+
+/**
+ * Build a bitmap index of def's design: for every factor level, the set of
+ * runs that use it.  Only the level matrix is compiled; no runs are
+ * generated.  def must outlive the index.
+ *
+ * @param def Experiment definition
+ * @param error_buf Buffer for error message
+ * @return Index handle, or NULL on error
+ */
+taguchi_run_index_t *taguchi_run_index_create(const taguchi_experiment_def_t *def, char *error_buf);
+
+/**
+ * Get the number of runs in the indexed design.
+ *
+ * @param index Run index
+ * @return Run count
+ */
+size_t taguchi_run_index_run_count(const taguchi_run_index_t *index);
+
+/**
+ * Get the size of a run set.
+ *
+ * @param index Run index
+ * @return uint64_t words per run set
+ */
+size_t taguchi_run_index_words(const taguchi_run_index_t *index);
+
+/**
+ * Get the runs that use a level of a factor.
+ *
+ * @param index Run index
+ * @param factor_index Factor index (0-based)
+ * @param level_index Level index (0-based)
+ * @return Run set (do not free; valid until the index is freed), or NULL
+ *         if either index is out of range
+ */
+const uint64_t *taguchi_run_index_level(
+    const taguchi_run_index_t *index,
+    size_t factor_index,
+    size_t level_index
+);
+
+/**
+ * Get the runs in which a factor takes a value ("threads", "64"); levels
+ * that repeat the value all count.
+ *
+ * @param index Run index
+ * @param factor_name Factor name
+ * @param value Level value
+ * @param bits_out Output: run set (taguchi_run_index_words() words)
+ * @param error_buf Buffer for error message
+ * @return 0 on success, -1 if there is no such factor or value
+ */
+int taguchi_run_index_select(
+    const taguchi_run_index_t *index,
+    const char *factor_name,
+    const char *value,
+    uint64_t *bits_out,
+    char *error_buf
+);
+
+/**
+ * Free a run index.
+ *
+ * @param index Run index to free
+ */
+void taguchi_run_index_free(taguchi_run_index_t *index);
+
+/** Intersect run sets: dst &= src. */
+void taguchi_bitset_and(uint64_t *dst, const uint64_t *src, size_t words);
+
+/** Unite run sets: dst |= src. */
+void taguchi_bitset_or(uint64_t *dst, const uint64_t *src, size_t words);
+
+/** Number of runs in a run set. */
+size_t taguchi_bitset_count(const uint64_t *bits, size_t words);
+
+/**
+ * List the run IDs in a run set, in increasing order.
+ *
+ * @param bits Run set
+ * @param words Words in the run set
+ * @param ids_out Output: run IDs (1-indexed; may be NULL when max_ids is 0)
+ * @param max_ids Room in ids_out
+ * @return Number of runs in the set (more than max_ids when truncated)
+ */
+size_t taguchi_bitset_runs(const uint64_t *bits, size_t words, size_t *ids_out, size_t max_ids);
+
+/**
+ * Calculate main effects over a subset of runs, e.g. the effects of every
+ * other factor given compression=zstd.  Level means are means of run means
+ * as in taguchi_calculate_main_effects(); levels without results in the
+ * subset get a NAN mean and are left out of the range.
+ *
+ * @param results Result set (created from the indexed definition)
+ * @param index Run index
+ * @param subset Run set to analyze
+ * @param effects_out Output: array of effect pointers (free with
+ *        taguchi_free_effects)
+ * @param count_out Output: number of effects
+ * @param error_buf Buffer for error message
+ * @return 0 on success, -1 on error
+ */
+int taguchi_calculate_conditional_effects(
+    const taguchi_result_set_t *results,
+    const taguchi_run_index_t *index,
+    const uint64_t *subset,
+    taguchi_main_effect_t ***effects_out,
+    size_t *count_out,
+    char *error_buf
+);
+
+/*
+ * ============================================================================
+ * Concurrent Ingestion API
+ * ============================================================================
+ */
+
+/**
+ * Create a concurrent ingestion queue for def.
+ *
+ * Any number of threads push results without locks; one consumer thread
+ * drains them into a run-indexed store and running per-level sums, and
+ * readers on any thread take consistent effect snapshots meanwhile.
+ * def must outlive the queue.
+ *
+ * @param def Experiment definition
+ * @param capacity Pending results the ring holds (rounded up to a power of 2)
+ * @param error_buf Buffer for error message
+ * @return Queue handle, or NULL on error
+ */
+taguchi_ingest_t *taguchi_ingest_create(
+    const taguchi_experiment_def_t *def,
+    size_t capacity,
+    char *error_buf
+);
+
+/**
+ * Push a result (any thread, lock-free).
+ *
+ * @param ingest Queue handle
+ * @param run_id Run ID (from taguchi_run_get_id)
+ * @param response_value Measured response value
+ * @return 0 on success, -1 if the ring is full (counted as dropped)
+ */
+int taguchi_ingest_push(taguchi_ingest_t *ingest, size_t run_id, double response_value);
+
+/**
+ * Apply pending results to the store.  Only one thread may drain.
+ *
+ * @param ingest Queue handle
+ * @param max_items Maximum results to apply; 0 = everything pending
+ * @return Number of results taken from the ring
+ */
+size_t taguchi_ingest_drain(taguchi_ingest_t *ingest, size_t max_items);
+
+/**
+ * Main effects of all results drained so far (any thread).  The snapshot
+ * reflects whole drain batches; it never mixes a half-applied batch.
+ *
+ * @param ingest Queue handle
+ * @param effects_out Output for effect pointers (free with taguchi_free_effects)
+ * @param count_out Output for effect count
+ * @param observations_out Output for the number of results included, or NULL
+ * @param error_buf Buffer for error message
+ * @return 0 on success, -1 on error
+ */
+int taguchi_ingest_snapshot_effects(
+    const taguchi_ingest_t *ingest,
+    taguchi_main_effect_t ***effects_out,
+    size_t *count_out,
+    size_t *observations_out,
+    char *error_buf
+);
+
+/**
+ * Mean and count of drained responses for one run (any thread).
+ *
+ * @param ingest Queue handle
+ * @param run_id Run ID
+ * @param mean_out Output for the mean response, or NULL
+ * @param count_out Output for the number of responses, or NULL
+ * @return 0 on success, -1 if run_id is not in the design
+ */
+int taguchi_ingest_run_stats(const taguchi_ingest_t *ingest, size_t run_id, double *mean_out, size_t *count_out);
+
+/**
+ * Number of pushes refused because the ring was full.
+ *
+ * @param ingest Queue handle
+ * @return Dropped count
+ */
+size_t taguchi_ingest_dropped(const taguchi_ingest_t *ingest);
+
+/**
+ * Number of drained results whose run ID is not in the design.
+ *
+ * @param ingest Queue handle
+ * @return Rejected count
+ */
+size_t taguchi_ingest_rejected(const taguchi_ingest_t *ingest);
+
+/**
+ * Copy every accepted result into a new result set.  Call from the
+ * draining thread.
+ *
+ * @param ingest Queue handle
+ * @param metric_name Name of metric being measured
+ * @return Result set handle (free with taguchi_free_result_set), or NULL on error
+ */
+taguchi_result_set_t *taguchi_ingest_to_result_set(const taguchi_ingest_t *ingest, const char *metric_name);
+
+/**
+ * Free an ingestion queue.  No thread may still be pushing.
+ *
+ * @param ingest Queue handle
+ */
+void taguchi_ingest_free(taguchi_ingest_t *ingest);
+
+/*
+ * ============================================================================
+ * Async API
+ * ============================================================================
+ */
+
+/* State of an asynchronous operation */
+typedef enum {
+    TAGUCHI_FUTURE_PENDING,    /* queued on the pool */
+    TAGUCHI_FUTURE_RUNNING,
+    TAGUCHI_FUTURE_DONE,       /* result ready to take */
+    TAGUCHI_FUTURE_FAILED,     /* see taguchi_future_error */
+    TAGUCHI_FUTURE_CANCELLED
+} taguchi_future_status_t;
+
+/*
+ * Completion callback, invoked once on a pool thread after the future has
+ * reached its final state.  It may take the result and free the future.
+ */
+typedef void (*taguchi_completion_fn)(taguchi_future_t *future, void *user);
+
+/**
+ * Start taguchi_generate_runs_ctx on the context's pool.
+ *
+ * def must stay valid until the future is finished (or freed).
+ *
+ * @param ctx Context, or NULL for the default context
+ * @param def Experiment definition
+ * @param on_complete Completion callback, or NULL
+ * @param user Passed to on_complete
+ * @param error_buf Buffer for error message
+ * @return Future handle (free with taguchi_future_free), or NULL on error
+ */
+taguchi_future_t *taguchi_generate_runs_async(
+    taguchi_context_t *ctx,
+    const taguchi_experiment_def_t *def,
+    taguchi_completion_fn on_complete,
+    void *user,
+    char *error_buf
+);
+
+/**
+ * Start taguchi_calculate_main_effects_ctx on the context's pool.
+ *
+ * results must stay valid and unmodified until the future is finished.
+ *
+ * @param ctx Context, or NULL for the default context
+ * @param results Result set
+ * @param on_complete Completion callback, or NULL
+ * @param user Passed to on_complete
+ * @param error_buf Buffer for error message
+ * @return Future handle (free with taguchi_future_free), or NULL on error
+ */
+taguchi_future_t *taguchi_calculate_main_effects_async(
+    taguchi_context_t *ctx,
+    const taguchi_result_set_t *results,
+    taguchi_completion_fn on_complete,
+    void *user,
+    char *error_buf
+);
+
+/**
+ * Get the current state of a future.
+ *
+ * @param future Future handle
+ * @return Status
+ */
+taguchi_future_status_t taguchi_future_status(const taguchi_future_t *future);
+
+/**
+ * Get an eventfd that becomes readable once the future is finished, for
+ * use with poll/epoll/libuv.  The library never reads it; it is closed by
+ * taguchi_future_free.
+ *
+ * @param future Future handle
+ * @return File descriptor, or -1 if eventfd is unavailable
+ */
+int taguchi_future_fd(const taguchi_future_t *future);
+
+/**
+ * Wait for a future to finish.
+ *
+ * @param future Future handle
+ * @param timeout_ms Maximum wait in milliseconds; negative waits forever
+ * @return Status after waiting (PENDING or RUNNING on timeout)
+ */
+taguchi_future_status_t taguchi_future_wait(taguchi_future_t *future, int timeout_ms);
+
+/**
+ * Request cancellation.  A queued operation never starts; a running one
+ * finishes its current step and its result is discarded.  Either way the
+ * future ends as CANCELLED and the callback still runs.
+ *
+ * @param future Future handle
+ * @return 0 if the request took effect, -1 if the future had already finished
+ */
+int taguchi_future_cancel(taguchi_future_t *future);
+
+/**
+ * Get the error message of a FAILED future.
+ *
+ * @param future Future handle
+ * @return Error message ("" unless FAILED)
+ */
+const char *taguchi_future_error(const taguchi_future_t *future);
+
+/**
+ * Take the runs of a DONE generate future.  Ownership moves to the caller
+ * (free with taguchi_free_runs); a second call fails.
+ *
+ * @param future Future from taguchi_generate_runs_async
+ * @param runs_out Output for run pointers
+ * @param count_out Output for run count
+ * @param error_buf Buffer for error message
+ * @return 0 on success, -1 on error
+ */
+int taguchi_future_take_runs(
+    taguchi_future_t *future,
+    taguchi_experiment_run_t ***runs_out,
+    size_t *count_out,
+    char *error_buf
+);
+
+/**
+ * Take the effects of a DONE analysis future.  Ownership moves to the
+ * caller (free with taguchi_free_effects); a second call fails.
+ *
+ * @param future Future from taguchi_calculate_main_effects_async
+ * @param effects_out Output for effect pointers
+ * @param count_out Output for effect count
+ * @param error_buf Buffer for error message
+ * @return 0 on success, -1 on error
+ */
+int taguchi_future_take_effects(
+    taguchi_future_t *future,
+    taguchi_main_effect_t ***effects_out,
+    size_t *count_out,
+    char *error_buf
+);
+
+/**
+ * Free a future.  An unfinished future is cancelled and waited for, so
+ * its inputs may be released afterwards.  May be called from the
+ * completion callback.  Results not taken are freed.
+ *
+ * @param future Future handle
+ */
+void taguchi_future_free(taguchi_future_t *future);
+
+/*
+ * ============================================================================
+ * Serialization API (for language bindings)
+ * ============================================================================
+ */
+
+/**
+ * Serialize runs to JSON string.
+ * 
+ * @param runs Array of run pointers
+ * @param count Number of runs
+ * @return JSON string (caller must free with taguchi_free_string)
+ */
+char *taguchi_runs_to_json(
+    const taguchi_experiment_run_t **runs,
+    size_t count
+);
+
+/**
+ * Serialize runs to JSON with typed factor values: numbers for int and float
+ * factors (size suffixes applied), true/false for bool factors and strings
+ * for the rest.
+ *
+ * @param def Experiment definition the runs were generated from
+ * @param runs Array of run pointers
+ * @param count Number of runs
+ * @return JSON string (caller must free with taguchi_free_string)
+ */
+char *taguchi_runs_to_typed_json(
+    const taguchi_experiment_def_t *def,
     const taguchi_experiment_run_t **runs,
     size_t count
 );
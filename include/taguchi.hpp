@@ -0,0 +1,445 @@
+#ifndef TAGUCHI_HPP
+#define TAGUCHI_HPP
+
+/*
+ * Header-only C++20 wrapper over the C API in taguchi.h.
+ *
+ * Owners (Definition, Design, ResultSet, Effects) are move-only and free
+ * their handle on destruction.  Run and Effect are views into an owner and
+ * must not outlive it.  Strings come back as std::string_view and arrays
+ * as std::span pointing at the library's own storage: nothing is copied
+ * or allocated beyond what the C calls do.  Errors throw taguchi::error
+ * carrying the library's message.
+ */
+
+#include "taguchi.h"
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace taguchi {
+
+/** Error reported by the library (what() is the error_buf message). */
+class error : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+namespace detail {
+
+[[noreturn]] inline void fail(const char *message) {
+    throw error(message[0] ? message : "taguchi: unknown error");
+}
+
+inline std::string_view view(const char *s) {
+    return s ? std::string_view(s) : std::string_view();
+}
+
+struct def_deleter {
+    void operator()(taguchi_experiment_def_t *def) const { taguchi_free_definition(def); }
+};
+
+struct results_deleter {
+    void operator()(taguchi_result_set_t *results) const { taguchi_free_result_set(results); }
+};
+
+/* Random-access iterator yielding View(handle) over an array of handles */
+template <typename View, typename Handle>
+class handle_iterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using iterator_concept = std::random_access_iterator_tag;
+    using value_type = View;
+    using difference_type = std::ptrdiff_t;
+    using reference = View;
+
+    struct pointer {
+        View view;
+        const View *operator->() const { return &view; }
+    };
+
+    handle_iterator() = default;
+    explicit handle_iterator(Handle *const *at) : at_(at) {}
+
+    View operator*() const { return View(*at_); }
+    pointer operator->() const { return pointer{View(*at_)}; }
+    View operator[](difference_type n) const { return View(at_[n]); }
+
+    handle_iterator &operator++() { ++at_; return *this; }
+    handle_iterator operator++(int) { handle_iterator old = *this; ++at_; return old; }
+    handle_iterator &operator--() { --at_; return *this; }
+    handle_iterator operator--(int) { handle_iterator old = *this; --at_; return old; }
+    handle_iterator &operator+=(difference_type n) { at_ += n; return *this; }
+    handle_iterator &operator-=(difference_type n) { at_ -= n; return *this; }
+
+    friend handle_iterator operator+(handle_iterator it, difference_type n) { return it += n; }
+    friend handle_iterator operator+(difference_type n, handle_iterator it) { return it += n; }
+    friend handle_iterator operator-(handle_iterator it, difference_type n) { return it -= n; }
+    friend difference_type operator-(handle_iterator a, handle_iterator b) { return a.at_ - b.at_; }
+    friend bool operator==(handle_iterator a, handle_iterator b) { return a.at_ == b.at_; }
+    friend auto operator<=>(handle_iterator a, handle_iterator b) { return a.at_ <=> b.at_; }
+
+private:
+    Handle *const *at_ = nullptr;
+};
+
+} // namespace detail
+
+/*
+ * ============================================================================
+ * Runs
+ * ============================================================================
+ */
+
+/** View of one generated run; valid while its Design lives. */
+class Run {
+public:
+    explicit Run(const taguchi_experiment_run_t *run) : run_(run) {}
+
+    /** Run ID (1-indexed). */
+    std::size_t id() const { return taguchi_run_get_id(run_); }
+    std::size_t factor_count() const { return taguchi_run_get_factor_count(run_); }
+
+    /** Factor name at index (empty if out of range). */
+    std::string_view factor_name(std::size_t index) const {
+        return detail::view(taguchi_run_get_factor_name_at_index(run_, index));
+    }
+
+    /** Level value of the factor at index (empty if out of range). */
+    std::string_view value(std::size_t index) const {
+        return detail::view(taguchi_run_get_value_at_index(run_, index));
+    }
+
+    /** Level value of a factor by name (empty if there is no such factor). */
+    std::string_view value(const char *factor_name) const {
+        return detail::view(taguchi_run_get_value(run_, factor_name));
+    }
+
+    /** This run's row of the level matrix: one 0-based level index per factor. */
+    std::span<const std::size_t> levels() const {
+        return {taguchi_run_get_level_indices(run_), factor_count()};
+    }
+
+    const taguchi_experiment_run_t *get() const { return run_; }
+
+private:
+    const taguchi_experiment_run_t *run_;
+};
+
+/** Generated runs of a definition (move-only owner). */
+class Design {
+public:
+    using iterator = detail::handle_iterator<Run, taguchi_experiment_run_t>;
+
+    Design() = default;
+
+    /** Take ownership of runs from taguchi_generate_runs(). */
+    Design(taguchi_experiment_run_t **runs, std::size_t count) : runs_(runs), count_(count) {}
+
+    Design(Design &&other) noexcept
+        : runs_(std::exchange(other.runs_, nullptr)), count_(std::exchange(other.count_, 0)) {}
+
+    Design &operator=(Design &&other) noexcept {
+        if (this != &other) {
+            reset();
+            runs_ = std::exchange(other.runs_, nullptr);
+            count_ = std::exchange(other.count_, 0);
+        }
+        return *this;
+    }
+
+    Design(const Design &) = delete;
+    Design &operator=(const Design &) = delete;
+    ~Design() { reset(); }
+
+    std::size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    iterator begin() const { return iterator(runs_); }
+    iterator end() const { return iterator(runs_ + count_); }
+    Run operator[](std::size_t index) const { return Run(runs_[index]); }
+
+    /** Level index of factor in run (both 0-based): the level matrix cell. */
+    std::size_t level(std::size_t run, std::size_t factor) const {
+        return taguchi_run_get_level_index(runs_[run], factor);
+    }
+
+    /** The run handles, for passing on to the C API. */
+    std::span<const taguchi_experiment_run_t *const> handles() const {
+        return {runs_, count_};
+    }
+
+    /** JSON as produced by taguchi_runs_to_json(). */
+    std::string to_json() const {
+        auto runs = const_cast<const taguchi_experiment_run_t **>(runs_);
+        std::unique_ptr<char, decltype(&taguchi_free_string)> json(
+            taguchi_runs_to_json(runs, count_), &taguchi_free_string);
+        if (!json) throw error("taguchi: cannot serialize runs");
+        return std::string(json.get());
+    }
+
+private:
+    void reset() {
+        if (runs_) taguchi_free_runs(runs_, count_);
+        runs_ = nullptr;
+        count_ = 0;
+    }
+
+    taguchi_experiment_run_t **runs_ = nullptr;
+    std::size_t count_ = 0;
+};
+
+/*
+ * ============================================================================
+ * Effects
+ * ============================================================================
+ */
+
+/** View of one factor's main effect; valid while its Effects lives. */
+class Effect {
+public:
+    explicit Effect(const taguchi_main_effect_t *effect) : effect_(effect) {}
+
+    std::string_view factor() const { return detail::view(taguchi_effect_get_factor(effect_)); }
+
+    /** Mean response at each level, in level order. */
+    std::span<const double> level_means() const {
+        std::size_t count = 0;
+        const double *means = taguchi_effect_get_level_means(effect_, &count);
+        return {means, count};
+    }
+
+    double range() const { return taguchi_effect_get_range(effect_); }
+    const taguchi_main_effect_t *get() const { return effect_; }
+
+private:
+    const taguchi_main_effect_t *effect_;
+};
+
+/** Main effects of a result set (move-only owner). */
+class Effects {
+public:
+    using iterator = detail::handle_iterator<Effect, taguchi_main_effect_t>;
+
+    Effects() = default;
+
+    /** Take ownership of effects from taguchi_calculate_main_effects(). */
+    Effects(taguchi_main_effect_t **effects, std::size_t count)
+        : effects_(effects), count_(count) {}
+
+    Effects(Effects &&other) noexcept
+        : effects_(std::exchange(other.effects_, nullptr)),
+          count_(std::exchange(other.count_, 0)) {}
+
+    Effects &operator=(Effects &&other) noexcept {
+        if (this != &other) {
+            reset();
+            effects_ = std::exchange(other.effects_, nullptr);
+            count_ = std::exchange(other.count_, 0);
+        }
+        return *this;
+    }
+
+    Effects(const Effects &) = delete;
+    Effects &operator=(const Effects &) = delete;
+    ~Effects() { reset(); }
+
+    std::size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    iterator begin() const { return iterator(effects_); }
+    iterator end() const { return iterator(effects_ + count_); }
+    Effect operator[](std::size_t index) const { return Effect(effects_[index]); }
+
+    /** The effect handles, for passing on to the C API. */
+    std::span<const taguchi_main_effect_t *const> handles() const {
+        return {effects_, count_};
+    }
+
+    /**
+     * Optimal levels ("factor=level_N, ...", 1-based) into buf; returns a view
+     * of the text written there.
+     */
+    std::string_view recommend(bool higher_is_better, std::span<char> buf) const {
+        auto effects = const_cast<const taguchi_main_effect_t **>(effects_);
+        if (taguchi_recommend_optimal(effects, count_, higher_is_better, buf.data(),
+                                      buf.size()) != 0) {
+            throw error("taguchi: cannot recommend a configuration");
+        }
+        return std::string_view(buf.data(), std::strlen(buf.data()));
+    }
+
+    /** JSON as produced by taguchi_effects_to_json(). */
+    std::string to_json() const {
+        auto effects = const_cast<const taguchi_main_effect_t **>(effects_);
+        std::unique_ptr<char, decltype(&taguchi_free_string)> json(
+            taguchi_effects_to_json(effects, count_), &taguchi_free_string);
+        if (!json) throw error("taguchi: cannot serialize effects");
+        return std::string(json.get());
+    }
+
+private:
+    void reset() {
+        if (effects_) taguchi_free_effects(effects_, count_);
+        effects_ = nullptr;
+        count_ = 0;
+    }
+
+    taguchi_main_effect_t **effects_ = nullptr;
+    std::size_t count_ = 0;
+};
+
+/*
+ * ============================================================================
+ * Results
+ * ============================================================================
+ */
+
+/**
+ * Responses collected for a definition (move-only owner).  Like the C
+ * handle it wraps, it keeps a pointer to the definition, which must
+ * outlive it.
+ */
+class ResultSet {
+public:
+    /** Take ownership of a handle from taguchi_create_result_set(). */
+    explicit ResultSet(taguchi_result_set_t *results) : results_(results) {
+        if (!results_) throw error("taguchi: cannot create result set");
+    }
+
+    /** Record a response for run_id (replicates may repeat an ID). */
+    void add(std::size_t run_id, double response_value) {
+        char err[TAGUCHI_ERROR_SIZE] = "";
+        if (taguchi_add_result(results_.get(), run_id, response_value, err) != 0) detail::fail(err);
+    }
+
+    /** Main effects, computed on ctx (nullptr for the default context). */
+    Effects main_effects(taguchi_context_t *ctx = nullptr) const {
+        char err[TAGUCHI_ERROR_SIZE] = "";
+        taguchi_main_effect_t **effects = nullptr;
+        std::size_t count = 0;
+        if (taguchi_calculate_main_effects_ctx(ctx, results_.get(), &effects, &count, err) != 0) {
+            detail::fail(err);
+        }
+        return Effects(effects, count);
+    }
+
+    taguchi_result_set_t *get() const { return results_.get(); }
+    taguchi_result_set_t *release() { return results_.release(); }
+
+private:
+    std::unique_ptr<taguchi_result_set_t, detail::results_deleter> results_;
+};
+
+/*
+ * ============================================================================
+ * Definitions
+ * ============================================================================
+ */
+
+/** Experiment definition (move-only owner). */
+class Definition {
+public:
+    /** Take ownership of a handle from the C API. */
+    explicit Definition(taguchi_experiment_def_t *def) : def_(def) {
+        if (!def_) throw error("taguchi: null definition");
+    }
+
+    /** Parse .tgu content. */
+    static Definition parse(const char *content) {
+        char err[TAGUCHI_ERROR_SIZE] = "";
+        taguchi_experiment_def_t *def = taguchi_parse_definition(content, err);
+        if (!def) detail::fail(err);
+        return Definition(def);
+    }
+
+    static Definition parse(const std::string &content) { return parse(content.c_str()); }
+
+    /** Empty definition on the given array ("L9"), filled with add_factor(). */
+    static Definition create(const char *array_type) {
+        taguchi_experiment_def_t *def = taguchi_create_definition(array_type);
+        if (!def) {
+            throw error(std::string("taguchi: cannot create definition for array ") + array_type);
+        }
+        return Definition(def);
+    }
+
+    void add_factor(const char *name, std::span<const char *const> levels) {
+        char err[TAGUCHI_ERROR_SIZE] = "";
+        /* The C API takes const char ** but does not write through it */
+        if (taguchi_add_factor(def_.get(), name, const_cast<const char **>(levels.data()),
+                               levels.size(), err) != 0) {
+            detail::fail(err);
+        }
+    }
+
+    /** Throws if the definition cannot be generated. */
+    void validate() const {
+        char err[TAGUCHI_ERROR_SIZE] = "";
+        if (!taguchi_validate_definition(def_.get(), err)) detail::fail(err);
+    }
+
+    std::size_t factor_count() const { return taguchi_def_get_factor_count(def_.get()); }
+
+    std::string_view factor_name(std::size_t index) const {
+        return detail::view(taguchi_def_get_factor_name(def_.get(), index));
+    }
+
+    std::size_t level_count(std::size_t index) const {
+        return taguchi_def_get_level_count(def_.get(), index);
+    }
+
+    taguchi_level_type_t level_type(std::size_t index) const {
+        return taguchi_def_get_level_type(def_.get(), index);
+    }
+
+    /** Level values of an int or bool factor; empty for other types. */
+    std::span<const std::int64_t> int_levels(std::size_t index) const {
+        const std::int64_t *levels = taguchi_def_get_int_levels(def_.get(), index);
+        return levels ? std::span<const std::int64_t>(levels, level_count(index))
+                      : std::span<const std::int64_t>();
+    }
+
+    /** Level values of an int or float factor; empty for other types. */
+    std::span<const double> numeric_levels(std::size_t index) const {
+        const double *levels = taguchi_def_get_numeric_levels(def_.get(), index);
+        return levels ? std::span<const double>(levels, level_count(index))
+                      : std::span<const double>();
+    }
+
+    /** Generate the runs on ctx (nullptr for the default context). */
+    Design generate(taguchi_context_t *ctx = nullptr) const {
+        char err[TAGUCHI_ERROR_SIZE] = "";
+        taguchi_experiment_run_t **runs = nullptr;
+        std::size_t count = 0;
+        if (taguchi_generate_runs_ctx(ctx, def_.get(), &runs, &count, err) != 0) detail::fail(err);
+        return Design(runs, count);
+    }
+
+    /**
+     * Empty result set for metric_name.  The result set refers to this
+     * definition, which must outlive it (moving the Definition keeps the
+     * handle, so that is fine); there is no overload for temporaries.
+     */
+    ResultSet results(const char *metric_name) const & {
+        return ResultSet(taguchi_create_result_set(def_.get(), metric_name));
+    }
+    ResultSet results(const char *metric_name) const && = delete;
+
+    taguchi_experiment_def_t *get() const { return def_.get(); }
+    taguchi_experiment_def_t *release() { return def_.release(); }
+
+private:
+    std::unique_ptr<taguchi_experiment_def_t, detail::def_deleter> def_;
+};
+
+} // namespace taguchi
+
+#endif /* TAGUCHI_HPP */
@@ -0,0 +1,192 @@
+#include "adaptive.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Collects each successful run's metric into the result set */
+typedef struct {
+    taguchi_result_set_t *results;
+    long counter;           /* Index into the perf counters, -1 for wall_seconds */
+    size_t failed;          /* Runs that failed or lacked the metric */
+} Collector;
+
+static void collect_result(void *user, size_t run_id, int exit_code, double wall_seconds,
+                           const uint64_t *counters, const bool *valid) {
+    Collector *c = user;
+    double value = wall_seconds;
+    if (exit_code != 0) {
+        c->failed++;
+        return;
+    }
+    if (c->counter >= 0) {
+        if (!counters || !valid[c->counter]) {
+            c->failed++;
+            return;
+        }
+        value = (double)counters[c->counter];
+    }
+    char error[TAGUCHI_ERROR_SIZE];
+    if (taguchi_add_result(c->results, run_id, value, error) != 0) {
+        c->failed++;
+    }
+}
+
+void adaptive_options_init(AdaptiveOptions *opts) {
+    memset(opts, 0, sizeof(*opts));
+    taguchi_replication_options_init(&opts->plan);
+    opts->metric = "wall_seconds";
+}
+
+/* Level means with their intervals, then the recommendation */
+static void print_summary(const taguchi_experiment_def_t *def, taguchi_result_set_t *results,
+                          const AdaptiveOptions *adaptive) {
+    char error[TAGUCHI_ERROR_SIZE];
+
+    printf("\nLevel means (%s, %g%% confidence):\n", adaptive->metric,
+           adaptive->plan.confidence * 100.0);
+    for (size_t f = 0; f < taguchi_def_get_factor_count(def); f++) {
+        size_t levels = taguchi_def_get_level_count(def, f);
+        double *means = malloc(2 * levels * sizeof(double) + 1);
+        if (!means) break;
+        double *half_widths = means + levels;
+        if (taguchi_level_intervals(results, f, adaptive->plan.confidence, means, half_widths,
+                                    levels, error) == 0) {
+            printf("  %s:", taguchi_def_get_factor_name(def, f));
+            for (size_t lv = 0; lv < levels; lv++) {
+                printf(" L%zu=%.4g+/-%.2g", lv + 1, means[lv], half_widths[lv]);
+            }
+            printf("\n");
+        }
+        free(means);
+    }
+
+    taguchi_main_effect_t **effects = NULL;
+    size_t effect_count = 0;
+    if (taguchi_calculate_main_effects(results, &effects, &effect_count, error) != 0) {
+        fprintf(stderr, "Error calculating effects: %s\n", error);
+        return;
+    }
+    char recommendation[1024];
+    if (taguchi_recommend_optimal((const taguchi_main_effect_t **)effects, effect_count,
+                                  adaptive->plan.higher_is_better, recommendation,
+                                  sizeof(recommendation)) == 0) {
+        printf("\nOptimal Configuration: %s\n", recommendation);
+    }
+    taguchi_free_effects(effects, effect_count);
+}
+
+int adaptive_execute(const taguchi_experiment_def_t *def, taguchi_experiment_run_t **runs,
+                     size_t count, RunnerOptions *opts, const AdaptiveOptions *adaptive) {
+    Collector collector;
+    memset(&collector, 0, sizeof(collector));
+    collector.counter = -1;
+    if (strcmp(adaptive->metric, "wall_seconds") != 0) {
+        for (size_t i = 0; opts->perf && i < opts->perf->count; i++) {
+            if (strcmp(opts->perf->events[i].name, adaptive->metric) == 0) {
+                collector.counter = (long)i;
+            }
+        }
+        if (collector.counter < 0) {
+            fprintf(stderr, "Error: adaptive metric '%s' is not recorded "
+                            "(use wall_seconds or a --perf-counters event)\n", adaptive->metric);
+            return -1;
+        }
+    }
+
+    size_t budget = adaptive->max_runs > 0 ? adaptive->max_runs : ADAPTIVE_DEFAULT_BUDGET * count;
+    if (budget < ADAPTIVE_INITIAL_REPLICATES * count) {
+        fprintf(stderr, "Error: --max-runs %zu is below the first round (%d x %zu runs)\n",
+                budget, ADAPTIVE_INITIAL_REPLICATES, count);
+        return -1;
+    }
+
+    collector.results = taguchi_create_result_set(def, adaptive->metric);
+    /* Runs by ID for scheduling replicates; room for the largest round */
+    taguchi_experiment_run_t **by_id = calloc(count + 1, sizeof(*by_id));
+    size_t round_size = (count + 3) / 4;
+    if (round_size < opts->jobs) round_size = opts->jobs;
+    size_t batch_room = ADAPTIVE_INITIAL_REPLICATES * count;
+    if (batch_room < round_size) batch_room = round_size;
+    taguchi_experiment_run_t **batch = malloc(batch_room * sizeof(*batch));
+    size_t *ids = malloc((round_size + 1) * sizeof(*ids));
+    if (!collector.results || !by_id || !batch || !ids) {
+        fprintf(stderr, "Error: out of memory\n");
+        taguchi_free_result_set(collector.results);
+        free(by_id);
+        free(batch);
+        free(ids);
+        return -1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        size_t id = taguchi_run_get_id(runs[i]);
+        if (id >= 1 && id <= count) by_id[id - 1] = runs[i];
+    }
+
+    opts->on_result = collect_result;
+    opts->user = &collector;
+
+    /* First round: the whole design, in the given order, each time */
+    size_t batch_count = 0;
+    for (size_t rep = 0; rep < ADAPTIVE_INITIAL_REPLICATES; rep++) {
+        for (size_t i = 0; i < count; i++) {
+            batch[batch_count++] = runs[i];
+        }
+    }
+
+    int rc = 0;
+    size_t executed = 0;
+    for (size_t round = 1; ; round++) {
+        if (runner_execute(batch, batch_count, opts) != 0) {
+            rc = -1;
+            break;
+        }
+        opts->append = true;
+        executed += batch_count;
+
+        size_t room = budget - executed < round_size ? budget - executed : round_size;
+        size_t planned = 0;
+        taguchi_replication_status_t status;
+        char error[TAGUCHI_ERROR_SIZE];
+        if (taguchi_plan_replicates(collector.results, &adaptive->plan, ids, room, &planned,
+                                    &status, error) != 0) {
+            fprintf(stderr, "Error planning replicates: %s\n", error);
+            rc = -1;
+            break;
+        }
+        printf("Adaptive round %zu: %zu run(s), %zu of %zu top factor(s) resolved "
+               "(sd %.4g, %zu df)\n",
+               round, executed, status.resolved, status.top_factors, status.pooled_sd,
+               status.error_df);
+
+        if (status.stable) {
+            printf("Adaptive replication: recommendation stable at %g%% confidence after %zu run(s)\n",
+                   adaptive->plan.confidence * 100.0, executed);
+            break;
+        }
+        if (planned == 0) {
+            printf("Adaptive replication: %s with %zu of %zu top factor(s) unresolved\n",
+                   executed >= budget ? "run budget reached" : "nothing left to replicate",
+                   status.top_factors - status.resolved, status.top_factors);
+            break;
+        }
+
+        batch_count = 0;
+        for (size_t i = 0; i < planned; i++) {
+            batch[batch_count++] = by_id[ids[i] - 1];
+        }
+    }
+    if (collector.failed > 0) {
+        fprintf(stderr, "Warning: %zu run(s) failed or lacked '%s' and were left out\n",
+                collector.failed, adaptive->metric);
+    }
+
+    if (rc == 0) print_summary(def, collector.results, adaptive);
+
+    opts->on_result = NULL;
+    opts->user = NULL;
+    taguchi_free_result_set(collector.results);
+    free(by_id);
+    free(batch);
+    free(ids);
+    return rc;
+}
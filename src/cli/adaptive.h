@@ -0,0 +1,41 @@
+#ifndef ADAPTIVE_H
+#define ADAPTIVE_H
+
+#include <stddef.h>
+#include "include/taguchi.h"
+#include "runner.h"
+
+/*
+ * Adaptive replication for `taguchi run --adaptive`.
+ *
+ * Every run is first executed ADAPTIVE_INITIAL_REPLICATES times so the
+ * within-run spread can be estimated.  After each round the library plans
+ * the next one (taguchi_plan_replicates): replicates go only to the runs
+ * that most narrow the confidence intervals of the top factors whose best
+ * level is still in doubt.  The campaign stops when every top factor's
+ * recommendation is resolved at the requested confidence or the run budget
+ * is spent.
+ */
+
+#define ADAPTIVE_INITIAL_REPLICATES 2
+#define ADAPTIVE_DEFAULT_BUDGET 5      /* Default budget: this many runs per row */
+
+typedef struct {
+    taguchi_replication_options_t plan;
+    size_t max_runs;        /* Total executions allowed; 0 for the default */
+    const char *metric;     /* "wall_seconds" or a perf counter name */
+} AdaptiveOptions;
+
+/* Defaults: 95% confidence, higher is better, top 3 factors, wall_seconds */
+void adaptive_options_init(AdaptiveOptions *opts);
+
+/*
+ * Run the campaign over runs (one per design row, in the order the first
+ * round should use).  opts is used for every round; its results file and
+ * run logs are appended to after the first.  Returns 0 when the campaign was carried
+ * out, -1 on error.
+ */
+int adaptive_execute(const taguchi_experiment_def_t *def, taguchi_experiment_run_t **runs,
+                     size_t count, RunnerOptions *opts, const AdaptiveOptions *adaptive);
+
+#endif /* ADAPTIVE_H */
@@ -0,0 +1,249 @@
+#define _GNU_SOURCE
+#include "batch.h"
+#include "commands.h"
+#include "include/taguchi.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+
+typedef int (*BatchFileFn)(const char *filename, FILE *out, FILE *err);
+
+/* Subcommands that can be batched */
+static const struct {
+    const char *name;
+    BatchFileFn fn;
+} batch_commands[] = {
+    { "validate",      run_validate_file },
+    { "generate",      run_generate_file },
+    { "suggest-array", run_suggest_array_file },
+};
+#define BATCH_COMMAND_COUNT (sizeof(batch_commands) / sizeof(batch_commands[0]))
+
+/* One input file and its captured result */
+typedef struct {
+    char *path;
+    char *out_buf;
+    size_t out_len;
+    char *err_buf;
+    size_t err_len;
+    int status;
+} BatchItem;
+
+typedef struct {
+    BatchItem *items;
+    BatchFileFn fn;
+} BatchJob;
+
+static void batch_usage(void) {
+    fprintf(stderr,
+        "Usage: batch <validate|generate|suggest-array> [-j N] [--manifest file]\n"
+        "             [--output-dir dir] [file.tgu ...]\n");
+}
+
+/* Process one file with output captured into memory buffers */
+static void process_item(BatchItem *item, BatchFileFn fn) {
+    FILE *out = open_memstream(&item->out_buf, &item->out_len);
+    FILE *err = open_memstream(&item->err_buf, &item->err_len);
+    if (!out || !err) {
+        if (out) fclose(out);
+        if (err) fclose(err);
+        item->status = 1;
+        return;
+    }
+    item->status = fn(item->path, out, err);
+    fclose(out);
+    fclose(err);
+}
+
+static void batch_chunk(void *arg, size_t begin, size_t end) {
+    BatchJob *job = arg;
+    for (size_t i = begin; i < end; i++) {
+        process_item(&job->items[i], job->fn);
+    }
+}
+
+static int add_item(BatchItem **items, size_t *count, size_t *capacity, const char *path) {
+    if (*count >= *capacity) {
+        size_t new_cap = *capacity ? *capacity * 2 : 64;
+        BatchItem *grown = realloc(*items, new_cap * sizeof(BatchItem));
+        if (!grown) return -1;
+        *items = grown;
+        *capacity = new_cap;
+    }
+    BatchItem *item = &(*items)[*count];
+    memset(item, 0, sizeof(*item));
+    item->path = strdup(path);
+    if (!item->path) return -1;
+    (*count)++;
+    return 0;
+}
+
+/* Read one path per line; blank lines and '#' comments are skipped */
+static int read_manifest(const char *manifest, BatchItem **items, size_t *count, size_t *capacity) {
+    FILE *f = strcmp(manifest, "-") == 0 ? stdin : fopen(manifest, "r");
+    if (!f) {
+        fprintf(stderr, "Error opening manifest %s: %s\n", manifest, strerror(errno));
+        return -1;
+    }
+    char line[PATH_MAX + 2];
+    int rc = 0;
+    while (fgets(line, sizeof(line), f)) {
+        size_t len = strlen(line);
+        while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r' ||
+                           line[len - 1] == ' ' || line[len - 1] == '\t')) {
+            line[--len] = '\0';
+        }
+        char *p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '\0' || *p == '#') continue;
+        if (add_item(items, count, capacity, p) != 0) {
+            rc = -1;
+            break;
+        }
+    }
+    if (f != stdin) fclose(f);
+    return rc;
+}
+
+/* Output file name: basename without .tgu, plus .<command>.out */
+static int output_path(char *buf, size_t size, const char *dir, const char *path, const char *cmd) {
+    const char *base = strrchr(path, '/');
+    base = base ? base + 1 : path;
+    size_t len = strlen(base);
+    if (len > 4 && strcmp(base + len - 4, ".tgu") == 0) len -= 4;
+    int nw = snprintf(buf, size, "%s/%.*s.%s.out", dir, (int)len, base, cmd);
+    return (nw < 0 || (size_t)nw >= size) ? -1 : 0;
+}
+
+static void free_items(BatchItem *items, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        free(items[i].path);
+        free(items[i].out_buf);
+        free(items[i].err_buf);
+    }
+    free(items);
+}
+
+int cmd_batch(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Error: batch command requires a subcommand\n");
+        batch_usage();
+        return 1;
+    }
+
+    const char *cmd = argv[1];
+    BatchFileFn fn = NULL;
+    for (size_t i = 0; i < BATCH_COMMAND_COUNT; i++) {
+        if (strcmp(batch_commands[i].name, cmd) == 0) fn = batch_commands[i].fn;
+    }
+    if (!fn) {
+        fprintf(stderr, "Error: '%s' cannot be batched\n", cmd);
+        batch_usage();
+        return 1;
+    }
+
+    size_t jobs = 0;          /* 0 = the default context's worker count */
+    const char *output_dir = NULL;
+    BatchItem *items = NULL;
+    size_t count = 0, capacity = 0;
+
+    for (int i = 2; i < argc; i++) {
+        if ((strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--jobs") == 0) && i + 1 < argc) {
+            char *endptr;
+            long j = strtol(argv[++i], &endptr, 10);
+            if (*endptr != '\0' || j < 1) {
+                fprintf(stderr, "Error: invalid job count '%s'\n", argv[i]);
+                free_items(items, count);
+                return 1;
+            }
+            jobs = (size_t)j;
+        } else if (strcmp(argv[i], "--manifest") == 0 && i + 1 < argc) {
+            if (read_manifest(argv[++i], &items, &count, &capacity) != 0) {
+                free_items(items, count);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--output-dir") == 0 && i + 1 < argc) {
+            output_dir = argv[++i];
+        } else if (add_item(&items, &count, &capacity, argv[i]) != 0) {
+            fprintf(stderr, "Error: out of memory\n");
+            free_items(items, count);
+            return 1;
+        }
+    }
+
+    if (count == 0) {
+        fprintf(stderr, "Error: batch %s requires at least one .tgu file\n", cmd);
+        batch_usage();
+        free_items(items, count);
+        return 1;
+    }
+
+    /* Per-file outputs must not overwrite each other */
+    if (output_dir) {
+        for (size_t i = 0; i < count; i++) {
+            char a[PATH_MAX];
+            if (output_path(a, sizeof(a), output_dir, items[i].path, cmd) != 0) {
+                fprintf(stderr, "Error: output path too long for %s\n", items[i].path);
+                free_items(items, count);
+                return 1;
+            }
+            for (size_t k = 0; k < i; k++) {
+                char b[PATH_MAX];
+                output_path(b, sizeof(b), output_dir, items[k].path, cmd);
+                if (strcmp(a, b) == 0) {
+                    fprintf(stderr, "Error: %s and %s map to the same output file %s\n",
+                            items[k].path, items[i].path, a);
+                    free_items(items, count);
+                    return 1;
+                }
+            }
+        }
+    }
+
+    if (jobs > 0) {
+        taguchi_context_set_max_workers(NULL, jobs);
+    }
+
+    /* One file per task; the pool balances uneven files by stealing */
+    BatchJob job;
+    job.items = items;
+    job.fn = fn;
+    taguchi_context_parallel_for(NULL, count, 1, batch_chunk, &job);
+
+    /* Emit results in input order */
+    size_t failed = 0;
+    for (size_t i = 0; i < count; i++) {
+        BatchItem *item = &items[i];
+        if (item->status != 0) failed++;
+
+        if (output_dir) {
+            char path[PATH_MAX];
+            output_path(path, sizeof(path), output_dir, item->path, cmd);
+            FILE *f = fopen(path, "w");
+            if (!f || fwrite(item->out_buf, 1, item->out_len, f) != item->out_len) {
+                fprintf(stderr, "Error writing %s: %s\n", path, strerror(errno));
+                if (item->status == 0) failed++;
+                item->status = 1;
+            }
+            if (f) fclose(f);
+        } else {
+            printf("==> %s <==\n", item->path);
+            fwrite(item->out_buf, 1, item->out_len, stdout);
+        }
+        if (item->err_len > 0) {
+            fwrite(item->err_buf, 1, item->err_len, stderr);
+        }
+    }
+
+    printf("Batch %s: %zu file(s), %zu succeeded, %zu failed\n",
+           cmd, count, count - failed, failed);
+    for (size_t i = 0; i < count; i++) {
+        if (items[i].status != 0) printf("  FAILED: %s\n", items[i].path);
+    }
+
+    free_items(items, count);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,15 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+/*
+ * `taguchi batch <command> [options] file1.tgu file2.tgu ...`
+ *
+ * Runs validate / generate / suggest-array over many definitions in one
+ * process: the array catalog is built once and files are processed in
+ * parallel by a pool of worker threads.  Each file's output is captured
+ * separately and either printed in input order or written to --output-dir,
+ * followed by a consolidated status line.
+ */
+int cmd_batch(int argc, char *argv[]);
+
+#endif /* BATCH_H */
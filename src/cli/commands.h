@@ -0,0 +1,24 @@
+#ifndef COMMANDS_H
+#define COMMANDS_H
+
+#include <stdio.h>
+
+/*
+ * Per-file command bodies shared by the single-file subcommands and
+ * `taguchi batch`.  Regular output goes to `out`, diagnostics to `err`;
+ * each returns the process exit status the subcommand would use.
+ * They only use the public library API and are safe to call concurrently.
+ */
+
+/*
+ * Read a definition input (path, "-" or /dev/fd/N) into a NUL-terminated
+ * heap buffer (caller frees), or NULL; a framed stream yields its
+ * definition section.  Implemented in input.c.
+ */
+char *read_file_dynamic(const char *filename, FILE *err);
+
+int run_generate_file(const char *filename, FILE *out, FILE *err);
+int run_validate_file(const char *filename, FILE *out, FILE *err);
+int run_suggest_array_file(const char *filename, FILE *out, FILE *err);
+
+#endif /* COMMANDS_H */
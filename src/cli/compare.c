@@ -0,0 +1,212 @@
+#include "compare.h"
+#include "commands.h"
+#include "input.h"
+#include "include/taguchi.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+static void compare_usage(void) {
+    fprintf(stderr,
+        "Usage: compare <file.tgu> <a.csv> <b.csv> [--metric name]\n"
+        "               [--permutations N [--seed N]] [--alpha A] [--fail-on-change]\n");
+}
+
+static int parse_size_opt(const char *opt, const char *arg, size_t *out) {
+    char *end;
+    unsigned long long v = strtoull(arg, &end, 10);
+    if (end == arg || *end != '\0' || v < 1 || arg[0] == '-') {
+        fprintf(stderr, "Error: invalid value '%s' for %s\n", arg, opt);
+        return -1;
+    }
+    *out = (size_t)v;
+    return 0;
+}
+
+/* Results of one campaign against def, or NULL after printing why */
+static taguchi_result_set_t *load_campaign(const taguchi_experiment_def_t *def,
+                                           const char *path, const char *metric) {
+    char *text = read_input(path, NULL, stderr);
+    if (!text) return NULL;
+
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_result_set_t *results = taguchi_create_result_set(def, metric);
+    if (!results) {
+        fprintf(stderr, "Error creating result set\n");
+        free(text);
+        return NULL;
+    }
+    if (parse_csv_results(text, path, metric, results, error) != 0) {
+        fprintf(stderr, "Error reading results from %s: %s\n", path, error);
+        taguchi_free_result_set(results);
+        results = NULL;
+    }
+    free(text);
+    return results;
+}
+
+static const char *error_source_name(taguchi_compare_error_t source) {
+    switch (source) {
+    case TAGUCHI_COMPARE_ERROR_REPLICATES: return "replicates";
+    case TAGUCHI_COMPARE_ERROR_RESIDUAL: return "main-effects residual";
+    default: return "none";
+    }
+}
+
+static void print_comparison(const char *metric, const char *path_a, const char *path_b,
+                             const taguchi_factor_change_t *changes, size_t count,
+                             const taguchi_comparison_summary_t *summary, double alpha) {
+    printf("Comparing %s: %s against %s (%zu run%s in both)\n", metric, path_b, path_a,
+           summary->runs, summary->runs == 1 ? "" : "s");
+    if (isnan(summary->shift_se)) {
+        printf("Shift (B - A): %+.3f\n", summary->shift);
+    } else {
+        printf("Shift (B - A): %+.3f (se %.3f)\n", summary->shift, summary->shift_se);
+    }
+    if (summary->error_source == TAGUCHI_COMPARE_ERROR_NONE) {
+        printf("Error estimate: none (saturated design without replicates)\n");
+    } else {
+        printf("Error estimate: %s, sd %.3f on %zu df\n",
+               error_source_name(summary->error_source), summary->error_sd, summary->error_df);
+    }
+    if (summary->permutations > 0) {
+        printf("Test: permutation (%zu shuffles), Holm-adjusted at alpha %g\n",
+               summary->permutations, alpha);
+    } else {
+        printf("Test: F, Holm-adjusted at alpha %g\n", alpha);
+    }
+
+    printf("\n%-4s %-20s %8s %8s %8s %8s  %s\n",
+           "Rank", "Factor", "Range A", "Range B", "p", "adj. p", "Changed");
+    for (size_t i = 0; i < count; i++) {
+        const taguchi_factor_change_t *c = &changes[i];
+        printf("%-4zu %-20s %8.3f %8.3f ", i + 1, c->factor, c->range_a, c->range_b);
+        if (isnan(c->p_value)) {
+            printf("%8s %8s  %s\n", "-", "-", "-");
+        } else {
+            printf("%8.4f %8.4f  %s\n", c->p_value, c->adjusted_p, c->significant ? "yes" : "no");
+        }
+        printf("     ");
+        for (size_t lv = 0; lv < c->level_count; lv++) {
+            if (lv > 0) printf(", ");
+            if (isnan(c->delta[lv])) {
+                printf("L%zu=-", lv + 1);
+            } else if (isnan(c->std_error[lv])) {
+                printf("L%zu=%+.3f", lv + 1, c->delta[lv]);
+            } else {
+                printf("L%zu=%+.3f (%.3f)", lv + 1, c->delta[lv], c->std_error[lv]);
+            }
+        }
+        printf("\n");
+    }
+}
+
+int cmd_compare(int argc, char *argv[]) {
+    const char *positional[3];
+    int positional_count = 0;
+    const char *metric = "response";
+    bool fail_on_change = false;
+    taguchi_compare_options_t opts;
+    taguchi_compare_options_init(&opts);
+
+    for (int i = 1; i < argc; i++) {
+        const char *opt = argv[i];
+        const char *arg = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(opt, "--fail-on-change") == 0) {
+            fail_on_change = true;
+            continue;
+        }
+        if (opt[0] != '-' || strcmp(opt, "-") == 0) {
+            if (positional_count >= 3) {
+                fprintf(stderr, "Error: unexpected argument '%s'\n", opt);
+                compare_usage();
+                return 1;
+            }
+            positional[positional_count++] = opt;
+            continue;
+        }
+        if (!arg) {
+            fprintf(stderr, "Error: unknown compare option '%s'\n", opt);
+            compare_usage();
+            return 1;
+        }
+        if (strcmp(opt, "--metric") == 0) {
+            metric = arg;
+        } else if (strcmp(opt, "--permutations") == 0) {
+            if (parse_size_opt(opt, arg, &opts.permutations) != 0) return 1;
+        } else if (strcmp(opt, "--seed") == 0) {
+            char *end;
+            opts.seed = strtoull(arg, &end, 0);
+            if (end == arg || *end != '\0' || arg[0] == '-') {
+                fprintf(stderr, "Error: invalid value '%s' for --seed\n", arg);
+                return 1;
+            }
+        } else if (strcmp(opt, "--alpha") == 0) {
+            char *end;
+            opts.alpha = strtod(arg, &end);
+            if (end == arg || *end != '\0') {
+                fprintf(stderr, "Error: invalid value '%s' for --alpha\n", arg);
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "Error: unknown compare option '%s'\n", opt);
+            compare_usage();
+            return 1;
+        }
+        i++;
+    }
+    if (positional_count != 3) {
+        fprintf(stderr, "Error: compare requires <file.tgu> <a.csv> <b.csv>\n");
+        compare_usage();
+        return 1;
+    }
+    int stdin_inputs = 0;
+    for (int i = 0; i < 3; i++) {
+        stdin_inputs += strcmp(positional[i], "-") == 0;
+    }
+    if (stdin_inputs > 1) {
+        fprintf(stderr, "Error: only one compare input can be read from stdin\n");
+        return 1;
+    }
+
+    int status = 1;
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = NULL;
+    taguchi_result_set_t *a = NULL, *b = NULL;
+    taguchi_factor_change_t *changes = NULL;
+    size_t count = 0;
+
+    char *content = read_file_dynamic(positional[0], stderr);
+    if (!content) goto done;
+    def = taguchi_parse_definition(content, error);
+    free(content);
+    if (!def) {
+        fprintf(stderr, "Error parsing %s: %s\n", positional[0], error);
+        goto done;
+    }
+    a = load_campaign(def, positional[1], metric);
+    if (!a) goto done;
+    b = load_campaign(def, positional[2], metric);
+    if (!b) goto done;
+
+    taguchi_comparison_summary_t summary;
+    if (taguchi_compare_results(a, b, &opts, &changes, &count, &summary, error) != 0) {
+        fprintf(stderr, "Error comparing results: %s\n", error);
+        goto done;
+    }
+    print_comparison(metric, positional[1], positional[2], changes, count, &summary, opts.alpha);
+
+    status = 0;
+    for (size_t i = 0; i < count && fail_on_change; i++) {
+        if (changes[i].significant) status = 2;
+    }
+
+done:
+    taguchi_free_factor_changes(changes, count);
+    taguchi_free_result_set(b);
+    taguchi_free_result_set(a);
+    taguchi_free_definition(def);
+    return status;
+}
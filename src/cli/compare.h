@@ -0,0 +1,15 @@
+#ifndef COMPARE_H
+#define COMPARE_H
+
+/*
+ * `taguchi compare <file.tgu> <a.csv> <b.csv> [options]`
+ *
+ * A/B diff of two campaigns run on the same design: aligns the results by
+ * run ID, reports the uniform shift between them and, per factor, how much
+ * each level's effect moved, then ranks the factors by the Holm-adjusted
+ * significance of the change (F test, or a permutation test with
+ * --permutations N).
+ */
+int cmd_compare(int argc, char *argv[]);
+
+#endif /* COMPARE_H */
@@ -0,0 +1,136 @@
+#define _GNU_SOURCE
+#include "evloop.h"
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/signalfd.h>
+#include <sys/syscall.h>
+
+/* epoll data: kind in the top 16 bits, slot below */
+#define EVLOOP_KIND_SHIFT 48
+
+static uint64_t pack(EventKind kind, size_t slot) {
+    return ((uint64_t)kind << EVLOOP_KIND_SHIFT) | (uint64_t)slot;
+}
+
+static int add_fd(EventLoop *loop, int fd, EventKind kind, size_t slot) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u64 = pack(kind, slot);
+    return epoll_ctl(loop->epfd, EPOLL_CTL_ADD, fd, &ev);
+}
+
+static int open_pidfd(pid_t pid) {
+#ifdef SYS_pidfd_open
+    return (int)syscall(SYS_pidfd_open, pid, 0);
+#else
+    (void)pid;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+int evloop_init(EventLoop *loop) {
+    memset(loop, 0, sizeof(*loop));
+    loop->timerfd = -1;
+    loop->sigfd = -1;
+    loop->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (loop->epfd < 0) return -1;
+    loop->timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (loop->timerfd < 0 || add_fd(loop, loop->timerfd, EVLOOP_TIMER, 0) != 0) {
+        evloop_free(loop);
+        return -1;
+    }
+
+    /* Probe on ourselves: kernels before 5.3 and some seccomp profiles lack it */
+    int probe = open_pidfd(getpid());
+    if (probe >= 0) {
+        close(probe);
+        loop->pidfds = true;
+        return 0;
+    }
+
+    sigset_t chld;
+    sigemptyset(&chld);
+    sigaddset(&chld, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &chld, NULL);
+    loop->sigfd = signalfd(-1, &chld, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (loop->sigfd < 0 || add_fd(loop, loop->sigfd, EVLOOP_CHILDREN, 0) != 0) {
+        evloop_free(loop);
+        return -1;
+    }
+    return 0;
+}
+
+void evloop_free(EventLoop *loop) {
+    if (loop->sigfd >= 0) {
+        close(loop->sigfd);
+        sigset_t chld;
+        sigemptyset(&chld);
+        sigaddset(&chld, SIGCHLD);
+        sigprocmask(SIG_UNBLOCK, &chld, NULL);
+    }
+    if (loop->timerfd >= 0) close(loop->timerfd);
+    if (loop->epfd >= 0) close(loop->epfd);
+    loop->epfd = loop->timerfd = loop->sigfd = -1;
+}
+
+int evloop_watch_child(EventLoop *loop, pid_t pid, size_t slot) {
+    if (!loop->pidfds) return -1;
+    /* The child is ours and not yet reaped, so the pid cannot be reused */
+    int fd = open_pidfd(pid);
+    if (fd < 0) return -1;
+    if (add_fd(loop, fd, EVLOOP_CHILD, slot) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int evloop_watch_output(EventLoop *loop, int fd, size_t slot) {
+    return add_fd(loop, fd, EVLOOP_OUTPUT, slot);
+}
+
+void evloop_unwatch(EventLoop *loop, int fd) {
+    epoll_ctl(loop->epfd, EPOLL_CTL_DEL, fd, NULL);
+}
+
+int evloop_wait(EventLoop *loop, Event *events, int max, double timeout) {
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    if (timeout >= 0.0) {
+        /* A zero it_value would disarm the timer instead */
+        its.it_value.tv_sec = (time_t)timeout;
+        its.it_value.tv_nsec = (long)((timeout - (double)its.it_value.tv_sec) * 1e9);
+        if (its.it_value.tv_sec == 0 && its.it_value.tv_nsec == 0) its.it_value.tv_nsec = 1;
+    }
+    timerfd_settime(loop->timerfd, 0, &its, NULL);
+
+    struct epoll_event ready[EVLOOP_BATCH];
+    if (max > EVLOOP_BATCH) max = EVLOOP_BATCH;
+    int n;
+    do {
+        n = epoll_wait(loop->epfd, ready, max, -1);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) return -1;
+
+    for (int i = 0; i < n; i++) {
+        events[i].kind = (EventKind)(ready[i].data.u64 >> EVLOOP_KIND_SHIFT);
+        events[i].slot = (size_t)(ready[i].data.u64 & ((UINT64_C(1) << EVLOOP_KIND_SHIFT) - 1));
+        if (events[i].kind == EVLOOP_TIMER) {
+            uint64_t expirations;
+            ssize_t r = read(loop->timerfd, &expirations, sizeof(expirations));
+            (void)r;
+        } else if (events[i].kind == EVLOOP_CHILDREN) {
+            struct signalfd_siginfo info;
+            while (read(loop->sigfd, &info, sizeof(info)) == (ssize_t)sizeof(info)) {}
+        }
+    }
+    return n;
+}
@@ -0,0 +1,67 @@
+#ifndef EVLOOP_H
+#define EVLOOP_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+/*
+ * Event loop for `taguchi run`: one epoll set watches every run's exit, its
+ * captured output and a timerfd for the runner's own deadlines (pressure
+ * re-sampling, retry backoff), so the runner sleeps in a single epoll_wait
+ * however many runs are in flight.
+ *
+ * Exits are watched through a pidfd per child (Linux 5.3+).  Where
+ * pidfd_open is unavailable SIGCHLD is blocked and delivered through a
+ * signalfd instead, and the caller reaps with waitpid(-1, WNOHANG).
+ */
+
+#define EVLOOP_BATCH 64        /* Events taken per wait */
+
+typedef enum {
+    EVLOOP_CHILD,              /* A watched child exited (slot is set) */
+    EVLOOP_CHILDREN,           /* SIGCHLD fallback: some child exited */
+    EVLOOP_OUTPUT,             /* A watched pipe is readable or closed */
+    EVLOOP_TIMER               /* The deadline passed */
+} EventKind;
+
+typedef struct {
+    EventKind kind;
+    size_t slot;
+} Event;
+
+typedef struct {
+    int epfd;
+    int timerfd;
+    int sigfd;                 /* SIGCHLD signalfd in fallback mode, else -1 */
+    bool pidfds;               /* Children are watched through pidfds */
+} EventLoop;
+
+/* Returns -1 (with errno set) if epoll or the timerfd are unavailable */
+int evloop_init(EventLoop *loop);
+void evloop_free(EventLoop *loop);
+
+/*
+ * Watch child pid for slot.  Returns its pidfd (the caller closes it after
+ * reaping), or -1 in fallback mode, where exits arrive as EVLOOP_CHILDREN.
+ */
+int evloop_watch_child(EventLoop *loop, pid_t pid, size_t slot);
+
+/* Watch a nonblocking pipe */
+int evloop_watch_output(EventLoop *loop, int fd, size_t slot);
+
+/*
+ * Stop watching fd; call it before closing a watched descriptor.  Closing
+ * alone is not enough: a child forked but not yet exec'd holds a copy, and
+ * epoll keeps reporting the descriptor while any copy is open.
+ */
+void evloop_unwatch(EventLoop *loop, int fd);
+
+/*
+ * Wait for events, or until timeout seconds have passed (< 0 for no
+ * deadline).  Returns the number of events stored (0 < n <= max), or -1 on
+ * error.
+ */
+int evloop_wait(EventLoop *loop, Event *events, int max, double timeout);
+
+#endif /* EVLOOP_H */
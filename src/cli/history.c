@@ -0,0 +1,426 @@
+#define _GNU_SOURCE
+#include "history.h"
+#include "histstore.h"
+#include "commands.h"
+#include "input.h"
+#include "include/taguchi.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+/* Options shared by the history subcommands */
+typedef struct {
+    const char *store;
+    const char *name;
+    const char *tag;
+    const char *metric;
+    const char *factor;
+    const char *date;
+    uint32_t since;
+    uint32_t until;
+    bool definition;
+    const char *positional[2];
+    int positional_count;
+} HistoryOptions;
+
+static void history_usage(void) {
+    fprintf(stderr,
+        "Usage: history record <file.tgu> <results.csv> --name N [--tag T]\n"
+        "                      [--date YYYY-MM-DD] [--metric name]\n"
+        "       history list [--name N] [--tag T] [--since D] [--until D]\n"
+        "       history trend --name N [--factor F] [--tag T] [--since D] [--until D]\n"
+        "       history export <campaign> [--definition]\n"
+        "Every subcommand takes --store dir (default $TAGUCHI_HISTORY_DIR or %s).\n",
+        HISTORY_DEFAULT_DIR);
+}
+
+static int parse_date_opt(const char *opt, const char *arg, uint32_t *out) {
+    *out = history_parse_date(arg);
+    if (*out == 0) {
+        fprintf(stderr, "Error: %s expects a date as YYYY-MM-DD, got '%s'\n", opt, arg);
+        return -1;
+    }
+    return 0;
+}
+
+static int parse_options(int argc, char *argv[], HistoryOptions *opts) {
+    memset(opts, 0, sizeof(*opts));
+    opts->store = getenv("TAGUCHI_HISTORY_DIR");
+    if (!opts->store || opts->store[0] == '\0') opts->store = HISTORY_DEFAULT_DIR;
+    opts->metric = "response";
+
+    for (int i = 2; i < argc; i++) {
+        const char *opt = argv[i];
+        const char *arg = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(opt, "--definition") == 0) {
+            opts->definition = true;
+            continue;
+        }
+        if (opt[0] != '-' || strcmp(opt, "-") == 0) {
+            if (opts->positional_count >= 2) {
+                fprintf(stderr, "Error: unexpected argument '%s'\n", opt);
+                return -1;
+            }
+            opts->positional[opts->positional_count++] = opt;
+            continue;
+        }
+        if (!arg) {
+            fprintf(stderr, "Error: unknown history option '%s'\n", opt);
+            return -1;
+        }
+        if (strcmp(opt, "--store") == 0) {
+            opts->store = arg;
+        } else if (strcmp(opt, "--name") == 0) {
+            opts->name = arg;
+        } else if (strcmp(opt, "--tag") == 0) {
+            opts->tag = arg;
+        } else if (strcmp(opt, "--metric") == 0) {
+            opts->metric = arg;
+        } else if (strcmp(opt, "--factor") == 0) {
+            opts->factor = arg;
+        } else if (strcmp(opt, "--date") == 0) {
+            opts->date = arg;
+        } else if (strcmp(opt, "--since") == 0) {
+            if (parse_date_opt(opt, arg, &opts->since) != 0) return -1;
+        } else if (strcmp(opt, "--until") == 0) {
+            if (parse_date_opt(opt, arg, &opts->until) != 0) return -1;
+        } else {
+            fprintf(stderr, "Error: unknown history option '%s'\n", opt);
+            return -1;
+        }
+        i++;
+    }
+    return 0;
+}
+
+static void print_date(uint32_t date) {
+    printf("%04u-%02u-%02u", date / 10000, date / 100 % 100, date % 100);
+}
+
+static int history_record(const HistoryOptions *opts) {
+    if (opts->positional_count != 2 || !opts->name) {
+        fprintf(stderr, "Error: history record requires <file.tgu> <results.csv> and --name\n");
+        history_usage();
+        return 1;
+    }
+
+    HistoryEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    if (strlen(opts->name) >= sizeof(entry.name) || opts->name[0] == '\0') {
+        fprintf(stderr, "Error: --name must be 1 to %zu characters\n", sizeof(entry.name) - 1);
+        return 1;
+    }
+    if (opts->tag && strlen(opts->tag) >= sizeof(entry.tag)) {
+        fprintf(stderr, "Error: --tag must be under %zu characters\n", sizeof(entry.tag));
+        return 1;
+    }
+    strcpy(entry.name, opts->name);
+    if (opts->tag) strcpy(entry.tag, opts->tag);
+    if (opts->date) {
+        if (parse_date_opt("--date", opts->date, &entry.date) != 0) return 1;
+    } else {
+        time_t now = time(NULL);
+        struct tm tm;
+        localtime_r(&now, &tm);
+        entry.date = (uint32_t)((tm.tm_year + 1900) * 10000 + (tm.tm_mon + 1) * 100 + tm.tm_mday);
+    }
+
+    const char *tgu_file = opts->positional[0];
+    const char *csv_file = opts->positional[1];
+    char *content = NULL, *csv_text = NULL;
+    if (load_definition_and_results(tgu_file, csv_file, &content, &csv_text, stderr) != 0) {
+        return 1;
+    }
+
+    char error[TAGUCHI_ERROR_SIZE];
+    int rc = 1;
+    HistoryStore store;
+    store.index_fd = -1;
+    taguchi_result_set_t *results = NULL;
+    taguchi_experiment_def_t *def = taguchi_parse_definition(content, error);
+    if (!def) {
+        fprintf(stderr, "Error parsing %s: %s\n", tgu_file, error);
+        goto done;
+    }
+    results = taguchi_create_result_set(def, opts->metric);
+    if (!results) {
+        fprintf(stderr, "Error creating result set\n");
+        goto done;
+    }
+    if (parse_csv_results(csv_text, csv_file, opts->metric, results, error) != 0) {
+        fprintf(stderr, "Error reading results: %s\n", error);
+        goto done;
+    }
+    if (history_open(&store, opts->store, true, error) != 0 ||
+        history_append(&store, &entry, content, def, results, error) != 0) {
+        fprintf(stderr, "Error: %s\n", error);
+        goto done;
+    }
+
+    printf("Recorded campaign #%u: %s%s%s ", entry.seq, entry.name, entry.tag[0] ? " " : "",
+           entry.tag);
+    print_date(entry.date);
+    printf(" (%u runs, %u results of %s)\n", entry.run_count, entry.result_count, entry.metric);
+    rc = 0;
+
+done:
+    history_close(&store);
+    taguchi_free_result_set(results);
+    taguchi_free_definition(def);
+    free(content);
+    free(csv_text);
+    return rc;
+}
+
+/* Open the store and select campaigns by the filter options */
+static int query(const HistoryOptions *opts, HistoryStore *store, HistoryEntry **entries,
+                 size_t *count) {
+    char error[TAGUCHI_ERROR_SIZE];
+    HistoryFilter filter;
+    filter.name = opts->name;
+    filter.tag = opts->tag;
+    filter.since = opts->since;
+    filter.until = opts->until;
+    if (history_open(store, opts->store, false, error) != 0 ||
+        history_query(store, &filter, entries, count, error) != 0) {
+        fprintf(stderr, "Error: %s\n", error);
+        history_close(store);
+        return -1;
+    }
+    return 0;
+}
+
+static int history_list(const HistoryOptions *opts) {
+    HistoryStore store;
+    HistoryEntry *entries = NULL;
+    size_t count = 0;
+    if (query(opts, &store, &entries, &count) != 0) return 1;
+
+    printf("%-5s %-10s  %-20s %-12s %-16s %5s %8s\n", "#", "Date", "Name", "Tag", "Metric",
+           "Runs", "Results");
+    for (size_t i = 0; i < count; i++) {
+        const HistoryEntry *e = &entries[i];
+        printf("%-5u ", e->seq);
+        print_date(e->date);
+        printf("  %-20s %-12s %-16s %5u %8u\n", e->name, e->tag[0] ? e->tag : "-", e->metric,
+               e->run_count, e->result_count);
+    }
+    printf("%zu campaign%s\n", count, count == 1 ? "" : "s");
+
+    free(entries);
+    history_close(&store);
+    return 0;
+}
+
+/* One row of a factor's trend: level means by value, then the range change */
+static void print_trend_row(const HistoryEntry *e, const HistoryFactor *factor,
+                            double *prev_range) {
+    printf("  %-5u ", e->seq);
+    print_date(e->date);
+    printf("  %-12s %-16s %8.3f ", e->tag[0] ? e->tag : "-", e->metric, factor->range);
+    if (isnan(*prev_range)) {
+        printf("%8s   ", "");
+    } else {
+        printf("%+8.3f   ", factor->range - *prev_range);
+    }
+    for (size_t lv = 0; lv < factor->level_count; lv++) {
+        if (lv > 0) printf(", ");
+        if (isnan(factor->means[lv])) {
+            printf("%s=-", factor->values[lv]);
+        } else {
+            printf("%s=%.3f", factor->values[lv], factor->means[lv]);
+        }
+    }
+    printf("\n");
+    *prev_range = factor->range;
+}
+
+/*
+ * Per factor, its effects in every matching campaign.  Only the FACTORS and
+ * EFFECTS columns of each record are read.
+ */
+static int history_trend(const HistoryOptions *opts) {
+    if (!opts->name) {
+        fprintf(stderr, "Error: history trend requires --name\n");
+        history_usage();
+        return 1;
+    }
+    HistoryStore store;
+    HistoryEntry *entries = NULL;
+    size_t count = 0;
+    if (query(opts, &store, &entries, &count) != 0) return 1;
+
+    int rc = 1;
+    char error[TAGUCHI_ERROR_SIZE];
+    HistoryFactor **factors = calloc(count + 1, sizeof(HistoryFactor *));
+    size_t *factor_counts = calloc(count + 1, sizeof(size_t));
+    if (!factors || !factor_counts) {
+        fprintf(stderr, "Error: out of memory\n");
+        goto done;
+    }
+    if (count == 0) {
+        fprintf(stderr, "Error: no campaigns of '%s' match\n", opts->name);
+        goto done;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (history_read_effects(&store, &entries[i], &factors[i], &factor_counts[i],
+                                 error) != 0) {
+            fprintf(stderr, "Error: %s\n", error);
+            goto done;
+        }
+    }
+
+    /* Factors in order of first appearance; designs may change over time */
+    printf("Effect trend for %s (%zu campaign%s)\n", opts->name, count, count == 1 ? "" : "s");
+    bool printed = false;
+    for (size_t i = 0; i < count; i++) {
+        for (size_t f = 0; f < factor_counts[i]; f++) {
+            const char *name = factors[i][f].name;
+            if (opts->factor && strcmp(name, opts->factor) != 0) continue;
+            bool seen = false;
+            for (size_t j = 0; j < i && !seen; j++) {
+                for (size_t g = 0; g < factor_counts[j] && !seen; g++) {
+                    seen = strcmp(factors[j][g].name, name) == 0;
+                }
+            }
+            if (seen) continue;
+
+            printf("\n%s\n", name);
+            printf("  %-5s %-10s  %-12s %-16s %8s %8s   %s\n", "#", "Date", "Tag", "Metric",
+                   "Range", "Change", "Level Means");
+            double prev_range = NAN;
+            for (size_t j = i; j < count; j++) {
+                for (size_t g = 0; g < factor_counts[j]; g++) {
+                    if (strcmp(factors[j][g].name, name) != 0) continue;
+                    print_trend_row(&entries[j], &factors[j][g], &prev_range);
+                }
+            }
+            printed = true;
+        }
+    }
+    if (!printed) {
+        fprintf(stderr, "Error: no campaign of '%s' has factor '%s'\n", opts->name,
+                opts->factor);
+        goto done;
+    }
+    rc = 0;
+
+done:
+    for (size_t i = 0; factors && i < count; i++) {
+        history_free_factors(factors[i], factor_counts[i]);
+    }
+    free(factors);
+    free(factor_counts);
+    free(entries);
+    history_close(&store);
+    return rc;
+}
+
+/* A campaign as run_id,<factors...>,<metric> rows, or its definition text */
+/* Shortest of %.15g and %.17g that reads back as value, as in the JSON export */
+static void print_response(double value) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.15g", value);
+    if (strtod(buf, NULL) != value) snprintf(buf, sizeof(buf), "%.17g", value);
+    printf(",%s\n", buf);
+}
+
+static int history_export(const HistoryOptions *opts) {
+    char *endptr = NULL;
+    unsigned long seq = opts->positional_count == 1 ? strtoul(opts->positional[0], &endptr, 10)
+                                                    : 0;
+    if (seq == 0 || *endptr != '\0') {
+        fprintf(stderr, "Error: history export requires a campaign number\n");
+        history_usage();
+        return 1;
+    }
+    HistoryOptions all = *opts;
+    all.name = NULL;
+    all.tag = NULL;
+    all.since = all.until = 0;
+    HistoryStore store;
+    HistoryEntry *entries = NULL;
+    size_t count = 0;
+    if (query(&all, &store, &entries, &count) != 0) return 1;
+
+    int rc = 1;
+    char error[TAGUCHI_ERROR_SIZE];
+    HistoryFactor *factors = NULL;
+    size_t factor_count = 0, rows = 0, result_count = 0;
+    uint8_t *levels = NULL;
+    size_t *run_ids = NULL;
+    double *responses = NULL;
+    const HistoryEntry *entry = NULL;
+    for (size_t i = 0; i < count && !entry; i++) {
+        if (entries[i].seq == seq) entry = &entries[i];
+    }
+    if (!entry) {
+        fprintf(stderr, "Error: no campaign #%lu in %s\n", seq, opts->store);
+        goto done;
+    }
+
+    if (opts->definition) {
+        char *source = history_read_source(&store, entry, error);
+        if (!source) {
+            fprintf(stderr, "Error: %s\n", error);
+            goto done;
+        }
+        fputs(source, stdout);
+        free(source);
+        rc = 0;
+        goto done;
+    }
+
+    if (history_read_effects(&store, entry, &factors, &factor_count, error) != 0 ||
+        history_read_design(&store, entry, factors, factor_count, &levels, &rows, error) != 0 ||
+        history_read_results(&store, entry, &run_ids, &responses, &result_count, error) != 0) {
+        fprintf(stderr, "Error: %s\n", error);
+        goto done;
+    }
+    printf("run_id");
+    for (size_t f = 0; f < factor_count; f++) printf(",%s", factors[f].name);
+    printf(",%s\n", entry->metric);
+    for (size_t i = 0; i < result_count; i++) {
+        printf("%zu", run_ids[i]);
+        for (size_t f = 0; f < factor_count; f++) {
+            size_t lv = run_ids[i] >= 1 && run_ids[i] <= rows
+                            ? levels[(run_ids[i] - 1) * factor_count + f] : factors[f].level_count;
+            printf(",%s", lv < factors[f].level_count ? factors[f].values[lv] : "");
+        }
+        print_response(responses[i]);
+    }
+    rc = 0;
+
+done:
+    history_free_factors(factors, factor_count);
+    free(levels);
+    free(run_ids);
+    free(responses);
+    free(entries);
+    history_close(&store);
+    return rc;
+}
+
+int cmd_history(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Error: history command requires a subcommand\n");
+        history_usage();
+        return 1;
+    }
+    HistoryOptions opts;
+    if (parse_options(argc, argv, &opts) != 0) {
+        history_usage();
+        return 1;
+    }
+
+    const char *sub = argv[1];
+    if (strcmp(sub, "record") == 0) return history_record(&opts);
+    if (strcmp(sub, "list") == 0) return history_list(&opts);
+    if (strcmp(sub, "trend") == 0) return history_trend(&opts);
+    if (strcmp(sub, "export") == 0) return history_export(&opts);
+    fprintf(stderr, "Error: unknown history subcommand '%s'\n", sub);
+    history_usage();
+    return 1;
+}
@@ -0,0 +1,16 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+/*
+ * `taguchi history <record|list|trend|export> [options]`
+ *
+ * Keeps every analysed campaign of an experiment in a local append-only
+ * store (histstore.h) so effects can be compared across releases:
+ * `record` files a definition with its results under an experiment name,
+ * version tag and date, `list` shows what was recorded, `trend` follows
+ * each factor's level means and range across campaigns, and `export`
+ * writes a campaign back out as a results CSV or its definition.
+ */
+int cmd_history(int argc, char *argv[]);
+
+#endif /* HISTORY_H */
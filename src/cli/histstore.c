@@ -0,0 +1,718 @@
+#define _GNU_SOURCE
+#include "histstore.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+
+#define HISTORY_INDEX_FILE "index.tgi"
+#define HISTORY_INDEX_MAGIC "TGHINDEX"
+#define HISTORY_RECORD_MAGIC "TGHREC1"
+#define HISTORY_FORMAT 1u
+#define HISTORY_MAX_COLUMNS 8
+
+typedef struct {
+    char magic[8];
+    uint32_t format;
+    uint32_t entry_size;
+} HistoryIndexHeader;
+
+typedef struct {
+    char magic[8];
+    uint32_t length;          /* Whole record, header included */
+    uint32_t column_count;
+} HistoryRecordHeader;
+
+typedef struct {
+    uint32_t kind;
+    uint32_t length;
+    uint64_t offset;          /* From the start of the record */
+    uint64_t checksum;        /* FNV-1a of the block */
+} HistoryColumn;
+
+/* Growable encode buffer; a failed allocation sticks until checked */
+typedef struct {
+    uint8_t *data;
+    size_t len;
+    size_t cap;
+    bool oom;
+} HistBuf;
+
+/* Bounds-checked decoder over one column block */
+typedef struct {
+    const uint8_t *p;
+    size_t left;
+    bool bad;
+} HistReader;
+
+static void history_error(char *error_buf, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(error_buf, TAGUCHI_ERROR_SIZE, fmt, args);
+    va_end(args);
+}
+
+static uint64_t fnv1a(const void *data, size_t len) {
+    const unsigned char *p = data;
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static void hb_put(HistBuf *b, const void *data, size_t n) {
+    if (b->oom) return;
+    if (b->len + n > b->cap) {
+        size_t cap = b->cap ? b->cap : 256;
+        while (cap < b->len + n) cap *= 2;
+        uint8_t *grown = realloc(b->data, cap);
+        if (!grown) {
+            b->oom = true;
+            return;
+        }
+        b->data = grown;
+        b->cap = cap;
+    }
+    memcpy(b->data + b->len, data, n);
+    b->len += n;
+}
+
+static void hb_u8(HistBuf *b, uint8_t v) { hb_put(b, &v, 1); }
+static void hb_u32(HistBuf *b, uint32_t v) { hb_put(b, &v, sizeof(v)); }
+static void hb_f64(HistBuf *b, double v) { hb_put(b, &v, sizeof(v)); }
+static void hb_str(HistBuf *b, const char *s) { hb_put(b, s, strlen(s) + 1); }
+
+static void hb_varint(HistBuf *b, uint64_t v) {
+    while (v >= 0x80) {
+        hb_u8(b, (uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    hb_u8(b, (uint8_t)v);
+}
+
+static const void *rd_take(HistReader *r, size_t n) {
+    if (r->bad || r->left < n) {
+        r->bad = true;
+        return NULL;
+    }
+    const void *p = r->p;
+    r->p += n;
+    r->left -= n;
+    return p;
+}
+
+static uint8_t rd_u8(HistReader *r) {
+    const uint8_t *p = rd_take(r, 1);
+    return p ? *p : 0;
+}
+
+static uint32_t rd_u32(HistReader *r) {
+    uint32_t v = 0;
+    const void *p = rd_take(r, sizeof(v));
+    if (p) memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static double rd_f64(HistReader *r) {
+    double v = NAN;
+    const void *p = rd_take(r, sizeof(v));
+    if (p) memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint64_t rd_varint(HistReader *r) {
+    uint64_t v = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        uint8_t byte = rd_u8(r);
+        if (r->bad) return 0;
+        v |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return v;
+    }
+    r->bad = true;
+    return 0;
+}
+
+/* A NUL-terminated string inside the block */
+static const char *rd_str(HistReader *r) {
+    if (r->bad) return NULL;
+    const uint8_t *end = memchr(r->p, '\0', r->left);
+    if (!end) {
+        r->bad = true;
+        return NULL;
+    }
+    return rd_take(r, (size_t)(end - r->p) + 1);
+}
+
+/* Bits per level index of a factor with level_count levels */
+static unsigned level_bits(size_t level_count) {
+    unsigned bits = 1;
+    while (((size_t)1 << bits) < level_count) bits++;
+    return bits;
+}
+
+static int write_all(int fd, const void *data, size_t len) {
+    const char *p = data;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static int read_at(int fd, void *data, size_t len, uint64_t offset) {
+    char *p = data;
+    while (len > 0) {
+        ssize_t n = pread(fd, p, len, (off_t)offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        len -= (size_t)n;
+        offset += (uint64_t)n;
+    }
+    return 0;
+}
+
+static void segment_path(const HistoryStore *store, uint32_t segment, char *path, size_t size) {
+    snprintf(path, size, "%s/segment-%06u.tgh", store->dir, segment);
+}
+
+/* mkdir -p */
+static int make_dirs(const char *dir) {
+    char path[PATH_MAX];
+    if (snprintf(path, sizeof(path), "%s", dir) >= (int)sizeof(path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    for (char *p = path + 1; *p; p++) {
+        if (*p != '/') continue;
+        *p = '\0';
+        if (mkdir(path, 0755) != 0 && errno != EEXIST) return -1;
+        *p = '/';
+    }
+    if (mkdir(path, 0755) != 0 && errno != EEXIST) return -1;
+    return 0;
+}
+
+int history_open(HistoryStore *store, const char *dir, bool create, char *error_buf) {
+    store->index_fd = -1;
+    if (snprintf(store->dir, sizeof(store->dir), "%s", dir) >= (int)sizeof(store->dir)) {
+        history_error(error_buf, "History directory name too long");
+        return -1;
+    }
+    if (create && make_dirs(dir) != 0) {
+        history_error(error_buf, "Cannot create history directory %s: %s", dir,
+                 strerror(errno));
+        return -1;
+    }
+
+    char path[PATH_MAX + 16];
+    snprintf(path, sizeof(path), "%s/%s", dir, HISTORY_INDEX_FILE);
+    int fd = open(path, create ? O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC : O_RDONLY | O_CLOEXEC,
+                  0644);
+    if (fd < 0) {
+        if (errno == ENOENT) {
+            history_error(error_buf, "No history recorded in %s", dir);
+        } else {
+            history_error(error_buf, "Cannot open %s: %s", path, strerror(errno));
+        }
+        return -1;
+    }
+
+    /* A new index gets its header under the lock, once */
+    flock(fd, LOCK_EX);
+    struct stat st;
+    HistoryIndexHeader header;
+    int rc = -1;
+    if (fstat(fd, &st) != 0) {
+        history_error(error_buf, "Cannot stat %s: %s", path, strerror(errno));
+    } else if (st.st_size == 0) {
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, HISTORY_INDEX_MAGIC, sizeof(header.magic));
+        header.format = HISTORY_FORMAT;
+        header.entry_size = sizeof(HistoryEntry);
+        if (!create || write_all(fd, &header, sizeof(header)) != 0) {
+            history_error(error_buf, "Cannot initialise %s", path);
+        } else {
+            rc = 0;
+        }
+    } else if (read_at(fd, &header, sizeof(header), 0) != 0 ||
+               memcmp(header.magic, HISTORY_INDEX_MAGIC, sizeof(header.magic)) != 0 ||
+               header.format != HISTORY_FORMAT || header.entry_size != sizeof(HistoryEntry)) {
+        history_error(error_buf, "%s is not a history index of this version",
+                 path);
+    } else {
+        rc = 0;
+    }
+    flock(fd, LOCK_UN);
+
+    if (rc != 0) {
+        close(fd);
+        return -1;
+    }
+    store->index_fd = fd;
+    return 0;
+}
+
+void history_close(HistoryStore *store) {
+    if (store->index_fd >= 0) close(store->index_fd);
+    store->index_fd = -1;
+}
+
+/* Every complete index entry; the caller holds a lock */
+static int load_entries(HistoryStore *store, HistoryEntry **entries_out, size_t *count_out,
+                        char *error_buf) {
+    *entries_out = NULL;
+    *count_out = 0;
+    struct stat st;
+    if (fstat(store->index_fd, &st) != 0) {
+        history_error(error_buf, "Cannot stat history index: %s", strerror(errno));
+        return -1;
+    }
+    size_t bytes = (size_t)st.st_size > sizeof(HistoryIndexHeader)
+                       ? (size_t)st.st_size - sizeof(HistoryIndexHeader) : 0;
+    size_t count = bytes / sizeof(HistoryEntry);     /* A torn tail entry is dropped */
+    HistoryEntry *entries = malloc(count * sizeof(HistoryEntry) + 1);
+    if (!entries) {
+        history_error(error_buf, "out of memory");
+        return -1;
+    }
+    if (count > 0 && read_at(store->index_fd, entries, count * sizeof(HistoryEntry),
+                             sizeof(HistoryIndexHeader)) != 0) {
+        history_error(error_buf, "Cannot read history index");
+        free(entries);
+        return -1;
+    }
+    *entries_out = entries;
+    *count_out = count;
+    return 0;
+}
+
+/* Encode the five columns of a campaign */
+static int encode_columns(const char *source, const taguchi_experiment_def_t *def,
+                          const taguchi_result_set_t *results, HistBuf cols[HISTORY_MAX_COLUMNS],
+                          uint32_t kinds[HISTORY_MAX_COLUMNS], size_t *col_count,
+                          size_t *run_count, char *error_buf) {
+    taguchi_experiment_run_t **runs = NULL;
+    size_t rows = 0;
+    if (taguchi_generate_runs(def, &runs, &rows, error_buf) != 0) return -1;
+    taguchi_main_effect_t **effects = NULL;
+    size_t effect_count = 0;
+    if (taguchi_calculate_main_effects(results, &effects, &effect_count, error_buf) != 0) {
+        taguchi_free_runs(runs, rows);
+        return -1;
+    }
+    size_t factor_count = taguchi_def_get_factor_count(def);
+
+    HistBuf *src = &cols[0], *fac = &cols[1], *des = &cols[2], *res = &cols[3], *eff = &cols[4];
+    kinds[0] = HCOL_SOURCE;
+    kinds[1] = HCOL_FACTORS;
+    kinds[2] = HCOL_DESIGN;
+    kinds[3] = HCOL_RESULTS;
+    kinds[4] = HCOL_EFFECTS;
+    *col_count = 5;
+
+    hb_put(src, source, strlen(source));
+
+    /* Level values come from the first run using each level */
+    hb_u32(fac, (uint32_t)factor_count);
+    for (size_t f = 0; f < factor_count; f++) {
+        size_t level_count = taguchi_def_get_level_count(def, f);
+        hb_str(fac, taguchi_def_get_factor_name(def, f));
+        hb_u8(fac, (uint8_t)level_count);
+        for (size_t lv = 0; lv < level_count; lv++) {
+            const char *value = NULL;
+            for (size_t r = 0; r < rows && !value; r++) {
+                if (taguchi_run_get_level_index(runs[r], f) == lv) {
+                    value = taguchi_run_get_value_at_index(runs[r], f);
+                }
+            }
+            char fallback[32];
+            snprintf(fallback, sizeof(fallback), "level_%zu", lv + 1);
+            hb_str(fac, value ? value : fallback);
+        }
+    }
+
+    hb_u32(des, (uint32_t)rows);
+    for (size_t f = 0; f < factor_count; f++) {
+        unsigned bits = level_bits(taguchi_def_get_level_count(def, f));
+        uint32_t acc = 0;
+        unsigned filled = 0;
+        for (size_t r = 0; r < rows; r++) {
+            acc |= (uint32_t)taguchi_run_get_level_index(runs[r], f) << filled;
+            filled += bits;
+            while (filled >= 8) {
+                hb_u8(des, (uint8_t)acc);
+                acc >>= 8;
+                filled -= 8;
+            }
+        }
+        if (filled > 0) hb_u8(des, (uint8_t)acc);
+    }
+
+    size_t result_count = taguchi_result_count(results);
+    hb_u32(res, (uint32_t)result_count);
+    int64_t prev = 0;
+    for (size_t i = 0; i < result_count; i++) {
+        size_t run_id = 0;
+        taguchi_result_get(results, i, &run_id, NULL);
+        int64_t delta = (int64_t)run_id - prev;
+        hb_varint(res, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+        prev = (int64_t)run_id;
+    }
+    for (size_t i = 0; i < result_count; i++) {
+        double response = 0.0;
+        taguchi_result_get(results, i, NULL, &response);
+        hb_f64(res, response);
+    }
+
+    for (size_t f = 0; f < effect_count; f++) {
+        size_t level_count = 0;
+        const double *means = taguchi_effect_get_level_means(effects[f], &level_count);
+        hb_f64(eff, taguchi_effect_get_range(effects[f]));
+        for (size_t lv = 0; lv < level_count; lv++) hb_f64(eff, means[lv]);
+    }
+
+    taguchi_free_effects(effects, effect_count);
+    taguchi_free_runs(runs, rows);
+    for (size_t c = 0; c < *col_count; c++) {
+        if (cols[c].oom) {
+            history_error(error_buf, "out of memory");
+            return -1;
+        }
+    }
+    *run_count = rows;
+    return 0;
+}
+
+int history_append(HistoryStore *store, HistoryEntry *entry, const char *source,
+                   const taguchi_experiment_def_t *def, const taguchi_result_set_t *results,
+                   char *error_buf) {
+    HistBuf cols[HISTORY_MAX_COLUMNS];
+    uint32_t kinds[HISTORY_MAX_COLUMNS];
+    size_t col_count = 0, run_count = 0;
+    HistBuf record;
+    memset(cols, 0, sizeof(cols));
+    memset(&record, 0, sizeof(record));
+    HistoryEntry *entries = NULL;
+    size_t entry_count = 0;
+    int seg_fd = -1;
+    int rc = -1;
+
+    if (encode_columns(source, def, results, cols, kinds, &col_count, &run_count,
+                       error_buf) != 0) {
+        goto done;
+    }
+
+    /* Header, column directory, blocks */
+    HistoryRecordHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, HISTORY_RECORD_MAGIC, sizeof(HISTORY_RECORD_MAGIC));
+    header.column_count = (uint32_t)col_count;
+    uint64_t length = sizeof(header) + col_count * sizeof(HistoryColumn);
+    for (size_t c = 0; c < col_count; c++) length += cols[c].len;
+    if (length > UINT32_MAX) {
+        history_error(error_buf, "Campaign too large to record");
+        goto done;
+    }
+    header.length = (uint32_t)length;
+    hb_put(&record, &header, sizeof(header));
+    uint64_t offset = sizeof(header) + col_count * sizeof(HistoryColumn);
+    for (size_t c = 0; c < col_count; c++) {
+        HistoryColumn column;
+        column.kind = kinds[c];
+        column.length = (uint32_t)cols[c].len;
+        column.offset = offset;
+        column.checksum = fnv1a(cols[c].data, cols[c].len);
+        hb_put(&record, &column, sizeof(column));
+        offset += cols[c].len;
+    }
+    for (size_t c = 0; c < col_count; c++) hb_put(&record, cols[c].data, cols[c].len);
+    if (record.oom) {
+        history_error(error_buf, "out of memory");
+        goto done;
+    }
+
+    flock(store->index_fd, LOCK_EX);
+    if (load_entries(store, &entries, &entry_count, error_buf) != 0) goto unlock;
+
+    /* Continue the newest segment unless this record would overflow it */
+    uint32_t segment = entry_count > 0 ? entries[entry_count - 1].segment : 1;
+    char path[PATH_MAX + 32];
+    struct stat st;
+    segment_path(store, segment, path, sizeof(path));
+    if (stat(path, &st) == 0 && st.st_size > 0 &&
+        (uint64_t)st.st_size + record.len > HISTORY_SEGMENT_BYTES) {
+        segment_path(store, ++segment, path, sizeof(path));
+    }
+    seg_fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (seg_fd < 0 || fstat(seg_fd, &st) != 0) {
+        history_error(error_buf, "Cannot open %s: %s", path, strerror(errno));
+        goto unlock;
+    }
+    if (write_all(seg_fd, record.data, record.len) != 0 || fdatasync(seg_fd) != 0) {
+        history_error(error_buf, "Cannot write %s: %s", path, strerror(errno));
+        goto unlock;
+    }
+
+    entry->seq = entry_count > 0 ? entries[entry_count - 1].seq + 1 : 1;
+    snprintf(entry->metric, sizeof(entry->metric), "%s", taguchi_result_metric(results));
+    entry->segment = segment;
+    entry->run_count = (uint32_t)run_count;
+    entry->result_count = (uint32_t)taguchi_result_count(results);
+    entry->length = (uint32_t)record.len;
+    entry->offset = (uint64_t)st.st_size;
+    if (write_all(store->index_fd, entry, sizeof(*entry)) != 0 ||
+        fdatasync(store->index_fd) != 0) {
+        history_error(error_buf, "Cannot write history index: %s",
+                 strerror(errno));
+        goto unlock;
+    }
+    rc = 0;
+
+unlock:
+    flock(store->index_fd, LOCK_UN);
+done:
+    if (seg_fd >= 0) close(seg_fd);
+    free(entries);
+    free(record.data);
+    for (size_t c = 0; c < HISTORY_MAX_COLUMNS; c++) free(cols[c].data);
+    return rc;
+}
+
+int history_query(HistoryStore *store, const HistoryFilter *filter, HistoryEntry **entries_out,
+                  size_t *count_out, char *error_buf) {
+    HistoryEntry *entries = NULL;
+    size_t count = 0;
+    flock(store->index_fd, LOCK_SH);
+    int rc = load_entries(store, &entries, &count, error_buf);
+    flock(store->index_fd, LOCK_UN);
+    if (rc != 0) return -1;
+
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++) {
+        const HistoryEntry *e = &entries[i];
+        if (filter->name && strcmp(e->name, filter->name) != 0) continue;
+        if (filter->tag && strcmp(e->tag, filter->tag) != 0) continue;
+        if (filter->since && e->date < filter->since) continue;
+        if (filter->until && e->date > filter->until) continue;
+        entries[kept++] = *e;
+    }
+    *entries_out = entries;
+    *count_out = kept;
+    return 0;
+}
+
+/* Read one column block of a record, checking it against its checksum */
+static uint8_t *read_column(HistoryStore *store, const HistoryEntry *entry, uint32_t kind,
+                            size_t *len_out, char *error_buf) {
+    char path[PATH_MAX + 32];
+    segment_path(store, entry->segment, path, sizeof(path));
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        history_error(error_buf, "Cannot open %s: %s", path, strerror(errno));
+        return NULL;
+    }
+
+    uint8_t *block = NULL;
+    HistoryRecordHeader header;
+    HistoryColumn dir[HISTORY_MAX_COLUMNS];
+    if (read_at(fd, &header, sizeof(header), entry->offset) != 0 ||
+        memcmp(header.magic, HISTORY_RECORD_MAGIC, sizeof(HISTORY_RECORD_MAGIC)) != 0 ||
+        header.length != entry->length || header.column_count > HISTORY_MAX_COLUMNS ||
+        read_at(fd, dir, header.column_count * sizeof(HistoryColumn),
+                entry->offset + sizeof(header)) != 0) {
+        history_error(error_buf, "Campaign #%u: damaged record in %s", entry->seq,
+                 path);
+        goto done;
+    }
+    for (uint32_t c = 0; c < header.column_count; c++) {
+        if (dir[c].kind != kind) continue;
+        if (dir[c].offset + dir[c].length > header.length) break;
+        block = malloc((size_t)dir[c].length + 1);
+        if (!block) {
+            history_error(error_buf, "out of memory");
+            goto done;
+        }
+        if (read_at(fd, block, dir[c].length, entry->offset + dir[c].offset) != 0 ||
+            fnv1a(block, dir[c].length) != dir[c].checksum) {
+            free(block);
+            block = NULL;
+            break;
+        }
+        block[dir[c].length] = '\0';
+        *len_out = dir[c].length;
+        goto done;
+    }
+    history_error(error_buf, "Campaign #%u: damaged record in %s", entry->seq,
+             path);
+
+done:
+    close(fd);
+    return block;
+}
+
+void history_free_factors(HistoryFactor *factors, size_t count) {
+    if (!factors) return;
+    for (size_t f = 0; f < count; f++) {
+        if (factors[f].values) {
+            for (size_t lv = 0; lv < factors[f].level_count; lv++) free(factors[f].values[lv]);
+        }
+        free(factors[f].values);
+        free(factors[f].means);
+    }
+    free(factors);
+}
+
+int history_read_effects(HistoryStore *store, const HistoryEntry *entry,
+                         HistoryFactor **factors_out, size_t *count_out, char *error_buf) {
+    size_t fac_len = 0, eff_len = 0;
+    uint8_t *fac = read_column(store, entry, HCOL_FACTORS, &fac_len, error_buf);
+    if (!fac) return -1;
+    uint8_t *eff = read_column(store, entry, HCOL_EFFECTS, &eff_len, error_buf);
+    if (!eff) {
+        free(fac);
+        return -1;
+    }
+
+    HistReader fr = { fac, fac_len, false };
+    HistReader er = { eff, eff_len, false };
+    size_t count = rd_u32(&fr);
+    HistoryFactor *factors = calloc(count + 1, sizeof(HistoryFactor));
+    bool oom = factors == NULL;
+    for (size_t f = 0; f < count && !oom && !fr.bad; f++) {
+        HistoryFactor *factor = &factors[f];
+        const char *name = rd_str(&fr);
+        factor->level_count = rd_u8(&fr);
+        if (fr.bad) break;
+        snprintf(factor->name, sizeof(factor->name), "%s", name);
+        factor->values = calloc(factor->level_count + 1, sizeof(char *));
+        factor->means = malloc((factor->level_count + 1) * sizeof(double));
+        if (!factor->values || !factor->means) {
+            oom = true;
+            break;
+        }
+        for (size_t lv = 0; lv < factor->level_count; lv++) {
+            const char *value = rd_str(&fr);
+            if (!value) break;
+            factor->values[lv] = strdup(value);
+            if (!factor->values[lv]) oom = true;
+        }
+        factor->range = rd_f64(&er);
+        for (size_t lv = 0; lv < factor->level_count; lv++) factor->means[lv] = rd_f64(&er);
+    }
+    free(fac);
+    free(eff);
+
+    if (oom || fr.bad || er.bad) {
+        history_free_factors(factors, count);
+        if (oom) {
+            history_error(error_buf, "out of memory");
+        } else {
+            history_error(error_buf, "Campaign #%u: malformed effects",
+                     entry->seq);
+        }
+        return -1;
+    }
+    *factors_out = factors;
+    *count_out = count;
+    return 0;
+}
+
+int history_read_design(HistoryStore *store, const HistoryEntry *entry,
+                        const HistoryFactor *factors, size_t factor_count,
+                        uint8_t **levels_out, size_t *rows_out, char *error_buf) {
+    size_t len = 0;
+    uint8_t *block = read_column(store, entry, HCOL_DESIGN, &len, error_buf);
+    if (!block) return -1;
+
+    HistReader r = { block, len, false };
+    size_t rows = rd_u32(&r);
+    uint8_t *levels = rows <= len * 8 ? malloc(rows * factor_count + 1) : NULL;
+    if (!levels) {
+        free(block);
+        history_error(error_buf, "Campaign #%u: malformed design", entry->seq);
+        return -1;
+    }
+    for (size_t f = 0; f < factor_count && !r.bad; f++) {
+        unsigned bits = level_bits(factors[f].level_count);
+        uint32_t acc = 0;
+        unsigned filled = 0;
+        for (size_t row = 0; row < rows; row++) {
+            while (filled < bits) {
+                acc |= (uint32_t)rd_u8(&r) << filled;
+                filled += 8;
+            }
+            levels[row * factor_count + f] = (uint8_t)(acc & ((1u << bits) - 1));
+            acc >>= bits;
+            filled -= bits;
+        }
+    }
+    free(block);
+    if (r.bad) {
+        free(levels);
+        history_error(error_buf, "Campaign #%u: malformed design", entry->seq);
+        return -1;
+    }
+    *levels_out = levels;
+    *rows_out = rows;
+    return 0;
+}
+
+char *history_read_source(HistoryStore *store, const HistoryEntry *entry, char *error_buf) {
+    size_t len = 0;
+    return (char *)read_column(store, entry, HCOL_SOURCE, &len, error_buf);
+}
+
+int history_read_results(HistoryStore *store, const HistoryEntry *entry, size_t **run_ids_out,
+                         double **responses_out, size_t *count_out, char *error_buf) {
+    size_t len = 0;
+    uint8_t *block = read_column(store, entry, HCOL_RESULTS, &len, error_buf);
+    if (!block) return -1;
+
+    HistReader r = { block, len, false };
+    size_t count = rd_u32(&r);
+    size_t *run_ids = count <= len ? malloc((count + 1) * sizeof(size_t)) : NULL;
+    double *responses = count <= len ? malloc((count + 1) * sizeof(double)) : NULL;
+    int64_t prev = 0;
+    for (size_t i = 0; run_ids && i < count; i++) {
+        uint64_t zigzag = rd_varint(&r);
+        prev += (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+        run_ids[i] = (size_t)prev;
+    }
+    for (size_t i = 0; responses && i < count; i++) responses[i] = rd_f64(&r);
+    free(block);
+
+    if (!run_ids || !responses || r.bad) {
+        free(run_ids);
+        free(responses);
+        history_error(error_buf, "Campaign #%u: malformed results", entry->seq);
+        return -1;
+    }
+    *run_ids_out = run_ids;
+    *responses_out = responses;
+    *count_out = count;
+    return 0;
+}
+
+uint32_t history_parse_date(const char *text) {
+    static const int days[] = { 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    unsigned y, m, d;
+    char tail;
+    if (sscanf(text, "%4u-%2u-%2u%c", &y, &m, &d, &tail) != 3) return 0;
+    if (y < 1970 || m < 1 || m > 12 || d < 1 || (int)d > days[m - 1]) return 0;
+    if (m == 2 && d == 29 && !(y % 4 == 0 && (y % 100 != 0 || y % 400 == 0))) return 0;
+    return y * 10000 + m * 100 + d;
+}
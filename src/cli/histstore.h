@@ -0,0 +1,135 @@
+#ifndef HISTSTORE_H
+#define HISTSTORE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
+#include "include/taguchi.h"
+
+/*
+ * Append-only experiment history for `taguchi history`.
+ *
+ * A store is a directory holding segment files and one index:
+ *
+ *   segment-NNNNNN.tgh   records appended back to back; a new segment is
+ *                        started once one would grow past
+ *                        HISTORY_SEGMENT_BYTES
+ *   index.tgi            HistoryIndexHeader, then one HistoryEntry per
+ *                        recorded campaign in recording order
+ *
+ * A record is a HistoryRecordHeader, a directory of HistoryColumn and the
+ * column blocks.  Columns are encoded separately so that a query reads
+ * only the blocks it needs (a trend reads FACTORS and EFFECTS, never the
+ * design or the raw results):
+ *
+ *   SOURCE    the definition text, so a campaign can be re-analysed
+ *   FACTORS   per factor: name\0, uint8 level count, level values \0-terminated
+ *   DESIGN    uint32 rows, then per factor its level column bit-packed at
+ *             the fewest bits that hold the factor's levels
+ *   RESULTS   uint32 count, run IDs as zigzag varint deltas, then the
+ *             responses as doubles
+ *   EFFECTS   per factor: range, then level means (doubles; NaN = no data)
+ *
+ * Everything is in native byte order: like the design cache, a store is
+ * local to one machine.  Each column carries an FNV-1a checksum checked
+ * when it is read.  Appends hold an exclusive flock on the index; the
+ * record is synced before its index entry is written, so a crash leaves at
+ * worst an unreferenced record, and a torn index entry at the end of the
+ * index is ignored.
+ */
+
+#define HISTORY_DEFAULT_DIR ".taguchi-history"
+#define HISTORY_SEGMENT_BYTES (8u << 20)
+#define HISTORY_NAME_MAX 64
+#define HISTORY_TAG_MAX 32
+#define HISTORY_METRIC_MAX 64
+
+typedef enum {
+    HCOL_SOURCE = 1,
+    HCOL_FACTORS,
+    HCOL_DESIGN,
+    HCOL_RESULTS,
+    HCOL_EFFECTS
+} HistoryColumnKind;
+
+/* Index entry; fixed size, stored as-is */
+typedef struct {
+    uint32_t seq;                      /* Campaign number, from 1 */
+    uint32_t date;                     /* YYYYMMDD */
+    char name[HISTORY_NAME_MAX];       /* Experiment name */
+    char tag[HISTORY_TAG_MAX];         /* Version tag, may be empty */
+    char metric[HISTORY_METRIC_MAX];
+    uint32_t segment;
+    uint32_t run_count;
+    uint32_t result_count;
+    uint32_t length;                   /* Record bytes */
+    uint64_t offset;                   /* Record offset in the segment */
+} HistoryEntry;
+
+typedef struct {
+    char dir[PATH_MAX];
+    int index_fd;
+} HistoryStore;
+
+/* Query filter; NULL / 0 fields match everything */
+typedef struct {
+    const char *name;
+    const char *tag;
+    uint32_t since;                    /* YYYYMMDD, inclusive */
+    uint32_t until;
+} HistoryFilter;
+
+/* One factor of a decoded FACTORS + EFFECTS pair */
+typedef struct {
+    char name[HISTORY_NAME_MAX];
+    size_t level_count;
+    char **values;
+    double range;
+    double *means;
+} HistoryFactor;
+
+/*
+ * Open the store in dir; with create, the directory and index are made if
+ * missing.  error_buf must hold TAGUCHI_ERROR_SIZE bytes.
+ */
+int history_open(HistoryStore *store, const char *dir, bool create, char *error_buf);
+void history_close(HistoryStore *store);
+
+/*
+ * Append a campaign: the design of def, its results and main effects and
+ * the definition text.  entry supplies name, tag, date and metric; the
+ * rest is filled in, including the new sequence number.
+ */
+int history_append(HistoryStore *store, HistoryEntry *entry, const char *source,
+                   const taguchi_experiment_def_t *def, const taguchi_result_set_t *results,
+                   char *error_buf);
+
+/* Index entries matching filter, in recording order (caller frees) */
+int history_query(HistoryStore *store, const HistoryFilter *filter, HistoryEntry **entries_out,
+                  size_t *count_out, char *error_buf);
+
+/* Decode FACTORS and EFFECTS of one record (free with history_free_factors) */
+int history_read_effects(HistoryStore *store, const HistoryEntry *entry,
+                         HistoryFactor **factors_out, size_t *count_out, char *error_buf);
+void history_free_factors(HistoryFactor *factors, size_t count);
+
+/*
+ * Decode DESIGN of a record, given its factors from history_read_effects:
+ * *levels_out is rows x factor_count level indices, row-major (caller frees)
+ */
+int history_read_design(HistoryStore *store, const HistoryEntry *entry,
+                        const HistoryFactor *factors, size_t factor_count,
+                        uint8_t **levels_out, size_t *rows_out, char *error_buf);
+
+/* The definition text of a record (caller frees) */
+char *history_read_source(HistoryStore *store, const HistoryEntry *entry, char *error_buf);
+
+/* Decode RESULTS of a record into parallel arrays (caller frees both) */
+int history_read_results(HistoryStore *store, const HistoryEntry *entry, size_t **run_ids_out,
+                         double **responses_out, size_t *count_out, char *error_buf);
+
+/* "YYYY-MM-DD" to YYYYMMDD; returns 0 when the text is not a valid date */
+uint32_t history_parse_date(const char *text);
+
+#endif /* HISTSTORE_H */
@@ -0,0 +1,341 @@
+#define _GNU_SOURCE
+#include "input.h"
+#include "commands.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdbool.h>
+
+#define INPUT_CHUNK 65536
+
+static bool is_stdin(const char *path) {
+    return strcmp(path, "-") == 0;
+}
+
+char *read_input(const char *path, size_t *len_out, FILE *err) {
+    FILE *file = is_stdin(path) ? stdin : fopen(path, "r");
+    if (!file) {
+        fprintf(err, "Error opening file %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    /* Grow geometrically: works for pipes and sockets, which cannot seek */
+    size_t cap = INPUT_CHUNK, len = 0;
+    char *buf = malloc(cap + 1);
+    while (buf) {
+        if (len == cap) {
+            char *grown = realloc(buf, cap * 2 + 1);
+            if (!grown) {
+                free(buf);
+                buf = NULL;
+                break;
+            }
+            buf = grown;
+            cap *= 2;
+        }
+        size_t n = fread(buf + len, 1, cap - len, file);
+        len += n;
+        if (n == 0) break;
+    }
+    bool failed = ferror(file) != 0;
+    int saved_errno = errno;
+    if (file != stdin) fclose(file);
+
+    if (!buf) {
+        fprintf(err, "Error: out of memory reading %s\n", path);
+        return NULL;
+    }
+    if (failed) {
+        fprintf(err, "Error reading %s: %s\n", path, strerror(saved_errno));
+        free(buf);
+        return NULL;
+    }
+    buf[len] = '\0';
+    if (len_out) *len_out = len;
+    return buf;
+}
+
+/* Parse "<name> <bytes>\n" at *pos; returns the section size or -1 */
+static long read_section_header(const char *buf, size_t len, size_t *pos, const char *name) {
+    size_t name_len = strlen(name);
+    if (*pos + name_len + 1 > len || strncmp(buf + *pos, name, name_len) != 0 ||
+        buf[*pos + name_len] != ' ') {
+        return -1;
+    }
+    const char *num = buf + *pos + name_len + 1;
+    char *end;
+    errno = 0;
+    long size = strtol(num, &end, 10);
+    if (errno != 0 || end == num || *end != '\n' || size < 0) return -1;
+    *pos = (size_t)(end - buf) + 1;
+    if ((size_t)size > len - *pos) return -1;
+    return size;
+}
+
+int split_framed_stream(char *buf, size_t len, char **definition, char **results,
+                        char *error_buf, size_t error_size) {
+    size_t magic_len = strlen(INPUT_STREAM_MAGIC);
+    if (len < magic_len || memcmp(buf, INPUT_STREAM_MAGIC, magic_len) != 0) {
+        snprintf(error_buf, error_size, "not a framed stream (expected '%.*s' header)",
+                 (int)(magic_len - 1), INPUT_STREAM_MAGIC);
+        return -1;
+    }
+    size_t pos = magic_len;
+
+    long def_size = read_section_header(buf, len, &pos, "definition");
+    if (def_size < 0) {
+        snprintf(error_buf, error_size, "framed stream: bad or truncated definition section");
+        return -1;
+    }
+    char *def = buf + pos;
+    pos += (size_t)def_size;
+
+    char *res = NULL;
+    long res_size = -1;
+    if (pos < len) {
+        res_size = read_section_header(buf, len, &pos, "results");
+        if (res_size < 0) {
+            snprintf(error_buf, error_size, "framed stream: bad or truncated results section");
+            return -1;
+        }
+        res = buf + pos;
+        pos += (size_t)res_size;
+        if (pos != len) {
+            snprintf(error_buf, error_size, "framed stream: %zu trailing byte(s)", len - pos);
+            return -1;
+        }
+    }
+
+    /* Terminate sections in place; the results header byte is already consumed */
+    def[def_size] = '\0';
+    if (res) res[res_size] = '\0';
+    *definition = def;
+    *results = res;
+    return 0;
+}
+
+/* Definition text of an input, unwrapping a framed stream */
+char *read_file_dynamic(const char *filename, FILE *err) {
+    size_t len = 0;
+    char *buf = read_input(filename, &len, err);
+    if (!buf) return NULL;
+
+    size_t magic_len = strlen(INPUT_STREAM_MAGIC);
+    if (len >= magic_len && memcmp(buf, INPUT_STREAM_MAGIC, magic_len) == 0) {
+        char *def, *res;
+        char error[256];
+        if (split_framed_stream(buf, len, &def, &res, error, sizeof(error)) != 0) {
+            fprintf(err, "Error reading %s: %s\n", filename, error);
+            free(buf);
+            return NULL;
+        }
+        memmove(buf, def, strlen(def) + 1);
+    }
+    return buf;
+}
+
+int load_definition_and_results(const char *tgu_path, const char *csv_path,
+                                char **definition, char **results, FILE *err) {
+    *definition = NULL;
+    *results = NULL;
+
+    if (strcmp(tgu_path, csv_path) == 0) {
+        size_t len = 0;
+        char *buf = read_input(tgu_path, &len, err);
+        if (!buf) return -1;
+        char *def, *res;
+        char error[256];
+        if (split_framed_stream(buf, len, &def, &res, error, sizeof(error)) != 0) {
+            fprintf(err, "Error reading %s: %s\n", tgu_path, error);
+            free(buf);
+            return -1;
+        }
+        if (!res) {
+            fprintf(err, "Error reading %s: framed stream has no results section\n", tgu_path);
+            free(buf);
+            return -1;
+        }
+        *definition = strdup(def);
+        *results = strdup(res);
+        free(buf);
+        if (!*definition || !*results) {
+            free(*definition);
+            free(*results);
+            fprintf(err, "Error: out of memory\n");
+            return -1;
+        }
+        return 0;
+    }
+
+    *definition = read_file_dynamic(tgu_path, err);
+    if (!*definition) return -1;
+    *results = read_input(csv_path, NULL, err);
+    if (!*results) {
+        free(*definition);
+        *definition = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+/* Split a CSV line in-place into field pointers. Returns field count.
+ * Replaces commas with NUL bytes; max_fields caps the result. */
+static int csv_split(char *line, char **fields, int max_fields) {
+    int n = 0;
+    char *p = line;
+    while (n < max_fields) {
+        fields[n++] = p;
+        p = strchr(p, ',');
+        if (!p) break;
+        *p++ = '\0';
+    }
+    return n;
+}
+
+/* Trim leading/trailing ASCII spaces and tabs in-place.
+ * Returns the new start pointer (may differ from s). */
+static char *csv_trim(char *s) {
+    while (*s == ' ' || *s == '\t') s++;
+    size_t len = strlen(s);
+    while (len > 0 && (s[len-1] == ' ' || s[len-1] == '\t')) s[--len] = '\0';
+    return s;
+}
+
+int parse_csv_results(const char *text, const char *source, const char *metric_name,
+                        taguchi_result_set_t *results, char *error_buf) {
+    /* The text may have come from a pipe; read it back through a memory stream */
+    size_t text_len = strlen(text);
+    FILE *file = text_len > 0 ? fmemopen((void *)text, text_len, "r") : NULL;
+    if (!file) {
+        snprintf(error_buf, TAGUCHI_ERROR_SIZE, "No data rows found in %s", source);
+        return -1;
+    }
+
+    char line[4096];
+    int line_num = 0;
+    int data_lines = 0;
+    int metric_col = -1;   /* column index for the response value; -1 = not yet resolved */
+    bool header_seen = false;
+
+    while (fgets(line, sizeof(line), file)) {
+        line_num++;
+        /* Detect truncated lines — buffer full with no newline means line exceeded limit */
+        size_t len = strlen(line);
+        if (len == sizeof(line) - 1 && line[len - 1] != '\n') {
+            snprintf(error_buf, TAGUCHI_ERROR_SIZE,
+                     "Line %d exceeds maximum length (%zu chars)", line_num, sizeof(line) - 2);
+            fclose(file);
+            return -1;
+        }
+        /* Trim trailing newline/CR */
+        while (len > 0 && (line[len-1] == '\n' || line[len-1] == '\r')) {
+            line[--len] = '\0';
+        }
+
+        /* Skip empty lines and comments */
+        if (len == 0 || line[0] == '#') continue;
+
+        if (!header_seen) {
+            header_seen = true;
+
+            /* Decide if this row is a header by checking whether its first
+             * comma-delimited field parses as a plain integer. */
+            char tmp[4096];
+            strncpy(tmp, line, sizeof(tmp) - 1);
+            tmp[sizeof(tmp) - 1] = '\0';
+
+            char *hfields[512];
+            int nhf = csv_split(tmp, hfields, 512);
+
+            char *endptr;
+            strtol(csv_trim(hfields[0]), &endptr, 10);
+            bool is_header = (*endptr != '\0'); /* non-numeric first field → header */
+
+            if (is_header) {
+                /* Locate the column whose name matches metric_name */
+                for (int col = 0; col < nhf; col++) {
+                    if (strcmp(csv_trim(hfields[col]), metric_name) == 0) {
+                        metric_col = col;
+                        break;
+                    }
+                }
+
+                if (metric_col == -1) {
+                    if (strcmp(metric_name, "response") == 0) {
+                        /* Default metric not present in header — fall back to col 1 */
+                        metric_col = 1;
+                    } else {
+                        snprintf(error_buf, TAGUCHI_ERROR_SIZE,
+                                 "Metric '%s' not found in CSV header", metric_name);
+                        fclose(file);
+                        return -1;
+                    }
+                }
+                continue; /* header consumed; proceed to data rows */
+            } else {
+                /* No header row */
+                if (strcmp(metric_name, "response") != 0) {
+                    snprintf(error_buf, TAGUCHI_ERROR_SIZE,
+                             "No header row in '%s'; cannot locate metric '%s'",
+                             source, metric_name);
+                    fclose(file);
+                    return -1;
+                }
+                metric_col = 1;
+                /* Fall through — parse this line as the first data row */
+            }
+        }
+
+        /* --- Data row --- */
+        char row[4096];
+        strncpy(row, line, sizeof(row) - 1);
+        row[sizeof(row) - 1] = '\0';
+
+        char *fields[512];
+        int nf = csv_split(row, fields, 512);
+
+        if (nf <= metric_col) {
+            snprintf(error_buf, TAGUCHI_ERROR_SIZE,
+                     "Row at line %d has %d column(s); metric '%s' is at column %d",
+                     line_num, nf, metric_name, metric_col + 1);
+            fclose(file);
+            return -1;
+        }
+
+        char *endptr;
+        long run_id = strtol(csv_trim(fields[0]), &endptr, 10);
+        if (*endptr != '\0' || run_id < 1) {
+            snprintf(error_buf, TAGUCHI_ERROR_SIZE, "Invalid run_id at line %d", line_num);
+            fclose(file);
+            return -1;
+        }
+
+        char *val_str = csv_trim(fields[metric_col]);
+        /* Skip rows where the metric value is absent (missing data) */
+        if (val_str[0] == '\0') continue;
+
+        double response = strtod(val_str, &endptr);
+        if (*endptr != '\0') {
+            snprintf(error_buf, TAGUCHI_ERROR_SIZE,
+                     "Invalid value for metric '%s' at line %d: '%s'",
+                     metric_name, line_num, val_str);
+            fclose(file);
+            return -1;
+        }
+
+        if (taguchi_add_result(results, (size_t)run_id, response, error_buf) != 0) {
+            fclose(file);
+            return -1;
+        }
+        data_lines++;
+    }
+
+    fclose(file);
+
+    if (data_lines == 0) {
+        snprintf(error_buf, TAGUCHI_ERROR_SIZE, "No data rows found in %s", source);
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,61 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "include/taguchi.h"
+
+/*
+ * Command inputs.
+ *
+ * Every definition or results argument may be a path, "-" for stdin, or
+ * /dev/fd/N for an inherited descriptor; inputs are read sequentially so
+ * pipes work.  A definition and its results can also travel together in
+ * one framed stream, selected by passing the same input for both
+ * arguments (e.g. `taguchi effects - -`):
+ *
+ *   TAGUCHI-STREAM 1\n
+ *   definition <bytes>\n
+ *   <bytes of .tgu>
+ *   results <bytes>\n          (optional for commands without results)
+ *   <bytes of CSV>
+ *
+ * Commands that take only a definition accept a framed stream as well and
+ * use its definition section.
+ */
+
+#define INPUT_STREAM_MAGIC "TAGUCHI-STREAM 1\n"
+
+/* Read a whole input into a NUL-terminated heap buffer (caller frees), or NULL */
+char *read_input(const char *path, size_t *len_out, FILE *err);
+
+/*
+ * Split a framed stream in place; *definition and *results point into buf
+ * (*results is NULL when the section is absent).  Returns 0 or -1 with a
+ * message in error_buf.
+ */
+int split_framed_stream(char *buf, size_t len, char **definition, char **results,
+                        char *error_buf, size_t error_size);
+
+/*
+ * Load the definition and results text of effects/analyze (both heap
+ * buffers, caller frees).  The same argument twice means one framed stream.
+ */
+int load_definition_and_results(const char *tgu_path, const char *csv_path,
+                                char **definition, char **results, FILE *err);
+
+/*
+ * Parse CSV results text into results; source names the input in
+ * messages and error_buf must hold TAGUCHI_ERROR_SIZE bytes.
+ *
+ * The file may have any number of columns.  If the first non-comment,
+ * non-empty row is a header (its first field is not a plain integer), the
+ * column whose name matches metric_name is used as the response value.
+ * When no header is present the second column (index 1) is used.
+ *
+ * Lines starting with '#' are treated as comments.
+ */
+int parse_csv_results(const char *text, const char *source, const char *metric_name,
+                      taguchi_result_set_t *results, char *error_buf);
+
+#endif /* INPUT_H */
@@ -0,0 +1,250 @@
+#define _GNU_SOURCE
+#include "logcap.h"
+#include "include/taguchi.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <zlib.h>
+
+#define LOGCAP_CHUNK (64 * 1024)
+#define LOGCAP_READS_PER_CALL 16   /* Bound one pipe's turn so others are drained too */
+
+void logcap_options_init(LogCaptureOptions *opts) {
+    memset(opts, 0, sizeof(*opts));
+    opts->ring_bytes = LOGCAP_DEFAULT_RING;
+    opts->max_bytes = LOGCAP_DEFAULT_MAX_BYTES;
+}
+
+bool logcap_enabled(const LogCaptureOptions *opts) {
+    return opts && (opts->dir || opts->metric_count > 0);
+}
+
+int logcap_add_metric(LogCaptureOptions *opts, const char *spec, char *error_buf) {
+    const char *eq = strchr(spec, '=');
+    if (!eq || eq == spec || eq[1] == '\0') {
+        snprintf(error_buf, TAGUCHI_ERROR_SIZE, "log metric '%s' must be name=text", spec);
+        return -1;
+    }
+    size_t len = (size_t)(eq - spec);
+    if (len >= LOGCAP_METRIC_NAME) {
+        snprintf(error_buf, TAGUCHI_ERROR_SIZE, "log metric name too long (max %d characters)",
+                 LOGCAP_METRIC_NAME - 1);
+        return -1;
+    }
+    if (opts->metric_count >= LOGCAP_MAX_METRICS) {
+        snprintf(error_buf, TAGUCHI_ERROR_SIZE, "too many log metrics (max %d)", LOGCAP_MAX_METRICS);
+        return -1;
+    }
+    LogMetric *m = &opts->metrics[opts->metric_count++];
+    memcpy(m->name, spec, len);
+    m->name[len] = '\0';
+    m->pattern = eq + 1;
+    return 0;
+}
+
+int logcap_parse_size(const char *text, uint64_t *out) {
+    char *endptr;
+    errno = 0;
+    unsigned long long value = strtoull(text, &endptr, 10);
+    if (endptr == text || errno != 0 || text[0] == '-') return -1;
+    unsigned shift = 0;
+    switch (*endptr) {
+        case 'K': case 'k': shift = 10; endptr++; break;
+        case 'M': case 'm': shift = 20; endptr++; break;
+        case 'G': case 'g': shift = 30; endptr++; break;
+        default: break;
+    }
+    if (*endptr != '\0' || value > (UINT64_MAX >> shift)) return -1;
+    *out = (uint64_t)value << shift;
+    return 0;
+}
+
+int logcap_init(LogCapture *cap, const LogCaptureOptions *opts) {
+    memset(cap, 0, sizeof(*cap));
+    cap->fd = -1;
+    size_t head = opts->ring_bytes / 2;
+    cap->tail_size = opts->ring_bytes - head;
+    cap->head = malloc(head + 1);
+    cap->tail = malloc(cap->tail_size + 1);
+    if (!cap->head || !cap->tail) {
+        logcap_free(cap);
+        return -1;
+    }
+    return 0;
+}
+
+void logcap_free(LogCapture *cap) {
+    if (cap->fd >= 0) close(cap->fd);
+    if (cap->gz) gzclose((gzFile)cap->gz);
+    free(cap->head);
+    free(cap->tail);
+    cap->fd = -1;
+    cap->gz = NULL;
+    cap->head = cap->tail = NULL;
+}
+
+int logcap_start(LogCapture *cap, const LogCaptureOptions *opts, size_t run_id, bool append) {
+    cap->head_len = 0;
+    cap->tail_len = 0;
+    cap->tail_pos = 0;
+    cap->total = 0;
+    cap->written = 0;
+    cap->line_len = 0;
+    memset(cap->found, 0, sizeof(cap->found));
+
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) return -1;
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    cap->fd = fds[0];
+
+    if (opts->dir) {
+        char path[4096];
+        char mode[8];
+        snprintf(path, sizeof(path), "%s/run-%zu.log.gz", opts->dir, run_id);
+        /* 'e' keeps the file out of later children */
+        snprintf(mode, sizeof(mode), "%cb%de", append ? 'a' : 'w', LOGCAP_LEVEL);
+        cap->gz = gzopen(path, mode);
+        if (!cap->gz) {
+            fprintf(stderr, "Warning: cannot write %s; run %zu output is not kept\n", path, run_id);
+        } else {
+            gzbuffer((gzFile)cap->gz, LOGCAP_CHUNK);
+        }
+    }
+    return fds[1];
+}
+
+/* Keep the first bytes in head and the latest in the tail ring */
+static void keep(LogCapture *cap, const char *data, size_t n, size_t head_size) {
+    if (cap->head_len < head_size) {
+        size_t take = head_size - cap->head_len < n ? head_size - cap->head_len : n;
+        memcpy(cap->head + cap->head_len, data, take);
+        cap->head_len += take;
+        data += take;
+        n -= take;
+    }
+    if (n == 0 || cap->tail_size == 0) return;
+    if (n >= cap->tail_size) {
+        memcpy(cap->tail, data + n - cap->tail_size, cap->tail_size);
+        cap->tail_pos = 0;
+        cap->tail_len = cap->tail_size;
+        return;
+    }
+    size_t first = cap->tail_size - cap->tail_pos < n ? cap->tail_size - cap->tail_pos : n;
+    memcpy(cap->tail + cap->tail_pos, data, first);
+    memcpy(cap->tail, data + first, n - first);
+    cap->tail_pos = (cap->tail_pos + n) % cap->tail_size;
+    cap->tail_len = cap->tail_len + n > cap->tail_size ? cap->tail_size : cap->tail_len + n;
+}
+
+/* The last occurrence of each metric's text on a line sets its value */
+static void match_line(LogCapture *cap, const LogCaptureOptions *opts) {
+    cap->line[cap->line_len] = '\0';
+    for (size_t m = 0; m < opts->metric_count; m++) {
+        const char *pattern = opts->metrics[m].pattern;
+        const char *hit = NULL;
+        for (const char *p = strstr(cap->line, pattern); p; p = strstr(p + 1, pattern)) {
+            hit = p;
+        }
+        if (!hit) continue;
+        char *endptr;
+        double value = strtod(hit + strlen(pattern), &endptr);
+        if (endptr != hit + strlen(pattern)) {
+            cap->values[m] = value;
+            cap->found[m] = true;
+        }
+    }
+    cap->line_len = 0;
+}
+
+static void consume(LogCapture *cap, const LogCaptureOptions *opts, const char *data, size_t n) {
+    if (cap->gz) {
+        uint64_t room = opts->max_bytes > 0 ? opts->max_bytes - cap->written : n;
+        size_t take = room < n ? (size_t)room : n;
+        if (take > 0 && gzwrite((gzFile)cap->gz, data, (unsigned)take) > 0) {
+            cap->written += take;
+        }
+    }
+    keep(cap, data, n, opts->ring_bytes / 2);
+    cap->total += n;
+
+    if (opts->metric_count == 0) return;
+    for (size_t i = 0; i < n; i++) {
+        if (data[i] == '\n') {
+            match_line(cap, opts);
+        } else if (cap->line_len < LOGCAP_LINE_MAX - 1) {
+            cap->line[cap->line_len++] = data[i];
+        }
+    }
+}
+
+/* Returns 0 at end of file, 1 when the pipe is empty for now, 2 when
+ * max_reads chunks were taken and more may be waiting */
+static int drain(LogCapture *cap, const LogCaptureOptions *opts, int max_reads) {
+    if (cap->fd < 0) return 0;
+    static char buf[LOGCAP_CHUNK];
+    for (int i = 0; i < max_reads; i++) {
+        ssize_t n = read(cap->fd, buf, sizeof(buf));
+        if (n > 0) {
+            consume(cap, opts, buf, (size_t)n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 1;
+        return 0;
+    }
+    return 2;
+}
+
+int logcap_read(LogCapture *cap, const LogCaptureOptions *opts) {
+    return drain(cap, opts, LOGCAP_READS_PER_CALL) != 0;
+}
+
+void logcap_finish(LogCapture *cap, const LogCaptureOptions *opts) {
+    /* Whatever was written before the run exited is in the pipe by now;
+     * a background process still holding it open loses the rest */
+    while (drain(cap, opts, LOGCAP_READS_PER_CALL) == 2) {}
+    if (cap->fd >= 0) {
+        close(cap->fd);
+        cap->fd = -1;
+    }
+    if (cap->line_len > 0) match_line(cap, opts);
+    if (cap->gz) {
+        if (cap->total > cap->written) {
+            gzprintf((gzFile)cap->gz, "\n[taguchi: log capped at %" PRIu64 " bytes, %" PRIu64
+                     " more not written]\n", cap->written, cap->total - cap->written);
+        }
+        gzclose((gzFile)cap->gz);
+        cap->gz = NULL;
+    }
+}
+
+void logcap_print_excerpt(const LogCapture *cap, FILE *out, size_t run_id) {
+    if (cap->total == 0) return;
+    fprintf(out, "--- Run %zu output", run_id);
+    uint64_t kept = cap->head_len + cap->tail_len;
+    if (cap->total > kept) {
+        fprintf(out, " (first %zu and last %zu of %" PRIu64 " bytes)", cap->head_len,
+                cap->tail_len, cap->total);
+    }
+    fprintf(out, " ---\n");
+    fwrite(cap->head, 1, cap->head_len, out);
+    if (cap->total > kept) {
+        fprintf(out, "\n[... %" PRIu64 " bytes omitted ...]\n", cap->total - kept);
+    }
+    /* Once the ring is full its oldest byte sits at tail_pos */
+    char last = cap->head_len > 0 ? cap->head[cap->head_len - 1] : '\n';
+    if (cap->tail_len == cap->tail_size && cap->tail_size > 0) {
+        fwrite(cap->tail + cap->tail_pos, 1, cap->tail_size - cap->tail_pos, out);
+        fwrite(cap->tail, 1, cap->tail_pos, out);
+        last = cap->tail[(cap->tail_pos + cap->tail_size - 1) % cap->tail_size];
+    } else if (cap->tail_len > 0) {
+        fwrite(cap->tail, 1, cap->tail_len, out);
+        last = cap->tail[cap->tail_len - 1];
+    }
+    if (last != '\n') fputc('\n', out);
+    fprintf(out, "--- end of run %zu output ---\n", run_id);
+    fflush(out);
+}
@@ -0,0 +1,94 @@
+#ifndef LOGCAP_H
+#define LOGCAP_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Per-run output capture for `taguchi run --log-dir` / `--log-metric`.
+ *
+ * A run's stdout and stderr share one pipe that the runner drains as data
+ * arrives.  Everything read is streamed through zlib into
+ * <dir>/run-<id>.log.gz (until max_bytes of output have been written),
+ * the first and last ring_bytes / 2 are kept in memory for an excerpt when
+ * the run fails, and each complete line is matched against the log metrics.
+ * Memory per run is fixed by ring_bytes and LOGCAP_LINE_MAX however much
+ * the workload prints.
+ */
+
+#define LOGCAP_MAX_METRICS 8
+#define LOGCAP_METRIC_NAME 32
+#define LOGCAP_LINE_MAX 4096                       /* Longer lines are matched on their start */
+#define LOGCAP_DEFAULT_RING (64 * 1024)            /* Head + tail kept per run */
+#define LOGCAP_DEFAULT_MAX_BYTES (256ULL << 20)    /* Output written per log file */
+#define LOGCAP_LEVEL 1                             /* zlib level: cheap on chatty runs */
+
+/* "name=text": the number after the last "text" seen in the output */
+typedef struct {
+    char name[LOGCAP_METRIC_NAME];
+    const char *pattern;
+} LogMetric;
+
+typedef struct {
+    const char *dir;           /* Directory for run-<id>.log.gz, or NULL */
+    size_t ring_bytes;         /* Head + tail kept in memory per run */
+    uint64_t max_bytes;        /* Output written to each log file, 0 for no cap */
+    LogMetric metrics[LOGCAP_MAX_METRICS];
+    size_t metric_count;
+} LogCaptureOptions;
+
+typedef struct {
+    int fd;                    /* Read end of the run's pipe, -1 once closed */
+    void *gz;                  /* gzFile, or NULL when not writing a file */
+    char *head;                /* First ring_bytes / 2 bytes */
+    size_t head_len;
+    char *tail;                /* Ring of the last bytes after the head */
+    size_t tail_size;
+    size_t tail_len;
+    size_t tail_pos;           /* Next write position in tail */
+    uint64_t total;            /* Bytes read */
+    uint64_t written;          /* Bytes passed to the log file */
+    char line[LOGCAP_LINE_MAX];
+    size_t line_len;
+    double values[LOGCAP_MAX_METRICS];
+    bool found[LOGCAP_MAX_METRICS];
+} LogCapture;
+
+/* Defaults: no log files, 64 KiB ring, 256 MiB per log file, no metrics */
+void logcap_options_init(LogCaptureOptions *opts);
+
+/* True when runs need their output captured at all */
+bool logcap_enabled(const LogCaptureOptions *opts);
+
+/* Add a "name=text" metric; error_buf must hold TAGUCHI_ERROR_SIZE bytes */
+int logcap_add_metric(LogCaptureOptions *opts, const char *spec, char *error_buf);
+
+/* Parse a byte count with an optional K, M or G suffix (powers of 1024) */
+int logcap_parse_size(const char *text, uint64_t *out);
+
+/* Allocate the ring for one slot; returns -1 when out of memory */
+int logcap_init(LogCapture *cap, const LogCaptureOptions *opts);
+void logcap_free(LogCapture *cap);
+
+/*
+ * Begin capturing a run: reset the buffers, open the log file (appending a
+ * new gzip member when append is true) and create the pipe.  Returns the
+ * write end for the child's stdout/stderr, or -1 if no pipe could be made.
+ * A log file that cannot be opened only warns; the output is still read.
+ */
+int logcap_start(LogCapture *cap, const LogCaptureOptions *opts, size_t run_id, bool append);
+
+/* Read whatever is available without blocking; returns 1 while the pipe is
+ * open, 0 once it reached end of file (it stays open until logcap_finish) */
+int logcap_read(LogCapture *cap, const LogCaptureOptions *opts);
+
+/* After the run was reaped: take what is left in the pipe, close it and
+ * finish the log file, noting how much the cap left out */
+void logcap_finish(LogCapture *cap, const LogCaptureOptions *opts);
+
+/* Print the kept head and tail of the output, marking any gap */
+void logcap_print_excerpt(const LogCapture *cap, FILE *out, size_t run_id);
+
+#endif /* LOGCAP_H */
@@ -2,36 +2,70 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 #include <unistd.h>
 #include <sys/wait.h>
 #include <getopt.h>
 #include <errno.h>
 #include <limits.h>
+#include <sys/stat.h>
 #include "include/taguchi.h"
+#include "runner.h"
+#include "adaptive.h"
+#include "commands.h"
+#include "batch.h"
+#include "simulate.h"
+#include "history.h"
+#include "compare.h"
+#include "input.h"
 
-/* Forward declaration — defined below after parse_csv_results */
-static char *read_file_dynamic(const char *filename);
 
 static void print_usage(const char *program_name) {
     fprintf(stderr, 
         "Usage: %s [OPTIONS] <command> [ARGS]\n"
         "\n"
+        "Options:\n"
+        "  --cache-dir dir         Cache compiled designs in dir (also TAGUCHI_CACHE_DIR)\n"
+        "  --max-workers N         Library thread pool size (also TAGUCHI_MAX_WORKERS)\n"
+        "\n"
         "Commands:\n"
         "  generate <file.tgu>     Generate experiment runs\n"
+        "                          [--json] (typed level values: numbers, true/false)\n"
         "  run <file.tgu> <script> Execute experiments with external script\n"
+        "                          [-j N|auto[:N]] [--metrics-file path] [--no-progress]\n"
+        "                          [--results out.csv] [--perf-counters list]\n"
+        "                          [--adaptive [--confidence C] [--max-runs N]]\n"
+        "                          [--log-dir dir] [--log-max-bytes SIZE] [--log-metric name=text]\n"
+        "                          [--retries N [--retry-on codes] [--retry-backoff S]] [--journal path]\n"
         "  analyze <file.tgu> <results.csv> Analyze experimental results\n"
+        "                          [--metric name] [--minimize] [--degree 1-3]\n"
         "  effects <file.tgu> <results.csv> Calculate main effects\n"
+        "                          [--metric name] [--where factor=value[,value]]...\n"
+        "  compare <file.tgu> <a.csv> <b.csv> Rank the factors whose effects changed\n"
+        "                          [--metric name] [--permutations N] [--fail-on-change]\n"
+        "  simulate <file.tgu>     Synthetic results from a ground-truth model\n"
+        "                          [--effect f=v1,v2,...] [--noise SD] [--check] [--bench N]\n"
         "  validate <file.tgu>     Validate experiment definition\n"
         "  suggest-array <file.tgu> Suggest optimal orthogonal array\n"
+        "  batch <command> <files...> Run validate/generate/suggest-array over\n"
+        "                          many files [-j N] [--manifest file] [--output-dir dir]\n"
+        "  history <subcommand>    Record campaigns and query them across releases:\n"
+        "                          record <file.tgu> <results.csv> --name N [--tag T],\n"
+        "                          list, trend --name N [--factor F], export <campaign>\n"
         "  list-arrays             List available orthogonal arrays\n"
         "  --help                  Show this help message\n"
         "  --version               Show version information\n"
         "\n"
+        "Any <file.tgu> or <results.csv> may be '-' (stdin) or /dev/fd/N.  Passing\n"
+        "the same input for both (e.g. 'effects - -') reads one framed stream:\n"
+        "  TAGUCHI-STREAM 1 / definition <bytes> / ... / results <bytes> / ...\n"
+        "\n"
         "Examples:\n"
         "  %s generate experiment.tgu\n"
         "  %s run experiment.tgu './my_script.sh'\n"
-        "  %s analyze experiment.tgu results.csv --metric throughput\n",
-        program_name, program_name, program_name, program_name);
+        "  %s analyze experiment.tgu results.csv --metric throughput\n"
+        "  cat results.csv | %s effects experiment.tgu -\n",
+        program_name, program_name, program_name, program_name, program_name);
 }
 
 static void print_version(void) {
@@ -74,17 +108,9 @@ static int cmd_list_arrays(int argc, char *argv[]) {
     return 0;
 }
 
-static int cmd_generate(int argc, char *argv[]) {
-    if (argc < 2) {
-        fprintf(stderr, "Error: generate command requires .tgu file\n");
-        print_usage(argv[0]);
-        return 1;
-    }
-    
-    const char *filename = argv[1];
-    
+int run_generate_file(const char *filename, FILE *out, FILE *err) {
     // Read the file
-    char *content = read_file_dynamic(filename);
+    char *content = read_file_dynamic(filename, err);
     if (!content) return 1;
 
     // Parse the definition
@@ -92,7 +118,7 @@ static int cmd_generate(int argc, char *argv[]) {
     taguchi_experiment_def_t *def = taguchi_parse_definition(content, error);
     free(content);
     if (!def) {
-        fprintf(stderr, "Error parsing file %s: %s\n", filename, error);
+        fprintf(err, "Error parsing file %s: %s\n", filename, error);
         return 1;
     }
 
@@ -101,82 +127,152 @@ static int cmd_generate(int argc, char *argv[]) {
     size_t count = 0;
     
     if (taguchi_generate_runs(def, &runs, &count, error) != 0) {
-        fprintf(stderr, "Error generating runs: %s\n", error);
+        fprintf(err, "Error generating runs: %s\n", error);
         taguchi_free_definition(def);
         return 1;
     }
     
     // Print runs with factor details
-    printf("Generated %zu experiment runs:\n", count);
+    fprintf(out, "Generated %zu experiment runs:\n", count);
+    size_t *plots = NULL;
+    if (taguchi_def_is_split_plot(def)) {
+        plots = malloc(count * sizeof(size_t));
+        if (!plots || taguchi_get_whole_plots(def, plots, count, error) == 0) {
+            fprintf(err, "Error: %s\n", plots ? error : "out of memory");
+            free(plots);
+            taguchi_free_runs(runs, count);
+            taguchi_free_definition(def);
+            return 1;
+        }
+    }
     for (size_t i = 0; i < count; i++) {
-        printf("Run %zu: ", taguchi_run_get_id(runs[i]));
-
         // Get factor count from the original definition to know how many to print
         size_t factor_count = taguchi_def_get_factor_count(def);
 
+        /* Split-plot: announce each whole plot with its hard-to-change levels */
+        if (plots && (i == 0 || plots[i] != plots[i - 1])) {
+            fprintf(out, "Whole plot %zu:", plots[i]);
+            for (size_t f = 0; f < factor_count; f++) {
+                if (!taguchi_def_is_whole_plot_factor(def, f)) continue;
+                const char *factor_name = taguchi_def_get_factor_name(def, f);
+                fprintf(out, " %s=%s", factor_name, taguchi_run_get_value(runs[i], factor_name));
+            }
+            fprintf(out, "\n");
+        }
+
+        fprintf(out, "Run %zu: ", taguchi_run_get_id(runs[i]));
+
         // Print each factor-value pair
         for (size_t f = 0; f < factor_count; f++) {
             const char *factor_name = taguchi_def_get_factor_name(def, f);
             if (factor_name) {
                 const char *factor_value = taguchi_run_get_value(runs[i], factor_name);
                 if (factor_value) {
-                    if (f > 0) printf(", "); // Comma separator except for first
-                    printf("%s=%s", factor_name, factor_value);
+                    if (f > 0) fprintf(out, ", "); // Comma separator except for first
+                    fprintf(out, "%s=%s", factor_name, factor_value);
                 }
             }
         }
-        printf("\n");
+        fprintf(out, "\n");
     }
     
     // Cleanup
+    free(plots);
     taguchi_free_runs(runs, count);
     taguchi_free_definition(def);
     
     return 0;
 }
 
-static int cmd_suggest_array(int argc, char *argv[]) {
+/* generate --json: runs with typed level values, for scripts and bindings */
+static int run_generate_json(const char *filename, FILE *out, FILE *err) {
+    char *content = read_file_dynamic(filename, err);
+    if (!content) return 1;
+
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(content, error);
+    free(content);
+    if (!def) {
+        fprintf(err, "Error parsing file %s: %s\n", filename, error);
+        return 1;
+    }
+
+    taguchi_experiment_run_t **runs = NULL;
+    size_t count = 0;
+    if (taguchi_generate_runs(def, &runs, &count, error) != 0) {
+        fprintf(err, "Error generating runs: %s\n", error);
+        taguchi_free_definition(def);
+        return 1;
+    }
+
+    char *json = taguchi_runs_to_typed_json(def, (const taguchi_experiment_run_t **)runs, count);
+    fprintf(out, "%s\n", json);
+    taguchi_free_string(json);
+    taguchi_free_runs(runs, count);
+    taguchi_free_definition(def);
+    return 0;
+}
+
+static int cmd_generate(int argc, char *argv[]) {
     if (argc < 2) {
-        fprintf(stderr, "Error: suggest-array command requires .tgu file\n");
+        fprintf(stderr, "Error: generate command requires .tgu file\n");
         print_usage(argv[0]);
         return 1;
     }
 
-    const char *filename = argv[1];
-    char *content = read_file_dynamic(filename);
+    bool json = false;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else {
+            fprintf(stderr, "Error: unknown generate option '%s'\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (json) {
+        return run_generate_json(argv[1], stdout, stderr);
+    }
+    return run_generate_file(argv[1], stdout, stderr);
+}
+
+int run_suggest_array_file(const char *filename, FILE *out, FILE *err) {
+    char *content = read_file_dynamic(filename, err);
     if (!content) return 1;
 
     char error[TAGUCHI_ERROR_SIZE];
     taguchi_experiment_def_t *def = taguchi_parse_definition(content, error);
     free(content);
     if (!def) {
-        fprintf(stderr, "Error: Invalid .tgu file %s: %s\n", filename, error);
+        fprintf(err, "Error: Invalid .tgu file %s: %s\n", filename, error);
         return 1;
     }
 
     const char *array_name = taguchi_suggest_optimal_array(def, error);
     if (!array_name) {
-        fprintf(stderr, "Error: %s\n", error);
+        fprintf(err, "Error: %s\n", error);
         taguchi_free_definition(def);
         return 1;
     }
 
-    printf("%s\n", array_name);
+    fprintf(out, "%s\n", array_name);
     taguchi_free_definition(def);
     return 0;
 }
 
-static int cmd_validate(int argc, char *argv[]) {
+static int cmd_suggest_array(int argc, char *argv[]) {
     if (argc < 2) {
-        fprintf(stderr, "Error: validate command requires .tgu file\n");
+        fprintf(stderr, "Error: suggest-array command requires .tgu file\n");
         print_usage(argv[0]);
         return 1;
     }
-    
-    const char *filename = argv[1];
-    
+
+    return run_suggest_array_file(argv[1], stdout, stderr);
+}
+
+int run_validate_file(const char *filename, FILE *out, FILE *err) {
     // Read the file
-    char *content = read_file_dynamic(filename);
+    char *content = read_file_dynamic(filename, err);
     if (!content) return 1;
 
     // Parse the definition
@@ -184,46 +280,315 @@ static int cmd_validate(int argc, char *argv[]) {
     taguchi_experiment_def_t *def = taguchi_parse_definition(content, error);
     free(content);
     if (!def) {
-        fprintf(stderr, "Error: Invalid .tgu file %s: %s\n", filename, error);
+        fprintf(err, "Error: Invalid .tgu file %s: %s\n", filename, error);
         return 1;
     }
     
     // Validate the definition
     if (!taguchi_validate_definition(def, error)) {
-        fprintf(stderr, "Validation failed: %s\n", error);
+        fprintf(err, "Validation failed: %s\n", error);
         taguchi_free_definition(def);
         return 1;
     }
     
-    printf("Valid .tgu file: %s\n", filename);
+    fprintf(out, "Valid .tgu file: %s\n", filename);
     taguchi_free_definition(def);
     
     return 0;
 }
 
+static int cmd_validate(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Error: validate command requires .tgu file\n");
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    return run_validate_file(argv[1], stdout, stderr);
+}
+
+/* Resolve "factor=command" hook specs against def, merging the setup and
+ * teardown of each factor into one RunnerHook */
+static int resolve_run_hooks(const taguchi_experiment_def_t *def, const char **specs,
+                             const bool *is_setup, size_t spec_count,
+                             RunnerHook *hooks, size_t *hook_count) {
+    *hook_count = 0;
+    for (size_t i = 0; i < spec_count; i++) {
+        const char *eq = strchr(specs[i], '=');
+        if (!eq || eq == specs[i] || eq[1] == '\0') {
+            fprintf(stderr, "Error: hook '%s' must look like factor=command\n", specs[i]);
+            return -1;
+        }
+        size_t name_len = (size_t)(eq - specs[i]);
+        size_t f = 0, factor_count = taguchi_def_get_factor_count(def);
+        while (f < factor_count) {
+            const char *name = taguchi_def_get_factor_name(def, f);
+            if (strlen(name) == name_len && strncmp(name, specs[i], name_len) == 0) break;
+            f++;
+        }
+        if (f == factor_count) {
+            fprintf(stderr, "Error: hook for unknown factor '%.*s'\n", (int)name_len, specs[i]);
+            return -1;
+        }
+
+        size_t h = 0;
+        while (h < *hook_count && hooks[h].factor_index != f) h++;
+        if (h == *hook_count) {
+            hooks[h].factor_index = f;
+            hooks[h].setup = NULL;
+            hooks[h].teardown = NULL;
+            (*hook_count)++;
+        }
+        const char **slot = is_setup[i] ? &hooks[h].setup : &hooks[h].teardown;
+        if (*slot) {
+            fprintf(stderr, "Error: more than one %s hook for factor '%s'\n",
+                    is_setup[i] ? "setup" : "teardown", taguchi_def_get_factor_name(def, f));
+            return -1;
+        }
+        *slot = eq + 1;
+    }
+    return 0;
+}
+
 // Command to run experiments with external script
 static int cmd_run(int argc, char *argv[]) {
     if (argc < 3) {
         fprintf(stderr, "Error: run command requires .tgu file and script\n");
-        print_usage(argv[0]);
+        fprintf(stderr, "Usage: run <file.tgu> <script> [-j N|auto[:N]] [--metrics-file path] [--no-progress]\n"
+                        "           [--results out.csv] [--perf-counters cycles,instructions,...]\n"
+                        "           [--order changeover|array] [--setup factor=cmd] [--teardown factor=cmd]\n"
+                        "           [--adaptive [--confidence C] [--max-runs N] [--top K]\n"
+                        "                       [--metric wall_seconds|counter] [--minimize]]\n"
+                        "           [--log-dir dir] [--log-max-bytes SIZE] [--log-ring SIZE]\n"
+                        "           [--log-metric name=text]\n"
+                        "           [--retries N [--retry-on 74,75,KILL,...] [--retry-backoff S]]\n"
+                        "           [--journal attempts.csv]\n");
         return 1;
     }
     
     const char *tgu_file = argv[1];
     const char *script = argv[2];
+
+    RunnerOptions opts;
+    runner_options_init(&opts);
+    opts.script = script;
+    opts.experiment = tgu_file;
+    opts.live_status = isatty(STDERR_FILENO);
+    /* Tests point -j auto at canned pressure files */
+    if (getenv("TAGUCHI_PROC_ROOT")) opts.proc_root = getenv("TAGUCHI_PROC_ROOT");
+    const char *perf_list = NULL;
+    const char *order_mode = NULL;
+    bool adaptive = false;
+    bool adaptive_tuned = false;   /* an option that only --adaptive uses */
+    AdaptiveOptions adaptive_opts;
+    adaptive_options_init(&adaptive_opts);
+    LogCaptureOptions log_opts;
+    logcap_options_init(&log_opts);
+    bool log_tuned = false;        /* a size option that only capture uses */
+    RetryPolicy retry;
+    retry_policy_init(&retry);
+    bool retry_tuned = false;      /* an option that only --retries uses */
+    /* --setup/--teardown arguments, "factor=command"; resolved after parsing.
+     * A factor has at most one of each, so more than this is rejected anyway */
+    const char *hook_specs[2 * RUNNER_MAX_HOOKS];
+    bool hook_is_setup[2 * RUNNER_MAX_HOOKS];
+    size_t hook_spec_count = 0;
+
+    /* Parse optional flags */
+    for (int i = 3; i < argc; i++) {
+        if ((strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--jobs") == 0) && i + 1 < argc) {
+            char *endptr;
+            const char *arg = argv[++i];
+            /* "auto" adapts to host pressure, up to one run per online CPU
+             * unless capped with "auto:N" */
+            bool auto_jobs = strncmp(arg, "auto", 4) == 0 && (arg[4] == '\0' || arg[4] == ':');
+            long jobs;
+            if (auto_jobs && arg[4] == '\0') {
+                jobs = sysconf(_SC_NPROCESSORS_ONLN);
+                if (jobs < 1) jobs = 1;
+                endptr = "";
+            } else {
+                jobs = strtol(auto_jobs ? arg + 5 : arg, &endptr, 10);
+            }
+            if (*endptr != '\0' || jobs < 1) {
+                fprintf(stderr, "Error: invalid job count '%s' (expected N, auto or auto:N)\n", arg);
+                return 1;
+            }
+            opts.jobs = (size_t)jobs;
+            opts.auto_jobs = auto_jobs;
+        } else if (strcmp(argv[i], "--metrics-file") == 0 && i + 1 < argc) {
+            opts.metrics_file = argv[++i];
+        } else if (strcmp(argv[i], "--no-progress") == 0) {
+            opts.live_status = false;
+        } else if (strcmp(argv[i], "--results") == 0 && i + 1 < argc) {
+            opts.results_file = argv[++i];
+        } else if (strcmp(argv[i], "--perf-counters") == 0 && i + 1 < argc) {
+            perf_list = argv[++i];
+        } else if (strcmp(argv[i], "--order") == 0 && i + 1 < argc) {
+            order_mode = argv[++i];
+            if (strcmp(order_mode, "changeover") != 0 && strcmp(order_mode, "array") != 0) {
+                fprintf(stderr, "Error: --order must be 'changeover' or 'array', got '%s'\n", order_mode);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--adaptive") == 0) {
+            adaptive = true;
+        } else if (strcmp(argv[i], "--confidence") == 0 && i + 1 < argc) {
+            char *endptr;
+            adaptive_opts.plan.confidence = strtod(argv[++i], &endptr);
+            if (*endptr != '\0' || !(adaptive_opts.plan.confidence > 0.0 &&
+                                     adaptive_opts.plan.confidence < 1.0)) {
+                fprintf(stderr, "Error: invalid confidence '%s' (expected 0 < c < 1)\n", argv[i]);
+                return 1;
+            }
+            adaptive_tuned = true;
+        } else if ((strcmp(argv[i], "--max-runs") == 0 || strcmp(argv[i], "--top") == 0) &&
+                   i + 1 < argc) {
+            char *endptr;
+            bool max_runs = strcmp(argv[i], "--max-runs") == 0;
+            long value = strtol(argv[++i], &endptr, 10);
+            if (*endptr != '\0' || value < 1) {
+                fprintf(stderr, "Error: invalid %s '%s'\n", max_runs ? "run budget" : "factor count",
+                        argv[i]);
+                return 1;
+            }
+            if (max_runs) {
+                adaptive_opts.max_runs = (size_t)value;
+            } else {
+                adaptive_opts.plan.top_factors = (size_t)value;
+            }
+            adaptive_tuned = true;
+        } else if (strcmp(argv[i], "--metric") == 0 && i + 1 < argc) {
+            adaptive_opts.metric = argv[++i];
+            adaptive_tuned = true;
+        } else if (strcmp(argv[i], "--minimize") == 0) {
+            adaptive_opts.plan.higher_is_better = false;
+            adaptive_tuned = true;
+        } else if (strcmp(argv[i], "--log-dir") == 0 && i + 1 < argc) {
+            log_opts.dir = argv[++i];
+        } else if ((strcmp(argv[i], "--log-max-bytes") == 0 || strcmp(argv[i], "--log-ring") == 0) &&
+                   i + 1 < argc) {
+            bool ring = strcmp(argv[i], "--log-ring") == 0;
+            uint64_t size;
+            if (logcap_parse_size(argv[++i], &size) != 0 || (ring && size > SIZE_MAX / 2)) {
+                fprintf(stderr, "Error: invalid size '%s' (expected bytes, or N with K, M or G)\n",
+                        argv[i]);
+                return 1;
+            }
+            if (ring) {
+                log_opts.ring_bytes = (size_t)size;
+            } else {
+                log_opts.max_bytes = size;
+            }
+            log_tuned = true;
+        } else if (strcmp(argv[i], "--log-metric") == 0 && i + 1 < argc) {
+            char error[TAGUCHI_ERROR_SIZE];
+            if (logcap_add_metric(&log_opts, argv[++i], error) != 0) {
+                fprintf(stderr, "Error: %s\n", error);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--retries") == 0 && i + 1 < argc) {
+            char *endptr;
+            long value = strtol(argv[++i], &endptr, 10);
+            if (*endptr != '\0' || value < 0 || value > 100) {
+                fprintf(stderr, "Error: invalid retry count '%s' (expected 0-100)\n", argv[i]);
+                return 1;
+            }
+            retry.max_retries = (unsigned)value;
+        } else if (strcmp(argv[i], "--retry-on") == 0 && i + 1 < argc) {
+            char error[TAGUCHI_ERROR_SIZE];
+            if (retry_parse_list(&retry, argv[++i], error) != 0) {
+                fprintf(stderr, "Error: %s\n", error);
+                return 1;
+            }
+            retry_tuned = true;
+        } else if (strcmp(argv[i], "--retry-backoff") == 0 && i + 1 < argc) {
+            char *endptr;
+            retry.backoff = strtod(argv[++i], &endptr);
+            if (*endptr != '\0' || !(retry.backoff >= 0.0 && retry.backoff <= RETRY_MAX_BACKOFF)) {
+                fprintf(stderr, "Error: invalid retry backoff '%s' (expected 0-%g seconds)\n",
+                        argv[i], RETRY_MAX_BACKOFF);
+                return 1;
+            }
+            retry_tuned = true;
+        } else if (strcmp(argv[i], "--journal") == 0 && i + 1 < argc) {
+            opts.journal_file = argv[++i];
+        } else if ((strcmp(argv[i], "--setup") == 0 || strcmp(argv[i], "--teardown") == 0) &&
+                   i + 1 < argc) {
+            if (hook_spec_count == 2 * RUNNER_MAX_HOOKS) {
+                fprintf(stderr, "Error: too many --setup/--teardown options (max %d)\n",
+                        2 * RUNNER_MAX_HOOKS);
+                return 1;
+            }
+            hook_is_setup[hook_spec_count] = strcmp(argv[i], "--setup") == 0;
+            hook_specs[hook_spec_count++] = argv[++i];
+        } else {
+            fprintf(stderr, "Error: unknown run option '%s'\n", argv[i]);
+            return 1;
+        }
+    }
+    if (adaptive_tuned && !adaptive) {
+        fprintf(stderr, "Error: --confidence, --max-runs, --top, --metric and --minimize "
+                        "require --adaptive\n");
+        return 1;
+    }
+    if (hook_spec_count > 0 && (opts.jobs > 1 || opts.auto_jobs)) {
+        fprintf(stderr, "Error: --setup/--teardown require sequential runs (-j 1)\n");
+        return 1;
+    }
+    if (log_tuned && !logcap_enabled(&log_opts)) {
+        fprintf(stderr, "Error: --log-max-bytes and --log-ring require --log-dir or --log-metric\n");
+        return 1;
+    }
+    if (log_opts.dir && mkdir(log_opts.dir, 0777) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Error: cannot create log directory %s: %s\n", log_opts.dir, strerror(errno));
+        return 1;
+    }
+    if (logcap_enabled(&log_opts)) opts.log = &log_opts;
+    if (retry_tuned && retry.max_retries == 0) {
+        fprintf(stderr, "Error: --retry-on and --retry-backoff require --retries N\n");
+        return 1;
+    }
+    if (retry.max_retries > 0) opts.retry = &retry;
+    
+    char error[TAGUCHI_ERROR_SIZE];
+
+    /* Resolve perf counters once, before any run starts, so every row of the
+     * results file carries the same columns */
+    PerfCounterSet perf;
+    if (perf_list) {
+        if (perf_parse_list(perf_list, &perf, error) != 0) {
+            fprintf(stderr, "Error: %s\n", error);
+            return 1;
+        }
+        if (perf_resolve(&perf) > 0) {
+            opts.perf = &perf;
+        } else {
+            fprintf(stderr, "Warning: no perf counters available; continuing without them\n");
+        }
+        if (!opts.results_file) {
+            fprintf(stderr, "Warning: --perf-counters without --results; counters will not be recorded\n");
+        }
+    }
     
     // Read the .tgu file
-    char *content = read_file_dynamic(tgu_file);
+    char *content = read_file_dynamic(tgu_file, stderr);
     if (!content) return 1;
 
     // Parse the definition
-    char error[TAGUCHI_ERROR_SIZE];
     taguchi_experiment_def_t *def = taguchi_parse_definition(content, error);
     free(content);
     if (!def) {
         fprintf(stderr, "Error parsing .tgu file %s: %s\n", tgu_file, error);
         return 1;
     }
+
+    RunnerHook hooks[RUNNER_MAX_HOOKS];
+    if (resolve_run_hooks(def, hook_specs, hook_is_setup, hook_spec_count, hooks,
+                          &opts.hook_count) != 0) {
+        taguchi_free_definition(def);
+        return 1;
+    }
+    opts.hooks = hooks;
     
     // Generate runs
     taguchi_experiment_run_t **runs = NULL;
@@ -234,316 +599,204 @@ static int cmd_run(int argc, char *argv[]) {
         taguchi_free_definition(def);
         return 1;
     }
-    
-    // Execute each run as a separate process
-    printf("Executing %zu experiment runs using '%s'...\n", count, script);
-    
-    for (size_t i = 0; i < count; i++) {
-        pid_t pid = fork();
-        
-        if (pid == 0) {
-            // Child process: set environment variables and run the script
-
-            // Set run ID as environment variable
-            char run_id_str[64];
-            snprintf(run_id_str, sizeof(run_id_str), "%zu", taguchi_run_get_id(runs[i]));
-            setenv("TAGUCHI_RUN_ID", run_id_str, 1);
-
-            // Set environment variables for each factor-value pair
-            size_t factor_count = taguchi_run_get_factor_count(runs[i]);
-            for (size_t f = 0; f < factor_count; f++) {
-                const char *factor_name = taguchi_run_get_factor_name_at_index(runs[i], f);
-                const char *factor_value = taguchi_run_get_value(runs[i], factor_name);
 
-                if (factor_name && factor_value) {
-                    /* Reject factor names containing '=' — would corrupt the env block */
-                    if (strchr(factor_name, '=') != NULL) {
-                        fprintf(stderr, "Error: factor name '%s' contains invalid character '='\n", factor_name);
-                        exit(1);
-                    }
-                    char env_name[256];
-                    int nw = snprintf(env_name, sizeof(env_name), "TAGUCHI_%s", factor_name);
-                    if (nw < 0 || nw >= (int)sizeof(env_name)) {
-                        fprintf(stderr, "Error: factor name too long for environment variable\n");
-                        exit(1);
-                    }
-                    setenv(env_name, factor_value, 1);
-                }
-            }
-
-            // Execute the script
-            execl("/bin/sh", "sh", "-c", script, (char *)NULL);
-            
-            // If execl returns, it failed
-            perror("exec failed");
-            exit(1);
-        } else if (pid > 0) {
-            // Parent process: wait for child process
-            int status;
-            waitpid(pid, &status, 0);
-            
-            if (WIFEXITED(status)) {
-                int exit_code = WEXITSTATUS(status);
-                printf("Run %zu completed with exit code %d\n", taguchi_run_get_id(runs[i]), exit_code);
-            } else {
-                printf("Run %zu terminated abnormally\n", taguchi_run_get_id(runs[i]));
-            }
-        } else {
-            // Fork failed
-            perror("fork failed");
+    /* Order runs so hard-to-change factors change level rarely; by default
+     * only when some factor declares a changeover cost */
+    bool any_cost = false;
+    for (size_t f = 0; f < taguchi_def_get_factor_count(def); f++) {
+        if (taguchi_def_get_changeover_cost(def, f) > 0.0) any_cost = true;
+    }
+    taguchi_experiment_run_t **ordered = malloc(count * sizeof(*ordered));
+    size_t *order = malloc(count * sizeof(*order));
+    if (!ordered || !order) {
+        fprintf(stderr, "Error: out of memory\n");
+        free(ordered);
+        free(order);
+        taguchi_free_runs(runs, count);
+        taguchi_free_definition(def);
+        return 1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    if (order_mode ? strcmp(order_mode, "changeover") == 0 : any_cost) {
+        double cost, array_cost;
+        if (taguchi_plan_run_order(def, order, count, &cost, &array_cost, error) != 0) {
+            fprintf(stderr, "Error planning run order: %s\n", error);
+            free(ordered);
+            free(order);
             taguchi_free_runs(runs, count);
             taguchi_free_definition(def);
             return 1;
         }
+        printf("Run order: changeover cost %g (array order %g)\n", cost, array_cost);
+    }
+    for (size_t i = 0; i < count; i++) {
+        ordered[i] = runs[order[i]];
     }
+    free(order);
+    
+    // Execute each run as a separate process
+    printf("Executing %zu experiment runs using '%s'...\n", count, script);
+
+    int rc = adaptive ? adaptive_execute(def, ordered, count, &opts, &adaptive_opts)
+                      : runner_execute(ordered, count, &opts);
     
     // Cleanup
+    free(ordered);
     taguchi_free_runs(runs, count);
     taguchi_free_definition(def);
     
+    if (rc != 0) return 1;
     printf("All experiment runs completed.\n");
     return 0;
 }
 
-/* Helper: read a file into a dynamically allocated buffer. Caller must free(). */
-static char *read_file_dynamic(const char *filename) {
-    FILE *file = fopen(filename, "r");
-    if (!file) {
-        perror("Error opening file");
-        return NULL;
-    }
-    if (fseek(file, 0, SEEK_END) != 0) {
-        perror("Error seeking in file");
-        fclose(file);
-        return NULL;
-    }
-    long sz = ftell(file);
-    if (sz < 0) {
-        perror("Error getting file size");
-        fclose(file);
-        return NULL;
-    }
-    rewind(file);
-    char *buf = malloc((size_t)sz + 1);
-    if (!buf) {
-        fprintf(stderr, "Error: out of memory\n");
-        fclose(file);
-        return NULL;
-    }
-    size_t n = fread(buf, 1, (size_t)sz, file);
-    fclose(file);
-    buf[n] = '\0';
-    return buf;
-}
-
-/* Split a CSV line in-place into field pointers. Returns field count.
- * Replaces commas with NUL bytes; max_fields caps the result. */
-static int csv_split(char *line, char **fields, int max_fields) {
-    int n = 0;
-    char *p = line;
-    while (n < max_fields) {
-        fields[n++] = p;
-        p = strchr(p, ',');
-        if (!p) break;
-        *p++ = '\0';
-    }
-    return n;
-}
-
-/* Trim leading/trailing ASCII spaces and tabs in-place.
- * Returns the new start pointer (may differ from s). */
-static char *csv_trim(char *s) {
-    while (*s == ' ' || *s == '\t') s++;
-    size_t len = strlen(s);
-    while (len > 0 && (s[len-1] == ' ' || s[len-1] == '\t')) s[--len] = '\0';
-    return s;
-}
+#define MAX_WHERE 16
 
 /*
- * Parse a CSV results file.
- *
- * The file may have any number of columns.  If the first non-comment,
- * non-empty row is a header (its first field is not a plain integer), the
- * column whose name matches metric_name is used as the response value.
- * When no header is present the second column (index 1) is used.
- *
- * Lines starting with '#' are treated as comments.
+ * Main effects over every run, or with --where conditions over the runs
+ * meeting all of them ("factor=v1,v2" holds for any listed value).  The
+ * runs are sliced with the run index, so nothing is regenerated.
  */
-static int parse_csv_results(const char *filename, const char *metric_name,
-                              taguchi_result_set_t *results, char *error_buf) {
-    FILE *file = fopen(filename, "r");
-    if (!file) {
-        snprintf(error_buf, TAGUCHI_ERROR_SIZE, "Cannot open results file: %s", filename);
-        return -1;
+static int calculate_effects(const taguchi_experiment_def_t *def,
+                             const taguchi_result_set_t *results, const char **wheres,
+                             size_t where_count, taguchi_main_effect_t ***effects_out,
+                             size_t *count_out, size_t *selected_out, size_t *total_out,
+                             char *error) {
+    if (where_count == 0) {
+        return taguchi_calculate_main_effects(results, effects_out, count_out, error);
     }
-
-    char line[4096];
-    int line_num = 0;
-    int data_lines = 0;
-    int metric_col = -1;   /* column index for the response value; -1 = not yet resolved */
-    bool header_seen = false;
-
-    while (fgets(line, sizeof(line), file)) {
-        line_num++;
-        /* Detect truncated lines — buffer full with no newline means line exceeded limit */
-        size_t len = strlen(line);
-        if (len == sizeof(line) - 1 && line[len - 1] != '\n') {
-            snprintf(error_buf, TAGUCHI_ERROR_SIZE,
-                     "Line %d exceeds maximum length (%zu chars)", line_num, sizeof(line) - 2);
-            fclose(file);
-            return -1;
+    taguchi_run_index_t *index = taguchi_run_index_create(def, error);
+    if (!index) return -1;
+
+    int rc = -1;
+    size_t words = taguchi_run_index_words(index);
+    uint64_t *subset = malloc((words + 1) * sizeof(uint64_t));
+    uint64_t *match = malloc((words + 1) * sizeof(uint64_t));
+    uint64_t *value_bits = malloc((words + 1) * sizeof(uint64_t));
+    if (!subset || !match || !value_bits) {
+        snprintf(error, TAGUCHI_ERROR_SIZE, "out of memory");
+        goto done;
+    }
+    memset(subset, 0xff, words * sizeof(uint64_t));
+
+    for (size_t w = 0; w < where_count; w++) {
+        char spec[512];
+        const char *eq = strchr(wheres[w], '=');
+        if (!eq || eq == wheres[w] || eq[1] == '\0' || strlen(wheres[w]) >= sizeof(spec)) {
+            snprintf(error, TAGUCHI_ERROR_SIZE,
+                     "--where expects factor=value[,value...], got '%s'", wheres[w]);
+            goto done;
         }
-        /* Trim trailing newline/CR */
-        while (len > 0 && (line[len-1] == '\n' || line[len-1] == '\r')) {
-            line[--len] = '\0';
+        strcpy(spec, wheres[w]);
+        spec[eq - wheres[w]] = '\0';
+        memset(match, 0, words * sizeof(uint64_t));
+        char *save = NULL;
+        for (char *value = strtok_r(spec + (eq - wheres[w]) + 1, ",", &save); value;
+             value = strtok_r(NULL, ",", &save)) {
+            if (taguchi_run_index_select(index, spec, value, value_bits, error) != 0) goto done;
+            taguchi_bitset_or(match, value_bits, words);
         }
+        taguchi_bitset_and(subset, match, words);
+    }
 
-        /* Skip empty lines and comments */
-        if (len == 0 || line[0] == '#') continue;
-
-        if (!header_seen) {
-            header_seen = true;
-
-            /* Decide if this row is a header by checking whether its first
-             * comma-delimited field parses as a plain integer. */
-            char tmp[4096];
-            strncpy(tmp, line, sizeof(tmp) - 1);
-            tmp[sizeof(tmp) - 1] = '\0';
+    *selected_out = taguchi_bitset_count(subset, words);
+    *total_out = taguchi_run_index_run_count(index);
+    rc = taguchi_calculate_conditional_effects(results, index, subset, effects_out, count_out,
+                                               error);
+
+done:
+    free(subset);
+    free(match);
+    free(value_bits);
+    taguchi_run_index_free(index);
+    return rc;
+}
 
-            char *hfields[512];
-            int nhf = csv_split(tmp, hfields, 512);
+/* "Given" line of a conditional analysis */
+static void print_where(const char **wheres, size_t where_count, size_t selected, size_t total) {
+    if (where_count == 0) return;
+    printf("Given ");
+    for (size_t w = 0; w < where_count; w++) {
+        printf("%s%s", w > 0 ? " and " : "", wheres[w]);
+    }
+    printf(" (%zu of %zu runs)\n", selected, total);
+}
 
-            char *endptr;
-            strtol(csv_trim(hfields[0]), &endptr, 10);
-            bool is_header = (*endptr != '\0'); /* non-numeric first field → header */
-
-            if (is_header) {
-                /* Locate the column whose name matches metric_name */
-                for (int col = 0; col < nhf; col++) {
-                    if (strcmp(csv_trim(hfields[col]), metric_name) == 0) {
-                        metric_col = col;
-                        break;
-                    }
-                }
+/* One row per factor; levels a conditional analysis saw no runs of show '-' */
+static void print_effects_rows(const taguchi_main_effect_t **effects, size_t effect_count) {
+    for (size_t i = 0; i < effect_count; i++) {
+        const char *name = taguchi_effect_get_factor(effects[i]);
+        double range = taguchi_effect_get_range(effects[i]);
+        size_t level_count = 0;
+        const double *means = taguchi_effect_get_level_means(effects[i], &level_count);
 
-                if (metric_col == -1) {
-                    if (strcmp(metric_name, "response") == 0) {
-                        /* Default metric not present in header — fall back to col 1 */
-                        metric_col = 1;
-                    } else {
-                        snprintf(error_buf, TAGUCHI_ERROR_SIZE,
-                                 "Metric '%s' not found in CSV header", metric_name);
-                        fclose(file);
-                        return -1;
-                    }
-                }
-                continue; /* header consumed; proceed to data rows */
+        printf("%-20s %8.3f   ", name, range);
+        for (size_t lv = 0; lv < level_count; lv++) {
+            if (lv > 0) printf(", ");
+            if (isnan(means[lv])) {
+                printf("L%zu=-", lv + 1);
             } else {
-                /* No header row */
-                if (strcmp(metric_name, "response") != 0) {
-                    snprintf(error_buf, TAGUCHI_ERROR_SIZE,
-                             "No header row in '%s'; cannot locate metric '%s'",
-                             filename, metric_name);
-                    fclose(file);
-                    return -1;
-                }
-                metric_col = 1;
-                /* Fall through — parse this line as the first data row */
+                printf("L%zu=%.3f", lv + 1, means[lv]);
             }
         }
-
-        /* --- Data row --- */
-        char row[4096];
-        strncpy(row, line, sizeof(row) - 1);
-        row[sizeof(row) - 1] = '\0';
-
-        char *fields[512];
-        int nf = csv_split(row, fields, 512);
-
-        if (nf <= metric_col) {
-            snprintf(error_buf, TAGUCHI_ERROR_SIZE,
-                     "Row at line %d has %d column(s); metric '%s' is at column %d",
-                     line_num, nf, metric_name, metric_col + 1);
-            fclose(file);
-            return -1;
-        }
-
-        char *endptr;
-        long run_id = strtol(csv_trim(fields[0]), &endptr, 10);
-        if (*endptr != '\0' || run_id < 1) {
-            snprintf(error_buf, TAGUCHI_ERROR_SIZE, "Invalid run_id at line %d", line_num);
-            fclose(file);
-            return -1;
-        }
-
-        char *val_str = csv_trim(fields[metric_col]);
-        /* Skip rows where the metric value is absent (missing data) */
-        if (val_str[0] == '\0') continue;
-
-        double response = strtod(val_str, &endptr);
-        if (*endptr != '\0') {
-            snprintf(error_buf, TAGUCHI_ERROR_SIZE,
-                     "Invalid value for metric '%s' at line %d: '%s'",
-                     metric_name, line_num, val_str);
-            fclose(file);
-            return -1;
-        }
-
-        if (taguchi_add_result(results, (size_t)run_id, response, error_buf) != 0) {
-            fclose(file);
-            return -1;
-        }
-        data_lines++;
-    }
-
-    fclose(file);
-
-    if (data_lines == 0) {
-        snprintf(error_buf, TAGUCHI_ERROR_SIZE, "No data rows found in %s", filename);
-        return -1;
+        printf("\n");
     }
-
-    return 0;
 }
 
 static int cmd_effects(int argc, char *argv[]) {
     if (argc < 3) {
         fprintf(stderr, "Error: effects command requires .tgu file and results CSV\n");
-        fprintf(stderr, "Usage: effects <file.tgu> <results.csv> [--metric name]\n");
+        fprintf(stderr, "Usage: effects <file.tgu> <results.csv> [--metric name] "
+                        "[--where factor=value[,value]]...\n");
         return 1;
     }
 
     const char *tgu_file = argv[1];
     const char *csv_file = argv[2];
     const char *metric_name = "response";
+    const char *wheres[MAX_WHERE];
+    size_t where_count = 0;
 
-    /* Parse optional --metric flag */
-    for (int i = 3; i < argc - 1; i++) {
-        if (strcmp(argv[i], "--metric") == 0) {
-            metric_name = argv[i + 1];
-            break;
+    /* Parse optional flags */
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--metric") == 0 && i + 1 < argc) {
+            metric_name = argv[++i];
+        } else if (strcmp(argv[i], "--where") == 0 && i + 1 < argc) {
+            if (where_count >= MAX_WHERE) {
+                fprintf(stderr, "Error: too many --where conditions (max %d)\n", MAX_WHERE);
+                return 1;
+            }
+            wheres[where_count++] = argv[++i];
         }
     }
 
-    char *content = read_file_dynamic(tgu_file);
-    if (!content) return 1;
+    char *content = NULL, *csv_text = NULL;
+    if (load_definition_and_results(tgu_file, csv_file, &content, &csv_text, stderr) != 0) {
+        return 1;
+    }
 
     char error[TAGUCHI_ERROR_SIZE];
     taguchi_experiment_def_t *def = taguchi_parse_definition(content, error);
     free(content);
     if (!def) {
         fprintf(stderr, "Error parsing %s: %s\n", tgu_file, error);
+        free(csv_text);
         return 1;
     }
 
     taguchi_result_set_t *results = taguchi_create_result_set(def, metric_name);
     if (!results) {
         fprintf(stderr, "Error creating result set\n");
+        free(csv_text);
         taguchi_free_definition(def);
         return 1;
     }
 
-    if (parse_csv_results(csv_file, metric_name, results, error) != 0) {
+    int parsed = parse_csv_results(csv_text, csv_file, metric_name, results, error);
+    free(csv_text);
+    if (parsed != 0) {
         fprintf(stderr, "Error reading results: %s\n", error);
         taguchi_free_result_set(results);
         taguchi_free_definition(def);
@@ -552,7 +805,9 @@ static int cmd_effects(int argc, char *argv[]) {
 
     taguchi_main_effect_t **effects = NULL;
     size_t effect_count = 0;
-    if (taguchi_calculate_main_effects(results, &effects, &effect_count, error) != 0) {
+    size_t selected = 0, total = 0;
+    if (calculate_effects(def, results, wheres, where_count, &effects, &effect_count, &selected,
+                          &total, error) != 0) {
         fprintf(stderr, "Error calculating effects: %s\n", error);
         taguchi_free_result_set(results);
         taguchi_free_definition(def);
@@ -561,22 +816,11 @@ static int cmd_effects(int argc, char *argv[]) {
 
     /* Print main effects table */
     printf("Main Effects for metric: %s\n", metric_name);
+    print_where(wheres, where_count, selected, total);
     printf("%-20s %8s   Level Means\n", "Factor", "Range");
     printf("%-20s %8s   -----------\n", "------", "-----");
 
-    for (size_t i = 0; i < effect_count; i++) {
-        const char *name = taguchi_effect_get_factor(effects[i]);
-        double range = taguchi_effect_get_range(effects[i]);
-        size_t level_count = 0;
-        const double *means = taguchi_effect_get_level_means(effects[i], &level_count);
-
-        printf("%-20s %8.3f   ", name, range);
-        for (size_t lv = 0; lv < level_count; lv++) {
-            if (lv > 0) printf(", ");
-            printf("L%zu=%.3f", lv + 1, means[lv]);
-        }
-        printf("\n");
-    }
+    print_effects_rows((const taguchi_main_effect_t **)effects, effect_count);
 
     taguchi_free_effects(effects, effect_count);
     taguchi_free_result_set(results);
@@ -584,10 +828,85 @@ static int cmd_effects(int argc, char *argv[]) {
     return 0;
 }
 
+/* Split-plot ANOVA table: each factor tested against its stratum's error */
+static int print_split_plot_anova(const taguchi_result_set_t *results, FILE *out, char *error) {
+    taguchi_anova_row_t *rows = NULL;
+    size_t count = 0;
+    if (taguchi_split_plot_anova(results, &rows, &count, error) != 0) {
+        return -1;
+    }
+
+    fprintf(out, "\nSplit-Plot ANOVA:\n");
+    fprintf(out, "%-20s %-6s %12s %4s %12s %9s %8s\n",
+            "Source", "Plot", "SS", "df", "MS", "F", "p");
+    for (size_t i = 0; i < count; i++) {
+        const taguchi_anova_row_t *row = &rows[i];
+        const char *stratum = row->stratum == TAGUCHI_STRATUM_WHOLE_PLOT ? "whole" : "sub";
+        fprintf(out, "%-20s %-6s %12.4f %4zu ", row->source, stratum, row->sum_squares, row->df);
+        if (row->df > 0) {
+            fprintf(out, "%12.4f", row->mean_square);
+        } else {
+            fprintf(out, "%12s", "-");
+        }
+        if (!row->is_error && !isnan(row->f_ratio)) {
+            fprintf(out, " %9.3f %8.4f\n", row->f_ratio, row->p_value);
+        } else {
+            fprintf(out, " %9s %8s\n", "-", "-");
+        }
+        if (row->is_error && row->df == 0) {
+            fprintf(out, "  (no %s-plot error df: add whole plots or replicates to test these factors)\n",
+                    stratum);
+        }
+    }
+    taguchi_free_anova(rows);
+    return 0;
+}
+
+/* Share of a factor's between-level sum of squares, or '-' */
+static void print_share(double share) {
+    if (isnan(share)) {
+        printf(" %7s", "-");
+    } else {
+        printf(" %6.1f%%", 100.0 * share);
+    }
+}
+
+/* Polynomial contrasts and interpolated optimum of every numeric factor */
+static int print_response_curves(const taguchi_result_set_t *results, bool higher_is_better,
+                                 size_t degree, char *error) {
+    taguchi_curve_options_t opts;
+    taguchi_curve_options_init(&opts);
+    opts.higher_is_better = higher_is_better;
+    opts.degree = degree;
+    taguchi_response_curve_t *curves = NULL;
+    size_t count = 0;
+    if (taguchi_fit_response_curves(results, &opts, &curves, &count, error) != 0) {
+        return -1;
+    }
+    if (count > 0) {
+        printf("\nResponse Curves (numeric factors, degree %zu fit):\n", degree);
+        printf("%-20s %7s %7s %7s %7s  %12s %10s  %s\n", "Factor", "Linear", "Quad", "Cubic",
+               "Fit", "Optimum", "Predicted", "Best tested");
+        for (size_t i = 0; i < count; i++) {
+            const taguchi_response_curve_t *c = &curves[i];
+            printf("%-20s", c->factor);
+            for (size_t k = 0; k < 3; k++) {
+                print_share(c->contrast_share[k]);
+            }
+            print_share(c->fit_share);
+            printf("  %12g %10.3f  L%zu=%.3f%s\n", c->optimum, c->predicted, c->best_level + 1,
+                   c->best_level_mean, c->interior ? "" : " (optimum at range end)");
+        }
+    }
+    taguchi_free_response_curves(curves);
+    return 0;
+}
+
 static int cmd_analyze(int argc, char *argv[]) {
     if (argc < 3) {
         fprintf(stderr, "Error: analyze command requires .tgu file and results CSV\n");
-        fprintf(stderr, "Usage: analyze <file.tgu> <results.csv> [--metric name] [--minimize]\n");
+        fprintf(stderr, "Usage: analyze <file.tgu> <results.csv> [--metric name] [--minimize] "
+                        "[--degree 1-3] [--where factor=value[,value]]...\n");
         return 1;
     }
 
@@ -595,6 +914,9 @@ static int cmd_analyze(int argc, char *argv[]) {
     const char *csv_file = argv[2];
     const char *metric_name = "response";
     bool higher_is_better = true;
+    size_t degree = 2;
+    const char *wheres[MAX_WHERE];
+    size_t where_count = 0;
 
     /* Parse optional flags */
     for (int i = 3; i < argc; i++) {
@@ -602,28 +924,47 @@ static int cmd_analyze(int argc, char *argv[]) {
             metric_name = argv[++i];
         } else if (strcmp(argv[i], "--minimize") == 0) {
             higher_is_better = false;
+        } else if (strcmp(argv[i], "--degree") == 0 && i + 1 < argc) {
+            const char *arg = argv[++i];
+            if (strlen(arg) != 1 || arg[0] < '1' || arg[0] > '3') {
+                fprintf(stderr, "Error: invalid value '%s' for --degree (1 to 3)\n", arg);
+                return 1;
+            }
+            degree = (size_t)(arg[0] - '0');
+        } else if (strcmp(argv[i], "--where") == 0 && i + 1 < argc) {
+            if (where_count >= MAX_WHERE) {
+                fprintf(stderr, "Error: too many --where conditions (max %d)\n", MAX_WHERE);
+                return 1;
+            }
+            wheres[where_count++] = argv[++i];
         }
     }
 
-    char *content = read_file_dynamic(tgu_file);
-    if (!content) return 1;
+    char *content = NULL, *csv_text = NULL;
+    if (load_definition_and_results(tgu_file, csv_file, &content, &csv_text, stderr) != 0) {
+        return 1;
+    }
 
     char error[TAGUCHI_ERROR_SIZE];
     taguchi_experiment_def_t *def = taguchi_parse_definition(content, error);
     free(content);
     if (!def) {
         fprintf(stderr, "Error parsing %s: %s\n", tgu_file, error);
+        free(csv_text);
         return 1;
     }
 
     taguchi_result_set_t *results = taguchi_create_result_set(def, metric_name);
     if (!results) {
         fprintf(stderr, "Error creating result set\n");
+        free(csv_text);
         taguchi_free_definition(def);
         return 1;
     }
 
-    if (parse_csv_results(csv_file, metric_name, results, error) != 0) {
+    int parsed = parse_csv_results(csv_text, csv_file, metric_name, results, error);
+    free(csv_text);
+    if (parsed != 0) {
         fprintf(stderr, "Error reading results: %s\n", error);
         taguchi_free_result_set(results);
         taguchi_free_definition(def);
@@ -632,7 +973,9 @@ static int cmd_analyze(int argc, char *argv[]) {
 
     taguchi_main_effect_t **effects = NULL;
     size_t effect_count = 0;
-    if (taguchi_calculate_main_effects(results, &effects, &effect_count, error) != 0) {
+    size_t selected = 0, total = 0;
+    if (calculate_effects(def, results, wheres, where_count, &effects, &effect_count, &selected,
+                          &total, error) != 0) {
         fprintf(stderr, "Error calculating effects: %s\n", error);
         taguchi_free_result_set(results);
         taguchi_free_definition(def);
@@ -640,25 +983,24 @@ static int cmd_analyze(int argc, char *argv[]) {
     }
 
     /* Print effects summary */
-    printf("Analysis for metric: %s (%s)\n\n",
+    printf("Analysis for metric: %s (%s)\n",
            metric_name, higher_is_better ? "maximizing" : "minimizing");
+    print_where(wheres, where_count, selected, total);
+    printf("\n");
 
     printf("Main Effects:\n");
     printf("%-20s %8s   Level Means\n", "Factor", "Range");
     printf("%-20s %8s   -----------\n", "------", "-----");
 
-    for (size_t i = 0; i < effect_count; i++) {
-        const char *name = taguchi_effect_get_factor(effects[i]);
-        double range = taguchi_effect_get_range(effects[i]);
-        size_t level_count = 0;
-        const double *means = taguchi_effect_get_level_means(effects[i], &level_count);
+    print_effects_rows((const taguchi_main_effect_t **)effects, effect_count);
 
-        printf("%-20s %8.3f   ", name, range);
-        for (size_t lv = 0; lv < level_count; lv++) {
-            if (lv > 0) printf(", ");
-            printf("L%zu=%.3f", lv + 1, means[lv]);
-        }
-        printf("\n");
+    if (taguchi_def_is_split_plot(def) && print_split_plot_anova(results, stdout, error) != 0) {
+        fprintf(stderr, "Warning: split-plot ANOVA unavailable: %s\n", error);
+    }
+
+    /* Curves interpolate between all tested levels, so only unconditioned */
+    if (where_count == 0 && print_response_curves(results, higher_is_better, degree, error) != 0) {
+        fprintf(stderr, "Warning: response curves unavailable: %s\n", error);
     }
 
     /* Print recommendation */
@@ -680,11 +1022,42 @@ int main(int argc, char *argv[]) {
         return 1;
     }
     
-    const char *command = argv[1];
+    /* Global options: design cache (TAGUCHI_CACHE_DIR) and pool size */
+    const char *cache_dir = getenv("TAGUCHI_CACHE_DIR");
+    int first = 1;
+    while (first + 1 < argc) {
+        if (strcmp(argv[first], "--cache-dir") == 0) {
+            cache_dir = argv[first + 1];
+        } else if (strcmp(argv[first], "--max-workers") == 0) {
+            char *endptr;
+            long n = strtol(argv[first + 1], &endptr, 10);
+            if (*endptr != '\0' || n < 1) {
+                fprintf(stderr, "Error: invalid worker count '%s'\n", argv[first + 1]);
+                return 1;
+            }
+            taguchi_context_set_max_workers(NULL, (size_t)n);
+        } else {
+            break;
+        }
+        first += 2;
+    }
+    if (first >= argc) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (cache_dir && cache_dir[0] != '\0') {
+        char error[TAGUCHI_ERROR_SIZE];
+        if (taguchi_set_design_cache_dir(cache_dir, error) != 0) {
+            fprintf(stderr, "Error: %s\n", error);
+            return 1;
+        }
+    }
+
+    const char *command = argv[first];
     
     // Shift arguments for command handlers
-    int sub_argc = argc - 1;
-    char **sub_argv = argv + 1;
+    int sub_argc = argc - first;
+    char **sub_argv = argv + first;
     
     if (strcmp(command, "--help") == 0 || strcmp(command, "-h") == 0) {
         print_usage(argv[0]);
@@ -704,6 +1077,14 @@ int main(int argc, char *argv[]) {
         return cmd_validate(sub_argc, sub_argv);
     } else if (strcmp(command, "suggest-array") == 0) {
         return cmd_suggest_array(sub_argc, sub_argv);
+    } else if (strcmp(command, "simulate") == 0) {
+        return cmd_simulate(sub_argc, sub_argv);
+    } else if (strcmp(command, "batch") == 0) {
+        return cmd_batch(sub_argc, sub_argv);
+    } else if (strcmp(command, "compare") == 0) {
+        return cmd_compare(sub_argc, sub_argv);
+    } else if (strcmp(command, "history") == 0) {
+        return cmd_history(sub_argc, sub_argv);
     } else if (strcmp(command, "run") == 0) {
         return cmd_run(sub_argc, sub_argv);
     } else if (strcmp(command, "analyze") == 0) {
@@ -0,0 +1,217 @@
+#define _GNU_SOURCE
+#include "perfcount.h"
+#include "include/taguchi.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+/* Known event names, their perf encoding and software fallback (NULL = none) */
+typedef struct {
+    const char *name;
+    uint32_t type;
+    uint64_t config;
+    const char *fallback;
+} PerfEventInfo;
+
+#ifdef __linux__
+static const PerfEventInfo known_events[] = {
+    { "cycles",           PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES,          "cpu-clock" },
+    { "instructions",     PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS,        "task-clock" },
+    { "cache-references", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES,    "minor-faults" },
+    { "cache-misses",     PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES,        "major-faults" },
+    { "branches",         PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS, NULL },
+    { "branch-misses",    PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES,       NULL },
+    { "bus-cycles",       PERF_TYPE_HARDWARE, PERF_COUNT_HW_BUS_CYCLES,          NULL },
+    { "ref-cycles",       PERF_TYPE_HARDWARE, PERF_COUNT_HW_REF_CPU_CYCLES,      "cpu-clock" },
+    { "cpu-clock",        PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_CLOCK,           NULL },
+    { "task-clock",       PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK,          NULL },
+    { "page-faults",      PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS,         NULL },
+    { "minor-faults",     PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MIN,     NULL },
+    { "major-faults",     PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MAJ,     NULL },
+    { "context-switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES,    NULL },
+    { "cpu-migrations",   PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS,      NULL },
+};
+#define KNOWN_EVENT_COUNT (sizeof(known_events) / sizeof(known_events[0]))
+
+static const PerfEventInfo *find_event(const char *name) {
+    for (size_t i = 0; i < KNOWN_EVENT_COUNT; i++) {
+        if (strcmp(known_events[i].name, name) == 0) return &known_events[i];
+    }
+    return NULL;
+}
+
+static int open_counter(const PerfEventSpec *spec, pid_t pid, bool enable_on_exec) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = spec->type;
+    attr.config = spec->config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.enable_on_exec = enable_on_exec ? 1 : 0;
+    /* User-space only: permitted at perf_event_paranoid <= 2 */
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    long fd = syscall(SYS_perf_event_open, &attr, pid, -1, -1, PERF_FLAG_FD_CLOEXEC);
+    return (int)fd;
+}
+
+int perf_parse_list(const char *list, PerfCounterSet *set, char *error_buf) {
+    memset(set, 0, sizeof(*set));
+    const char *p = list;
+    while (*p) {
+        const char *end = strchr(p, ',');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        if (len > 0) {
+            char name[PERF_EVENT_NAME];
+            if (len >= sizeof(name)) {
+                snprintf(error_buf, TAGUCHI_ERROR_SIZE, "Perf event name too long: %.*s", (int)len, p);
+                return -1;
+            }
+            memcpy(name, p, len);
+            name[len] = '\0';
+
+            const PerfEventInfo *info = find_event(name);
+            if (!info) {
+                snprintf(error_buf, TAGUCHI_ERROR_SIZE, "Unknown perf event '%s'", name);
+                return -1;
+            }
+            if (set->count >= PERF_MAX_COUNTERS) {
+                snprintf(error_buf, TAGUCHI_ERROR_SIZE, "Too many perf events (max %d)", PERF_MAX_COUNTERS);
+                return -1;
+            }
+            PerfEventSpec *spec = &set->events[set->count++];
+            strcpy(spec->name, info->name);
+            spec->type = info->type;
+            spec->config = info->config;
+        }
+        if (!end) break;
+        p = end + 1;
+    }
+    if (set->count == 0) {
+        snprintf(error_buf, TAGUCHI_ERROR_SIZE, "No perf events given");
+        return -1;
+    }
+    return 0;
+}
+
+static bool set_contains(const PerfCounterSet *set, size_t upto, const char *name) {
+    for (size_t i = 0; i < upto; i++) {
+        if (strcmp(set->events[i].name, name) == 0) return true;
+    }
+    return false;
+}
+
+size_t perf_resolve(PerfCounterSet *set) {
+    size_t out = 0;
+    for (size_t i = 0; i < set->count; i++) {
+        PerfEventSpec spec = set->events[i];
+        int fd = open_counter(&spec, 0, false);
+        if (fd < 0 && spec.type == PERF_TYPE_HARDWARE) {
+            int saved_errno = errno;
+            const PerfEventInfo *info = find_event(spec.name);
+            const PerfEventInfo *fb = (info && info->fallback) ? find_event(info->fallback) : NULL;
+            if (fb && !set_contains(set, out, fb->name)) {
+                fprintf(stderr, "Warning: hardware counter '%s' unavailable (%s); recording software event '%s' instead\n",
+                        spec.name, strerror(saved_errno), fb->name);
+                strcpy(spec.name, fb->name);
+                spec.type = fb->type;
+                spec.config = fb->config;
+                fd = open_counter(&spec, 0, false);
+            } else {
+                fprintf(stderr, "Warning: hardware counter '%s' unavailable (%s); not recorded\n",
+                        spec.name, strerror(saved_errno));
+                continue;
+            }
+        }
+        if (fd < 0) {
+            fprintf(stderr, "Warning: perf event '%s' unavailable (%s); not recorded\n",
+                    spec.name, strerror(errno));
+            continue;
+        }
+        close(fd);
+        if (set_contains(set, out, spec.name)) continue;
+        set->events[out++] = spec;
+    }
+    set->count = out;
+    return out;
+}
+
+void perf_open_for_child(const PerfCounterSet *set, pid_t child, PerfRunCounters *out) {
+    for (size_t i = 0; i < PERF_MAX_COUNTERS; i++) {
+        out->fds[i] = -1;
+    }
+    for (size_t i = 0; i < set->count; i++) {
+        out->fds[i] = open_counter(&set->events[i], child, true);
+    }
+}
+
+void perf_read_and_close(const PerfCounterSet *set, PerfRunCounters *counters,
+                         uint64_t values[], bool valid[]) {
+    for (size_t i = 0; i < set->count; i++) {
+        valid[i] = false;
+        values[i] = 0;
+        int fd = counters->fds[i];
+        if (fd < 0) continue;
+
+        /* read_format: value, time_enabled, time_running */
+        uint64_t buf[3];
+        ssize_t n = read(fd, buf, sizeof(buf));
+        close(fd);
+        counters->fds[i] = -1;
+        if (n != (ssize_t)sizeof(buf)) continue;
+
+        if (buf[2] == 0) {
+            /* Never scheduled (e.g. run too short to count) */
+            values[i] = buf[0];
+        } else if (buf[2] < buf[1]) {
+            /* Counter was multiplexed: scale to the full enabled time */
+            values[i] = (uint64_t)((double)buf[0] * (double)buf[1] / (double)buf[2]);
+        } else {
+            values[i] = buf[0];
+        }
+        valid[i] = true;
+    }
+}
+
+#else /* !__linux__ */
+
+int perf_parse_list(const char *list, PerfCounterSet *set, char *error_buf) {
+    (void)list;
+    memset(set, 0, sizeof(*set));
+    snprintf(error_buf, TAGUCHI_ERROR_SIZE, "Perf counters are only supported on Linux");
+    return -1;
+}
+
+size_t perf_resolve(PerfCounterSet *set) {
+    set->count = 0;
+    return 0;
+}
+
+void perf_open_for_child(const PerfCounterSet *set, pid_t child, PerfRunCounters *out) {
+    (void)set;
+    (void)child;
+    for (size_t i = 0; i < PERF_MAX_COUNTERS; i++) {
+        out->fds[i] = -1;
+    }
+}
+
+void perf_read_and_close(const PerfCounterSet *set, PerfRunCounters *counters,
+                         uint64_t values[], bool valid[]) {
+    (void)counters;
+    for (size_t i = 0; i < set->count; i++) {
+        values[i] = 0;
+        valid[i] = false;
+    }
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,58 @@
+#ifndef PERFCOUNT_H
+#define PERFCOUNT_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/*
+ * Per-run hardware performance counters for `taguchi run --perf-counters`.
+ *
+ * Counters are opened by the parent on the freshly forked child (before it
+ * execs), inherited by everything the child spawns, enabled on exec and read
+ * once the child has been reaped.  When hardware events are not permitted
+ * (perf_event_paranoid, containers, VMs without a PMU) each event degrades to
+ * a software event where a sensible one exists, or is dropped with a warning.
+ */
+
+#define PERF_MAX_COUNTERS 8
+#define PERF_EVENT_NAME 32
+
+typedef struct {
+    char name[PERF_EVENT_NAME];  /* Metric/column name as recorded */
+    uint32_t type;               /* PERF_TYPE_* */
+    uint64_t config;             /* PERF_COUNT_* */
+} PerfEventSpec;
+
+typedef struct {
+    PerfEventSpec events[PERF_MAX_COUNTERS];
+    size_t count;
+} PerfCounterSet;
+
+typedef struct {
+    int fds[PERF_MAX_COUNTERS];  /* -1 for events that failed to open */
+} PerfRunCounters;
+
+/* Parse a comma-separated event list ("cycles,instructions,...");
+ * error_buf must hold TAGUCHI_ERROR_SIZE bytes */
+int perf_parse_list(const char *list, PerfCounterSet *set, char *error_buf);
+
+/*
+ * Probe every event on the calling process and substitute software
+ * fallbacks for hardware events that cannot be opened.  Warnings are
+ * printed to stderr.  Returns the number of usable events.
+ */
+size_t perf_resolve(PerfCounterSet *set);
+
+/* Attach counters to a stopped/blocked child before it execs */
+void perf_open_for_child(const PerfCounterSet *set, pid_t child, PerfRunCounters *out);
+
+/*
+ * Read final totals (scaled for multiplexing) and close the descriptors.
+ * valid[i] is false when event i could not be counted for this run.
+ */
+void perf_read_and_close(const PerfCounterSet *set, PerfRunCounters *counters,
+                         uint64_t values[], bool valid[]);
+
+#endif /* PERFCOUNT_H */
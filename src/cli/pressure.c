@@ -0,0 +1,98 @@
+#define _GNU_SOURCE
+#include "pressure.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* "some avg10=1.23 avg60=..." line of a pressure file; returns -1 if unreadable */
+static int read_psi_some(const char *proc_root, const char *resource, double *avg10) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/pressure/%s", proc_root, resource);
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+
+    int rc = -1;
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "some avg10=%lf", avg10) == 1) {
+            rc = 0;
+            break;
+        }
+    }
+    fclose(f);
+    return rc;
+}
+
+/* MemAvailable / MemTotal from meminfo; -1 if unreadable */
+static double read_mem_available(const char *proc_root) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/meminfo", proc_root);
+    FILE *f = fopen(path, "r");
+    if (!f) return -1.0;
+
+    unsigned long long total = 0, available = 0, value;
+    bool have_available = false;
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "MemTotal: %llu", &value) == 1) {
+            total = value;
+        } else if (sscanf(line, "MemAvailable: %llu", &value) == 1) {
+            available = value;
+            have_available = true;
+        }
+    }
+    fclose(f);
+    if (total == 0 || !have_available) return -1.0;
+    return (double)available / (double)total;
+}
+
+int pressure_sample(const char *proc_root, PressureSample *out) {
+    memset(out, 0, sizeof(*out));
+    if (!proc_root) proc_root = "/proc";
+
+    out->psi = read_psi_some(proc_root, "cpu", &out->cpu_some) == 0;
+    if (out->psi) {
+        /* memory and io exist whenever cpu does; a missing one reads as idle */
+        if (read_psi_some(proc_root, "memory", &out->memory_some) != 0) out->memory_some = 0.0;
+        if (read_psi_some(proc_root, "io", &out->io_some) != 0) out->io_some = 0.0;
+    } else {
+        out->cpu_some = 0.0;
+    }
+    out->mem_available = read_mem_available(proc_root);
+    return (out->psi || out->mem_available >= 0.0) ? 0 : -1;
+}
+
+bool pressure_overloaded(const PressureSample *s) {
+    if (s->psi && (s->cpu_some > PRESSURE_CPU_SOME ||
+                   s->memory_some > PRESSURE_MEMORY_SOME ||
+                   s->io_some > PRESSURE_IO_SOME)) {
+        return true;
+    }
+    return s->mem_available >= 0.0 && s->mem_available < PRESSURE_MIN_MEM_AVAILABLE;
+}
+
+void aimd_init(AimdController *c, size_t max) {
+    memset(c, 0, sizeof(*c));
+    c->max = max > 0 ? max : 1;
+    c->limit = 1;
+    c->peak = 1;
+    c->slow_start = true;
+    c->last_decrease = -PRESSURE_DECREASE_INTERVAL;
+}
+
+void aimd_on_finish(AimdController *c, bool overloaded) {
+    if (overloaded || c->limit >= c->max) return;
+    c->limit = c->slow_start ? c->limit * 2 : c->limit + 1;
+    if (c->limit > c->max) c->limit = c->max;
+    if (c->limit > c->peak) c->peak = c->limit;
+}
+
+void aimd_on_overload(AimdController *c, double now) {
+    c->slow_start = false;
+    if (now - c->last_decrease < PRESSURE_DECREASE_INTERVAL) return;
+    c->last_decrease = now;
+    if (c->limit > 1) {
+        c->limit /= 2;
+        c->decreases++;
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef PRESSURE_H
+#define PRESSURE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+ * Adaptive concurrency for `taguchi run -j auto`.
+ *
+ * Host load is sampled from pressure-stall information (the "some avg10"
+ * share of time tasks waited for CPU, memory or I/O in
+ * <proc>/pressure/{cpu,memory,io}) and MemAvailable / MemTotal from
+ * <proc>/meminfo.  An AIMD controller turns the samples into a concurrency
+ * limit: while the host is below every threshold each finished run raises
+ * the limit (doubling until the first overload, then by one), and an
+ * overload halves it.  Decreases are spaced by PRESSURE_DECREASE_INTERVAL
+ * because avg10 lags the runs that caused it.
+ */
+
+#define PRESSURE_CPU_SOME 25.0         /* % of time runnable tasks waited for a CPU */
+#define PRESSURE_MEMORY_SOME 10.0      /* % of time tasks stalled on memory */
+#define PRESSURE_IO_SOME 40.0          /* % of time tasks stalled on I/O */
+#define PRESSURE_MIN_MEM_AVAILABLE 0.10 /* Fraction of MemTotal */
+#define PRESSURE_DECREASE_INTERVAL 2.0 /* Seconds between multiplicative decreases */
+#define PRESSURE_POLL_MS 250           /* Re-sample period while admission is held */
+
+typedef struct {
+    bool psi;               /* Pressure files were readable */
+    double cpu_some;        /* avg10 percentages; 0 without PSI */
+    double memory_some;
+    double io_some;
+    double mem_available;   /* MemAvailable / MemTotal, or -1 if unknown */
+} PressureSample;
+
+typedef struct {
+    size_t limit;           /* Current concurrency limit (1..max) */
+    size_t max;             /* Upper bound (online CPUs, capped by run count) */
+    bool slow_start;        /* Doubling until the first overload */
+    double last_decrease;   /* Monotonic time of the last decrease */
+    size_t peak;            /* Highest limit reached */
+    size_t decreases;
+} AimdController;
+
+/* Read a sample below proc_root (normally "/proc"); returns -1 if neither
+ * pressure nor meminfo could be read */
+int pressure_sample(const char *proc_root, PressureSample *out);
+
+/* True if any measured quantity is past its threshold */
+bool pressure_overloaded(const PressureSample *s);
+
+/* Start at a limit of 1 with at most max concurrent runs */
+void aimd_init(AimdController *c, size_t max);
+
+/* A run finished while the host was (not) overloaded */
+void aimd_on_finish(AimdController *c, bool overloaded);
+
+/* An admission check found the host overloaded at monotonic time now */
+void aimd_on_overload(AimdController *c, double now);
+
+#endif /* PRESSURE_H */
@@ -0,0 +1,178 @@
+#define _GNU_SOURCE
+#include "progress.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <limits.h>
+
+/* Minimum interval between textfile rewrites while the campaign runs */
+#define PROGRESS_EXPORT_INTERVAL 1.0
+
+double progress_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+void progress_init(ProgressTracker *p, size_t total, size_t parallelism,
+                   const char *experiment, const char *textfile,
+                   FILE *status_stream) {
+    memset(p, 0, sizeof(*p));
+    p->total = total;
+    p->parallelism = parallelism > 0 ? parallelism : 1;
+    p->start_time = progress_now();
+    p->last_export = -PROGRESS_EXPORT_INTERVAL;
+    p->textfile = textfile;
+    p->status_stream = status_stream;
+
+    /* Prometheus label values may not contain raw quotes, backslashes or newlines */
+    size_t n = 0;
+    for (const char *s = experiment ? experiment : ""; *s && n < sizeof(p->experiment) - 1; s++) {
+        p->experiment[n++] = (*s == '"' || *s == '\\' || *s == '\n') ? '_' : *s;
+    }
+    p->experiment[n] = '\0';
+}
+
+void progress_run_started(ProgressTracker *p) {
+    p->in_flight++;
+}
+
+void progress_run_finished(ProgressTracker *p, double seconds, bool failed) {
+    if (p->in_flight > 0) p->in_flight--;
+    if (p->done == 0) {
+        p->ewma_seconds = seconds;
+    } else {
+        p->ewma_seconds = PROGRESS_EWMA_ALPHA * seconds
+                        + (1.0 - PROGRESS_EWMA_ALPHA) * p->ewma_seconds;
+    }
+    p->done++;
+    if (failed) p->failed++;
+}
+
+void progress_run_retrying(ProgressTracker *p) {
+    if (p->in_flight > 0) p->in_flight--;
+    p->retried++;
+}
+
+void progress_set_parallelism(ProgressTracker *p, size_t parallelism) {
+    p->parallelism = parallelism > 0 ? parallelism : 1;
+}
+
+double progress_eta_seconds(const ProgressTracker *p) {
+    if (p->done >= p->total) return 0.0;
+    if (p->done == 0) return -1.0;
+
+    /* Remaining runs drain in waves of `parallelism`; in-flight runs are
+     * assumed to be halfway through on average. */
+    size_t remaining = p->total - p->done;
+    size_t queued = remaining > p->in_flight ? remaining - p->in_flight : 0;
+    size_t waves = (queued + p->parallelism - 1) / p->parallelism;
+    double eta = (double)waves * p->ewma_seconds;
+    if (p->in_flight > 0 && queued == 0) {
+        eta += 0.5 * p->ewma_seconds;
+    }
+    return eta;
+}
+
+int progress_write_textfile(const ProgressTracker *p) {
+    if (!p->textfile) return 0;
+
+    char tmp_path[PATH_MAX];
+    int nw = snprintf(tmp_path, sizeof(tmp_path), "%s.%ld.tmp", p->textfile, (long)getpid());
+    if (nw < 0 || nw >= (int)sizeof(tmp_path)) return -1;
+
+    FILE *f = fopen(tmp_path, "w");
+    if (!f) return -1;
+
+    const char *lbl = p->experiment;
+    double eta = progress_eta_seconds(p);
+    fprintf(f, "# HELP taguchi_runs_total Runs in the current campaign.\n"
+               "# TYPE taguchi_runs_total gauge\n"
+               "taguchi_runs_total{experiment=\"%s\"} %zu\n", lbl, p->total);
+    fprintf(f, "# HELP taguchi_runs_done Runs finished so far, including failures.\n"
+               "# TYPE taguchi_runs_done gauge\n"
+               "taguchi_runs_done{experiment=\"%s\"} %zu\n", lbl, p->done);
+    fprintf(f, "# HELP taguchi_runs_failed Runs that exited non-zero or abnormally.\n"
+               "# TYPE taguchi_runs_failed gauge\n"
+               "taguchi_runs_failed{experiment=\"%s\"} %zu\n", lbl, p->failed);
+    fprintf(f, "# HELP taguchi_runs_retried Failed attempts scheduled to run again.\n"
+               "# TYPE taguchi_runs_retried gauge\n"
+               "taguchi_runs_retried{experiment=\"%s\"} %zu\n", lbl, p->retried);
+    fprintf(f, "# HELP taguchi_runs_in_flight Runs currently executing.\n"
+               "# TYPE taguchi_runs_in_flight gauge\n"
+               "taguchi_runs_in_flight{experiment=\"%s\"} %zu\n", lbl, p->in_flight);
+    fprintf(f, "# HELP taguchi_parallelism Current concurrency limit.\n"
+               "# TYPE taguchi_parallelism gauge\n"
+               "taguchi_parallelism{experiment=\"%s\"} %zu\n", lbl, p->parallelism);
+    fprintf(f, "# HELP taguchi_run_duration_ewma_seconds EWMA of run wall time.\n"
+               "# TYPE taguchi_run_duration_ewma_seconds gauge\n"
+               "taguchi_run_duration_ewma_seconds{experiment=\"%s\"} %.6f\n", lbl, p->ewma_seconds);
+    fprintf(f, "# HELP taguchi_eta_seconds Estimated seconds until the campaign completes (-1 = unknown).\n"
+               "# TYPE taguchi_eta_seconds gauge\n"
+               "taguchi_eta_seconds{experiment=\"%s\"} %.3f\n", lbl, eta);
+    fprintf(f, "# HELP taguchi_elapsed_seconds Seconds since the campaign started.\n"
+               "# TYPE taguchi_elapsed_seconds gauge\n"
+               "taguchi_elapsed_seconds{experiment=\"%s\"} %.3f\n", lbl, progress_now() - p->start_time);
+
+    if (fclose(f) != 0) {
+        unlink(tmp_path);
+        return -1;
+    }
+    /* rename() is atomic within a filesystem, so the collector never sees a partial file */
+    if (rename(tmp_path, p->textfile) != 0) {
+        unlink(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+static void format_duration(double seconds, char *buf, size_t size) {
+    if (seconds < 0) {
+        snprintf(buf, size, "--:--");
+        return;
+    }
+    unsigned long s = (unsigned long)(seconds + 0.5);
+    if (s >= 3600) {
+        snprintf(buf, size, "%lu:%02lu:%02lu", s / 3600, (s / 60) % 60, s % 60);
+    } else {
+        snprintf(buf, size, "%lu:%02lu", s / 60, s % 60);
+    }
+}
+
+void progress_clear_status(ProgressTracker *p) {
+    if (p->status_stream && p->status_visible) {
+        fputs("\r\033[K", p->status_stream);
+        fflush(p->status_stream);
+        p->status_visible = false;
+    }
+}
+
+void progress_update(ProgressTracker *p) {
+    if (p->status_stream) {
+        char eta[32];
+        format_duration(progress_eta_seconds(p), eta, sizeof(eta));
+        fprintf(p->status_stream, "\r\033[K[%zu/%zu] failed=%zu running=%zu avg=%.1fs eta=%s",
+                p->done, p->total, p->failed, p->in_flight, p->ewma_seconds, eta);
+        fflush(p->status_stream);
+        p->status_visible = true;
+    }
+
+    double now = progress_now();
+    if (p->textfile && now - p->last_export >= PROGRESS_EXPORT_INTERVAL) {
+        if (progress_write_textfile(p) != 0) {
+            progress_clear_status(p);
+            fprintf(stderr, "Warning: cannot write metrics file %s\n", p->textfile);
+            p->textfile = NULL;
+        }
+        p->last_export = now;
+    }
+}
+
+void progress_finish(ProgressTracker *p) {
+    progress_clear_status(p);
+    if (p->textfile && progress_write_textfile(p) != 0) {
+        fprintf(stderr, "Warning: cannot write metrics file %s\n", p->textfile);
+    }
+}
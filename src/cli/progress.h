@@ -0,0 +1,69 @@
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/*
+ * In-process progress tracker for `taguchi run`.
+ *
+ * Tracks runs done / failed / in flight, an exponentially weighted moving
+ * average of run duration and a makespan ETA for the current parallelism.
+ * Optionally mirrors its state into a Prometheus node-exporter textfile
+ * (written to a temp file and renamed into place) and a live status line.
+ */
+
+#define PROGRESS_EWMA_ALPHA 0.3
+
+typedef struct {
+    size_t total;          /* Runs in the campaign */
+    size_t done;           /* Runs finished (successful or not) */
+    size_t failed;         /* Runs that exited non-zero or abnormally */
+    size_t in_flight;      /* Runs currently executing */
+    size_t retried;        /* Failed attempts that were scheduled again */
+    size_t parallelism;    /* Current concurrency limit */
+
+    double ewma_seconds;   /* EWMA of run wall time; valid once done > 0 */
+    double start_time;     /* Monotonic campaign start (seconds) */
+    double last_export;    /* Monotonic time of last textfile write */
+
+    char experiment[64];   /* Label value for exported metrics */
+    const char *textfile;  /* Prometheus textfile path, or NULL */
+    FILE *status_stream;   /* Live status line target, or NULL */
+    bool status_visible;   /* A status line is currently drawn */
+} ProgressTracker;
+
+/* Monotonic clock in seconds */
+double progress_now(void);
+
+/* Initialise tracker; textfile and status_stream may be NULL */
+void progress_init(ProgressTracker *p, size_t total, size_t parallelism,
+                   const char *experiment, const char *textfile,
+                   FILE *status_stream);
+
+/* Record run lifecycle transitions */
+void progress_run_started(ProgressTracker *p);
+void progress_run_finished(ProgressTracker *p, double seconds, bool failed);
+/* A failed attempt leaves flight to be retried; the run is not done yet */
+void progress_run_retrying(ProgressTracker *p);
+
+/* Update the concurrency used for the ETA */
+void progress_set_parallelism(ProgressTracker *p, size_t parallelism);
+
+/* Estimated seconds until the last run finishes; negative if unknown */
+double progress_eta_seconds(const ProgressTracker *p);
+
+/* Write the Prometheus textfile atomically; returns 0 on success */
+int progress_write_textfile(const ProgressTracker *p);
+
+/* Erase the live status line so regular output can be printed */
+void progress_clear_status(ProgressTracker *p);
+
+/* Redraw the live status line and refresh the textfile (rate limited) */
+void progress_update(ProgressTracker *p);
+
+/* Final textfile flush and status line teardown */
+void progress_finish(ProgressTracker *p);
+
+#endif /* PROGRESS_H */
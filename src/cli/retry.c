@@ -0,0 +1,101 @@
+#define _GNU_SOURCE
+#include "retry.h"
+#include "include/taguchi.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <signal.h>
+
+/* Signals worth naming in --retry-on */
+static const struct {
+    const char *name;
+    int number;
+} signal_names[] = {
+    { "HUP", SIGHUP }, { "INT", SIGINT }, { "QUIT", SIGQUIT }, { "ILL", SIGILL },
+    { "ABRT", SIGABRT }, { "BUS", SIGBUS }, { "FPE", SIGFPE }, { "KILL", SIGKILL },
+    { "SEGV", SIGSEGV }, { "PIPE", SIGPIPE }, { "ALRM", SIGALRM }, { "TERM", SIGTERM },
+    { "XCPU", SIGXCPU }, { "XFSZ", SIGXFSZ },
+};
+
+void retry_policy_init(RetryPolicy *policy) {
+    memset(policy, 0, sizeof(*policy));
+    policy->backoff = RETRY_DEFAULT_BACKOFF;
+    char error[TAGUCHI_ERROR_SIZE];
+    retry_parse_list(policy, RETRY_DEFAULT_LIST, error);
+}
+
+static int parse_item(const char *item, int *code) {
+    char *endptr;
+    long value = strtol(item, &endptr, 10);
+    if (endptr != item && *endptr == '\0') {
+        if (value < 1 || value > 255) return -1;
+        *code = (int)value;
+        return 0;
+    }
+    const char *name = strncasecmp(item, "SIG", 3) == 0 ? item + 3 : item;
+    for (size_t i = 0; i < sizeof(signal_names) / sizeof(signal_names[0]); i++) {
+        if (strcasecmp(name, signal_names[i].name) == 0) {
+            *code = 128 + signal_names[i].number;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int retry_parse_list(RetryPolicy *policy, const char *list, char *error_buf) {
+    char buf[512];
+    if (strlen(list) >= sizeof(buf)) {
+        snprintf(error_buf, TAGUCHI_ERROR_SIZE, "retry list too long");
+        return -1;
+    }
+    strcpy(buf, list);
+
+    size_t count = 0;
+    int codes[RETRY_MAX_CODES];
+    char *save = NULL;
+    for (char *item = strtok_r(buf, ",", &save); item; item = strtok_r(NULL, ",", &save)) {
+        if (count >= RETRY_MAX_CODES) {
+            snprintf(error_buf, TAGUCHI_ERROR_SIZE, "too many retryable codes (max %d)",
+                     RETRY_MAX_CODES);
+            return -1;
+        }
+        if (parse_item(item, &codes[count]) != 0) {
+            snprintf(error_buf, TAGUCHI_ERROR_SIZE,
+                     "unknown retryable code '%s' (expected 1-255 or a signal name)", item);
+            return -1;
+        }
+        count++;
+    }
+    if (count == 0) {
+        snprintf(error_buf, TAGUCHI_ERROR_SIZE, "empty retry list");
+        return -1;
+    }
+    memcpy(policy->codes, codes, count * sizeof(int));
+    policy->code_count = count;
+    return 0;
+}
+
+RetryClass retry_classify(const RetryPolicy *policy, int exit_code) {
+    if (exit_code == 0) return RETRY_OK;
+    for (size_t i = 0; i < policy->code_count; i++) {
+        if (policy->codes[i] == exit_code) return RETRY_RETRYABLE;
+    }
+    return RETRY_PERMANENT;
+}
+
+double retry_delay(const RetryPolicy *policy, unsigned attempt) {
+    double delay = policy->backoff;
+    for (unsigned i = 1; i < attempt && delay < RETRY_MAX_BACKOFF; i++) {
+        delay *= 2.0;
+    }
+    return delay < RETRY_MAX_BACKOFF ? delay : RETRY_MAX_BACKOFF;
+}
+
+const char *retry_class_name(RetryClass cls) {
+    switch (cls) {
+        case RETRY_OK: return "ok";
+        case RETRY_RETRYABLE: return "retryable";
+        default: return "permanent";
+    }
+}
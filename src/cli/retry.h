@@ -0,0 +1,56 @@
+#ifndef RETRY_H
+#define RETRY_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+ * Retry policy for `taguchi run --retries N`.
+ *
+ * A failed attempt is classified by its exit code in the runner's shell
+ * convention (128 + N for death by signal N, which is also what sh reports
+ * when the benchmark it started was killed).  Codes and signals on the
+ * retryable list are infrastructure failures worth another attempt: by
+ * default EX_IOERR (74), EX_TEMPFAIL (75), SIGKILL (what the OOM killer
+ * sends) and SIGBUS (I/O errors on mapped files).  Anything else is
+ * permanent.  Retry k waits backoff * 2^(k-1) seconds, capped at
+ * RETRY_MAX_BACKOFF.
+ */
+
+#define RETRY_MAX_CODES 32
+#define RETRY_DEFAULT_LIST "74,75,KILL,BUS"
+#define RETRY_DEFAULT_BACKOFF 1.0      /* Seconds before the first retry */
+#define RETRY_MAX_BACKOFF 60.0
+
+typedef enum {
+    RETRY_OK,               /* Exit code 0 */
+    RETRY_RETRYABLE,
+    RETRY_PERMANENT
+} RetryClass;
+
+typedef struct {
+    unsigned max_retries;   /* Extra attempts per run; 0 disables retries */
+    double backoff;
+    int codes[RETRY_MAX_CODES]; /* Retryable exit codes (signals as 128 + N) */
+    size_t code_count;
+} RetryPolicy;
+
+/* No retries, default retryable list and backoff */
+void retry_policy_init(RetryPolicy *policy);
+
+/*
+ * Replace the retryable list with a comma-separated list of exit codes
+ * (1-255) and signal names ("KILL" or "SIGKILL"); error_buf must hold
+ * TAGUCHI_ERROR_SIZE bytes.
+ */
+int retry_parse_list(RetryPolicy *policy, const char *list, char *error_buf);
+
+RetryClass retry_classify(const RetryPolicy *policy, int exit_code);
+
+/* Seconds to wait before retry number attempt (1 for the first retry) */
+double retry_delay(const RetryPolicy *policy, unsigned attempt);
+
+/* "ok", "retryable" or "permanent", as written to the journal */
+const char *retry_class_name(RetryClass cls);
+
+#endif /* RETRY_H */
@@ -0,0 +1,679 @@
+#define _GNU_SOURCE
+#include "runner.h"
+#include "progress.h"
+#include "pressure.h"
+#include "evloop.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <time.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+/* Per-child bookkeeping for runs currently executing */
+typedef struct {
+    pid_t pid;
+    size_t run_index;
+    double started;
+    size_t concurrency;        /* Most runs in flight while this one ran */
+    unsigned attempt;          /* 1 for the first attempt */
+    PerfRunCounters counters;
+    LogCapture log;            /* Output capture (unused without opts->log) */
+    int pidfd;                 /* Exit notification, -1 in the SIGCHLD fallback */
+} RunSlot;
+
+/* Failed attempts waiting for their backoff, plus per-run attempt counts */
+typedef struct {
+    unsigned *attempts;        /* Attempts started, by run index */
+    size_t *index;             /* Queued run indices */
+    double *ready;             /* Monotonic time each may start */
+    size_t count;
+    FILE *journal;             /* Attempt journal, or NULL */
+    size_t recovered;          /* Runs that succeeded after a retry */
+    size_t exhausted;          /* Runs still failing when attempts ran out */
+} RetryQueue;
+
+void runner_options_init(RunnerOptions *opts) {
+    memset(opts, 0, sizeof(*opts));
+    opts->jobs = 1;
+    opts->proc_root = "/proc";
+}
+
+/* Child side of fork(): export the run configuration and exec the script.
+ * If gate_fd >= 0, block until the parent closes the other end so counters
+ * can be attached before exec.  If out_fd >= 0 it becomes stdout and stderr. */
+static void exec_run_child(const taguchi_experiment_run_t *run, const char *script, int gate_fd,
+                           int out_fd) {
+    if (gate_fd >= 0) {
+        char byte;
+        ssize_t n;
+        do {
+            n = read(gate_fd, &byte, 1);
+        } while (n < 0 && errno == EINTR);
+        close(gate_fd);
+    }
+    if (out_fd >= 0) {
+        dup2(out_fd, STDOUT_FILENO);
+        dup2(out_fd, STDERR_FILENO);
+        close(out_fd);
+    }
+
+    /* The event loop may block SIGCHLD in the parent; the script gets a clean mask */
+    sigset_t chld;
+    sigemptyset(&chld);
+    sigaddset(&chld, SIGCHLD);
+    sigprocmask(SIG_UNBLOCK, &chld, NULL);
+
+    char run_id_str[64];
+    snprintf(run_id_str, sizeof(run_id_str), "%zu", taguchi_run_get_id(run));
+    setenv("TAGUCHI_RUN_ID", run_id_str, 1);
+
+    size_t factor_count = taguchi_run_get_factor_count(run);
+    for (size_t f = 0; f < factor_count; f++) {
+        const char *factor_name = taguchi_run_get_factor_name_at_index(run, f);
+        const char *factor_value = taguchi_run_get_value(run, factor_name);
+
+        if (factor_name && factor_value) {
+            /* Reject factor names containing '=' — would corrupt the env block */
+            if (strchr(factor_name, '=') != NULL) {
+                fprintf(stderr, "Error: factor name '%s' contains invalid character '='\n", factor_name);
+                _exit(1);
+            }
+            char env_name[256];
+            int nw = snprintf(env_name, sizeof(env_name), "TAGUCHI_%s", factor_name);
+            if (nw < 0 || nw >= (int)sizeof(env_name)) {
+                fprintf(stderr, "Error: factor name too long for environment variable\n");
+                _exit(1);
+            }
+            setenv(env_name, factor_value, 1);
+        }
+    }
+
+    execl("/bin/sh", "sh", "-c", script, (char *)NULL);
+
+    /* If execl returns, it failed */
+    perror("exec failed");
+    _exit(127);
+}
+
+/* Run a hook command in the environment of run and wait for it */
+static int run_hook(const taguchi_experiment_run_t *run, const char *kind,
+                    const char *factor, const char *command) {
+    printf("%s for %s=%s\n", kind, factor, taguchi_run_get_value(run, factor));
+    fflush(stdout);
+    fflush(stderr);
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        exec_run_child(run, command, -1, -1);
+    } else if (pid < 0) {
+        perror("fork failed");
+        return -1;
+    }
+
+    int status;
+    pid_t waited;
+    do {
+        waited = waitpid(pid, &status, 0);
+    } while (waited < 0 && errno == EINTR);
+    if (waited < 0) {
+        perror("waitpid failed");
+        return -1;
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "%s for %s failed (%s %d)\n", kind, factor,
+                WIFEXITED(status) ? "exit code" : "signal",
+                WIFEXITED(status) ? WEXITSTATUS(status) : WTERMSIG(status));
+        return -1;
+    }
+    return 0;
+}
+
+/* Hook bookkeeping for one campaign: the run whose level each hook has set
+ * up, so a teardown sees that level even after a later setup failed */
+typedef struct {
+    const taguchi_experiment_run_t *applied[RUNNER_MAX_HOOKS]; /* NULL = none */
+    size_t setups;
+    size_t teardowns;
+} HookState;
+
+/* Before launching run: tear down and set up every factor whose level
+ * differs from the one set up.  Returns -1 if a setup failed. */
+static int hooks_before_run(const taguchi_experiment_run_t *run, const RunnerOptions *opts,
+                            HookState *state) {
+    for (size_t h = 0; h < opts->hook_count; h++) {
+        const RunnerHook *hook = &opts->hooks[h];
+        const taguchi_experiment_run_t *prev = state->applied[h];
+        if (prev && taguchi_run_get_level_index(prev, hook->factor_index) ==
+                    taguchi_run_get_level_index(run, hook->factor_index)) {
+            state->applied[h] = run;
+            continue;
+        }
+        const char *factor = taguchi_run_get_factor_name_at_index(run, hook->factor_index);
+        if (prev && hook->teardown) {
+            if (run_hook(prev, "Teardown", factor, hook->teardown) != 0) {
+                fprintf(stderr, "Warning: continuing after failed teardown\n");
+            }
+            state->teardowns++;
+        }
+        state->applied[h] = NULL;
+        if (hook->setup) {
+            state->setups++;
+            if (run_hook(run, "Setup", factor, hook->setup) != 0) return -1;
+        }
+        state->applied[h] = run;
+    }
+    return 0;
+}
+
+/* After the campaign: tear down every level still set up */
+static void hooks_finish(const RunnerOptions *opts, HookState *state) {
+    for (size_t h = 0; h < opts->hook_count; h++) {
+        const RunnerHook *hook = &opts->hooks[h];
+        const taguchi_experiment_run_t *applied = state->applied[h];
+        state->applied[h] = NULL;
+        if (!applied || !hook->teardown) continue;
+        const char *factor = taguchi_run_get_factor_name_at_index(applied, hook->factor_index);
+        if (run_hook(applied, "Teardown", factor, hook->teardown) != 0) {
+            fprintf(stderr, "Warning: teardown failed\n");
+        }
+        state->teardowns++;
+    }
+}
+
+/* Write the results CSV header: run_id, exit_code, wall_seconds, counters...,
+ * log metrics... and concurrency under -j auto */
+static void write_results_header(FILE *out, const PerfCounterSet *perf,
+                                 const LogCaptureOptions *log, bool attempts, bool concurrency) {
+    fprintf(out, "run_id,exit_code,wall_seconds");
+    for (size_t i = 0; perf && i < perf->count; i++) {
+        fprintf(out, ",%s", perf->events[i].name);
+    }
+    for (size_t i = 0; log && i < log->metric_count; i++) {
+        fprintf(out, ",%s", log->metrics[i].name);
+    }
+    if (attempts) fprintf(out, ",attempts");
+    if (concurrency) fprintf(out, ",concurrency");
+    fprintf(out, "\n");
+    fflush(out);
+}
+
+/* Append one row; counters that could not be read and log metrics that were
+ * never printed are left empty (missing).  attempts and concurrency of 0
+ * mean the column is not written. */
+static void write_results_row(FILE *out, size_t run_id, int exit_code, double wall,
+                              const PerfCounterSet *perf, const uint64_t *values,
+                              const bool *valid, const LogCaptureOptions *log,
+                              const LogCapture *capture, unsigned attempts, size_t concurrency) {
+    fprintf(out, "%zu,%d,%.6f", run_id, exit_code, wall);
+    for (size_t i = 0; perf && i < perf->count; i++) {
+        if (valid[i]) {
+            fprintf(out, ",%" PRIu64, values[i]);
+        } else {
+            fprintf(out, ",");
+        }
+    }
+    for (size_t i = 0; log && i < log->metric_count; i++) {
+        if (capture->found[i]) {
+            fprintf(out, ",%.17g", capture->values[i]);
+        } else {
+            fprintf(out, ",");
+        }
+    }
+    if (attempts > 0) fprintf(out, ",%u", attempts);
+    if (concurrency > 0) fprintf(out, ",%zu", concurrency);
+    fprintf(out, "\n");
+}
+
+/* Take a slot's pipe and pidfd out of the event loop before they are closed */
+static void unwatch_slot(EventLoop *loop, RunSlot *slot, const RunnerOptions *opts) {
+    if (opts->log && slot->log.fd >= 0) evloop_unwatch(loop, slot->log.fd);
+    if (slot->pidfd >= 0) evloop_unwatch(loop, slot->pidfd);
+}
+
+/* Report a reaped run, queueing a retry when the policy allows.  Results and
+ * journal rows are left in the stdio buffers; the event loop flushes them
+ * once per batch of events. */
+static void finish_run(RunSlot *slot, int status, taguchi_experiment_run_t **runs,
+                       const RunnerOptions *opts, EventLoop *loop, FILE *results,
+                       ProgressTracker *progress, RetryQueue *retries) {
+    double elapsed = progress_now() - slot->started;
+    size_t run_id = taguchi_run_get_id(runs[slot->run_index]);
+    bool failed = true;
+    int exit_code;
+
+    uint64_t values[PERF_MAX_COUNTERS];
+    bool valid[PERF_MAX_COUNTERS];
+    if (opts->perf) {
+        perf_read_and_close(opts->perf, &slot->counters, values, valid);
+    }
+    unwatch_slot(loop, slot, opts);
+    if (opts->log) logcap_finish(&slot->log, opts->log);
+    if (slot->pidfd >= 0) close(slot->pidfd);
+    slot->pidfd = -1;
+    slot->pid = 0;
+
+    progress_clear_status(progress);
+    if (WIFEXITED(status)) {
+        exit_code = WEXITSTATUS(status);
+        failed = (exit_code != 0);
+        printf("Run %zu completed with exit code %d\n", run_id, exit_code);
+    } else {
+        /* Shell convention for death by signal */
+        exit_code = WIFSIGNALED(status) ? 128 + WTERMSIG(status) : -1;
+        printf("Run %zu terminated abnormally\n", run_id);
+    }
+    fflush(stdout);
+    if (opts->log && failed) logcap_print_excerpt(&slot->log, stderr, run_id);
+
+    unsigned attempt = slot->attempt;
+    RetryClass cls = opts->retry ? retry_classify(opts->retry, exit_code)
+                                 : (failed ? RETRY_PERMANENT : RETRY_OK);
+    bool retry = cls == RETRY_RETRYABLE && attempt <= opts->retry->max_retries;
+    if (retries->journal) {
+        fprintf(retries->journal, "%zu,%u,%d,%.6f,%s,%s\n", run_id, attempt, exit_code, elapsed,
+                retry_class_name(cls),
+                retry ? "retry" : cls == RETRY_RETRYABLE ? "give_up" : "done");
+    }
+    if (retry) {
+        double delay = retry_delay(opts->retry, attempt);
+        printf("Retrying run %zu in %gs (attempt %u of %u)\n", run_id, delay, attempt + 1,
+               opts->retry->max_retries + 1);
+        fflush(stdout);
+        retries->index[retries->count] = slot->run_index;
+        retries->ready[retries->count++] = progress_now() + delay;
+        progress_run_retrying(progress);
+        return;
+    }
+    if (cls == RETRY_RETRYABLE) retries->exhausted++;
+    if (!failed && attempt > 1) retries->recovered++;
+
+    if (results) {
+        write_results_row(results, run_id, exit_code, elapsed, opts->perf, values, valid,
+                          opts->log, &slot->log, opts->retry ? attempt : 0,
+                          opts->auto_jobs ? slot->concurrency : 0);
+    }
+    if (opts->on_result) {
+        opts->on_result(opts->user, run_id, exit_code, elapsed,
+                        opts->perf ? values : NULL, opts->perf ? valid : NULL);
+    }
+
+    progress_run_finished(progress, elapsed, failed);
+}
+
+/* The pidfd of slot's run became readable: reap it.  Returns 1 if it was
+ * reaped, 0 if it had not exited after all, -1 on error. */
+static int reap_slot(RunSlot *slot, taguchi_experiment_run_t **runs, const RunnerOptions *opts,
+                     EventLoop *loop, FILE *results, ProgressTracker *progress,
+                     RetryQueue *retries) {
+    int status;
+    pid_t pid;
+    /* An empty slot must not reach waitpid(0, ...), which reaps any child */
+    if (slot->pid == 0) return 0;
+    do {
+        pid = waitpid(slot->pid, &status, WNOHANG);
+    } while (pid < 0 && errno == EINTR);
+    if (pid <= 0) return pid;
+    finish_run(slot, status, runs, opts, loop, results, progress, retries);
+    return 1;
+}
+
+/* SIGCHLD fallback: reap every child that has exited.  Returns the number
+ * of runs reaped, or -1 on error. */
+static int reap_exited(RunSlot *slots, size_t slot_count, taguchi_experiment_run_t **runs,
+                       const RunnerOptions *opts, EventLoop *loop, FILE *results,
+                       ProgressTracker *progress, RetryQueue *retries) {
+    int reaped = 0;
+    for (;;) {
+        int status;
+        pid_t pid = waitpid(-1, &status, WNOHANG);
+        if (pid < 0 && errno == EINTR) continue;
+        if (pid < 0) return errno == ECHILD ? reaped : -1;
+        if (pid == 0) return reaped;
+        for (size_t s = 0; s < slot_count; s++) {
+            if (slots[s].pid != pid) continue;
+            finish_run(&slots[s], status, runs, opts, loop, results, progress, retries);
+            reaped++;
+            break;
+        }
+        /* Not one of ours (e.g. inherited child) — ignore */
+    }
+}
+
+/* Queued retry whose backoff has passed (earliest first), or SIZE_MAX */
+static size_t retry_ready(const RetryQueue *retries, double now) {
+    size_t best = SIZE_MAX;
+    for (size_t i = 0; i < retries->count; i++) {
+        if (retries->ready[i] <= now && (best == SIZE_MAX || retries->ready[i] < retries->ready[best])) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+/* Seconds until the earliest queued retry may start (0 if one may now) */
+static double retry_wait(const RetryQueue *retries, double now) {
+    double wait = -1.0;
+    for (size_t i = 0; i < retries->count; i++) {
+        double until = retries->ready[i] > now ? retries->ready[i] - now : 0.0;
+        if (wait < 0.0 || until < wait) wait = until;
+    }
+    return wait;
+}
+
+/* Start runs[index] in slot; returns -1 (with nothing left running in the
+ * slot) if it could not be launched */
+static int launch_run(RunSlot *slot, size_t slot_index, taguchi_experiment_run_t **runs,
+                      size_t index, const RunnerOptions *opts, EventLoop *loop,
+                      bool *log_started, ProgressTracker *progress) {
+    /* With counters, the child waits on a gate pipe until they are attached */
+    int gate[2] = { -1, -1 };
+    if (opts->perf && pipe2(gate, O_CLOEXEC) != 0) {
+        progress_clear_status(progress);
+        perror("pipe failed");
+        return -1;
+    }
+
+    int out = -1;
+    if (opts->log) {
+        size_t id = taguchi_run_get_id(runs[index]);
+        out = logcap_start(&slot->log, opts->log, id, opts->append || log_started[id]);
+        log_started[id] = true;
+        if (out < 0 || evloop_watch_output(loop, slot->log.fd, slot_index) != 0) {
+            progress_clear_status(progress);
+            perror(out < 0 ? "pipe failed" : "epoll_ctl failed");
+            if (out >= 0) close(out);
+            logcap_finish(&slot->log, opts->log);
+            if (gate[0] >= 0) {
+                close(gate[0]);
+                close(gate[1]);
+            }
+            return -1;
+        }
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (gate[1] >= 0) close(gate[1]);
+        exec_run_child(runs[index], opts->script, gate[0], out);
+    } else if (pid < 0) {
+        progress_clear_status(progress);
+        perror("fork failed");
+        if (gate[0] >= 0) {
+            close(gate[0]);
+            close(gate[1]);
+        }
+        if (out >= 0) close(out);
+        unwatch_slot(loop, slot, opts);
+        if (opts->log) logcap_finish(&slot->log, opts->log);
+        return -1;
+    }
+
+    if (opts->perf) {
+        close(gate[0]);
+        perf_open_for_child(opts->perf, pid, &slot->counters);
+    }
+    if (out >= 0) close(out);
+
+    slot->pidfd = evloop_watch_child(loop, pid, slot_index);
+    if (slot->pidfd < 0 && loop->pidfds) {
+        /* Its exit would go unnoticed; take it back before it starts */
+        progress_clear_status(progress);
+        perror("pidfd_open failed");
+        kill(pid, SIGKILL);
+        if (gate[1] >= 0) close(gate[1]);
+        waitpid(pid, NULL, 0);
+        if (opts->perf) {
+            uint64_t values[PERF_MAX_COUNTERS];
+            bool valid[PERF_MAX_COUNTERS];
+            perf_read_and_close(opts->perf, &slot->counters, values, valid);
+        }
+        unwatch_slot(loop, slot, opts);
+        if (opts->log) logcap_finish(&slot->log, opts->log);
+        return -1;
+    }
+    if (gate[1] >= 0) close(gate[1]); /* release the child */
+
+    slot->pid = pid;
+    slot->run_index = index;
+    slot->started = progress_now();
+    slot->concurrency = 0;
+    return 0;
+}
+
+int runner_execute(taguchi_experiment_run_t **runs, size_t count, const RunnerOptions *opts) {
+    size_t jobs = opts->jobs > 0 ? opts->jobs : 1;
+    if (jobs > count && count > 0) jobs = count;
+    if (opts->hook_count > 0 && (jobs > 1 || opts->auto_jobs)) {
+        fprintf(stderr, "Error: setup/teardown hooks require sequential runs (-j 1)\n");
+        return -1;
+    }
+    if (opts->hook_count > RUNNER_MAX_HOOKS) {
+        fprintf(stderr, "Error: too many hooks (max %d)\n", RUNNER_MAX_HOOKS);
+        return -1;
+    }
+    HookState hooks;
+    memset(&hooks, 0, sizeof(hooks));
+
+    int rc = -1;
+    FILE *results = NULL;
+    EventLoop loop;
+    bool loop_ok = false;
+    RetryQueue retries;
+    memset(&retries, 0, sizeof(retries));
+    RunSlot *slots = calloc(jobs, sizeof(RunSlot));
+    /* Log files start afresh the first time this campaign runs an ID */
+    size_t max_id = 0;
+    for (size_t i = 0; i < count; i++) {
+        size_t id = taguchi_run_get_id(runs[i]);
+        if (id > max_id) max_id = id;
+    }
+    bool *log_started = calloc(max_id + 1, sizeof(bool));
+    retries.attempts = calloc(count + 1, sizeof(unsigned));
+    retries.index = calloc(count + 1, sizeof(size_t));
+    retries.ready = calloc(count + 1, sizeof(double));
+    bool log_ok = slots != NULL;
+    for (size_t s = 0; slots && s < jobs; s++) {
+        slots[s].pidfd = -1;
+        if (opts->log && logcap_init(&slots[s].log, opts->log) != 0) log_ok = false;
+    }
+    if (!log_ok || !log_started || !retries.attempts || !retries.index || !retries.ready) {
+        fprintf(stderr, "Error: out of memory\n");
+        goto done;
+    }
+
+    if (opts->results_file) {
+        results = fopen(opts->results_file, opts->append ? "a" : "w");
+        if (!results) {
+            fprintf(stderr, "Error: cannot open results file %s\n", opts->results_file);
+            goto done;
+        }
+        if (!opts->append) {
+            write_results_header(results, opts->perf, opts->log, opts->retry != NULL,
+                                 opts->auto_jobs);
+        }
+    }
+    if (opts->journal_file) {
+        retries.journal = fopen(opts->journal_file, opts->append ? "a" : "w");
+        if (!retries.journal) {
+            fprintf(stderr, "Error: cannot open journal %s\n", opts->journal_file);
+            goto done;
+        }
+        if (!opts->append) {
+            fprintf(retries.journal, "run_id,attempt,exit_code,wall_seconds,class,action\n");
+            fflush(retries.journal);
+        }
+    }
+    if (evloop_init(&loop) != 0) {
+        perror("Error: cannot set up the event loop");
+        goto done;
+    }
+    loop_ok = true;
+
+    /* Under -j auto the slots bound the controller's limit */
+    AimdController aimd;
+    aimd_init(&aimd, jobs);
+    size_t limit = opts->auto_jobs ? aimd.limit : jobs;
+    PressureSample sample;
+    if (opts->auto_jobs && pressure_sample(opts->proc_root, &sample) != 0) {
+        fprintf(stderr, "Warning: cannot read %s/pressure or %s/meminfo; -j auto will not throttle\n",
+                opts->proc_root, opts->proc_root);
+    } else if (opts->auto_jobs && !sample.psi) {
+        fprintf(stderr, "Warning: no pressure-stall information; -j auto uses MemAvailable only\n");
+    }
+
+    ProgressTracker progress;
+    progress_init(&progress, count, limit, opts->experiment, opts->metrics_file,
+                  opts->live_status ? stderr : NULL);
+    progress_update(&progress);
+
+    rc = 0;
+    size_t next = 0;
+    while (next < count || progress.in_flight > 0 || retries.count > 0) {
+        /* Fill free slots, retries whose backoff has passed first; under
+         * -j auto only while the host has headroom (an idle runner always
+         * admits one run so the campaign progresses) */
+        bool held = false;
+        while (progress.in_flight < limit) {
+            size_t r = retry_ready(&retries, progress_now());
+            if (r == SIZE_MAX && next >= count) break;
+
+            if (opts->auto_jobs && progress.in_flight > 0) {
+                pressure_sample(opts->proc_root, &sample);
+                if (pressure_overloaded(&sample)) {
+                    aimd_on_overload(&aimd, progress_now());
+                    limit = aimd.limit;
+                    progress_set_parallelism(&progress, limit);
+                    held = true;
+                    break;
+                }
+            }
+
+            size_t index;
+            if (r != SIZE_MAX) {
+                index = retries.index[r];
+                retries.count--;
+                retries.index[r] = retries.index[retries.count];
+                retries.ready[r] = retries.ready[retries.count];
+            } else {
+                index = next++;
+            }
+
+            size_t s = 0;
+            while (slots[s].pid != 0) s++;
+
+            /* Sequential only, so the previous run has been reaped; a failed
+             * launch stops the campaign and drains what is running */
+            if ((opts->hook_count > 0 && hooks_before_run(runs[index], opts, &hooks) != 0) ||
+                launch_run(&slots[s], s, runs, index, opts, &loop, log_started, &progress) != 0) {
+                rc = -1;
+                next = count;
+                retries.count = 0;
+                break;
+            }
+
+            slots[s].attempt = ++retries.attempts[index];
+            progress_run_started(&progress);
+            for (size_t t = 0; t < jobs; t++) {
+                if (slots[t].pid != 0 && slots[t].concurrency < progress.in_flight) {
+                    slots[t].concurrency = progress.in_flight;
+                }
+            }
+        }
+
+        /* While admission is held, re-sample every PRESSURE_POLL_MS so a drop
+         * in pressure is noticed before the next run finishes; with a free
+         * slot, wake when the next retry may start */
+        double wait = held ? PRESSURE_POLL_MS / 1000.0 : -1.0;
+        if (retries.count > 0 && progress.in_flight < limit) {
+            double until = retry_wait(&retries, progress_now());
+            if (wait < 0.0 || until < wait) wait = until;
+        }
+        if (progress.in_flight == 0 && retries.count == 0) break;
+
+        Event events[EVLOOP_BATCH];
+        int n = evloop_wait(&loop, events, EVLOOP_BATCH, wait);
+        if (n < 0) {
+            progress_clear_status(&progress);
+            perror("epoll_wait failed");
+            rc = -1;
+            break;
+        }
+        int finished = 0;
+        bool output_only = true;
+        for (int e = 0; e < n && rc == 0; e++) {
+            int reaped = 0;
+            if (events[e].kind == EVLOOP_OUTPUT) {
+                /* At end of file stop watching; the run's exit closes the pipe */
+                LogCapture *cap = &slots[events[e].slot].log;
+                if (cap->fd >= 0 && logcap_read(cap, opts->log) == 0) {
+                    evloop_unwatch(&loop, cap->fd);
+                }
+                continue;
+            }
+            output_only = false;
+            if (events[e].kind == EVLOOP_CHILD) {
+                reaped = reap_slot(&slots[events[e].slot], runs, opts, &loop, results,
+                                   &progress, &retries);
+            } else if (events[e].kind == EVLOOP_CHILDREN) {
+                reaped = reap_exited(slots, jobs, runs, opts, &loop, results, &progress,
+                                     &retries);
+            }
+            if (reaped < 0) {
+                progress_clear_status(&progress);
+                perror("waitpid failed");
+                rc = -1;
+            }
+            finished += reaped > 0 ? reaped : 0;
+        }
+        if (rc != 0) break;
+        /* One write per batch however many runs finished in it */
+        if (results) fflush(results);
+        if (retries.journal) fflush(retries.journal);
+
+        if (finished > 0 && opts->auto_jobs) {
+            pressure_sample(opts->proc_root, &sample);
+            bool overloaded = pressure_overloaded(&sample);
+            for (int k = 0; k < finished; k++) {
+                aimd_on_finish(&aimd, overloaded);
+            }
+            limit = aimd.limit;
+            progress_set_parallelism(&progress, limit);
+        }
+        if (!output_only) progress_update(&progress);
+    }
+
+    progress_finish(&progress);
+    if (opts->retry) {
+        printf("Retries: %zu attempt(s) retried, %zu run(s) recovered, %zu gave up\n",
+               progress.retried, retries.recovered, retries.exhausted);
+    }
+    if (opts->auto_jobs) {
+        printf("Concurrency: auto, peak limit %zu of %zu, final %zu, %zu decrease(s)\n",
+               aimd.peak, jobs, limit, aimd.decreases);
+    }
+    if (opts->hook_count > 0) {
+        hooks_finish(opts, &hooks);
+        printf("Hooks: %zu setup(s), %zu teardown(s)\n", hooks.setups, hooks.teardowns);
+    }
+
+done:
+    if (loop_ok) evloop_free(&loop);
+    if (results) fclose(results);
+    if (retries.journal) fclose(retries.journal);
+    for (size_t s = 0; slots && opts->log && s < jobs; s++) {
+        logcap_free(&slots[s].log);
+    }
+    free(slots);
+    free(log_started);
+    free(retries.attempts);
+    free(retries.index);
+    free(retries.ready);
+    return rc;
+}
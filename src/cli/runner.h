@@ -0,0 +1,89 @@
+#ifndef RUNNER_H
+#define RUNNER_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "include/taguchi.h"
+#include "perfcount.h"
+#include "logcap.h"
+#include "retry.h"
+
+#define RUNNER_MAX_HOOKS 256  /* At most one hook per factor */
+
+/*
+ * Commands run when a factor changes level between consecutive runs, e.g.
+ * rebuilding with other compiler flags.  Setup runs before the first run at
+ * a new level, teardown after the last run at the old one; both see the
+ * TAGUCHI_* environment of the run they belong to.
+ */
+typedef struct {
+    size_t factor_index;
+    const char *setup;         /* Shell command, or NULL */
+    const char *teardown;      /* Shell command, or NULL */
+} RunnerHook;
+
+/* Options for executing a campaign with `taguchi run` */
+typedef struct {
+    const char *script;        /* Shell command executed once per run */
+    const char *experiment;    /* Label for metrics (usually the .tgu path) */
+    size_t jobs;               /* Maximum concurrent runs (>= 1) */
+    bool auto_jobs;            /* Adapt concurrency to host pressure, up to jobs */
+    const char *proc_root;     /* Where pressure/ and meminfo live ("/proc") */
+    const char *metrics_file;  /* Prometheus textfile path, or NULL */
+    bool live_status;          /* Draw a live status line on stderr */
+    const char *results_file;  /* Per-run metrics CSV, or NULL */
+    const PerfCounterSet *perf; /* Counters attached to each run, or NULL */
+    const RunnerHook *hooks;   /* Level-change hooks (require jobs == 1) */
+    size_t hook_count;
+    const LogCaptureOptions *log; /* Capture run output, or NULL to inherit stdout */
+    const RetryPolicy *retry;  /* Retry failed attempts, or NULL */
+    const char *journal_file;  /* One CSV row per attempt, or NULL */
+    bool append;               /* Continue a campaign: append to results_file and
+                                * journal_file (no header) and to run logs */
+    /* Called in the parent as each run is reaped; counters is NULL without
+     * perf counters (may be NULL) */
+    void (*on_result)(void *user, size_t run_id, int exit_code, double wall_seconds,
+                      const uint64_t *counters, const bool *valid);
+    void *user;
+} RunnerOptions;
+
+/* Set defaults: sequential, no metrics file, no status line */
+void runner_options_init(RunnerOptions *opts);
+
+/*
+ * Execute every run via /bin/sh -c <script>, with TAGUCHI_RUN_ID and
+ * TAGUCHI_<factor> set in the child environment.  When results_file is set,
+ * one CSV row per run is written with run_id, exit_code, wall_seconds and
+ * one column per perf counter, ready for `taguchi analyze --metric`.
+ * Log metrics follow the counters (empty when a run never printed them),
+ * with a retry policy an "attempts" column counts the attempts each run
+ * took, and with auto_jobs a final "concurrency" column records the most
+ * runs that were in flight at once during each run.
+ *
+ * A failed attempt that the retry policy classifies as retryable is queued
+ * again after its backoff; other runs keep using the free slots meanwhile
+ * and only the final attempt reaches the results file.  journal_file gets
+ * every attempt: run_id, attempt, exit_code, wall_seconds, class (ok,
+ * retryable or permanent) and action (done, retry or give_up).
+ *
+ * With log capture a run's stdout and stderr go to a pipe instead of the
+ * terminal; a run that fails has the head and tail of its output printed
+ * to stderr.
+ *
+ * Between launches the runner sleeps in one EventLoop (evloop.h) that
+ * wakes on run exits, captured output and its own deadlines; results and
+ * journal rows are flushed once per batch of events.
+ *
+ * Runs start in the order given (retries when their backoff has passed,
+ * ahead of runs not yet started).  A failing setup hook stops the campaign
+ * (teardowns for levels already set up still run); a failing teardown only
+ * warns.
+ *
+ * Returns 0 when the campaign was carried out (individual runs may still
+ * have failed), -1 if runs could not be launched.
+ */
+int runner_execute(taguchi_experiment_run_t **runs, size_t count,
+                   const RunnerOptions *opts);
+
+#endif /* RUNNER_H */
@@ -0,0 +1,542 @@
+#define _GNU_SOURCE
+#include "simulate.h"
+#include "commands.h"
+#include "include/taguchi.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+
+#define SIM_MAX_INTERACTIONS 32
+
+/* Two-factor interaction: strength * c(a) * c(b), c() = level centred to [-1, 1] */
+typedef struct {
+    size_t a;
+    size_t b;
+    double strength;
+} SimInteraction;
+
+/* Ground-truth model and sampling parameters */
+typedef struct {
+    size_t factor_count;
+    size_t *level_counts;
+    double **effects;          /* effects[f][level], additive */
+    SimInteraction interactions[SIM_MAX_INTERACTIONS];
+    size_t interaction_count;
+    double base;               /* intercept */
+    double noise;              /* noise standard deviation at the intercept */
+    double hetero;             /* sd grows by this factor per unit |mean - base| */
+    double missing;            /* probability an observation is dropped */
+    size_t replicates;
+    uint64_t rng;
+    bool have_spare;
+    double spare;
+} SimModel;
+
+/* Design flattened to level indices, rows x factor_count */
+typedef struct {
+    size_t rows;
+    size_t *run_ids;
+    size_t *levels;
+} SimDesign;
+
+static void simulate_usage(void) {
+    fprintf(stderr,
+        "Usage: simulate <file.tgu> [--effect name=v1,v2,...] [--interaction a:b=strength]\n"
+        "                [--base B] [--scale S] [--noise SD] [--hetero K] [--missing P]\n"
+        "                [--replicates R] [--seed N] [--metric name] [--output file]\n"
+        "                [--check [--tolerance T]] [--bench N]\n");
+}
+
+/* splitmix64: small, fast and good enough for synthetic data */
+static uint64_t sim_next(SimModel *m) {
+    uint64_t z = (m->rng += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/* Uniform in [0, 1) */
+static double sim_uniform(SimModel *m) {
+    return (double)(sim_next(m) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* Standard normal via the polar Box-Muller method */
+static double sim_normal(SimModel *m) {
+    if (m->have_spare) {
+        m->have_spare = false;
+        return m->spare;
+    }
+    double u, v, s;
+    do {
+        u = 2.0 * sim_uniform(m) - 1.0;
+        v = 2.0 * sim_uniform(m) - 1.0;
+        s = u * u + v * v;
+    } while (s >= 1.0 || s == 0.0);
+    double scale = sqrt(-2.0 * log(s) / s);
+    m->spare = v * scale;
+    m->have_spare = true;
+    return u * scale;
+}
+
+static double centred_level(size_t level, size_t level_count) {
+    if (level_count < 2) return 0.0;
+    double half = (double)(level_count - 1) / 2.0;
+    return ((double)level - half) / half;
+}
+
+/* Expected response of one run (no noise) */
+static double sim_mean(const SimModel *m, const size_t *levels) {
+    double mu = m->base;
+    for (size_t f = 0; f < m->factor_count; f++) {
+        mu += m->effects[f][levels[f]];
+    }
+    for (size_t i = 0; i < m->interaction_count; i++) {
+        const SimInteraction *ix = &m->interactions[i];
+        mu += ix->strength *
+              centred_level(levels[ix->a], m->level_counts[ix->a]) *
+              centred_level(levels[ix->b], m->level_counts[ix->b]);
+    }
+    return mu;
+}
+
+/* One observation; returns false if it is missing */
+static bool sim_observe(SimModel *m, const size_t *levels, double *value) {
+    if (m->missing > 0.0 && sim_uniform(m) < m->missing) {
+        return false;
+    }
+    double mu = sim_mean(m, levels);
+    double sd = m->noise * (1.0 + m->hetero * fabs(mu - m->base));
+    *value = mu + sd * sim_normal(m);
+    return true;
+}
+
+static void sim_model_free(SimModel *m) {
+    if (m->effects) {
+        for (size_t f = 0; f < m->factor_count; f++) {
+            free(m->effects[f]);
+        }
+    }
+    free(m->effects);
+    free(m->level_counts);
+}
+
+static int factor_index(const taguchi_experiment_def_t *def, const char *name, size_t len) {
+    size_t count = taguchi_def_get_factor_count(def);
+    for (size_t f = 0; f < count; f++) {
+        const char *fname = taguchi_def_get_factor_name(def, f);
+        if (strlen(fname) == len && strncmp(fname, name, len) == 0) return (int)f;
+    }
+    return -1;
+}
+
+/* --effect name=v1,v2,... : one value per level */
+static int parse_effect(SimModel *m, const taguchi_experiment_def_t *def, const char *spec) {
+    const char *eq = strchr(spec, '=');
+    int f = eq ? factor_index(def, spec, (size_t)(eq - spec)) : -1;
+    if (f < 0) {
+        fprintf(stderr, "Error: invalid --effect '%s' (expected factor=v1,v2,...)\n", spec);
+        return -1;
+    }
+    size_t count = 0;
+    const char *p = eq + 1;
+    while (*p) {
+        char *end;
+        double v = strtod(p, &end);
+        if (end == p || count >= m->level_counts[f]) {
+            count = 0;
+            break;
+        }
+        m->effects[f][count++] = v;
+        p = (*end == ',') ? end + 1 : end;
+        if (*end != ',' && *end != '\0') {
+            count = 0;
+            break;
+        }
+    }
+    if (count != m->level_counts[f]) {
+        fprintf(stderr, "Error: --effect for '%s' needs %zu numeric values\n",
+                taguchi_def_get_factor_name(def, (size_t)f), m->level_counts[f]);
+        return -1;
+    }
+    return 0;
+}
+
+/* --interaction a:b=strength */
+static int parse_interaction(SimModel *m, const taguchi_experiment_def_t *def, const char *spec) {
+    const char *colon = strchr(spec, ':');
+    const char *eq = colon ? strchr(colon, '=') : NULL;
+    int a = colon ? factor_index(def, spec, (size_t)(colon - spec)) : -1;
+    int b = eq ? factor_index(def, colon + 1, (size_t)(eq - colon - 1)) : -1;
+    char *end = NULL;
+    double strength = eq ? strtod(eq + 1, &end) : 0.0;
+    if (a < 0 || b < 0 || a == b || end == eq + 1 || *end != '\0') {
+        fprintf(stderr, "Error: invalid --interaction '%s' (expected a:b=strength)\n", spec);
+        return -1;
+    }
+    if (m->interaction_count >= SIM_MAX_INTERACTIONS) {
+        fprintf(stderr, "Error: at most %d interactions are supported\n", SIM_MAX_INTERACTIONS);
+        return -1;
+    }
+    SimInteraction *ix = &m->interactions[m->interaction_count++];
+    ix->a = (size_t)a;
+    ix->b = (size_t)b;
+    ix->strength = strength;
+    return 0;
+}
+
+static int parse_double_opt(const char *opt, const char *arg, double lo, double hi, double *out) {
+    char *end;
+    double v = strtod(arg, &end);
+    if (end == arg || *end != '\0' || !(v >= lo && v <= hi)) {
+        fprintf(stderr, "Error: invalid value '%s' for %s\n", arg, opt);
+        return -1;
+    }
+    *out = v;
+    return 0;
+}
+
+static int parse_count_opt(const char *opt, const char *arg, size_t *out) {
+    char *end;
+    unsigned long long v = strtoull(arg, &end, 10);
+    if (end == arg || *end != '\0' || v < 1 || arg[0] == '-') {
+        fprintf(stderr, "Error: invalid value '%s' for %s\n", arg, opt);
+        return -1;
+    }
+    *out = (size_t)v;
+    return 0;
+}
+
+static int parse_seed_opt(const char *arg, uint64_t *out) {
+    char *end;
+    unsigned long long v = strtoull(arg, &end, 0);
+    if (end == arg || *end != '\0' || arg[0] == '-') {
+        fprintf(stderr, "Error: invalid value '%s' for --seed\n", arg);
+        return -1;
+    }
+    *out = (uint64_t)v;
+    return 0;
+}
+
+static int sim_design_build(const taguchi_experiment_def_t *def, SimDesign *d) {
+    taguchi_experiment_run_t **runs = NULL;
+    size_t count = 0;
+    char error[TAGUCHI_ERROR_SIZE];
+    if (taguchi_generate_runs(def, &runs, &count, error) != 0) {
+        fprintf(stderr, "Error generating runs: %s\n", error);
+        return -1;
+    }
+    size_t fc = taguchi_def_get_factor_count(def);
+    d->rows = count;
+    d->run_ids = malloc(count * sizeof(size_t));
+    d->levels = malloc(count * fc * sizeof(size_t) + 1);
+    if (!d->run_ids || !d->levels) {
+        fprintf(stderr, "Error: out of memory\n");
+        taguchi_free_runs(runs, count);
+        return -1;
+    }
+    for (size_t r = 0; r < count; r++) {
+        d->run_ids[r] = taguchi_run_get_id(runs[r]);
+        for (size_t f = 0; f < fc; f++) {
+            d->levels[r * fc + f] = taguchi_run_get_level_index(runs[r], f);
+        }
+    }
+    taguchi_free_runs(runs, count);
+    return 0;
+}
+
+/* Simulate every (run, replicate) into a result set; returns observations kept */
+static size_t simulate_into(SimModel *m, const SimDesign *d, taguchi_result_set_t *results) {
+    size_t kept = 0;
+    for (size_t rep = 0; rep < m->replicates; rep++) {
+        for (size_t r = 0; r < d->rows; r++) {
+            double value;
+            if (sim_observe(m, &d->levels[r * m->factor_count], &value)) {
+                taguchi_add_result(results, d->run_ids[r], value, NULL);
+                kept++;
+            }
+        }
+    }
+    return kept;
+}
+
+static int simulate_csv(SimModel *m, const SimDesign *d, const char *metric, const char *path) {
+    FILE *out = stdout;
+    if (path) {
+        out = fopen(path, "w");
+        if (!out) {
+            fprintf(stderr, "Error: cannot open output file %s\n", path);
+            return 1;
+        }
+        setvbuf(out, NULL, _IOFBF, 1 << 16);
+    }
+
+    fprintf(out, "run_id,%s\n", metric);
+    for (size_t rep = 0; rep < m->replicates; rep++) {
+        for (size_t r = 0; r < d->rows; r++) {
+            double value;
+            if (sim_observe(m, &d->levels[r * m->factor_count], &value)) {
+                fprintf(out, "%zu,%.6f\n", d->run_ids[r], value);
+            }
+        }
+    }
+    int rc = 0;
+    if (fflush(out) != 0) {
+        fprintf(stderr, "Error: failed writing simulated results\n");
+        rc = 1;
+    }
+    if (path) fclose(out);
+    return rc;
+}
+
+/* Compare centred estimated level means with the centred additive truth */
+static int simulate_check(SimModel *m, const SimDesign *d, const taguchi_experiment_def_t *def,
+                          const char *metric, double tolerance) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_result_set_t *results = taguchi_create_result_set(def, metric);
+    if (!results) {
+        fprintf(stderr, "Error creating result set\n");
+        return 1;
+    }
+    size_t kept = simulate_into(m, d, results);
+    size_t total = d->rows * m->replicates;
+
+    taguchi_main_effect_t **effects = NULL;
+    size_t effect_count = 0;
+    if (taguchi_calculate_main_effects(results, &effects, &effect_count, error) != 0) {
+        fprintf(stderr, "Error calculating effects: %s\n", error);
+        taguchi_free_result_set(results);
+        return 1;
+    }
+
+    printf("Ground truth recovery: %zu observations (%zu missing)\n", kept, total - kept);
+    printf("%-20s %10s %10s %10s   %s\n", "Factor", "True range", "Est range", "Max |err|", "Best level");
+    printf("%-20s %10s %10s %10s   %s\n", "------", "----------", "---------", "---------", "----------");
+
+    double worst = 0.0;
+    size_t mismatches = 0;
+    for (size_t f = 0; f < effect_count && f < m->factor_count; f++) {
+        size_t level_count = 0;
+        const double *means = taguchi_effect_get_level_means(effects[f], &level_count);
+        const double *truth = m->effects[f];
+
+        double true_mean = 0.0, est_mean = 0.0;
+        for (size_t lv = 0; lv < level_count; lv++) {
+            true_mean += truth[lv];
+            est_mean += means[lv];
+        }
+        true_mean /= (double)level_count;
+        est_mean /= (double)level_count;
+
+        double max_err = 0.0, true_lo = truth[0], true_hi = truth[0];
+        size_t est_best = 0;
+        for (size_t lv = 0; lv < level_count; lv++) {
+            double err = fabs((means[lv] - est_mean) - (truth[lv] - true_mean));
+            if (err > max_err) max_err = err;
+            if (truth[lv] < true_lo) true_lo = truth[lv];
+            if (truth[lv] > true_hi) true_hi = truth[lv];
+            if (means[lv] > means[est_best]) est_best = lv;
+        }
+        /* Ties in the truth: any level at the true maximum counts as recovered */
+        bool best_ok = truth[est_best] >= true_hi - 1e-12;
+        if (!best_ok) mismatches++;
+        if (max_err > worst) worst = max_err;
+
+        printf("%-20s %10.4f %10.4f %10.4f   L%zu %s\n",
+               taguchi_effect_get_factor(effects[f]), true_hi - true_lo,
+               taguchi_effect_get_range(effects[f]), max_err, est_best + 1,
+               best_ok ? "ok" : "MISMATCH");
+    }
+    printf("Largest level-effect error: %.4f; best level recovered for %zu/%zu factors\n",
+           worst, effect_count - mismatches, effect_count);
+
+    taguchi_free_effects(effects, effect_count);
+    taguchi_free_result_set(results);
+
+    if (tolerance >= 0.0 && worst > tolerance) {
+        fprintf(stderr, "Error: effect error %.4f exceeds tolerance %.4f\n", worst, tolerance);
+        return 1;
+    }
+    return 0;
+}
+
+static double sim_clock(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Repeatedly simulate and analyze to measure end-to-end throughput */
+static int simulate_bench(SimModel *m, const SimDesign *d, const taguchi_experiment_def_t *def,
+                          const char *metric, size_t iterations) {
+    char error[TAGUCHI_ERROR_SIZE];
+    size_t observations = 0;
+    double sim_seconds = 0.0, analyze_seconds = 0.0;
+
+    for (size_t it = 0; it < iterations; it++) {
+        taguchi_result_set_t *results = taguchi_create_result_set(def, metric);
+        if (!results) {
+            fprintf(stderr, "Error creating result set\n");
+            return 1;
+        }
+        double t0 = sim_clock();
+        observations += simulate_into(m, d, results);
+        double t1 = sim_clock();
+
+        taguchi_main_effect_t **effects = NULL;
+        size_t effect_count = 0;
+        int rc = taguchi_calculate_main_effects(results, &effects, &effect_count, error);
+        double t2 = sim_clock();
+        sim_seconds += t1 - t0;
+        analyze_seconds += t2 - t1;
+        if (rc != 0) {
+            fprintf(stderr, "Error calculating effects: %s\n", error);
+            taguchi_free_result_set(results);
+            return 1;
+        }
+        taguchi_free_effects(effects, effect_count);
+        taguchi_free_result_set(results);
+    }
+
+    double total = sim_seconds + analyze_seconds;
+    printf("Benchmark: %zu iterations, %zu runs x %zu replicates, %zu observations\n",
+           iterations, d->rows, m->replicates, observations);
+    printf("  simulate: %.6f s (%.0f observations/s)\n", sim_seconds,
+           sim_seconds > 0.0 ? (double)observations / sim_seconds : 0.0);
+    printf("  analyze:  %.6f s (%.0f analyses/s, %.0f observations/s)\n", analyze_seconds,
+           analyze_seconds > 0.0 ? (double)iterations / analyze_seconds : 0.0,
+           analyze_seconds > 0.0 ? (double)observations / analyze_seconds : 0.0);
+    printf("  total:    %.6f s\n", total);
+    return 0;
+}
+
+int cmd_simulate(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Error: simulate command requires .tgu file\n");
+        simulate_usage();
+        return 1;
+    }
+
+    const char *tgu_file = argv[1];
+    char *content = read_file_dynamic(tgu_file, stderr);
+    if (!content) return 1;
+
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(content, error);
+    free(content);
+    if (!def) {
+        fprintf(stderr, "Error parsing %s: %s\n", tgu_file, error);
+        return 1;
+    }
+
+    SimModel model;
+    memset(&model, 0, sizeof(model));
+    model.factor_count = taguchi_def_get_factor_count(def);
+    model.noise = 0.1;
+    model.replicates = 1;
+    model.level_counts = calloc(model.factor_count + 1, sizeof(size_t));
+    model.effects = calloc(model.factor_count + 1, sizeof(double *));
+    bool *explicit_effect = calloc(model.factor_count + 1, sizeof(bool));
+    SimDesign design;
+    memset(&design, 0, sizeof(design));
+    double scale = 1.0, tolerance = -1.0;
+    uint64_t seed = 1;
+    const char *metric = "response";
+    const char *output = NULL;
+    bool check = false;
+    size_t bench = 0;
+    int rc = 1;
+
+    if (!model.level_counts || !model.effects || !explicit_effect) {
+        fprintf(stderr, "Error: out of memory\n");
+        goto done;
+    }
+    for (size_t f = 0; f < model.factor_count; f++) {
+        model.level_counts[f] = taguchi_def_get_level_count(def, f);
+        model.effects[f] = calloc(model.level_counts[f] + 1, sizeof(double));
+        if (!model.effects[f]) {
+            fprintf(stderr, "Error: out of memory\n");
+            goto done;
+        }
+    }
+
+    for (int i = 2; i < argc; i++) {
+        const char *opt = argv[i];
+        const char *arg = (i + 1 < argc) ? argv[i + 1] : NULL;
+        int err = 0;
+        if (strcmp(opt, "--check") == 0) {
+            check = true;
+            continue;
+        }
+        if (!arg) {
+            fprintf(stderr, "Error: unknown simulate option '%s'\n", opt);
+            simulate_usage();
+            goto done;
+        }
+        if (strcmp(opt, "--effect") == 0) {
+            err = parse_effect(&model, def, arg);
+            const char *eq = strchr(arg, '=');
+            if (err == 0) explicit_effect[factor_index(def, arg, (size_t)(eq - arg))] = true;
+        } else if (strcmp(opt, "--interaction") == 0) {
+            err = parse_interaction(&model, def, arg);
+        } else if (strcmp(opt, "--base") == 0) {
+            err = parse_double_opt(opt, arg, -HUGE_VAL, HUGE_VAL, &model.base);
+        } else if (strcmp(opt, "--scale") == 0) {
+            err = parse_double_opt(opt, arg, 0.0, HUGE_VAL, &scale);
+        } else if (strcmp(opt, "--noise") == 0) {
+            err = parse_double_opt(opt, arg, 0.0, HUGE_VAL, &model.noise);
+        } else if (strcmp(opt, "--hetero") == 0) {
+            err = parse_double_opt(opt, arg, 0.0, HUGE_VAL, &model.hetero);
+        } else if (strcmp(opt, "--missing") == 0) {
+            err = parse_double_opt(opt, arg, 0.0, 0.99, &model.missing);
+        } else if (strcmp(opt, "--seed") == 0) {
+            err = parse_seed_opt(arg, &seed);
+        } else if (strcmp(opt, "--tolerance") == 0) {
+            err = parse_double_opt(opt, arg, 0.0, HUGE_VAL, &tolerance);
+        } else if (strcmp(opt, "--replicates") == 0) {
+            err = parse_count_opt(opt, arg, &model.replicates);
+        } else if (strcmp(opt, "--bench") == 0) {
+            err = parse_count_opt(opt, arg, &bench);
+        } else if (strcmp(opt, "--metric") == 0) {
+            metric = arg;
+        } else if (strcmp(opt, "--output") == 0) {
+            output = arg;
+        } else {
+            fprintf(stderr, "Error: unknown simulate option '%s'\n", opt);
+            simulate_usage();
+            goto done;
+        }
+        if (err != 0) goto done;
+        i++;
+    }
+
+    /* Factors without an explicit --effect get seeded random level effects */
+    model.rng = seed;
+    for (size_t f = 0; f < model.factor_count; f++) {
+        if (explicit_effect[f]) continue;
+        for (size_t lv = 0; lv < model.level_counts[f]; lv++) {
+            model.effects[f][lv] = scale * (2.0 * sim_uniform(&model) - 1.0);
+        }
+    }
+
+    if (sim_design_build(def, &design) != 0) goto done;
+
+    if (bench > 0) {
+        rc = simulate_bench(&model, &design, def, metric, bench);
+    } else if (check) {
+        rc = simulate_check(&model, &design, def, metric, tolerance);
+    } else {
+        rc = simulate_csv(&model, &design, metric, output);
+    }
+
+done:
+    free(design.run_ids);
+    free(design.levels);
+    free(explicit_effect);
+    sim_model_free(&model);
+    taguchi_free_definition(def);
+    return rc;
+}
@@ -0,0 +1,16 @@
+#ifndef SIMULATE_H
+#define SIMULATE_H
+
+/*
+ * `taguchi simulate <file.tgu> [options]`
+ *
+ * Produces synthetic responses for every run of a design from a known
+ * ground-truth model: per-level additive effects, pairwise interactions,
+ * heteroscedastic Gaussian noise and randomly missing observations.
+ * Responses are written as a results CSV, or fed straight into the effects
+ * engine to check that the estimated effects recover the truth (--check)
+ * or to measure analysis throughput (--bench N).
+ */
+int cmd_simulate(int argc, char *argv[]);
+
+#endif /* SIMULATE_H */
@@ -1,10 +1,12 @@
 #include "analyzer.h"
 #include "utils.h"
 #include "arrays.h"
+#include "context.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <float.h>
+#include <math.h>
 
 /* Create result set for collecting experimental data */
 ResultSet *create_result_set(const ExperimentDef *def, const char *metric_name) {
@@ -71,95 +73,143 @@ void free_result_set(ResultSet *results) {
     }
 }
 
+/* Shared state for computing effects of a range of factors */
+typedef struct {
+    taguchi_context_t *ctx;
+    const ResultSet *results;
+    const CompiledDesign *design;
+    const size_t *run_counts;       /* Results per run (replicates) */
+    MainEffect *effects;
+} EffectsJob;
+
+/* Level means and range of one factor */
+static void compute_factor_effect(const EffectsJob *job, size_t factor_idx) {
+    const ResultSet *results = job->results;
+    const ExperimentDef *def = results->experiment_def;
+    const CompiledDesign *design = job->design;
+    size_t run_count = design->rows;
+
+    MainEffect *effect = &job->effects[factor_idx];
+    memset(effect, 0, sizeof(MainEffect));
+
+    const Factor *factor = &def->factors[factor_idx];
+    strcpy(effect->factor_name, factor->name);
+    effect->level_count = factor->level_count;
+    effect->level_means = xmalloc(factor->level_count * sizeof(double));
+
+    /* Each run weighs the same however often it was replicated, so level
+     * means are averages of run means and unequal replication does not
+     * tilt them towards the levels of heavily replicated runs */
+    double *level_sums = context_calloc(job->ctx, factor->level_count, sizeof(double));
+    double *level_weights = context_calloc(job->ctx, factor->level_count, sizeof(double));
+
+    /* For each result, find the corresponding run and determine
+       which level of this factor was used */
+    for (size_t result_idx = 0; result_idx < results->count; result_idx++) {
+        size_t run_id = results->run_ids[result_idx];
+        double response = results->responses[result_idx];
+
+        /* Find the run with this ID (runs are 1-indexed) */
+        if (run_id < 1 || run_id > run_count) continue;
+        const uint8_t *row = &design->levels[(run_id - 1) * design->factor_count];
+
+        /* Use the stored OA level index directly.
+         * String matching would pick the first occurrence of a duplicate
+         * value string, leaving other buckets at 0.  The level index is
+         * the authoritative bucket regardless of repeated value strings. */
+        size_t lv = row[factor_idx];
+        if (lv < factor->level_count) {
+            double weight = 1.0 / (double)job->run_counts[run_id - 1];
+            level_sums[lv] += response * weight;
+            level_weights[lv] += weight;
+        }
+    }
+
+    /* Calculate means for each level */
+    for (size_t lv = 0; lv < factor->level_count; lv++) {
+        if (level_weights[lv] > 0.0) {
+            effect->level_means[lv] = level_sums[lv] / level_weights[lv];
+        } else {
+            effect->level_means[lv] = 0.0;
+        }
+    }
+
+    /* Calculate range (max - min) */
+    if (factor->level_count > 0) {
+        double min_val = effect->level_means[0];
+        double max_val = effect->level_means[0];
+        for (size_t lv = 1; lv < factor->level_count; lv++) {
+            if (effect->level_means[lv] < min_val) min_val = effect->level_means[lv];
+            if (effect->level_means[lv] > max_val) max_val = effect->level_means[lv];
+        }
+        effect->range = max_val - min_val;
+    }
+
+    context_free(job->ctx, level_sums);
+    context_free(job->ctx, level_weights);
+}
+
+static void effects_chunk(void *arg, size_t begin, size_t end) {
+    for (size_t factor_idx = begin; factor_idx < end; factor_idx++) {
+        compute_factor_effect(arg, factor_idx);
+    }
+}
+
 /*
  * Calculate main effects from results and experiment design.
  *
- * This regenerates the experiment runs from the stored definition to
- * determine which level of each factor was used in each run, then
- * groups responses by factor level and computes means.
+ * This compiles (or loads from the design cache) the level-index matrix
+ * of the stored definition to determine which level of each factor was
+ * used in each run, then groups responses by factor level and computes
+ * means (of run means, when runs were replicated).  Factors are independent and are spread over the context's pool.
  */
-int calculate_main_effects(const ResultSet *results, MainEffect **effects_out, size_t *count_out) {
+int calculate_main_effects_in(taguchi_context_t *ctx, const ResultSet *results,
+                              MainEffect **effects_out, size_t *count_out) {
     if (!results || !effects_out || !count_out || !results->experiment_def) {
         return -1;
     }
 
     const ExperimentDef *def = results->experiment_def;
 
-    /* Regenerate the runs to get the factor-level mapping */
-    ExperimentRun *runs = NULL;
-    size_t run_count = 0;
+    /* Only the level-index matrix is needed, not fully materialized runs */
+    CompiledDesign design;
     char error_buf[256];
-    if (generate_experiments(def, &runs, &run_count, error_buf) != 0) {
+    if (acquire_design(ctx, def, &design, error_buf) != 0) {
         return -1;
     }
 
-    /* Create effects array - one per factor */
-    MainEffect *effects = xmalloc(def->factor_count * sizeof(MainEffect));
-
-    for (size_t factor_idx = 0; factor_idx < def->factor_count; factor_idx++) {
-        MainEffect *effect = &effects[factor_idx];
-        memset(effect, 0, sizeof(MainEffect));
-
-        const Factor *factor = &def->factors[factor_idx];
-        strcpy(effect->factor_name, factor->name);
-        effect->level_count = factor->level_count;
-        effect->level_means = xmalloc(factor->level_count * sizeof(double));
-
-        double *level_sums = xcalloc(factor->level_count, sizeof(double));
-        size_t *level_counts = xcalloc(factor->level_count, sizeof(size_t));
-
-        /* For each result, find the corresponding run and determine
-           which level of this factor was used */
-        for (size_t result_idx = 0; result_idx < results->count; result_idx++) {
-            size_t run_id = results->run_ids[result_idx];
-            double response = results->responses[result_idx];
-
-            /* Find the run with this ID (runs are 1-indexed) */
-            if (run_id < 1 || run_id > run_count) continue;
-            const ExperimentRun *run = &runs[run_id - 1];
-
-            /* Use the stored OA level index directly.
-             * String matching would pick the first occurrence of a duplicate
-             * value string, leaving other buckets at 0.  The level index is
-             * the authoritative bucket regardless of repeated value strings. */
-            size_t lv = run->level_indices[factor_idx];
-            if (lv < factor->level_count) {
-                level_sums[lv] += response;
-                level_counts[lv]++;
-            }
-        }
+    size_t *run_counts = xcalloc(design.rows + 1, sizeof(size_t));
+    for (size_t i = 0; i < results->count; i++) {
+        size_t run_id = results->run_ids[i];
+        if (run_id >= 1 && run_id <= design.rows) run_counts[run_id - 1]++;
+    }
 
-        /* Calculate means for each level */
-        for (size_t lv = 0; lv < factor->level_count; lv++) {
-            if (level_counts[lv] > 0) {
-                effect->level_means[lv] = level_sums[lv] / (double)level_counts[lv];
-            } else {
-                effect->level_means[lv] = 0.0;
-            }
-        }
+    /* Create effects array - one per factor */
+    MainEffect *effects = xmalloc(def->factor_count * sizeof(MainEffect) + 1);
 
-        /* Calculate range (max - min) */
-        if (factor->level_count > 0) {
-            double min_val = effect->level_means[0];
-            double max_val = effect->level_means[0];
-            for (size_t lv = 1; lv < factor->level_count; lv++) {
-                if (effect->level_means[lv] < min_val) min_val = effect->level_means[lv];
-                if (effect->level_means[lv] > max_val) max_val = effect->level_means[lv];
-            }
-            effect->range = max_val - min_val;
-        }
+    EffectsJob job;
+    job.ctx = ctx;
+    job.results = results;
+    job.design = &design;
+    job.run_counts = run_counts;
+    job.effects = effects;
 
-        free(level_sums);
-        free(level_counts);
-    }
+    /* Each chunk should scan at least ~16K results to be worth a task */
+    size_t grain = 16384 / (results->count + 1) + 1;
+    context_parallel_for(ctx, def->factor_count, grain, effects_chunk, &job);
 
-    free_experiments(runs, run_count);
+    free(run_counts);
+    free_compiled_design(&design);
 
     *effects_out = effects;
     *count_out = def->factor_count;
     return 0;
 }
 
+int calculate_main_effects(const ResultSet *results, MainEffect **effects_out, size_t *count_out) {
+    return calculate_main_effects_in(NULL, results, effects_out, count_out);
+}
+
 /* Free main effects */
 void free_main_effects(MainEffect *effects, size_t count) {
     if (effects) {
@@ -183,12 +233,14 @@ int recommend_optimal_levels(const MainEffect *effects, size_t effect_count,
         const MainEffect *effect = &effects[i];
         if (effect->level_count == 0) continue;
 
+        /* NAN marks a level a conditional analysis saw no runs of */
         size_t best_idx = 0;
         double best_val = effect->level_means[0];
         for (size_t lv = 1; lv < effect->level_count; lv++) {
-            bool is_better = higher_is_better
+            if (isnan(effect->level_means[lv])) continue;
+            bool is_better = isnan(best_val) || (higher_is_better
                 ? (effect->level_means[lv] > best_val)
-                : (effect->level_means[lv] < best_val);
+                : (effect->level_means[lv] < best_val));
             if (is_better) {
                 best_val = effect->level_means[lv];
                 best_idx = lv;
@@ -46,6 +46,14 @@ int calculate_main_effects(
     size_t *count_out
 );
 
+/* Same, scheduling work on ctx (NULL = default context) */
+int calculate_main_effects_in(
+    taguchi_context_t *ctx,
+    const ResultSet *results,
+    MainEffect **effects_out,
+    size_t *count_out
+);
+
 /* Free main effects */
 void free_main_effects(MainEffect *effects, size_t count);
 
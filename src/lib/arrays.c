@@ -1,9 +1,11 @@
+#define _POSIX_C_SOURCE 200809L
 #include "arrays.h"
 #include "utils.h"
 #include <string.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <math.h>
+#include <pthread.h>
 
 /* Predefined arrays (const static data) */
 
@@ -276,14 +278,12 @@ static const OrthogonalArray static_arrays[] = {
 #define MAX_ARRAYS 21
 static OrthogonalArray all_arrays[MAX_ARRAYS];
 static size_t all_arrays_count = 0;
-static bool arrays_initialized = false;
+static pthread_once_t arrays_once = PTHREAD_ONCE_INIT;
 
 static const char *array_names[MAX_ARRAYS + 1];
 
-/* Initialize generated arrays on first use */
-static void ensure_arrays_initialized(void) {
-    if (arrays_initialized) return;
-
+/* Build the catalog; runs exactly once per process */
+static void init_arrays(void) {
     /* Copy static arrays */
     for (size_t i = 0; i < NUM_STATIC_ARRAYS; i++) {
         all_arrays[i] = static_arrays[i];
@@ -419,8 +419,14 @@ static void ensure_arrays_initialized(void) {
         array_names[i] = all_arrays[i].name;
     }
     array_names[all_arrays_count] = NULL;
+}
 
-    arrays_initialized = true;
+/*
+ * Initialize generated arrays on first use.  The catalog is shared by every
+ * thread in the process, so initialization goes through pthread_once.
+ */
+static void ensure_arrays_initialized(void) {
+    pthread_once(&arrays_once, init_arrays);
 }
 
 const OrthogonalArray *get_array(const char *name) {
@@ -0,0 +1,217 @@
+#include "bitmap.h"
+#include "context.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* GCC and Clang lower these to POPCNT / TZCNT where the target has them */
+#if defined(__GNUC__) || defined(__clang__)
+#define popcount64(x) ((size_t)__builtin_popcountll(x))
+#define ctz64(x) ((size_t)__builtin_ctzll(x))
+#else
+static size_t popcount64(uint64_t x) {
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (size_t)((x * 0x0101010101010101ULL) >> 56);
+}
+
+static size_t ctz64(uint64_t x) {
+    return popcount64((x & (0 - x)) - 1);
+}
+#endif
+
+/* Shared state for filling the bitsets of a range of factors */
+typedef struct {
+    const CompiledDesign *design;
+    RunIndex *index;
+} BuildJob;
+
+static void build_factors(void *arg, size_t begin, size_t end) {
+    const BuildJob *job = arg;
+    const CompiledDesign *design = job->design;
+    RunIndex *index = job->index;
+
+    /* Each factor owns its bitsets, so factors fill in parallel */
+    for (size_t f = begin; f < end; f++) {
+        size_t level_count = index->def->factors[f].level_count;
+        uint64_t *factor_bits = index->bits + index->first[f] * index->words;
+        for (size_t r = 0; r < design->rows; r++) {
+            size_t lv = design->levels[r * design->factor_count + f];
+            if (lv >= level_count) continue;
+            factor_bits[lv * index->words + r / BITSET_WORD_BITS] |=
+                UINT64_C(1) << (r % BITSET_WORD_BITS);
+        }
+    }
+}
+
+int run_index_build(taguchi_context_t *ctx, const ExperimentDef *def, RunIndex *index,
+                    char *error_buf) {
+    memset(index, 0, sizeof(*index));
+    if (!def) {
+        set_error(error_buf, "Invalid parameters to run_index_build");
+        return -1;
+    }
+
+    CompiledDesign design;
+    if (acquire_design(ctx, def, &design, error_buf) != 0) {
+        return -1;
+    }
+
+    size_t bitsets = 0;
+    for (size_t f = 0; f < def->factor_count; f++) {
+        index->first[f] = bitsets;
+        bitsets += def->factors[f].level_count;
+    }
+    index->def = def;
+    index->rows = design.rows;
+    index->words = BITSET_WORDS(design.rows);
+    index->bits = xcalloc(bitsets * index->words + 1, sizeof(uint64_t));
+
+    BuildJob job;
+    job.design = &design;
+    job.index = index;
+    context_parallel_for(ctx, def->factor_count, 65536 / (design.rows + 1) + 1, build_factors,
+                         &job);
+
+    free_compiled_design(&design);
+    return 0;
+}
+
+void run_index_free(RunIndex *index) {
+    if (!index) return;
+    free(index->bits);
+    index->bits = NULL;
+}
+
+const uint64_t *run_index_level(const RunIndex *index, size_t factor, size_t level) {
+    if (!index || factor >= index->def->factor_count) return NULL;
+    if (level >= index->def->factors[factor].level_count) return NULL;
+    return index->bits + (index->first[factor] + level) * index->words;
+}
+
+int run_index_select(const RunIndex *index, const char *factor, const char *value,
+                     uint64_t *out, char *error_buf) {
+    if (!index || !factor || !value || !out) {
+        set_error(error_buf, "Invalid parameters to run_index_select");
+        return -1;
+    }
+    const ExperimentDef *def = index->def;
+    for (size_t f = 0; f < def->factor_count; f++) {
+        if (strcmp(def->factors[f].name, factor) != 0) continue;
+
+        /* A value may be repeated across levels; take all of them */
+        bool found = false;
+        memset(out, 0, index->words * sizeof(uint64_t));
+        for (size_t lv = 0; lv < def->factors[f].level_count; lv++) {
+            if (strcmp(def->factors[f].values[lv], value) != 0) continue;
+            bitset_or(out, run_index_level(index, f, lv), index->words);
+            found = true;
+        }
+        if (!found) {
+            set_error(error_buf, "Factor '%s' has no level '%s'", factor, value);
+            return -1;
+        }
+        return 0;
+    }
+    set_error(error_buf, "Unknown factor '%s'", factor);
+    return -1;
+}
+
+void bitset_and(uint64_t *dst, const uint64_t *src, size_t words) {
+    for (size_t w = 0; w < words; w++) dst[w] &= src[w];
+}
+
+void bitset_or(uint64_t *dst, const uint64_t *src, size_t words) {
+    for (size_t w = 0; w < words; w++) dst[w] |= src[w];
+}
+
+size_t bitset_count(const uint64_t *bits, size_t words) {
+    size_t count = 0;
+    for (size_t w = 0; w < words; w++) count += popcount64(bits[w]);
+    return count;
+}
+
+size_t bitset_runs(const uint64_t *bits, size_t words, size_t *ids_out, size_t max_ids) {
+    size_t count = 0;
+    for (size_t w = 0; w < words; w++) {
+        for (uint64_t m = bits[w]; m; m &= m - 1) {
+            if (count < max_ids) ids_out[count] = w * BITSET_WORD_BITS + ctz64(m) + 1;
+            count++;
+        }
+    }
+    return count;
+}
+
+int conditional_main_effects(const ResultSet *results, const RunIndex *index,
+                             const uint64_t *subset, MainEffect **effects_out,
+                             size_t *count_out, char *error_buf) {
+    if (!results || !index || !subset || !effects_out || !count_out) {
+        set_error(error_buf, "Invalid parameters to conditional_main_effects");
+        return -1;
+    }
+    if (results->experiment_def != index->def) {
+        set_error(error_buf, "Result set and run index belong to different definitions");
+        return -1;
+    }
+
+    /* Run means, and the subset narrowed to runs that have any results */
+    size_t rows = index->rows;
+    size_t words = index->words;
+    size_t *n = xcalloc(rows + 1, sizeof(size_t));
+    double *mean = xcalloc(rows + 1, sizeof(double));
+    uint64_t *selected = xcalloc(words + 1, sizeof(uint64_t));
+    for (size_t i = 0; i < results->count; i++) {
+        size_t run_id = results->run_ids[i];
+        if (run_id < 1 || run_id > rows) continue;
+        n[run_id - 1]++;
+        mean[run_id - 1] += results->responses[i];
+    }
+    for (size_t r = 0; r < rows; r++) {
+        if (n[r] == 0) continue;
+        mean[r] /= (double)n[r];
+        selected[r / BITSET_WORD_BITS] |= UINT64_C(1) << (r % BITSET_WORD_BITS);
+    }
+    bitset_and(selected, subset, words);
+
+    const ExperimentDef *def = index->def;
+    MainEffect *effects = xmalloc(def->factor_count * sizeof(MainEffect) + 1);
+    for (size_t f = 0; f < def->factor_count; f++) {
+        MainEffect *effect = &effects[f];
+        memset(effect, 0, sizeof(MainEffect));
+        strcpy(effect->factor_name, def->factors[f].name);
+        effect->level_count = def->factors[f].level_count;
+        effect->level_means = xmalloc(effect->level_count * sizeof(double) + 1);
+
+        double lo = INFINITY, hi = -INFINITY;
+        for (size_t lv = 0; lv < effect->level_count; lv++) {
+            const uint64_t *level_bits = run_index_level(index, f, lv);
+            size_t runs = 0;
+            double sum = 0.0;
+            for (size_t w = 0; w < words; w++) {
+                uint64_t m = selected[w] & level_bits[w];
+                runs += popcount64(m);
+                while (m) {
+                    sum += mean[w * BITSET_WORD_BITS + ctz64(m)];
+                    m &= m - 1;
+                }
+            }
+            if (runs == 0) {
+                effect->level_means[lv] = NAN;
+                continue;
+            }
+            effect->level_means[lv] = sum / (double)runs;
+            if (effect->level_means[lv] < lo) lo = effect->level_means[lv];
+            if (effect->level_means[lv] > hi) hi = effect->level_means[lv];
+        }
+        effect->range = hi >= lo ? hi - lo : 0.0;
+    }
+
+    free(n);
+    free(mean);
+    free(selected);
+    *effects_out = effects;
+    *count_out = def->factor_count;
+    return 0;
+}
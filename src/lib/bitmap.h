@@ -0,0 +1,62 @@
+#ifndef BITMAP_H
+#define BITMAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "analyzer.h"    // For ResultSet, MainEffect
+
+/*
+ * Bitmap inverted index over a compiled design.
+ *
+ * Every (factor, level) pair gets a bitset of the runs that use it, bit r
+ * standing for run r + 1, in words of 64 runs.  Slicing the design is then
+ * a matter of ANDing and ORing bitsets, and the number of runs in a slice
+ * is a popcount.  Conditional main effects intersect a subset with each
+ * level's bitset and sum run means over the set bits only.
+ */
+
+#define BITSET_WORD_BITS 64
+
+/* Words needed for a bitset of n runs */
+#define BITSET_WORDS(n) (((n) + BITSET_WORD_BITS - 1) / BITSET_WORD_BITS)
+
+typedef struct {
+    const ExperimentDef *def;
+    size_t rows;                     /* runs in the design */
+    size_t words;                    /* uint64_t words per bitset */
+    size_t first[MAX_FACTORS];       /* bitset number of each factor's level 0 */
+    uint64_t *bits;                  /* one bitset per (factor, level) */
+} RunIndex;
+
+/* Build the index of def's design; def must outlive it */
+int run_index_build(taguchi_context_t *ctx, const ExperimentDef *def, RunIndex *index,
+                    char *error_buf);
+void run_index_free(RunIndex *index);
+
+/* Runs using level of factor, or NULL if either is out of range */
+const uint64_t *run_index_level(const RunIndex *index, size_t factor, size_t level);
+
+/* Runs whose value of the named factor is value (every level spelled so);
+ * returns -1 if there is no such factor or value */
+int run_index_select(const RunIndex *index, const char *factor, const char *value,
+                     uint64_t *out, char *error_buf);
+
+void bitset_and(uint64_t *dst, const uint64_t *src, size_t words);
+void bitset_or(uint64_t *dst, const uint64_t *src, size_t words);
+size_t bitset_count(const uint64_t *bits, size_t words);
+
+/* Run IDs in bits, ascending, up to max_ids of them; returns the total */
+size_t bitset_runs(const uint64_t *bits, size_t words, size_t *ids_out, size_t max_ids);
+
+/* Main effects over the runs in subset only.  Levels without results in
+ * the subset get a NAN mean and are left out of the range. */
+int conditional_main_effects(
+    const ResultSet *results,
+    const RunIndex *index,
+    const uint64_t *subset,
+    MainEffect **effects_out,
+    size_t *count_out,
+    char *error_buf
+);
+
+#endif /* BITMAP_H */
@@ -0,0 +1,172 @@
+#include "changeover.h"
+#include "utils.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Work budgets (distance evaluations) for the heuristic: small designs get
+ * nearest neighbour from every row and 2-opt to a local optimum, the
+ * largest arrays (thousands of runs) a few starts and a bounded number of
+ * 2-opt passes.
+ */
+#define CHANGEOVER_START_BUDGET ((size_t)1 << 25)
+#define CHANGEOVER_PASS_BUDGET ((size_t)1 << 27)
+
+/* Levels of the costly factors only, packed rows x k for the inner loops */
+typedef struct {
+    size_t n;
+    size_t k;
+    uint8_t *cells;
+    double weights[MAX_FACTORS];
+} CostModel;
+
+static double model_distance(const CostModel *m, size_t a, size_t b) {
+    const uint8_t *ra = &m->cells[a * m->k];
+    const uint8_t *rb = &m->cells[b * m->k];
+    double d = 0.0;
+    for (size_t f = 0; f < m->k; f++) {
+        if (ra[f] != rb[f]) d += m->weights[f];
+    }
+    return d;
+}
+
+double changeover_distance(const ExperimentDef *def, const CompiledDesign *design,
+                           size_t a, size_t b) {
+    const uint8_t *ra = &design->levels[a * design->factor_count];
+    const uint8_t *rb = &design->levels[b * design->factor_count];
+    double d = 0.0;
+    for (size_t f = 0; f < design->factor_count; f++) {
+        if (ra[f] != rb[f]) d += def->factors[f].changeover_cost;
+    }
+    return d;
+}
+
+double changeover_path_cost(const ExperimentDef *def, const CompiledDesign *design,
+                            const size_t *order, size_t count) {
+    double cost = 0.0;
+    for (size_t i = 1; i < count; i++) {
+        cost += changeover_distance(def, design, order[i - 1], order[i]);
+    }
+    return cost;
+}
+
+/* Greedy path from start: always move to the cheapest unvisited row */
+static double nearest_neighbour(const CostModel *m, size_t start, size_t *path, bool *used) {
+    memset(used, 0, m->n * sizeof(bool));
+    path[0] = start;
+    used[start] = true;
+    double cost = 0.0;
+
+    for (size_t i = 1; i < m->n; i++) {
+        size_t best = 0;
+        double best_d = -1.0;
+        for (size_t j = 0; j < m->n; j++) {
+            if (used[j]) continue;
+            double d = model_distance(m, path[i - 1], j);
+            if (best_d < 0.0 || d < best_d) {
+                best = j;
+                best_d = d;
+                if (d == 0.0) break;   /* cannot do better; lowest index wins ties */
+            }
+        }
+        path[i] = best;
+        used[best] = true;
+        cost += best_d;
+    }
+    return cost;
+}
+
+static void reverse_segment(size_t *path, size_t i, size_t j) {
+    while (i < j) {
+        size_t tmp = path[i];
+        path[i++] = path[j];
+        path[j--] = tmp;
+    }
+}
+
+/* 2-opt for an open path: reverse path[i..j] whenever that shortens it */
+static void two_opt(const CostModel *m, size_t *path, size_t max_passes) {
+    size_t n = m->n;
+    for (size_t pass = 0; pass < max_passes; pass++) {
+        bool improved = false;
+        for (size_t i = 0; i + 1 < n; i++) {
+            for (size_t j = i + 1; j < n; j++) {
+                double before = 0.0, after = 0.0;
+                if (i > 0) {
+                    before += model_distance(m, path[i - 1], path[i]);
+                    after += model_distance(m, path[i - 1], path[j]);
+                }
+                if (j + 1 < n) {
+                    before += model_distance(m, path[j], path[j + 1]);
+                    after += model_distance(m, path[i], path[j + 1]);
+                }
+                if (after + 1e-9 < before) {
+                    reverse_segment(path, i, j);
+                    improved = true;
+                }
+            }
+        }
+        if (!improved) break;
+    }
+}
+
+double changeover_order(const ExperimentDef *def, const CompiledDesign *design, size_t *order) {
+    size_t n = design->rows;
+    for (size_t i = 0; i < n; i++) {
+        order[i] = i;
+    }
+
+    CostModel m;
+    memset(&m, 0, sizeof(m));
+    m.n = n;
+    size_t costly[MAX_FACTORS];
+    for (size_t f = 0; f < design->factor_count; f++) {
+        if (def->factors[f].changeover_cost > 0.0) {
+            costly[m.k] = f;
+            m.weights[m.k] = def->factors[f].changeover_cost;
+            m.k++;
+        }
+    }
+    if (m.k == 0 || n < 3) {
+        return changeover_path_cost(def, design, order, n);
+    }
+
+    m.cells = xmalloc(n * m.k);
+    for (size_t r = 0; r < n; r++) {
+        const uint8_t *row = &design->levels[r * design->factor_count];
+        for (size_t c = 0; c < m.k; c++) {
+            m.cells[r * m.k + c] = row[costly[c]];
+        }
+    }
+
+    size_t *path = xmalloc(n * sizeof(size_t));
+    size_t *best_path = xmalloc(n * sizeof(size_t));
+    bool *used = xmalloc(n * sizeof(bool));
+    size_t per_pass = n * n;
+    size_t starts = CHANGEOVER_START_BUDGET / per_pass;
+    if (starts < 1) starts = 1;
+    if (starts > n) starts = n;
+    size_t max_passes = CHANGEOVER_PASS_BUDGET / per_pass;
+    if (max_passes < 1) max_passes = 1;
+
+    /* Array order is the baseline a start must beat */
+    memcpy(best_path, order, n * sizeof(size_t));
+    double best_cost = changeover_path_cost(def, design, order, n);
+    for (size_t s = 0; s < starts; s++) {
+        double cost = nearest_neighbour(&m, s * n / starts, path, used);
+        if (cost < best_cost) {
+            best_cost = cost;
+            memcpy(best_path, path, n * sizeof(size_t));
+        }
+    }
+    two_opt(&m, best_path, max_passes);
+    memcpy(order, best_path, n * sizeof(size_t));
+
+    free(used);
+    free(best_path);
+    free(path);
+    free(m.cells);
+    return changeover_path_cost(def, design, order, n);
+}
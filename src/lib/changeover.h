@@ -0,0 +1,33 @@
+#ifndef CHANGEOVER_H
+#define CHANGEOVER_H
+
+#include <stddef.h>
+#include "parser.h"      // For ExperimentDef
+#include "generator.h"   // For CompiledDesign
+
+/*
+ * Run ordering for hard-to-change factors.
+ *
+ * Moving from one run to the next costs the sum of changeover_cost over the
+ * factors whose level differs (a weighted Hamming distance between rows of
+ * the level matrix).  Ordering runs to minimise the total is an open-path
+ * travelling-salesman problem; it is solved heuristically with nearest
+ * neighbour construction from every start row followed by 2-opt.
+ */
+
+/* Cost of going from design row a to design row b */
+double changeover_distance(const ExperimentDef *def, const CompiledDesign *design,
+                           size_t a, size_t b);
+
+/* Total cost of visiting design rows in the given order */
+double changeover_path_cost(const ExperimentDef *def, const CompiledDesign *design,
+                            const size_t *order, size_t count);
+
+/*
+ * Fill order[0..design->rows) with a permutation of design rows that keeps
+ * the total changeover cost low.  With no costly factor the array order is
+ * kept.  Returns the cost of the chosen order.
+ */
+double changeover_order(const ExperimentDef *def, const CompiledDesign *design, size_t *order);
+
+#endif /* CHANGEOVER_H */
@@ -0,0 +1,487 @@
+#define _POSIX_C_SOURCE 200809L
+#include "context.h"
+#include "design_cache.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <pthread.h>
+
+/*
+ * Work-stealing pool.
+ *
+ * Each worker owns a deque: it pushes and pops chunks at the bottom (LIFO,
+ * cache-warm) while idle workers steal from the top (FIFO, largest pending
+ * work first).  Threads that are not workers of the pool use an extra
+ * injection deque.  Deques are small mutex-protected ring buffers; chunks
+ * are coarse (a few per worker per parallel_for), so contention is low.
+ */
+
+/* Completion counter shared by the chunks of one parallel_for (NULL = detached) */
+typedef struct {
+    size_t remaining;
+} PoolJob;
+
+typedef struct {
+    taguchi_range_fn fn;
+    void *arg;
+    size_t begin;
+    size_t end;
+    PoolJob *job;
+} PoolTask;
+
+typedef struct {
+    pthread_mutex_t lock;
+    PoolTask *tasks;     /* ring buffer */
+    size_t capacity;
+    size_t top;          /* steal end */
+    size_t count;
+} WorkDeque;
+
+typedef struct {
+    taguchi_context_t *ctx;
+    size_t index;
+} WorkerInfo;
+
+struct taguchi_context {
+    /* Configuration */
+    size_t max_workers;                  /* including the calling thread */
+    void *(*alloc)(size_t size, void *user);
+    void (*release)(void *ptr, void *user);
+    void *alloc_user;
+    char cache_dir[PATH_MAX];
+    pthread_mutex_t config_lock;         /* cache_dir, pool start/stop */
+
+    /* Pool (started on first parallel use) */
+    bool started;
+    size_t thread_count;                 /* worker threads actually running */
+    size_t deque_count;                  /* planned workers + injection deque */
+    pthread_t *threads;
+    WorkerInfo *workers;
+    WorkDeque *deques;
+    pthread_mutex_t sleep_lock;
+    pthread_cond_t wake;
+    size_t pending;                      /* queued, not yet taken (atomic) */
+    bool shutdown;
+};
+
+static pthread_key_t worker_key;
+static pthread_once_t worker_key_once = PTHREAD_ONCE_INIT;
+
+static void create_worker_key(void) {
+    pthread_key_create(&worker_key, NULL);
+}
+
+static void *default_alloc(size_t size, void *user) {
+    (void)user;
+    return malloc(size);
+}
+
+static void default_release(void *ptr, void *user) {
+    (void)user;
+    free(ptr);
+}
+
+/* Online CPUs, capped by TAGUCHI_MAX_WORKERS for shared hosts */
+static size_t effective_workers(size_t requested) {
+    size_t n = requested;
+    if (n == 0) {
+        long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+        n = ncpu > 0 ? (size_t)ncpu : 1;
+    }
+    const char *cap_env = getenv("TAGUCHI_MAX_WORKERS");
+    if (cap_env && cap_env[0] != '\0') {
+        char *end;
+        long cap = strtol(cap_env, &end, 10);
+        if (*end == '\0' && cap >= 1 && (size_t)cap < n) {
+            n = (size_t)cap;
+        }
+    }
+    return n;
+}
+
+/*
+ * ============================================================================
+ * Allocation
+ * ============================================================================
+ */
+
+void *context_alloc(taguchi_context_t *ctx, size_t size) {
+    ctx = context_resolve(ctx);
+    void *ptr = ctx->alloc(size ? size : 1, ctx->alloc_user);
+    if (ptr == NULL) {
+        fprintf(stderr, "Fatal: context allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+void *context_calloc(taguchi_context_t *ctx, size_t count, size_t size) {
+    if (size != 0 && count > (size_t)-1 / size) {
+        fprintf(stderr, "Fatal: context allocation overflow\n");
+        exit(EXIT_FAILURE);
+    }
+    void *ptr = context_alloc(ctx, count * size);
+    memset(ptr, 0, count * size);
+    return ptr;
+}
+
+void context_free(taguchi_context_t *ctx, void *ptr) {
+    if (ptr) {
+        ctx = context_resolve(ctx);
+        ctx->release(ptr, ctx->alloc_user);
+    }
+}
+
+/*
+ * ============================================================================
+ * Deques
+ * ============================================================================
+ */
+
+static void deque_push(taguchi_context_t *ctx, WorkDeque *d, const PoolTask *task) {
+    pthread_mutex_lock(&d->lock);
+    if (d->count == d->capacity) {
+        size_t new_cap = d->capacity ? d->capacity * 2 : 16;
+        PoolTask *grown = context_alloc(ctx, new_cap * sizeof(PoolTask));
+        for (size_t i = 0; i < d->count; i++) {
+            grown[i] = d->tasks[(d->top + i) % d->capacity];
+        }
+        context_free(ctx, d->tasks);
+        d->tasks = grown;
+        d->capacity = new_cap;
+        d->top = 0;
+    }
+    d->tasks[(d->top + d->count) % d->capacity] = *task;
+    d->count++;
+    pthread_mutex_unlock(&d->lock);
+}
+
+static bool deque_pop_bottom(WorkDeque *d, PoolTask *out) {
+    bool got = false;
+    pthread_mutex_lock(&d->lock);
+    if (d->count > 0) {
+        d->count--;
+        *out = d->tasks[(d->top + d->count) % d->capacity];
+        got = true;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return got;
+}
+
+static bool deque_steal_top(WorkDeque *d, PoolTask *out) {
+    bool got = false;
+    pthread_mutex_lock(&d->lock);
+    if (d->count > 0) {
+        *out = d->tasks[d->top];
+        d->top = (d->top + 1) % d->capacity;
+        d->count--;
+        got = true;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return got;
+}
+
+/* Own deque first, then steal round-robin from the others */
+static bool pool_find_task(taguchi_context_t *ctx, size_t self, PoolTask *out) {
+    bool got = deque_pop_bottom(&ctx->deques[self], out);
+    for (size_t i = 1; !got && i < ctx->deque_count; i++) {
+        got = deque_steal_top(&ctx->deques[(self + i) % ctx->deque_count], out);
+    }
+    if (got) {
+        __atomic_sub_fetch(&ctx->pending, 1, __ATOMIC_ACQ_REL);
+    }
+    return got;
+}
+
+static void pool_run_task(taguchi_context_t *ctx, const PoolTask *task) {
+    task->fn(task->arg, task->begin, task->end);
+    /* The job lives on the submitter's stack: do not touch it after this */
+    if (task->job && __atomic_sub_fetch(&task->job->remaining, 1, __ATOMIC_ACQ_REL) == 0) {
+        pthread_mutex_lock(&ctx->sleep_lock);
+        pthread_cond_broadcast(&ctx->wake);
+        pthread_mutex_unlock(&ctx->sleep_lock);
+    }
+}
+
+static void *pool_worker(void *arg) {
+    WorkerInfo *self = arg;
+    taguchi_context_t *ctx = self->ctx;
+    pthread_setspecific(worker_key, self);
+
+    for (;;) {
+        PoolTask task;
+        if (pool_find_task(ctx, self->index, &task)) {
+            pool_run_task(ctx, &task);
+            continue;
+        }
+        pthread_mutex_lock(&ctx->sleep_lock);
+        while (!ctx->shutdown && __atomic_load_n(&ctx->pending, __ATOMIC_ACQUIRE) == 0) {
+            pthread_cond_wait(&ctx->wake, &ctx->sleep_lock);
+        }
+        bool stop = ctx->shutdown;
+        pthread_mutex_unlock(&ctx->sleep_lock);
+        if (stop) break;
+    }
+    return NULL;
+}
+
+/*
+ * Start worker threads on first use; false if running inline is required.
+ * A single-worker context still gets one thread so detached tasks never
+ * run on the submitter; its parallel_for calls stay inline.
+ */
+static bool pool_ensure_started(taguchi_context_t *ctx) {
+    pthread_mutex_lock(&ctx->config_lock);
+    if (!ctx->started) {
+        size_t planned = ctx->max_workers > 1 ? ctx->max_workers - 1 : 1;
+        ctx->deque_count = planned + 1;
+        ctx->deques = context_calloc(ctx, ctx->deque_count, sizeof(WorkDeque));
+        for (size_t i = 0; i < ctx->deque_count; i++) {
+            pthread_mutex_init(&ctx->deques[i].lock, NULL);
+        }
+        ctx->workers = context_calloc(ctx, planned, sizeof(WorkerInfo));
+        ctx->threads = context_calloc(ctx, planned, sizeof(pthread_t));
+        ctx->shutdown = false;
+        ctx->pending = 0;
+        ctx->thread_count = 0;
+        for (size_t i = 0; i < planned; i++) {
+            ctx->workers[i].ctx = ctx;
+            ctx->workers[i].index = i;
+            if (pthread_create(&ctx->threads[i], NULL, pool_worker, &ctx->workers[i]) != 0) {
+                break;
+            }
+            ctx->thread_count++;
+        }
+        ctx->started = true;
+    }
+    bool usable = ctx->thread_count > 0;
+    pthread_mutex_unlock(&ctx->config_lock);
+    return usable;
+}
+
+/* Join workers and release the pool; the context must be idle */
+static void pool_stop(taguchi_context_t *ctx) {
+    if (!ctx->started) return;
+
+    pthread_mutex_lock(&ctx->sleep_lock);
+    ctx->shutdown = true;
+    pthread_cond_broadcast(&ctx->wake);
+    pthread_mutex_unlock(&ctx->sleep_lock);
+    for (size_t i = 0; i < ctx->thread_count; i++) {
+        pthread_join(ctx->threads[i], NULL);
+    }
+    for (size_t i = 0; i < ctx->deque_count; i++) {
+        pthread_mutex_destroy(&ctx->deques[i].lock);
+        context_free(ctx, ctx->deques[i].tasks);
+    }
+    context_free(ctx, ctx->deques);
+    context_free(ctx, ctx->workers);
+    context_free(ctx, ctx->threads);
+    ctx->deques = NULL;
+    ctx->workers = NULL;
+    ctx->threads = NULL;
+    ctx->thread_count = 0;
+    ctx->deque_count = 0;
+    ctx->started = false;
+}
+
+void context_parallel_for(taguchi_context_t *ctx, size_t count, size_t grain,
+                          taguchi_range_fn fn, void *arg) {
+    if (count == 0 || !fn) return;
+    ctx = context_resolve(ctx);
+    if (grain == 0) grain = 1;
+
+    if (ctx->max_workers <= 1 || count <= grain || !pool_ensure_started(ctx)) {
+        fn(arg, 0, count);
+        return;
+    }
+
+    /* A few chunks per worker: enough to balance, few enough to stay cheap */
+    size_t max_chunks = ctx->max_workers * 4;
+    size_t chunk = (count + max_chunks - 1) / max_chunks;
+    if (chunk < grain) chunk = grain;
+    size_t chunk_count = (count + chunk - 1) / chunk;
+
+    /* Workers of this pool push to their own deque, others to the injection deque */
+    pthread_once(&worker_key_once, create_worker_key);
+    const WorkerInfo *me = pthread_getspecific(worker_key);
+    size_t self = (me && me->ctx == ctx) ? me->index : ctx->deque_count - 1;
+
+    PoolJob job;
+    job.remaining = chunk_count;
+
+    /* Count the chunks as pending before they become stealable */
+    __atomic_add_fetch(&ctx->pending, chunk_count - 1, __ATOMIC_ACQ_REL);
+    for (size_t c = chunk_count; c-- > 1;) {
+        PoolTask task;
+        task.fn = fn;
+        task.arg = arg;
+        task.begin = c * chunk;
+        task.end = (c + 1) * chunk < count ? (c + 1) * chunk : count;
+        task.job = &job;
+        deque_push(ctx, &ctx->deques[self], &task);
+    }
+    pthread_mutex_lock(&ctx->sleep_lock);
+    pthread_cond_broadcast(&ctx->wake);
+    pthread_mutex_unlock(&ctx->sleep_lock);
+
+    /* Run the first chunk here, then help until every chunk has finished */
+    PoolTask first;
+    first.fn = fn;
+    first.arg = arg;
+    first.begin = 0;
+    first.end = chunk < count ? chunk : count;
+    first.job = &job;
+    pool_run_task(ctx, &first);
+
+    while (__atomic_load_n(&job.remaining, __ATOMIC_ACQUIRE) > 0) {
+        PoolTask task;
+        if (pool_find_task(ctx, self, &task)) {
+            pool_run_task(ctx, &task);
+            continue;
+        }
+        pthread_mutex_lock(&ctx->sleep_lock);
+        while (__atomic_load_n(&job.remaining, __ATOMIC_ACQUIRE) > 0 &&
+               __atomic_load_n(&ctx->pending, __ATOMIC_ACQUIRE) == 0) {
+            pthread_cond_wait(&ctx->wake, &ctx->sleep_lock);
+        }
+        pthread_mutex_unlock(&ctx->sleep_lock);
+    }
+}
+
+int context_submit(taguchi_context_t *ctx, taguchi_range_fn fn, void *arg) {
+    ctx = context_resolve(ctx);
+    if (!fn || !pool_ensure_started(ctx)) return -1;
+
+    pthread_once(&worker_key_once, create_worker_key);
+    const WorkerInfo *me = pthread_getspecific(worker_key);
+    size_t self = (me && me->ctx == ctx) ? me->index : ctx->deque_count - 1;
+
+    PoolTask task;
+    task.fn = fn;
+    task.arg = arg;
+    task.begin = 0;
+    task.end = 1;
+    task.job = NULL;
+    __atomic_add_fetch(&ctx->pending, 1, __ATOMIC_ACQ_REL);
+    deque_push(ctx, &ctx->deques[self], &task);
+    pthread_mutex_lock(&ctx->sleep_lock);
+    pthread_cond_broadcast(&ctx->wake);
+    pthread_mutex_unlock(&ctx->sleep_lock);
+    return 0;
+}
+
+/*
+ * ============================================================================
+ * Contexts
+ * ============================================================================
+ */
+
+static taguchi_context_t *default_ctx;
+static pthread_once_t default_once = PTHREAD_ONCE_INIT;
+
+static void create_default_context(void) {
+    default_ctx = taguchi_context_create(NULL, NULL);
+}
+
+taguchi_context_t *context_resolve(taguchi_context_t *ctx) {
+    return ctx ? ctx : taguchi_default_context();
+}
+
+bool context_cache_dir(taguchi_context_t *ctx, char *buf, size_t size) {
+    ctx = context_resolve(ctx);
+    pthread_mutex_lock(&ctx->config_lock);
+    bool enabled = ctx->cache_dir[0] != '\0';
+    if (enabled) {
+        snprintf(buf, size, "%s", ctx->cache_dir);
+    }
+    pthread_mutex_unlock(&ctx->config_lock);
+    return enabled;
+}
+
+void taguchi_context_options_init(taguchi_context_options_t *opts) {
+    if (opts) {
+        memset(opts, 0, sizeof(*opts));
+    }
+}
+
+taguchi_context_t *taguchi_context_create(const taguchi_context_options_t *opts, char *error_buf) {
+    if (opts && ((opts->alloc == NULL) != (opts->release == NULL))) {
+        set_error(error_buf, "Context allocator needs both alloc and release");
+        return NULL;
+    }
+    void *(*alloc)(size_t, void *) = (opts && opts->alloc) ? opts->alloc : default_alloc;
+    void *user = opts ? opts->alloc_user : NULL;
+
+    taguchi_context_t *ctx = alloc(sizeof(taguchi_context_t), user);
+    if (!ctx) {
+        set_error(error_buf, "Out of memory creating context");
+        return NULL;
+    }
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->alloc = alloc;
+    ctx->release = (opts && opts->release) ? opts->release : default_release;
+    ctx->alloc_user = user;
+    ctx->max_workers = effective_workers(opts ? opts->max_workers : 0);
+    pthread_mutex_init(&ctx->config_lock, NULL);
+    pthread_mutex_init(&ctx->sleep_lock, NULL);
+    pthread_cond_init(&ctx->wake, NULL);
+    return ctx;
+}
+
+void taguchi_context_free(taguchi_context_t *ctx) {
+    if (!ctx || ctx == default_ctx) return;
+    pool_stop(ctx);
+    pthread_mutex_destroy(&ctx->config_lock);
+    pthread_mutex_destroy(&ctx->sleep_lock);
+    pthread_cond_destroy(&ctx->wake);
+    ctx->release(ctx, ctx->alloc_user);
+}
+
+taguchi_context_t *taguchi_default_context(void) {
+    pthread_once(&default_once, create_default_context);
+    return default_ctx;
+}
+
+size_t taguchi_context_get_max_workers(const taguchi_context_t *ctx) {
+    if (!ctx) ctx = taguchi_default_context();
+    return ctx->max_workers;
+}
+
+int taguchi_context_set_max_workers(taguchi_context_t *ctx, size_t max_workers) {
+    ctx = context_resolve(ctx);
+    pthread_mutex_lock(&ctx->config_lock);
+    size_t n = effective_workers(max_workers);
+    if (n != ctx->max_workers) {
+        /* Restarted lazily with the new size on the next parallel call */
+        pool_stop(ctx);
+        ctx->max_workers = n;
+    }
+    pthread_mutex_unlock(&ctx->config_lock);
+    return 0;
+}
+
+int taguchi_context_set_design_cache_dir(taguchi_context_t *ctx, const char *dir, char *error_buf) {
+    ctx = context_resolve(ctx);
+    if (dir && dir[0] != '\0') {
+        if (strlen(dir) >= sizeof(ctx->cache_dir) - 32) {
+            set_error(error_buf, "Design cache directory path too long: %s", dir);
+            return -1;
+        }
+        if (design_cache_prepare_dir(dir, error_buf) != 0) {
+            return -1;
+        }
+    }
+    pthread_mutex_lock(&ctx->config_lock);
+    snprintf(ctx->cache_dir, sizeof(ctx->cache_dir), "%s", dir ? dir : "");
+    pthread_mutex_unlock(&ctx->config_lock);
+    return 0;
+}
+
+void taguchi_context_parallel_for(taguchi_context_t *ctx, size_t count, size_t grain,
+                                  taguchi_range_fn fn, void *arg) {
+    context_parallel_for(ctx, count, grain, fn, arg);
+}
@@ -0,0 +1,43 @@
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "include/taguchi.h"
+
+/*
+ * Library runtime context (internal view).
+ *
+ * A context owns a lazily started work-stealing thread pool, the design
+ * cache configuration and the allocator used for library scratch memory.
+ * The array catalog is immutable and shared by all contexts.  Every
+ * internal routine taking a context accepts NULL for the default context.
+ */
+
+/* Resolve NULL to the default context */
+taguchi_context_t *context_resolve(taguchi_context_t *ctx);
+
+/*
+ * Run fn over [0, count) split into chunks of at least `grain` items.
+ * The calling thread executes chunks too, so nested calls from inside a
+ * chunk are safe.  Returns once every chunk has completed.
+ */
+void context_parallel_for(taguchi_context_t *ctx, size_t count, size_t grain,
+                          taguchi_range_fn fn, void *arg);
+
+/*
+ * Queue fn(arg, 0, 1) to run on a pool thread without waiting for it.
+ * Queued tasks are drained before the pool stops.  Returns -1 if no
+ * worker thread could be started.
+ */
+int context_submit(taguchi_context_t *ctx, taguchi_range_fn fn, void *arg);
+
+/* Copy the design cache directory; returns false when caching is disabled */
+bool context_cache_dir(taguchi_context_t *ctx, char *buf, size_t size);
+
+/* Scratch allocation through the context allocator (exits on failure) */
+void *context_alloc(taguchi_context_t *ctx, size_t size);
+void *context_calloc(taguchi_context_t *ctx, size_t count, size_t size);
+void context_free(taguchi_context_t *ctx, void *ptr);
+
+#endif /* CONTEXT_H */
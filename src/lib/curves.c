@@ -0,0 +1,243 @@
+#include "curves.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#define CURVE_MAX_DEGREE 3
+
+/* Points of one factor's curve: tested values with results */
+typedef struct {
+    size_t count;
+    double u[MAX_LEVELS];       /* scaled level value */
+    double mean[MAX_LEVELS];    /* level mean */
+    double weight[MAX_LEVELS];  /* runs behind the level mean */
+} CurvePoints;
+
+/* c[0] + c[1] u + c[2] u^2 + c[3] u^3 */
+static double poly_at(const double *c, double u) {
+    return ((c[3] * u + c[2]) * u + c[1]) * u + c[0];
+}
+
+/* Weighted sum over the points of p(u) * q(u) */
+static double poly_dot(const double *p, const double *q, const CurvePoints *pts) {
+    double s = 0.0;
+    for (size_t i = 0; i < pts->count; i++) {
+        s += pts->weight[i] * poly_at(p, pts->u[i]) * poly_at(q, pts->u[i]);
+    }
+    return s;
+}
+
+/*
+ * Polynomials p_0 .. p_degree orthogonal over the points, each monic (leading
+ * coefficient 1), so a positive quadratic contrast means a valley and a
+ * negative one a peak.  Built by modified Gram-Schmidt on 1, u, u^2, u^3.
+ */
+static void orthogonal_polys(const CurvePoints *pts, size_t degree,
+                             double polys[CURVE_MAX_DEGREE + 1][CURVE_MAX_DEGREE + 1]) {
+    memset(polys, 0, (CURVE_MAX_DEGREE + 1) * sizeof(polys[0]));
+    for (size_t j = 0; j <= degree; j++) {
+        polys[j][j] = 1.0;
+        for (size_t k = 0; k < j; k++) {
+            double proj = poly_dot(polys[j], polys[k], pts) / poly_dot(polys[k], polys[k], pts);
+            for (size_t d = 0; d <= k; d++) {
+                polys[j][d] -= proj * polys[k][d];
+            }
+        }
+    }
+}
+
+/* Best point of the curve over u in [-1, 1]: an end, or a stationary point */
+static double best_u(const double *c, bool higher_is_better) {
+    double candidates[4] = { -1.0, 1.0 };
+    size_t n = 2;
+    /* Roots of c[1] + 2 c[2] u + 3 c[3] u^2 (coefficients past the degree are 0) */
+    double a = 3.0 * c[3], b = 2.0 * c[2];
+    if (a != 0.0) {
+        double disc = b * b - 4.0 * a * c[1];
+        if (disc >= 0.0) {
+            candidates[n++] = (-b + sqrt(disc)) / (2.0 * a);
+            candidates[n++] = (-b - sqrt(disc)) / (2.0 * a);
+        }
+    } else if (b != 0.0) {
+        candidates[n++] = -c[1] / b;
+    }
+
+    double best = candidates[0];
+    double best_y = poly_at(c, best);
+    for (size_t i = 1; i < n; i++) {
+        if (!(candidates[i] >= -1.0 && candidates[i] <= 1.0)) continue;
+        double y = poly_at(c, candidates[i]);
+        if (higher_is_better ? y > best_y : y < best_y) {
+            best = candidates[i];
+            best_y = y;
+        }
+    }
+    return best;
+}
+
+static void fit_factor(const Factor *factor, const double *sums, const size_t *runs,
+                       const taguchi_curve_options_t *opts, taguchi_response_curve_t *curve) {
+    double low = INFINITY, high = -INFINITY;
+    for (size_t lv = 0; lv < factor->level_count; lv++) {
+        if (runs[lv] == 0) continue;
+        low = fmin(low, factor->numeric_values[lv]);
+        high = fmax(high, factor->numeric_values[lv]);
+    }
+    curve->low = low;
+    curve->high = high;
+    curve->center = (low + high) / 2.0;
+    curve->scale = (high - low) / 2.0;
+
+    CurvePoints pts;
+    pts.count = 0;
+    size_t distinct = 0;
+    double total = 0.0, weight = 0.0;
+    curve->best_level_mean = NAN;
+    for (size_t lv = 0; lv < factor->level_count; lv++) {
+        if (runs[lv] == 0) continue;
+        double x = factor->numeric_values[lv];
+        bool seen = false;
+        for (size_t k = 0; k < lv; k++) {
+            seen = seen || (runs[k] > 0 && factor->numeric_values[k] == x);
+        }
+        distinct += !seen;
+
+        size_t i = pts.count++;
+        pts.u[i] = (x - curve->center) / curve->scale;
+        pts.mean[i] = sums[lv] / (double)runs[lv];
+        pts.weight[i] = (double)runs[lv];
+        total += pts.mean[i] * pts.weight[i];
+        weight += pts.weight[i];
+
+        if (isnan(curve->best_level_mean) ||
+            (opts->higher_is_better ? pts.mean[i] > curve->best_level_mean
+                                    : pts.mean[i] < curve->best_level_mean)) {
+            curve->best_level = lv;
+            curve->best_level_mean = pts.mean[i];
+        }
+    }
+    curve->points = distinct;
+
+    double grand = total / weight;
+    double between = 0.0;
+    for (size_t i = 0; i < pts.count; i++) {
+        between += pts.weight[i] * (pts.mean[i] - grand) * (pts.mean[i] - grand);
+    }
+
+    size_t estimable = distinct - 1 < CURVE_MAX_DEGREE ? distinct - 1 : CURVE_MAX_DEGREE;
+    double polys[CURVE_MAX_DEGREE + 1][CURVE_MAX_DEGREE + 1];
+    orthogonal_polys(&pts, estimable, polys);
+
+    curve->degree = opts->degree < estimable ? opts->degree : estimable;
+    memset(curve->coefficients, 0, sizeof(curve->coefficients));
+    curve->coefficients[0] = grand;
+    double fitted_ss = 0.0;
+    for (size_t j = 1; j <= CURVE_MAX_DEGREE; j++) {
+        curve->contrast[j - 1] = NAN;
+        curve->contrast_share[j - 1] = NAN;
+        if (j > estimable) continue;
+
+        double norm = poly_dot(polys[j], polys[j], &pts);
+        double l = 0.0;
+        for (size_t i = 0; i < pts.count; i++) {
+            l += pts.weight[i] * poly_at(polys[j], pts.u[i]) * pts.mean[i];
+        }
+        double ss = l * l / norm;
+        curve->contrast[j - 1] = copysign(sqrt(ss), l);
+        if (between > 0.0) curve->contrast_share[j - 1] = ss / between;
+
+        if (j <= curve->degree) {
+            fitted_ss += ss;
+            for (size_t d = 0; d <= j; d++) {
+                curve->coefficients[d] += l / norm * polys[j][d];
+            }
+        }
+    }
+    curve->fit_share = between > 0.0 ? fitted_ss / between : NAN;
+
+    double u = best_u(curve->coefficients, opts->higher_is_better);
+    curve->optimum = curve->center + curve->scale * u;
+    curve->predicted = poly_at(curve->coefficients, u);
+    curve->interior = u > -1.0 && u < 1.0;
+}
+
+double response_curve_at(const taguchi_response_curve_t *curve, double x) {
+    return poly_at(curve->coefficients, (x - curve->center) / curve->scale);
+}
+
+int fit_response_curves(taguchi_context_t *ctx, const ResultSet *results,
+                        const taguchi_curve_options_t *opts,
+                        taguchi_response_curve_t **curves_out, size_t *count_out,
+                        char *error_buf) {
+    if (!results || !results->experiment_def || !opts || !curves_out || !count_out) {
+        set_error(error_buf, "Invalid parameters to fit_response_curves");
+        return -1;
+    }
+    if (opts->degree < 1 || opts->degree > CURVE_MAX_DEGREE) {
+        set_error(error_buf, "Curve degree must be 1 to %d, got %zu", CURVE_MAX_DEGREE,
+                  opts->degree);
+        return -1;
+    }
+
+    const ExperimentDef *def = results->experiment_def;
+    CompiledDesign design;
+    if (acquire_design(ctx, def, &design, error_buf) != 0) {
+        return -1;
+    }
+    size_t rows = design.rows;
+    size_t fc = design.factor_count;
+
+    /* Run means, so replicated runs weigh the same as the rest */
+    size_t *n = xcalloc(rows + 1, sizeof(size_t));
+    double *mean = xcalloc(rows + 1, sizeof(double));
+    for (size_t i = 0; i < results->count; i++) {
+        size_t run_id = results->run_ids[i];
+        if (run_id < 1 || run_id > rows) continue;
+        n[run_id - 1]++;
+        mean[run_id - 1] += results->responses[i];
+    }
+    for (size_t r = 0; r < rows; r++) {
+        if (n[r] > 0) mean[r] /= (double)n[r];
+    }
+
+    taguchi_response_curve_t *curves = xcalloc(fc + 1, sizeof(taguchi_response_curve_t));
+    size_t count = 0;
+    for (size_t f = 0; f < fc; f++) {
+        const Factor *factor = &def->factors[f];
+        if (!factor->numeric) continue;
+
+        double sums[MAX_LEVELS] = { 0.0 };
+        size_t runs[MAX_LEVELS] = { 0 };
+        for (size_t r = 0; r < rows; r++) {
+            size_t lv = design.levels[r * fc + f];
+            if (n[r] == 0 || lv >= factor->level_count) continue;
+            sums[lv] += mean[r];
+            runs[lv]++;
+        }
+
+        /* A curve needs two distinct tested values */
+        size_t tested = 0;
+        double first = 0.0;
+        bool spread = false;
+        for (size_t lv = 0; lv < factor->level_count; lv++) {
+            if (runs[lv] == 0) continue;
+            if (tested++ == 0) first = factor->numeric_values[lv];
+            spread = spread || factor->numeric_values[lv] != first;
+        }
+        if (!spread) continue;
+
+        taguchi_response_curve_t *curve = &curves[count++];
+        snprintf(curve->factor, sizeof(curve->factor), "%s", factor->name);
+        curve->factor_index = f;
+        fit_factor(factor, sums, runs, opts, curve);
+    }
+
+    free(n);
+    free(mean);
+    free_compiled_design(&design);
+    *curves_out = curves;
+    *count_out = count;
+    return 0;
+}
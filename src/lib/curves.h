@@ -0,0 +1,33 @@
+#ifndef CURVES_H
+#define CURVES_H
+
+#include <stddef.h>
+#include "analyzer.h"    // For ResultSet
+
+/*
+ * Response curves of numeric factors.
+ *
+ * A numeric factor's level means (means of run means, as in the main
+ * effects) are points on a curve over its tested values.  The curve is
+ * expanded in polynomials orthogonal over those points, weighted by the
+ * runs behind each level mean: the first three give the linear, quadratic
+ * and cubic contrasts, which split the factor's between-level sum of
+ * squares, and the first opts->degree give the fitted curve.  Values are
+ * centered and scaled to u in [-1, 1] over the tested range first, so wide
+ * ranges (byte sizes) stay well conditioned.
+ */
+
+/* Fit every numeric factor of results (see taguchi_fit_response_curves_ctx) */
+int fit_response_curves(
+    taguchi_context_t *ctx,
+    const ResultSet *results,
+    const taguchi_curve_options_t *opts,
+    taguchi_response_curve_t **curves_out,
+    size_t *count_out,
+    char *error_buf
+);
+
+/* Value of a fitted curve at level value x */
+double response_curve_at(const taguchi_response_curve_t *curve, double x);
+
+#endif /* CURVES_H */
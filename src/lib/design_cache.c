@@ -0,0 +1,230 @@
+#define _POSIX_C_SOURCE 200809L
+#include "design_cache.h"
+#include "arrays.h"
+#include "utils.h"
+#include "include/taguchi.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*
+ * Cache file layout (native byte order; the cache is local to one machine):
+ *
+ *   DesignFileHeader
+ *   uint32_t col_start[factor_count]
+ *   uint32_t col_count[factor_count]
+ *   uint8_t  level_counts[factor_count]   (collision check against the def)
+ *   uint8_t  levels[rows * factor_count]  (level index matrix)
+ */
+#define DESIGN_FILE_MAGIC "TGDESIGN"
+#define DESIGN_FILE_FORMAT 1u
+#define DESIGN_LIB_VERSION ((uint32_t)(TAGUCHI_VERSION_MAJOR * 10000 + \
+                                       TAGUCHI_VERSION_MINOR * 100 + \
+                                       TAGUCHI_VERSION_PATCH))
+
+typedef struct {
+    char magic[8];
+    uint32_t format;
+    uint32_t lib_version;
+    uint64_t key;
+    char array_name[8];
+    uint32_t rows;
+    uint32_t factor_count;
+} DesignFileHeader;
+
+/* mkdir -p */
+static int make_dirs(const char *dir) {
+    char path[PATH_MAX];
+    if (snprintf(path, sizeof(path), "%s", dir) >= (int)sizeof(path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    for (char *p = path + 1; *p; p++) {
+        if (*p != '/') continue;
+        *p = '\0';
+        if (mkdir(path, 0755) != 0 && errno != EEXIST) return -1;
+        *p = '/';
+    }
+    if (mkdir(path, 0755) != 0 && errno != EEXIST) return -1;
+    return 0;
+}
+
+int design_cache_prepare_dir(const char *dir, char *error_buf) {
+    if (make_dirs(dir) != 0) {
+        set_error(error_buf, "Cannot create design cache directory %s: %s", dir, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+/* FNV-1a, 64-bit */
+static uint64_t fnv1a(uint64_t hash, const void *data, size_t len) {
+    const unsigned char *p = data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+uint64_t design_cache_key(const ExperimentDef *def) {
+    uint64_t hash = 14695981039346656037ULL;
+    uint32_t version = DESIGN_LIB_VERSION;
+    uint32_t format = DESIGN_FILE_FORMAT;
+    uint32_t count = (uint32_t)def->factor_count;
+
+    hash = fnv1a(hash, &format, sizeof(format));
+    hash = fnv1a(hash, &version, sizeof(version));
+    /* Include the terminator so "L2" + levels cannot alias "L27" + levels */
+    hash = fnv1a(hash, def->array_type, strlen(def->array_type) + 1);
+    hash = fnv1a(hash, &count, sizeof(count));
+    for (size_t i = 0; i < def->factor_count; i++) {
+        uint8_t levels = (uint8_t)def->factors[i].level_count;
+        hash = fnv1a(hash, &levels, sizeof(levels));
+    }
+    return hash;
+}
+
+static int entry_path(char *buf, size_t size, const char *dir, uint64_t key) {
+    int nw = snprintf(buf, size, "%s/%016llx.tgd", dir, (unsigned long long)key);
+    return (nw < 0 || (size_t)nw >= size) ? -1 : 0;
+}
+
+static size_t entry_size(size_t rows, size_t factor_count) {
+    return sizeof(DesignFileHeader) + factor_count * (2 * sizeof(uint32_t) + 1) +
+           rows * factor_count;
+}
+
+int design_cache_load(const char *dir, const ExperimentDef *def, CompiledDesign *out) {
+    char path[PATH_MAX];
+    if (!dir || !def || !out) return -1;
+
+    uint64_t key = design_cache_key(def);
+    if (entry_path(path, sizeof(path), dir, key) != 0) return -1;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(DesignFileHeader)) {
+        close(fd);
+        return -1;
+    }
+    size_t size = (size_t)st.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+
+    /* Validate everything before trusting the entry; any mismatch is a miss */
+    const DesignFileHeader *hdr = map;
+    size_t fc = def->factor_count;
+    const OrthogonalArray *array = NULL;
+    bool ok = memcmp(hdr->magic, DESIGN_FILE_MAGIC, sizeof(hdr->magic)) == 0 &&
+              hdr->format == DESIGN_FILE_FORMAT &&
+              hdr->lib_version == DESIGN_LIB_VERSION &&
+              hdr->key == key &&
+              hdr->factor_count == fc &&
+              memchr(hdr->array_name, '\0', sizeof(hdr->array_name)) != NULL;
+    if (ok) {
+        array = get_array(hdr->array_name);
+        ok = array != NULL && array->rows == hdr->rows &&
+             (def->array_type[0] == '\0' || strcmp(def->array_type, hdr->array_name) == 0) &&
+             size == entry_size(hdr->rows, fc);
+    }
+
+    const unsigned char *body = (const unsigned char *)map + sizeof(DesignFileHeader);
+    const unsigned char *level_counts = body + fc * 2 * sizeof(uint32_t);
+    const uint8_t *levels = level_counts + fc;
+    for (size_t i = 0; ok && i < fc; i++) {
+        ok = level_counts[i] == def->factors[i].level_count;
+    }
+    for (size_t r = 0; ok && r < hdr->rows; r++) {
+        for (size_t i = 0; i < fc; i++) {
+            if (levels[r * fc + i] >= level_counts[i]) {
+                ok = false;
+                break;
+            }
+        }
+    }
+    if (!ok) {
+        munmap(map, size);
+        return -1;
+    }
+
+    memset(out, 0, sizeof(*out));
+    strcpy(out->array_name, hdr->array_name);
+    out->rows = hdr->rows;
+    out->factor_count = fc;
+    memcpy(out->col_start, body, fc * sizeof(uint32_t));
+    memcpy(out->col_count, body + fc * sizeof(uint32_t), fc * sizeof(uint32_t));
+    out->levels = levels;
+    out->mapping = map;
+    out->mapping_size = size;
+    return 0;
+}
+
+static int write_all(int fd, const void *data, size_t len) {
+    const char *p = data;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+int design_cache_store(const char *dir, const ExperimentDef *def, const CompiledDesign *design) {
+    char path[PATH_MAX];
+    char tmp[PATH_MAX];
+    if (!dir || !def || !design) return 0;
+
+    uint64_t key = design_cache_key(def);
+    if (entry_path(path, sizeof(path), dir, key) != 0) return -1;
+    int nw = snprintf(tmp, sizeof(tmp), "%s.XXXXXX", path);
+    if (nw < 0 || (size_t)nw >= sizeof(tmp)) return -1;
+
+    DesignFileHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, DESIGN_FILE_MAGIC, sizeof(hdr.magic));
+    hdr.format = DESIGN_FILE_FORMAT;
+    hdr.lib_version = DESIGN_LIB_VERSION;
+    hdr.key = key;
+    snprintf(hdr.array_name, sizeof(hdr.array_name), "%s", design->array_name);
+    hdr.rows = (uint32_t)design->rows;
+    hdr.factor_count = (uint32_t)design->factor_count;
+
+    size_t fc = design->factor_count;
+    uint8_t level_counts[MAX_FACTORS];
+    for (size_t i = 0; i < fc; i++) {
+        level_counts[i] = (uint8_t)def->factors[i].level_count;
+    }
+
+    /* Write to a unique temp file and rename, so readers never see a partial entry */
+    int fd = mkstemp(tmp);
+    if (fd < 0) return -1;
+    int rc = write_all(fd, &hdr, sizeof(hdr));
+    if (rc == 0) rc = write_all(fd, design->col_start, fc * sizeof(uint32_t));
+    if (rc == 0) rc = write_all(fd, design->col_count, fc * sizeof(uint32_t));
+    if (rc == 0) rc = write_all(fd, level_counts, fc);
+    if (rc == 0) rc = write_all(fd, design->levels, design->rows * fc);
+    if (close(fd) != 0) rc = -1;
+    if (rc == 0 && rename(tmp, path) != 0) rc = -1;
+    if (rc != 0) unlink(tmp);
+    return rc;
+}
+
+void design_cache_unmap(void *mapping, size_t size) {
+    if (mapping) {
+        munmap(mapping, size);
+    }
+}
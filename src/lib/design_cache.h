@@ -0,0 +1,34 @@
+#ifndef DESIGN_CACHE_H
+#define DESIGN_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "parser.h"     // For ExperimentDef
+#include "generator.h"  // For CompiledDesign
+
+/*
+ * On-disk cache of compiled designs.
+ *
+ * Entries are keyed by a hash of the normalized definition (array type and
+ * per-factor level counts; names and level strings do not affect the
+ * design) plus the library version, and are mapped read-only on load.
+ * The directory comes from the runtime context (see context.h); caching
+ * is disabled when the context has none.
+ */
+
+/* Create the cache directory (and parents) if missing */
+int design_cache_prepare_dir(const char *dir, char *error_buf);
+
+/* Cache key of a definition */
+uint64_t design_cache_key(const ExperimentDef *def);
+
+/* Map a cached design for def from dir; returns 0 on hit, -1 on miss or invalid entry */
+int design_cache_load(const char *dir, const ExperimentDef *def, CompiledDesign *out);
+
+/* Write a compiled design to dir; returns 0 on success */
+int design_cache_store(const char *dir, const ExperimentDef *def, const CompiledDesign *design);
+
+/* Release a mapping returned through CompiledDesign.mapping */
+void design_cache_unmap(void *mapping, size_t size);
+
+#endif /* DESIGN_CACHE_H */
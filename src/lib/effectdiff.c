@@ -0,0 +1,421 @@
+#include "effectdiff.h"
+#include "context.h"
+#include "stats.h"
+#include "utils.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+/* Runs with results in both campaigns */
+typedef struct {
+    CompiledDesign design;
+    size_t count;
+    size_t *row;            /* design row of each aligned run */
+    double *mean_a;         /* run means */
+    double *mean_b;
+    double *d;              /* mean_b - mean_a */
+    double *var_units;      /* variance of d in units of the error variance */
+    uint8_t *levels;        /* count x factor_count level indices */
+    double within_ss;       /* replicate sum of squares, both campaigns */
+    size_t within_df;
+} Aligned;
+
+static bool same_design(const ExperimentDef *a, const ExperimentDef *b) {
+    if (a == b) return true;
+    if (a->factor_count != b->factor_count ||
+        strcmp(a->array_type, b->array_type) != 0 ||
+        strcmp(a->whole_plot_array, b->whole_plot_array) != 0 ||
+        a->split_plot_layout != b->split_plot_layout) {
+        return false;
+    }
+    for (size_t f = 0; f < a->factor_count; f++) {
+        if (strcmp(a->factors[f].name, b->factors[f].name) != 0 ||
+            a->factors[f].level_count != b->factors[f].level_count ||
+            a->factors[f].whole_plot != b->factors[f].whole_plot) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Results and means per run of one campaign; returns the replicate SS */
+static double run_means(const ResultSet *results, size_t rows, size_t *n, double *mean,
+                        size_t *df_out) {
+    for (size_t i = 0; i < results->count; i++) {
+        size_t run_id = results->run_ids[i];
+        if (run_id < 1 || run_id > rows) continue;
+        n[run_id - 1]++;
+        mean[run_id - 1] += results->responses[i];
+    }
+    for (size_t r = 0; r < rows; r++) {
+        if (n[r] > 0) mean[r] /= (double)n[r];
+        if (n[r] > 1) *df_out += n[r] - 1;
+    }
+    double ss = 0.0;
+    for (size_t i = 0; i < results->count; i++) {
+        size_t run_id = results->run_ids[i];
+        if (run_id < 1 || run_id > rows) continue;
+        double e = results->responses[i] - mean[run_id - 1];
+        ss += e * e;
+    }
+    return ss;
+}
+
+static int align_runs(taguchi_context_t *ctx, const ResultSet *a, const ResultSet *b,
+                      Aligned *al, char *error_buf) {
+    memset(al, 0, sizeof(*al));
+    if (acquire_design(ctx, a->experiment_def, &al->design, error_buf) != 0) {
+        return -1;
+    }
+    size_t rows = al->design.rows;
+    size_t fc = al->design.factor_count;
+    size_t *n_a = xcalloc(rows + 1, sizeof(size_t));
+    size_t *n_b = xcalloc(rows + 1, sizeof(size_t));
+    double *sum_a = xcalloc(rows + 1, sizeof(double));
+    double *sum_b = xcalloc(rows + 1, sizeof(double));
+    al->within_ss = run_means(a, rows, n_a, sum_a, &al->within_df) +
+                    run_means(b, rows, n_b, sum_b, &al->within_df);
+
+    al->row = xmalloc((rows + 1) * sizeof(size_t));
+    al->mean_a = xmalloc((rows + 1) * sizeof(double));
+    al->mean_b = xmalloc((rows + 1) * sizeof(double));
+    al->d = xmalloc((rows + 1) * sizeof(double));
+    al->var_units = xmalloc((rows + 1) * sizeof(double));
+    al->levels = xmalloc(rows * fc + 1);
+    for (size_t r = 0; r < rows; r++) {
+        if (n_a[r] == 0 || n_b[r] == 0) continue;
+        size_t i = al->count++;
+        al->row[i] = r;
+        al->mean_a[i] = sum_a[r];
+        al->mean_b[i] = sum_b[r];
+        al->d[i] = sum_b[r] - sum_a[r];
+        al->var_units[i] = 1.0 / (double)n_a[r] + 1.0 / (double)n_b[r];
+        memcpy(&al->levels[i * fc], &al->design.levels[r * fc], fc);
+    }
+
+    free(n_a);
+    free(n_b);
+    free(sum_a);
+    free(sum_b);
+    return 0;
+}
+
+static void aligned_free(Aligned *al) {
+    free(al->row);
+    free(al->mean_a);
+    free(al->mean_b);
+    free(al->d);
+    free(al->var_units);
+    free(al->levels);
+    free_compiled_design(&al->design);
+}
+
+/* Sum over non-empty levels of (level sum of x)^2 / runs at the level; the
+ * between-level SS less the constant (sum of x)^2 / count */
+static double level_square_sum(const uint8_t *levels, size_t fc, size_t f, size_t level_count,
+                               const double *x, size_t count, double *sums, size_t *runs) {
+    for (size_t lv = 0; lv < level_count; lv++) {
+        sums[lv] = 0.0;
+        runs[lv] = 0;
+    }
+    for (size_t i = 0; i < count; i++) {
+        size_t lv = levels[i * fc + f];
+        if (lv >= level_count) continue;
+        sums[lv] += x[i];
+        runs[lv]++;
+    }
+    double q = 0.0;
+    for (size_t lv = 0; lv < level_count; lv++) {
+        if (runs[lv] > 0) q += sums[lv] * sums[lv] / (double)runs[lv];
+    }
+    return q;
+}
+
+/* Randomization test: shuffle d across the aligned runs and count, per
+ * factor, the shuffles whose statistic reaches the observed one */
+typedef struct {
+    taguchi_context_t *ctx;
+    const Aligned *al;
+    size_t factor_count;
+    const size_t *level_counts;
+    const double *observed;     /* level_square_sum of the observed d */
+    uint64_t seed;
+    size_t *exceed;
+} PermutationJob;
+
+static uint64_t splitmix_next(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/* Uniform in [0, bound), rejecting the draws that would bias the modulo */
+static size_t rng_below(uint64_t *state, size_t bound) {
+    uint64_t limit = UINT64_MAX - UINT64_MAX % bound;
+    uint64_t x;
+    do {
+        x = splitmix_next(state);
+    } while (x >= limit);
+    return (size_t)(x % bound);
+}
+
+static void permutation_chunk(void *arg, size_t begin, size_t end) {
+    const PermutationJob *job = arg;
+    const Aligned *al = job->al;
+    size_t n = al->count;
+    size_t fc = job->factor_count;
+
+    double *x = context_alloc(job->ctx, n * sizeof(double));
+    double *sums = context_alloc(job->ctx, MAX_LEVELS * sizeof(double));
+    size_t *runs = context_alloc(job->ctx, MAX_LEVELS * sizeof(size_t));
+    size_t *local = context_calloc(job->ctx, fc, sizeof(size_t));
+
+    for (size_t p = begin; p < end; p++) {
+        /* Every shuffle has its own stream, so p-values do not depend on
+         * how the permutations were split into chunks */
+        uint64_t state = job->seed ^ ((uint64_t)(p + 1) * 0xD1B54A32D192ED03ULL);
+        memcpy(x, al->d, n * sizeof(double));
+        for (size_t i = n - 1; i > 0; i--) {
+            size_t j = rng_below(&state, i + 1);
+            double t = x[i];
+            x[i] = x[j];
+            x[j] = t;
+        }
+        for (size_t f = 0; f < fc; f++) {
+            double q = level_square_sum(al->levels, fc, f, job->level_counts[f], x, n, sums, runs);
+            /* Shuffles that regroup the same runs differ by rounding only */
+            if (q >= job->observed[f] - 1e-10 * fabs(job->observed[f])) local[f]++;
+        }
+    }
+
+    for (size_t f = 0; f < fc; f++) {
+        if (local[f] > 0) __atomic_add_fetch(&job->exceed[f], local[f], __ATOMIC_RELAXED);
+    }
+    context_free(job->ctx, x);
+    context_free(job->ctx, sums);
+    context_free(job->ctx, runs);
+    context_free(job->ctx, local);
+}
+
+static int compare_changes(const void *a, const void *b) {
+    const taguchi_factor_change_t *x = a, *y = b;
+    double px = isnan(x->adjusted_p) ? 2.0 : x->adjusted_p;
+    double py = isnan(y->adjusted_p) ? 2.0 : y->adjusted_p;
+    if (px != py) return px < py ? -1 : 1;
+    if (x->sum_squares != y->sum_squares) return x->sum_squares > y->sum_squares ? -1 : 1;
+    return x->factor_index < y->factor_index ? -1 : (x->factor_index > y->factor_index);
+}
+
+/* Holm step-down adjustment of the factors' p-values */
+static void holm_adjust(taguchi_factor_change_t *changes, size_t count, double alpha) {
+    size_t *order = xmalloc((count + 1) * sizeof(size_t));
+    size_t tested = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!isnan(changes[i].p_value)) order[tested++] = i;
+    }
+    /* Insertion sort by raw p: one entry per factor */
+    for (size_t i = 1; i < tested; i++) {
+        size_t k = order[i], j = i;
+        while (j > 0 && changes[order[j - 1]].p_value > changes[k].p_value) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = k;
+    }
+    double running = 0.0;
+    for (size_t i = 0; i < tested; i++) {
+        taguchi_factor_change_t *c = &changes[order[i]];
+        double adj = c->p_value * (double)(tested - i);
+        if (adj > 1.0) adj = 1.0;
+        if (adj < running) adj = running;
+        running = adj;
+        c->adjusted_p = adj;
+        c->significant = adj <= alpha;
+    }
+    free(order);
+}
+
+int effect_diff(taguchi_context_t *ctx, const ResultSet *a, const ResultSet *b,
+                const taguchi_compare_options_t *opts, taguchi_factor_change_t **changes_out,
+                size_t *count_out, taguchi_comparison_summary_t *summary_out, char *error_buf) {
+    if (!a || !b || !a->experiment_def || !b->experiment_def || !opts || !changes_out ||
+        !count_out) {
+        set_error(error_buf, "Invalid parameters to effect_diff");
+        return -1;
+    }
+    if (!(opts->alpha > 0.0 && opts->alpha < 1.0)) {
+        set_error(error_buf, "Alpha must be between 0 and 1, got %g", opts->alpha);
+        return -1;
+    }
+    if (!same_design(a->experiment_def, b->experiment_def)) {
+        set_error(error_buf, "Campaigns were not run on the same design (array, factor names "
+                             "and level counts must match)");
+        return -1;
+    }
+
+    const ExperimentDef *def = a->experiment_def;
+    Aligned al;
+    if (align_runs(ctx, a, b, &al, error_buf) != 0) {
+        return -1;
+    }
+    size_t n = al.count;
+    size_t fc = def->factor_count;
+    if (n < 2) {
+        set_error(error_buf, "Campaigns share %zu run%s with results; need at least 2", n,
+                  n == 1 ? "" : "s");
+        aligned_free(&al);
+        return -1;
+    }
+
+    taguchi_factor_change_t *changes = xcalloc(fc + 1, sizeof(taguchi_factor_change_t));
+    size_t level_counts[MAX_FACTORS];
+    double observed[MAX_FACTORS];
+    double sums[MAX_LEVELS], sums_a[MAX_LEVELS], sums_b[MAX_LEVELS], vsum[MAX_LEVELS];
+    size_t runs[MAX_LEVELS];
+
+    double total = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        total += al.d[i];
+    }
+    double mean_d = total / (double)n;
+    double ss_total = 0.0, ss_raw = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        ss_total += (al.d[i] - mean_d) * (al.d[i] - mean_d);
+        ss_raw += al.d[i] * al.d[i];
+    }
+
+    size_t model_df = 0;
+    double model_ss = 0.0;
+    for (size_t f = 0; f < fc; f++) {
+        taguchi_factor_change_t *c = &changes[f];
+        size_t levels = def->factors[f].level_count;
+        snprintf(c->factor, sizeof(c->factor), "%s", def->factors[f].name);
+        c->factor_index = f;
+        c->level_count = levels;
+        c->p_value = NAN;
+        c->adjusted_p = NAN;
+        level_counts[f] = levels;
+
+        observed[f] = level_square_sum(al.levels, fc, f, levels, al.d, n, sums, runs);
+        size_t filled = 0;
+        for (size_t lv = 0; lv < levels; lv++) {
+            filled += runs[lv] > 0;
+        }
+        /* The difference of two large sums: below rounding it is no change */
+        c->sum_squares = observed[f] - total * total / (double)n;
+        if (c->sum_squares <= 1e-12 * ss_raw) c->sum_squares = 0.0;
+        c->df = filled > 0 ? filled - 1 : 0;
+        model_ss += c->sum_squares;
+        model_df += c->df;
+    }
+
+    /* Error variance: replicates first, else the residual of the
+     * main-effects model of d, whose runs then weigh 1 each */
+    taguchi_comparison_summary_t summary;
+    memset(&summary, 0, sizeof(summary));
+    summary.runs = n;
+    summary.shift = mean_d;
+    double sigma2 = NAN;
+    if (al.within_df > 0) {
+        summary.error_source = TAGUCHI_COMPARE_ERROR_REPLICATES;
+        summary.error_df = al.within_df;
+        sigma2 = al.within_ss / (double)al.within_df;
+    } else if (n > model_df + 1) {
+        summary.error_source = TAGUCHI_COMPARE_ERROR_RESIDUAL;
+        summary.error_df = n - 1 - model_df;
+        double ss_res = ss_total - model_ss;
+        sigma2 = (ss_res > 0.0 ? ss_res : 0.0) / (double)summary.error_df;
+        for (size_t i = 0; i < n; i++) {
+            al.var_units[i] = 1.0;
+        }
+    }
+    double total_units = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        total_units += al.var_units[i];
+    }
+    double unit_var = total_units / (double)n;   /* mean variance of a run difference */
+    summary.error_sd = isnan(sigma2) ? NAN : sqrt(sigma2 * unit_var);
+    summary.shift_se = isnan(sigma2) ? NAN : sqrt(sigma2 * total_units) / (double)n;
+
+    for (size_t f = 0; f < fc; f++) {
+        taguchi_factor_change_t *c = &changes[f];
+        size_t levels = c->level_count;
+        c->delta = xmalloc(levels * sizeof(double));
+        c->std_error = xmalloc(levels * sizeof(double));
+        level_square_sum(al.levels, fc, f, levels, al.d, n, sums, runs);
+        level_square_sum(al.levels, fc, f, levels, al.mean_a, n, sums_a, runs);
+        level_square_sum(al.levels, fc, f, levels, al.mean_b, n, sums_b, runs);
+        level_square_sum(al.levels, fc, f, levels, al.var_units, n, vsum, runs);
+
+        double lo_a = INFINITY, hi_a = -INFINITY, lo_b = INFINITY, hi_b = -INFINITY;
+        for (size_t lv = 0; lv < levels; lv++) {
+            if (runs[lv] == 0) {
+                c->delta[lv] = NAN;
+                c->std_error[lv] = NAN;
+                continue;
+            }
+            double k = (double)runs[lv];
+            double ma = sums_a[lv] / k, mb = sums_b[lv] / k;
+            if (ma < lo_a) lo_a = ma;
+            if (ma > hi_a) hi_a = ma;
+            if (mb < lo_b) lo_b = mb;
+            if (mb > hi_b) hi_b = mb;
+            c->delta[lv] = sums[lv] / k - mean_d;
+
+            /* delta = sum_i w_i d_i with w_i = [i at lv]/k - 1/n, so its
+             * variance is sigma2 * sum_i w_i^2 var_units_i */
+            double in = 1.0 / k - 1.0 / (double)n;
+            double out = 1.0 / (double)n;
+            double units = vsum[lv] * (in * in - out * out) + total_units * out * out;
+            c->std_error[lv] = isnan(sigma2) ? NAN : sqrt(sigma2 * (units > 0.0 ? units : 0.0));
+        }
+        c->range_a = hi_a >= lo_a ? hi_a - lo_a : 0.0;
+        c->range_b = hi_b >= lo_b ? hi_b - lo_b : 0.0;
+    }
+
+    if (opts->permutations > 0) {
+        size_t *exceed = xcalloc(fc + 1, sizeof(size_t));
+        PermutationJob job = { ctx, &al, fc, level_counts, observed, opts->seed, exceed };
+        /* A shuffle costs about n * (factor_count + 1) steps */
+        size_t grain = 65536 / (n * (fc + 1) + 1) + 1;
+        context_parallel_for(ctx, opts->permutations, grain, permutation_chunk, &job);
+        for (size_t f = 0; f < fc; f++) {
+            if (changes[f].df == 0) continue;
+            changes[f].p_value = (double)(exceed[f] + 1) / (double)(opts->permutations + 1);
+        }
+        summary.permutations = opts->permutations;
+        free(exceed);
+    } else if (!isnan(sigma2)) {
+        for (size_t f = 0; f < fc; f++) {
+            taguchi_factor_change_t *c = &changes[f];
+            if (c->df == 0) continue;
+            double ms_error = sigma2 * unit_var;
+            if (c->sum_squares == 0.0) {
+                c->p_value = 1.0;
+            } else if (ms_error <= 0.0) {
+                c->p_value = 0.0;
+            } else {
+                double f_ratio = (c->sum_squares / (double)c->df) / ms_error;
+                c->p_value = f_distribution_sf(f_ratio, (double)c->df, (double)summary.error_df);
+            }
+        }
+    } else {
+        set_error(error_buf, "No error estimate: the design is saturated and no run was "
+                             "replicated; replicate runs or use a permutation test");
+        taguchi_free_factor_changes(changes, fc);
+        aligned_free(&al);
+        return -1;
+    }
+
+    holm_adjust(changes, fc, opts->alpha);
+    qsort(changes, fc, sizeof(taguchi_factor_change_t), compare_changes);
+
+    *changes_out = changes;
+    *count_out = fc;
+    if (summary_out) *summary_out = summary;
+    aligned_free(&al);
+    return 0;
+}
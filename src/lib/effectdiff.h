@@ -0,0 +1,30 @@
+#ifndef EFFECTDIFF_H
+#define EFFECTDIFF_H
+
+#include <stddef.h>
+#include "analyzer.h"    // For ResultSet
+
+/*
+ * Effect differences between two campaigns on one design.
+ *
+ * Runs are aligned by run ID and reduced to d_r = mean_B(r) - mean_A(r).
+ * The change in factor f's effect at level l is the mean of d over the
+ * runs at l less the mean of d over all aligned runs, and f changed when
+ * d varies between its levels: its test statistic is the between-level sum
+ * of squares of d.  A uniform shift between campaigns (a faster machine)
+ * moves every d alike and changes no factor.
+ */
+
+/* Compare results a and b (see taguchi_compare_results_ctx) */
+int effect_diff(
+    taguchi_context_t *ctx,
+    const ResultSet *a,
+    const ResultSet *b,
+    const taguchi_compare_options_t *opts,
+    taguchi_factor_change_t **changes_out,
+    size_t *count_out,
+    taguchi_comparison_summary_t *summary_out,
+    char *error_buf
+);
+
+#endif /* EFFECTDIFF_H */
@@ -0,0 +1,294 @@
+#define _GNU_SOURCE
+#include "context.h"
+#include "utils.h"
+#include "include/taguchi.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+
+/*
+ * Futures for generate/analyze on the context pool.
+ *
+ * A future is shared by its owner and the queued task (two references);
+ * whoever drops the last one frees it.  The state becomes final, the
+ * eventfd is signalled and waiters are woken before the callback runs, so
+ * the callback (or any waiter) may free the future.
+ */
+
+typedef enum {
+    FUTURE_GENERATE,
+    FUTURE_EFFECTS
+} FutureKind;
+
+struct taguchi_future {
+    taguchi_context_t *ctx;
+    FutureKind kind;
+    const taguchi_experiment_def_t *def;
+    const taguchi_result_set_t *results;
+    taguchi_completion_fn on_complete;
+    void *user;
+    int event_fd;
+
+    pthread_mutex_t lock;
+    pthread_cond_t finished;
+    taguchi_future_status_t status;      /* written under lock, read atomically */
+    bool cancel_requested;
+    size_t refs;
+    char error[TAGUCHI_ERROR_SIZE];
+
+    /* Result (owned until taken) */
+    taguchi_experiment_run_t **runs;
+    taguchi_main_effect_t **effects;
+    size_t count;
+};
+
+static bool status_is_final(taguchi_future_status_t status) {
+    return status == TAGUCHI_FUTURE_DONE || status == TAGUCHI_FUTURE_FAILED ||
+           status == TAGUCHI_FUTURE_CANCELLED;
+}
+
+static void free_result(taguchi_future_t *f) {
+    if (f->runs) taguchi_free_runs(f->runs, f->count);
+    if (f->effects) taguchi_free_effects(f->effects, f->count);
+    f->runs = NULL;
+    f->effects = NULL;
+    f->count = 0;
+}
+
+static void future_release(taguchi_future_t *f) {
+    pthread_mutex_lock(&f->lock);
+    size_t refs = --f->refs;
+    pthread_mutex_unlock(&f->lock);
+    if (refs > 0) return;
+
+    free_result(f);
+    if (f->event_fd >= 0) close(f->event_fd);
+    pthread_mutex_destroy(&f->lock);
+    pthread_cond_destroy(&f->finished);
+    free(f);
+}
+
+static void future_task(void *arg, size_t begin, size_t end) {
+    (void)begin;
+    (void)end;
+    taguchi_future_t *f = arg;
+
+    pthread_mutex_lock(&f->lock);
+    bool cancelled = f->cancel_requested;
+    __atomic_store_n(&f->status, cancelled ? TAGUCHI_FUTURE_CANCELLED : TAGUCHI_FUTURE_RUNNING,
+                     __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&f->lock);
+
+    if (!cancelled) {
+        char error[TAGUCHI_ERROR_SIZE] = "";
+        taguchi_experiment_run_t **runs = NULL;
+        taguchi_main_effect_t **effects = NULL;
+        size_t count = 0;
+        int rc;
+        if (f->kind == FUTURE_GENERATE) {
+            rc = taguchi_generate_runs_ctx(f->ctx, f->def, &runs, &count, error);
+        } else {
+            rc = taguchi_calculate_main_effects_ctx(f->ctx, f->results, &effects, &count, error);
+        }
+
+        pthread_mutex_lock(&f->lock);
+        f->runs = runs;
+        f->effects = effects;
+        f->count = count;
+        taguchi_future_status_t status = TAGUCHI_FUTURE_DONE;
+        if (f->cancel_requested) {
+            /* Cancelled while running: the result is not wanted */
+            free_result(f);
+            status = TAGUCHI_FUTURE_CANCELLED;
+        } else if (rc != 0) {
+            free_result(f);
+            snprintf(f->error, sizeof(f->error), "%s", error);
+            status = TAGUCHI_FUTURE_FAILED;
+        }
+        __atomic_store_n(&f->status, status, __ATOMIC_RELEASE);
+        pthread_mutex_unlock(&f->lock);
+    }
+
+    pthread_mutex_lock(&f->lock);
+    pthread_cond_broadcast(&f->finished);
+    pthread_mutex_unlock(&f->lock);
+    if (f->event_fd >= 0) {
+        uint64_t one = 1;
+        ssize_t n;
+        do {
+            n = write(f->event_fd, &one, sizeof(one));
+        } while (n < 0 && errno == EINTR);
+    }
+    if (f->on_complete) {
+        f->on_complete(f, f->user);
+    }
+    future_release(f);
+}
+
+static taguchi_future_t *future_start(taguchi_context_t *ctx, FutureKind kind,
+                                      const taguchi_experiment_def_t *def,
+                                      const taguchi_result_set_t *results,
+                                      taguchi_completion_fn on_complete, void *user,
+                                      char *error_buf) {
+    taguchi_future_t *f = xcalloc(1, sizeof(taguchi_future_t));
+    f->ctx = context_resolve(ctx);
+    f->kind = kind;
+    f->def = def;
+    f->results = results;
+    f->on_complete = on_complete;
+    f->user = user;
+    f->status = TAGUCHI_FUTURE_PENDING;
+    f->refs = 2;    /* owner + task */
+    f->event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    pthread_mutex_init(&f->lock, NULL);
+    pthread_cond_init(&f->finished, NULL);
+
+    if (context_submit(f->ctx, future_task, f) != 0) {
+        set_error(error_buf, "Cannot start a worker thread for the async operation");
+        f->refs = 1;
+        future_release(f);
+        return NULL;
+    }
+    return f;
+}
+
+taguchi_future_t *taguchi_generate_runs_async(taguchi_context_t *ctx,
+                                              const taguchi_experiment_def_t *def,
+                                              taguchi_completion_fn on_complete, void *user,
+                                              char *error_buf) {
+    if (!def) {
+        set_error(error_buf, "Invalid parameters to taguchi_generate_runs_async");
+        return NULL;
+    }
+    return future_start(ctx, FUTURE_GENERATE, def, NULL, on_complete, user, error_buf);
+}
+
+taguchi_future_t *taguchi_calculate_main_effects_async(taguchi_context_t *ctx,
+                                                       const taguchi_result_set_t *results,
+                                                       taguchi_completion_fn on_complete,
+                                                       void *user, char *error_buf) {
+    if (!results) {
+        set_error(error_buf, "Invalid parameters to taguchi_calculate_main_effects_async");
+        return NULL;
+    }
+    return future_start(ctx, FUTURE_EFFECTS, NULL, results, on_complete, user, error_buf);
+}
+
+taguchi_future_status_t taguchi_future_status(const taguchi_future_t *future) {
+    if (!future) return TAGUCHI_FUTURE_FAILED;
+    return __atomic_load_n(&future->status, __ATOMIC_ACQUIRE);
+}
+
+int taguchi_future_fd(const taguchi_future_t *future) {
+    return future ? future->event_fd : -1;
+}
+
+taguchi_future_status_t taguchi_future_wait(taguchi_future_t *future, int timeout_ms) {
+    if (!future) return TAGUCHI_FUTURE_FAILED;
+
+    struct timespec deadline;
+    if (timeout_ms >= 0) {
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += timeout_ms / 1000;
+        deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    pthread_mutex_lock(&future->lock);
+    while (!status_is_final(future->status)) {
+        if (timeout_ms < 0) {
+            pthread_cond_wait(&future->finished, &future->lock);
+        } else if (pthread_cond_timedwait(&future->finished, &future->lock, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    taguchi_future_status_t status = future->status;
+    pthread_mutex_unlock(&future->lock);
+    return status;
+}
+
+int taguchi_future_cancel(taguchi_future_t *future) {
+    if (!future) return -1;
+    pthread_mutex_lock(&future->lock);
+    int rc = status_is_final(future->status) ? -1 : 0;
+    if (rc == 0) {
+        future->cancel_requested = true;
+    }
+    pthread_mutex_unlock(&future->lock);
+    return rc;
+}
+
+const char *taguchi_future_error(const taguchi_future_t *future) {
+    if (!future || taguchi_future_status(future) != TAGUCHI_FUTURE_FAILED) return "";
+    return future->error;
+}
+
+/* Move the result out of a DONE future of the given kind */
+static int future_take(taguchi_future_t *future, FutureKind kind, char *error_buf) {
+    if (taguchi_future_status(future) != TAGUCHI_FUTURE_DONE) {
+        set_error(error_buf, "Async operation has not completed successfully");
+        return -1;
+    }
+    if (future->kind != kind) {
+        set_error(error_buf, "Async operation produced a different result type");
+        return -1;
+    }
+    if (!future->runs && !future->effects) {
+        set_error(error_buf, "Async result was already taken");
+        return -1;
+    }
+    return 0;
+}
+
+int taguchi_future_take_runs(taguchi_future_t *future, taguchi_experiment_run_t ***runs_out,
+                             size_t *count_out, char *error_buf) {
+    if (!future || !runs_out || !count_out) {
+        set_error(error_buf, "Invalid parameters to taguchi_future_take_runs");
+        return -1;
+    }
+    pthread_mutex_lock(&future->lock);
+    int rc = future_take(future, FUTURE_GENERATE, error_buf);
+    if (rc == 0) {
+        *runs_out = future->runs;
+        *count_out = future->count;
+        future->runs = NULL;
+        future->count = 0;
+    }
+    pthread_mutex_unlock(&future->lock);
+    return rc;
+}
+
+int taguchi_future_take_effects(taguchi_future_t *future, taguchi_main_effect_t ***effects_out,
+                                size_t *count_out, char *error_buf) {
+    if (!future || !effects_out || !count_out) {
+        set_error(error_buf, "Invalid parameters to taguchi_future_take_effects");
+        return -1;
+    }
+    pthread_mutex_lock(&future->lock);
+    int rc = future_take(future, FUTURE_EFFECTS, error_buf);
+    if (rc == 0) {
+        *effects_out = future->effects;
+        *count_out = future->count;
+        future->effects = NULL;
+        future->count = 0;
+    }
+    pthread_mutex_unlock(&future->lock);
+    return rc;
+}
+
+void taguchi_future_free(taguchi_future_t *future) {
+    if (!future) return;
+    /* Inputs belong to the caller: the task must be done with them first */
+    taguchi_future_cancel(future);
+    taguchi_future_wait(future, -1);
+    future_release(future);
+}
@@ -1,9 +1,14 @@
 #include "generator.h"
 #include "utils.h"
 #include "arrays.h"
+#include "design_cache.h"
+#include "context.h"
+#include "splitplot.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#include <pthread.h>
 
 /* Helper function to find the best array for the given factors */
 static const OrthogonalArray *get_suggested_array_for_factors(const ExperimentDef *def, char *error_buf) {
@@ -142,16 +147,8 @@ bool check_array_compatibility(const ExperimentDef *def, const OrthogonalArray *
     return true;
 }
 
-/* Generate experiments from definition (with column pairing and mixed-level support) */
-int generate_experiments(const ExperimentDef *def, ExperimentRun **runs_out, size_t *count_out, char *error_buf) {
-    if (!def || !runs_out || !count_out) {
-        if (error_buf) {
-            strcpy(error_buf, "Invalid parameters to generate_experiments");
-        }
-        return -1;
-    }
-
-    /* Find the corresponding array */
+/* Resolve the array a definition uses: the named one, or the auto-selected one */
+static const OrthogonalArray *resolve_array(const ExperimentDef *def, char *error_buf) {
     const OrthogonalArray *array = NULL;
 
     if (strlen(def->array_type) == 0) {
@@ -161,7 +158,7 @@ int generate_experiments(const ExperimentDef *def, ExperimentRun **runs_out, siz
                 set_error(error_buf, "No suitable array found for %zu factors. "
                          "Either specify an array or reduce factor/level count.", def->factor_count);
             }
-            return -1;
+            return NULL;
         }
     } else {
         array = get_array(def->array_type);
@@ -169,12 +166,170 @@ int generate_experiments(const ExperimentDef *def, ExperimentRun **runs_out, siz
             if (error_buf) {
                 set_error(error_buf, "Unknown array type: %s", def->array_type);
             }
-            return -1;
+            return NULL;
         }
     }
 
     /* Check compatibility */
     if (!check_array_compatibility(def, array, error_buf)) {
+        return NULL;
+    }
+    return array;
+}
+
+/*
+ * Level-index kernels.  A factor's level index is its array columns read as
+ * digits of the array base (column pairing), folded onto the factor's level
+ * count by modulo (mixed-level support: a 2-level factor in a 3-level array
+ * maps 0,1,2 to 0,1,0).  Both steps are fixed per factor, so compile_design
+ * picks a kernel once per factor, with the base as a compile-time constant,
+ * and the modulo precomputed into a table per level count; each row is then
+ * a table lookup.
+ *
+ * The combined value stays below level_count * base <= MAX_LEVELS * 5, so
+ * the table covers every value a catalog array can produce, and no factor
+ * needs more columns than MAX_LEVELS does in base 2 (5).
+ */
+#define KERNEL_MAP_SIZE 256
+#define KERNEL_MAX_COLS 8
+
+typedef struct FactorKernel FactorKernel;
+
+/* Fill count rows of one factor: cells advance by stride, out by out_stride */
+typedef void (*FactorKernelFn)(const FactorKernel *k, const int *cells, size_t stride,
+                               uint8_t *out, size_t out_stride, size_t count);
+
+struct FactorKernel {
+    FactorKernelFn fn;
+    const uint8_t *map;                   /* combined value -> level index */
+    uint32_t start;                       /* first array column */
+    uint32_t ncols;                       /* columns combined */
+    uint32_t multiplier[KERNEL_MAX_COLS]; /* base^(ncols - 1 - c) (generic kernel) */
+};
+
+/* level_maps[n][v] = v % n, shared by every design */
+static uint8_t level_maps[MAX_LEVELS + 1][KERNEL_MAP_SIZE];
+static pthread_once_t level_maps_once = PTHREAD_ONCE_INIT;
+
+static void init_level_maps(void) {
+    for (size_t n = 1; n <= MAX_LEVELS; n++) {
+        for (size_t v = 0; v < KERNEL_MAP_SIZE; v++) {
+            level_maps[n][v] = (uint8_t)(v % n);
+        }
+    }
+}
+
+static void kernel_single(const FactorKernel *k, const int *cells, size_t stride,
+                          uint8_t *out, size_t out_stride, size_t count) {
+    const uint8_t *map = k->map;
+    for (size_t r = 0; r < count; r++) {
+        out[r * out_stride] = map[cells[r * stride]];
+    }
+}
+
+#define PAIRED_KERNEL(name, BASE)                                              \
+    static void name(const FactorKernel *k, const int *cells, size_t stride,  \
+                     uint8_t *out, size_t out_stride, size_t count) {          \
+        const uint8_t *map = k->map;                                           \
+        for (size_t r = 0; r < count; r++) {                                   \
+            const int *c = &cells[r * stride];                                 \
+            out[r * out_stride] = map[c[0] * (BASE) + c[1]];                   \
+        }                                                                      \
+    }
+
+#define TRIPLED_KERNEL(name, BASE)                                             \
+    static void name(const FactorKernel *k, const int *cells, size_t stride,  \
+                     uint8_t *out, size_t out_stride, size_t count) {          \
+        const uint8_t *map = k->map;                                           \
+        for (size_t r = 0; r < count; r++) {                                   \
+            const int *c = &cells[r * stride];                                 \
+            out[r * out_stride] = map[(c[0] * (BASE) + c[1]) * (BASE) + c[2]]; \
+        }                                                                      \
+    }
+
+PAIRED_KERNEL(kernel_paired_2, 2)
+PAIRED_KERNEL(kernel_paired_3, 3)
+PAIRED_KERNEL(kernel_paired_5, 5)
+TRIPLED_KERNEL(kernel_tripled_2, 2)
+TRIPLED_KERNEL(kernel_tripled_3, 3)
+TRIPLED_KERNEL(kernel_tripled_5, 5)
+
+/* Any other base or column count (e.g. a 9+ level factor in a 2-level array) */
+static void kernel_generic(const FactorKernel *k, const int *cells, size_t stride,
+                           uint8_t *out, size_t out_stride, size_t count) {
+    for (size_t r = 0; r < count; r++) {
+        const int *c = &cells[r * stride];
+        size_t value = 0;
+        for (size_t i = 0; i < k->ncols; i++) {
+            value += (size_t)c[i] * k->multiplier[i];
+        }
+        out[r * out_stride] = k->map[value];
+    }
+}
+
+/* Choose and prepare the kernel for a factor using ncols columns from start */
+static void prepare_kernel(FactorKernel *k, size_t start, size_t ncols, size_t base,
+                           size_t level_count) {
+    pthread_once(&level_maps_once, init_level_maps);
+    k->map = level_maps[level_count];
+    k->start = (uint32_t)start;
+    k->ncols = (uint32_t)ncols;
+    uint32_t m = 1;
+    for (size_t i = ncols; i-- > 0;) {
+        k->multiplier[i] = m;
+        m *= (uint32_t)base;
+    }
+
+    k->fn = kernel_generic;
+    if (ncols == 1) {
+        k->fn = kernel_single;
+    } else if (ncols == 2) {
+        if (base == 2) k->fn = kernel_paired_2;
+        else if (base == 3) k->fn = kernel_paired_3;
+        else if (base == 5) k->fn = kernel_paired_5;
+    } else if (ncols == 3) {
+        if (base == 2) k->fn = kernel_tripled_2;
+        else if (base == 3) k->fn = kernel_tripled_3;
+        else if (base == 5) k->fn = kernel_tripled_5;
+    }
+}
+
+/* Shared state for filling rows of the level matrix */
+typedef struct {
+    const OrthogonalArray *array;
+    const FactorKernel *kernels;
+    size_t factor_count;
+    uint8_t *levels;
+} CompileJob;
+
+/* Map array values to factor level indices for rows [begin, end), factor by factor */
+static void compile_rows(void *arg, size_t begin, size_t end) {
+    const CompileJob *job = arg;
+    const OrthogonalArray *array = job->array;
+    size_t fc = job->factor_count;
+
+    for (size_t factor_idx = 0; factor_idx < fc; factor_idx++) {
+        const FactorKernel *k = &job->kernels[factor_idx];
+        k->fn(k, &array->data[begin * array->cols + k->start], array->cols,
+              &job->levels[begin * fc + factor_idx], fc, end - begin);
+    }
+}
+
+/* Compile a definition into its array choice, column map and level matrix */
+int compile_design(taguchi_context_t *ctx, const ExperimentDef *def, CompiledDesign *out, char *error_buf) {
+    if (!def || !out) {
+        if (error_buf) {
+            strcpy(error_buf, "Invalid parameters to compile_design");
+        }
+        return -1;
+    }
+    if (def_is_split_plot(def)) {
+        return compile_split_plot_design(ctx, def, out, error_buf);
+    }
+    memset(out, 0, sizeof(*out));
+
+    const OrthogonalArray *array = resolve_array(def, error_buf);
+    if (!array) {
         return -1;
     }
 
@@ -182,8 +337,8 @@ int generate_experiments(const ExperimentDef *def, ExperimentRun **runs_out, siz
      * Build column assignment map: for each factor, record which OA columns
      * it uses and how many.
      */
-    size_t col_start[MAX_FACTORS];  /* first OA column for each factor */
-    size_t col_count[MAX_FACTORS];  /* number of OA columns for each factor */
+    uint32_t *col_start = out->col_start;  /* first OA column for each factor */
+    uint32_t *col_count = out->col_count;  /* number of OA columns for each factor */
 
     if (array->col_levels != NULL) {
         /*
@@ -197,11 +352,11 @@ int generate_experiments(const ExperimentDef *def, ExperimentRun **runs_out, siz
         for (size_t i = 0; i < def->factor_count; i++) {
             size_t needed = def->factors[i].level_count;
             col_count[i] = 1;
-            col_start[i] = array->cols; /* sentinel */
+            col_start[i] = (uint32_t)array->cols; /* sentinel */
 
             for (size_t c = 0; c < array->cols && c < 64; c++) {
                 if (!col_used[c] && (size_t)array->col_levels[c] == needed) {
-                    col_start[i] = c;
+                    col_start[i] = (uint32_t)c;
                     col_used[c] = true;
                     break;
                 }
@@ -212,69 +367,136 @@ int generate_experiments(const ExperimentDef *def, ExperimentRun **runs_out, siz
         /* Homogeneous array: sequential assignment with column pairing */
         size_t next_col = 0;
         for (size_t i = 0; i < def->factor_count; i++) {
-            col_count[i] = columns_needed_for_factor(def->factors[i].level_count, array->levels);
-            col_start[i] = next_col;
+            col_count[i] = (uint32_t)columns_needed_for_factor(def->factors[i].level_count, array->levels);
+            col_start[i] = (uint32_t)next_col;
             next_col += col_count[i];
         }
     }
 
-    /* Allocate runs array */
-    ExperimentRun *runs = xcalloc(array->rows, sizeof(ExperimentRun));
+    size_t fc = def->factor_count;
+    FactorKernel kernels[MAX_FACTORS];
+    for (size_t i = 0; i < fc; i++) {
+        /* Mixed-level columns are single, so their own level count never matters */
+        prepare_kernel(&kernels[i], col_start[i], col_count[i], array->levels,
+                       def->factors[i].level_count);
+    }
+    uint8_t *levels = xmalloc(array->rows * fc + 1);
+
+    CompileJob job;
+    job.array = array;
+    job.kernels = kernels;
+    job.factor_count = fc;
+    job.levels = levels;
+    /* Rows are independent; only large designs are worth splitting */
+    context_parallel_for(ctx, array->rows, 65536 / (fc + 1) + 1, compile_rows, &job);
+
+    strcpy(out->array_name, array->name);
+    out->rows = array->rows;
+    out->factor_count = fc;
+    out->levels = levels;
+    out->owned = levels;
+    return 0;
+}
+
+/* Release a compiled design, whether heap-built or mapped from the cache */
+void free_compiled_design(CompiledDesign *design) {
+    if (!design) return;
+    if (design->mapping) {
+        design_cache_unmap(design->mapping, design->mapping_size);
+    }
+    free(design->owned);
+    design->levels = NULL;
+    design->owned = NULL;
+    design->mapping = NULL;
+    design->mapping_size = 0;
+}
+
+/* Compiled design for a definition: from the design cache when enabled, else built */
+int acquire_design(taguchi_context_t *ctx, const ExperimentDef *def, CompiledDesign *out, char *error_buf) {
+    if (!def || !out) {
+        if (error_buf) {
+            strcpy(error_buf, "Invalid parameters to acquire_design");
+        }
+        return -1;
+    }
+    char dir[PATH_MAX];
+    /* Cache entries describe a single array; split-plot designs combine or
+     * reorder arrays and are cheap to rebuild from cached parts */
+    bool cached = !def_is_split_plot(def) && context_cache_dir(ctx, dir, sizeof(dir));
+    if (cached && design_cache_load(dir, def, out) == 0) {
+        return 0;
+    }
+    if (compile_design(ctx, def, out, error_buf) != 0) {
+        return -1;
+    }
+    /* Best effort: a cache that cannot be written never fails generation */
+    if (cached) {
+        design_cache_store(dir, def, out);
+    }
+    return 0;
+}
+
+/* Shared state for expanding a compiled design into runs */
+typedef struct {
+    const ExperimentDef *def;
+    const CompiledDesign *design;
+    ExperimentRun *runs;
+} ExpandJob;
+
+static void expand_rows(void *arg, size_t begin, size_t end) {
+    const ExpandJob *job = arg;
+    const ExperimentDef *def = job->def;
 
-    /* Generate each run */
-    for (size_t run_idx = 0; run_idx < array->rows; run_idx++) {
-        ExperimentRun *run = &runs[run_idx];
+    for (size_t run_idx = begin; run_idx < end; run_idx++) {
+        ExperimentRun *run = &job->runs[run_idx];
+        const uint8_t *row = &job->design->levels[run_idx * job->design->factor_count];
         run->run_id = run_idx + 1;
         run->factor_count = def->factor_count;
 
-        /* Copy factor names */
         for (size_t factor_idx = 0; factor_idx < def->factor_count; factor_idx++) {
+            size_t level_index = row[factor_idx];
             strcpy(run->factor_names[factor_idx], def->factors[factor_idx].name);
+            run->level_indices[factor_idx] = level_index;
+            strcpy(run->values[factor_idx], def->factors[factor_idx].values[level_index]);
         }
+    }
+}
 
-        /* Map array values to factor levels (with column pairing) */
-        for (size_t factor_idx = 0; factor_idx < def->factor_count; factor_idx++) {
-            const Factor *factor = &def->factors[factor_idx];
-            int level_index = 0;
-
-            if (col_count[factor_idx] == 1) {
-                /* Single column: direct mapping */
-                level_index = array->data[run_idx * array->cols + col_start[factor_idx]];
-            } else {
-                /* Multiple columns (column pairing): combine values */
-                /* level_index = col_a * base^(n-1) + col_b * base^(n-2) + ... */
-                size_t base = array->levels;
-                level_index = 0;
-                for (size_t c = 0; c < col_count[factor_idx]; c++) {
-                    int col_val = array->data[run_idx * array->cols + col_start[factor_idx] + c];
-                    /* Multiply by base^(remaining positions) */
-                    size_t multiplier = 1;
-                    for (size_t p = c + 1; p < col_count[factor_idx]; p++) {
-                        multiplier *= base;
-                    }
-                    level_index += col_val * (int)multiplier;
-                }
-            }
-
-            /*
-             * Mixed-level support: if the computed index exceeds the factor's
-             * level count, wrap using modulo. This handles cases like:
-             * - 2-level factor in 3-level array (index 0,1,2 -> level 0,1,0)
-             * - 5-level factor using 2 paired columns (index 0-8 -> level 0-4,0-3)
-             */
-            if (level_index < 0) level_index = 0;
-            level_index = level_index % (int)factor->level_count;
-
-            run->level_indices[factor_idx] = (size_t)level_index;
-            strcpy(run->values[factor_idx], factor->values[level_index]);
+/* Generate experiments from definition (with column pairing and mixed-level support) */
+int generate_experiments_in(taguchi_context_t *ctx, const ExperimentDef *def,
+                            ExperimentRun **runs_out, size_t *count_out, char *error_buf) {
+    if (!def || !runs_out || !count_out) {
+        if (error_buf) {
+            strcpy(error_buf, "Invalid parameters to generate_experiments");
         }
+        return -1;
     }
 
+    CompiledDesign design;
+    if (acquire_design(ctx, def, &design, error_buf) != 0) {
+        return -1;
+    }
+
+    /* Allocate runs array */
+    ExperimentRun *runs = xcalloc(design.rows, sizeof(ExperimentRun));
+
+    ExpandJob job;
+    job.def = def;
+    job.design = &design;
+    job.runs = runs;
+    /* Each run touches ~50 KB; a few hundred per chunk amortizes scheduling */
+    context_parallel_for(ctx, design.rows, 256, expand_rows, &job);
+
     *runs_out = runs;
-    *count_out = array->rows;
+    *count_out = design.rows;
+    free_compiled_design(&design);
     return 0;
 }
 
+int generate_experiments(const ExperimentDef *def, ExperimentRun **runs_out, size_t *count_out, char *error_buf) {
+    return generate_experiments_in(NULL, def, runs_out, count_out, error_buf);
+}
+
 /* Free generated runs */
 void free_experiments(ExperimentRun *runs, size_t count) {
     if (runs) {
@@ -3,8 +3,10 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include "parser.h"  // For ExperimentDef
 #include "arrays.h"  // For OrthogonalArray
+#include "include/taguchi.h"  // For taguchi_context_t
 
 /* Internal structure for generated experiment run */
 typedef struct {
@@ -15,6 +17,45 @@ typedef struct {
     char factor_names[MAX_FACTORS][MAX_FACTOR_NAME];
 } ExperimentRun;
 
+/*
+ * Compiled design: everything generation derives from a definition before
+ * level values are filled in.  Level indices are stored as one byte per
+ * cell (MAX_LEVELS fits), row-major, rows x factor_count.  The matrix is
+ * either heap-owned or points into an mmap'd design cache file.
+ */
+typedef struct {
+    char array_name[8];
+    size_t rows;
+    size_t factor_count;
+    uint32_t col_start[MAX_FACTORS];  /* first OA column for each factor */
+    uint32_t col_count[MAX_FACTORS];  /* OA columns used by each factor */
+    const uint8_t *levels;            /* level index matrix */
+    uint8_t *owned;                   /* heap matrix to free, or NULL */
+    char whole_plot_array[8];         /* crossed split-plot: whole-plot array */
+    size_t plot_rows;                 /* crossed split-plot: runs per whole plot, else 0 */
+    void *mapping;                    /* cache file mapping, or NULL */
+    size_t mapping_size;
+} CompiledDesign;
+
+/* Compile a definition (array choice, column map, level matrix) on ctx */
+int compile_design(
+    taguchi_context_t *ctx,
+    const ExperimentDef *def,
+    CompiledDesign *out,
+    char *error_buf
+);
+
+/* Compiled design from ctx's design cache if enabled, otherwise compile_design */
+int acquire_design(
+    taguchi_context_t *ctx,
+    const ExperimentDef *def,
+    CompiledDesign *out,
+    char *error_buf
+);
+
+/* Release a compiled design */
+void free_compiled_design(CompiledDesign *design);
+
 /* Generate experiments from definition */
 int generate_experiments(
     const ExperimentDef *def,
@@ -23,6 +64,15 @@ int generate_experiments(
     char *error_buf
 );
 
+/* Same, scheduling work on ctx (NULL = default context) */
+int generate_experiments_in(
+    taguchi_context_t *ctx,
+    const ExperimentDef *def,
+    ExperimentRun **runs_out,
+    size_t *count_out,
+    char *error_buf
+);
+
 /* Free generated runs */
 void free_experiments(ExperimentRun *runs, size_t count);
 
@@ -0,0 +1,299 @@
+#include "ingest.h"
+#include "generator.h"
+#include "utils.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * The ring is a bounded MPMC-style array queue (per-cell sequence
+ * numbers; D. Vyukov) used with one consumer: producers claim a slot with
+ * a CAS on enqueue_pos, fill it and release it by bumping the cell's
+ * sequence.  The consumer publishes accumulator updates under `version`,
+ * a sequence lock: odd while a batch is being applied.
+ */
+
+#define INGEST_CACHE_LINE 64
+#define INGEST_PUBLISH_BATCH 256   /* results applied per writer section */
+
+typedef struct {
+    size_t seq;
+    size_t run_id;
+    double response;
+} IngestCell;
+
+struct IngestQueue {
+    IngestCell *cells;
+    size_t mask;
+    char pad0[INGEST_CACHE_LINE];
+    size_t enqueue_pos;             /* shared by producers */
+    char pad1[INGEST_CACHE_LINE];
+    size_t dequeue_pos;             /* consumer only */
+    size_t dropped;                 /* atomic */
+    char pad2[INGEST_CACHE_LINE];
+
+    const ExperimentDef *def;
+    CompiledDesign design;
+    ResultSet *log;                 /* consumer-owned copy of accepted results */
+
+    /* Published state, guarded by version */
+    unsigned long version;
+    size_t observations;
+    size_t rejected;
+    double *run_sums;               /* [rows] */
+    size_t *run_counts;
+    size_t level_base[MAX_FACTORS]; /* offset of each factor's levels */
+    size_t level_total;
+    double *level_sums;             /* [level_total] sums of run means */
+    size_t *level_counts;           /* runs with results, per level */
+};
+
+/* Relaxed atomic accessors: readers may race with the consumer by design */
+static double load_double(const double *p) {
+    double v;
+    __atomic_load(p, &v, __ATOMIC_RELAXED);
+    return v;
+}
+
+static void store_double(double *p, double v) {
+    __atomic_store(p, &v, __ATOMIC_RELAXED);
+}
+
+static size_t load_size(const size_t *p) {
+    return __atomic_load_n(p, __ATOMIC_RELAXED);
+}
+
+static void add_size(size_t *p, size_t n) {
+    __atomic_store_n(p, *p + n, __ATOMIC_RELAXED);
+}
+
+IngestQueue *ingest_create(const ExperimentDef *def, size_t capacity, char *error_buf) {
+    if (!def || capacity == 0) {
+        set_error(error_buf, "Invalid parameters to ingest_create");
+        return NULL;
+    }
+    if (capacity > ((size_t)1 << 30)) {
+        set_error(error_buf, "Ingestion queue capacity too large: %zu", capacity);
+        return NULL;
+    }
+
+    IngestQueue *q = xcalloc(1, sizeof(IngestQueue));
+    if (acquire_design(NULL, def, &q->design, error_buf) != 0) {
+        free(q);
+        return NULL;
+    }
+    q->def = def;
+    q->log = create_result_set(def, "response");
+
+    size_t ring = 2;
+    while (ring < capacity) ring <<= 1;
+    q->cells = xcalloc(ring, sizeof(IngestCell));
+    q->mask = ring - 1;
+    for (size_t i = 0; i < ring; i++) {
+        q->cells[i].seq = i;
+    }
+
+    q->run_sums = xcalloc(q->design.rows + 1, sizeof(double));
+    q->run_counts = xcalloc(q->design.rows + 1, sizeof(size_t));
+    for (size_t f = 0; f < def->factor_count; f++) {
+        q->level_base[f] = q->level_total;
+        q->level_total += def->factors[f].level_count;
+    }
+    q->level_sums = xcalloc(q->level_total + 1, sizeof(double));
+    q->level_counts = xcalloc(q->level_total + 1, sizeof(size_t));
+    return q;
+}
+
+int ingest_push(IngestQueue *q, size_t run_id, double response) {
+    if (!q) return -1;
+
+    size_t pos = __atomic_load_n(&q->enqueue_pos, __ATOMIC_RELAXED);
+    IngestCell *cell;
+    for (;;) {
+        cell = &q->cells[pos & q->mask];
+        size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&q->enqueue_pos, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+            /* pos was reloaded by the failed CAS */
+        } else if (diff < 0) {
+            /* The consumer has not freed this cell yet: the ring is full */
+            __atomic_add_fetch(&q->dropped, 1, __ATOMIC_RELAXED);
+            return -1;
+        } else {
+            pos = __atomic_load_n(&q->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+    cell->run_id = run_id;
+    cell->response = response;
+    __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+/* Fold one result into the accumulators (inside a writer section) */
+static void apply_result(IngestQueue *q, size_t run_id, double response) {
+    if (run_id < 1 || run_id > q->design.rows) {
+        add_size(&q->rejected, 1);
+        return;
+    }
+    add_result(q->log, run_id, response);
+    size_t r = run_id - 1;
+    size_t n = q->run_counts[r];
+    double old_mean = n > 0 ? q->run_sums[r] / (double)n : 0.0;
+    store_double(&q->run_sums[r], q->run_sums[r] + response);
+    add_size(&q->run_counts[r], 1);
+
+    /* Level sums hold run means (as calculate_main_effects averages them):
+     * move this run's contribution from its old mean to the new one */
+    double delta = q->run_sums[r] / (double)(n + 1) - old_mean;
+    const uint8_t *row = &q->design.levels[r * q->design.factor_count];
+    for (size_t f = 0; f < q->design.factor_count; f++) {
+        size_t slot = q->level_base[f] + row[f];
+        store_double(&q->level_sums[slot], q->level_sums[slot] + delta);
+        if (n == 0) add_size(&q->level_counts[slot], 1);
+    }
+    add_size(&q->observations, 1);
+}
+
+size_t ingest_drain(IngestQueue *q, size_t max_items) {
+    if (!q) return 0;
+
+    size_t drained = 0;
+    bool more = true;
+    while (more && (max_items == 0 || drained < max_items)) {
+        unsigned long v = q->version;
+        bool open = false;
+
+        for (size_t n = 0; n < INGEST_PUBLISH_BATCH; n++) {
+            if (max_items != 0 && drained >= max_items) break;
+            IngestCell *cell = &q->cells[q->dequeue_pos & q->mask];
+            size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+            if (seq != q->dequeue_pos + 1) {
+                more = false;
+                break;
+            }
+            size_t run_id = cell->run_id;
+            double response = cell->response;
+            /* Hand the cell back to producers one lap ahead */
+            __atomic_store_n(&cell->seq, q->dequeue_pos + q->mask + 1, __ATOMIC_RELEASE);
+            q->dequeue_pos++;
+
+            if (!open) {
+                __atomic_store_n(&q->version, v + 1, __ATOMIC_RELAXED);
+                __atomic_thread_fence(__ATOMIC_RELEASE);
+                open = true;
+            }
+            apply_result(q, run_id, response);
+            drained++;
+        }
+        if (open) {
+            __atomic_store_n(&q->version, v + 2, __ATOMIC_RELEASE);
+        }
+    }
+    return drained;
+}
+
+/* Copy the published accumulators; retries while a batch is being applied */
+static void read_consistent(const IngestQueue *q, double *sums, size_t *counts,
+                            size_t *observations) {
+    for (;;) {
+        unsigned long v1 = __atomic_load_n(&q->version, __ATOMIC_ACQUIRE);
+        if (v1 & 1) continue;
+        for (size_t i = 0; i < q->level_total; i++) {
+            sums[i] = load_double(&q->level_sums[i]);
+            counts[i] = load_size(&q->level_counts[i]);
+        }
+        *observations = load_size(&q->observations);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&q->version, __ATOMIC_RELAXED) == v1) return;
+    }
+}
+
+int ingest_snapshot_effects(const IngestQueue *q, MainEffect **effects_out,
+                            size_t *count_out, size_t *observations_out) {
+    if (!q || !effects_out || !count_out) return -1;
+
+    double *sums = xmalloc((q->level_total + 1) * sizeof(double));
+    size_t *counts = xmalloc((q->level_total + 1) * sizeof(size_t));
+    size_t observations = 0;
+    read_consistent(q, sums, counts, &observations);
+
+    const ExperimentDef *def = q->def;
+    MainEffect *effects = xmalloc(def->factor_count * sizeof(MainEffect) + 1);
+    for (size_t f = 0; f < def->factor_count; f++) {
+        MainEffect *effect = &effects[f];
+        memset(effect, 0, sizeof(MainEffect));
+        strcpy(effect->factor_name, def->factors[f].name);
+        effect->level_count = def->factors[f].level_count;
+        effect->level_means = xmalloc(effect->level_count * sizeof(double) + 1);
+
+        double min_val = 0.0, max_val = 0.0;
+        for (size_t lv = 0; lv < effect->level_count; lv++) {
+            size_t slot = q->level_base[f] + lv;
+            double mean = counts[slot] > 0 ? sums[slot] / (double)counts[slot] : 0.0;
+            effect->level_means[lv] = mean;
+            if (lv == 0 || mean < min_val) min_val = mean;
+            if (lv == 0 || mean > max_val) max_val = mean;
+        }
+        effect->range = max_val - min_val;
+    }
+    free(sums);
+    free(counts);
+
+    *effects_out = effects;
+    *count_out = def->factor_count;
+    if (observations_out) *observations_out = observations;
+    return 0;
+}
+
+int ingest_run_stats(const IngestQueue *q, size_t run_id, double *mean_out, size_t *count_out) {
+    if (!q || run_id < 1 || run_id > q->design.rows) return -1;
+
+    double sum;
+    size_t count;
+    for (;;) {
+        unsigned long v1 = __atomic_load_n(&q->version, __ATOMIC_ACQUIRE);
+        if (v1 & 1) continue;
+        sum = load_double(&q->run_sums[run_id - 1]);
+        count = load_size(&q->run_counts[run_id - 1]);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&q->version, __ATOMIC_RELAXED) == v1) break;
+    }
+    if (mean_out) *mean_out = count > 0 ? sum / (double)count : 0.0;
+    if (count_out) *count_out = count;
+    return 0;
+}
+
+size_t ingest_dropped(const IngestQueue *q) {
+    return q ? __atomic_load_n(&q->dropped, __ATOMIC_RELAXED) : 0;
+}
+
+size_t ingest_rejected(const IngestQueue *q) {
+    return q ? load_size(&q->rejected) : 0;
+}
+
+ResultSet *ingest_to_result_set(const IngestQueue *q, const char *metric_name) {
+    if (!q || !metric_name) return NULL;
+    ResultSet *results = create_result_set(q->def, metric_name);
+    if (!results) return NULL;
+    for (size_t i = 0; i < q->log->count; i++) {
+        add_result(results, q->log->run_ids[i], q->log->responses[i]);
+    }
+    return results;
+}
+
+void ingest_free(IngestQueue *q) {
+    if (!q) return;
+    free_compiled_design(&q->design);
+    free_result_set(q->log);
+    free(q->cells);
+    free(q->run_sums);
+    free(q->run_counts);
+    free(q->level_sums);
+    free(q->level_counts);
+    free(q);
+}
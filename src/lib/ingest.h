@@ -0,0 +1,48 @@
+#ifndef INGEST_H
+#define INGEST_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "parser.h"      // For ExperimentDef
+#include "analyzer.h"    // For MainEffect, ResultSet
+
+/*
+ * Concurrent result ingestion.
+ *
+ * Producers push (run_id, response) pairs into a bounded multi-producer /
+ * single-consumer ring without taking locks.  The consumer drains the ring
+ * into a run-indexed store and per-factor level accumulators, publishing
+ * each batch under a sequence lock so readers on any thread can copy a
+ * consistent snapshot while ingestion continues.
+ */
+typedef struct IngestQueue IngestQueue;
+
+/* Create a queue for def with room for at least capacity pending results */
+IngestQueue *ingest_create(const ExperimentDef *def, size_t capacity, char *error_buf);
+
+/* Push one result (any thread); returns -1 when the ring is full */
+int ingest_push(IngestQueue *q, size_t run_id, double response);
+
+/* Move up to max_items (0 = all available) into the store; consumer thread only */
+size_t ingest_drain(IngestQueue *q, size_t max_items);
+
+/* Consistent main effects of everything drained so far (any thread) */
+int ingest_snapshot_effects(const IngestQueue *q, MainEffect **effects_out,
+                            size_t *count_out, size_t *observations_out);
+
+/* Mean and count of drained responses for one run (any thread); -1 if out of range */
+int ingest_run_stats(const IngestQueue *q, size_t run_id, double *mean_out, size_t *count_out);
+
+/* Pushes refused because the ring was full */
+size_t ingest_dropped(const IngestQueue *q);
+
+/* Drained results whose run_id is not in the design */
+size_t ingest_rejected(const IngestQueue *q);
+
+/* Copy drained results into a new ResultSet (consumer thread only) */
+ResultSet *ingest_to_result_set(const IngestQueue *q, const char *metric_name);
+
+/* Free the queue; no producer may still be pushing */
+void ingest_free(IngestQueue *q);
+
+#endif /* INGEST_H */
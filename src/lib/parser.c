@@ -1,10 +1,15 @@
+#define _POSIX_C_SOURCE 200809L
 #include "parser.h"
 #include "utils.h"
 #include "arrays.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
 
 /* Helper function to trim whitespace */
 char *trim_whitespace(char *str) {
@@ -32,24 +37,22 @@ char *trim_whitespace(char *str) {
     return str;
 }
 
-/* Helper function to split string by delimiter */
-int split_string(const char *str, char delim, char **tokens, size_t max_tokens) {
+/* Helper function to split string by delimiter, in place: each token is
+ * NUL-terminated within str and tokens[] points into it */
+int split_string(char *str, char delim, char **tokens, size_t max_tokens) {
     if (!str || !tokens || max_tokens == 0) {
         return 0;
     }
 
     size_t count = 0;
-    const char *start = str;
-    const char *ptr = str;
+    char *start = str;
+    char *ptr = str;
 
     while (*ptr && count < max_tokens) {
         if (*ptr == delim) {
-            size_t len = ptr - start;
-            if (len > 0) {
-                tokens[count] = xmalloc(len + 1);
-                strncpy(tokens[count], start, len);
-                tokens[count][len] = '\0';
-                count++;
+            *ptr = '\0';
+            if (ptr > start) {
+                tokens[count++] = start;
             }
             start = ptr + 1;
         }
@@ -58,24 +61,21 @@ int split_string(const char *str, char delim, char **tokens, size_t max_tokens)
 
     // Handle the last token
     if (start < ptr && count < max_tokens) {
-        size_t len = ptr - start;
-        tokens[count] = xmalloc(len + 1);
-        strncpy(tokens[count], start, len);
-        tokens[count][len] = '\0';
-        count++;
+        tokens[count++] = start;
     }
 
     return (int)count;
 }
 
-/* Parse a line containing factor levels (e.g., "cache_size: 64M, 128M, 256M") */
-int parse_factor_line(const char *line, Factor *factor, char *error_buf) {
+/* Parse a line containing factor levels (e.g., "cache_size: 64M, 128M, 256M").
+ * The level list is split in place, so line is modified. */
+int parse_factor_line(char *line, Factor *factor, char *error_buf) {
     if (!line || !factor) {
         return -1;
     }
     
     // Find the colon
-    const char *colon_pos = strchr(line, ':');
+    char *colon_pos = strchr(line, ':');
     if (!colon_pos) {
         set_error(error_buf, "Expected ':' after factor name");
         return -1;
@@ -99,30 +99,22 @@ int parse_factor_line(const char *line, Factor *factor, char *error_buf) {
     }
     
     // Skip colon and any leading whitespace
-    const char *values_start = colon_pos + 1;
+    char *values_start = colon_pos + 1;
     while (*values_start && isspace(*values_start)) {
         values_start++;
     }
     
     // Parse values using comma separator
-    char *values_copy = xmalloc(strlen(values_start) + 1);
-    strcpy(values_copy, values_start);
-    
     char *tokens[MAX_LEVELS];
-    int num_tokens = split_string(values_copy, ',', tokens, MAX_LEVELS);
+    int num_tokens = split_string(values_start, ',', tokens, MAX_LEVELS);
     
     if (num_tokens <= 0) {
         set_error(error_buf, "No factor levels found after ':'");
-        free(values_copy);
         return -1;
     }
     
     if (num_tokens > MAX_LEVELS) {
         set_error(error_buf, "Too many levels for factor '%s' (max %d)", factor->name, MAX_LEVELS);
-        for (int i = 0; i < num_tokens; i++) {
-            free(tokens[i]);
-        }
-        free(values_copy);
         return -1;
     }
     
@@ -132,31 +124,191 @@ int parse_factor_line(const char *line, Factor *factor, char *error_buf) {
         char *trimmed = trim_whitespace(tokens[i]);
         if (strlen(trimmed) == 0) {
             // Skip empty levels
-            free(tokens[i]);
             continue;
         }
         
         if (strlen(trimmed) >= MAX_LEVEL_VALUE) {
             set_error(error_buf, "Level value '%s' too long (max %d)", trimmed, MAX_LEVEL_VALUE - 1);
-            for (int j = i; j < num_tokens; j++) {
-                free(tokens[j]);
-            }
-            free(values_copy);
             return -1;
         }
         
         strcpy(factor->values[factor->level_count], trimmed);
         factor->level_count++;
-        free(tokens[i]);
     }
     
-    free(values_copy);
-    
     if (factor->level_count == 0) {
         set_error(error_buf, "No valid levels found for factor '%s'", factor->name);
         return -1;
     }
     
+    classify_factor_levels(factor);
+    return 0;
+}
+
+/* Position of a binary size suffix in "KMGT", plus one (0 = not a suffix) */
+static int size_suffix_power(const char *suffix) {
+    static const char suffixes[] = "KMGT";
+    const char *found = *suffix ? strchr(suffixes, toupper((unsigned char)*suffix)) : NULL;
+    if (!found || suffix[1] != '\0') {
+        return 0;
+    }
+    return (int)(found - suffixes) + 1;
+}
+
+bool parse_numeric_level(const char *text, double *value_out) {
+    if (!text || !*text || isspace((unsigned char)*text)) {
+        return false;
+    }
+    char *end;
+    double value = strtod(text, &end);
+    if (end == text || !isfinite(value)) {
+        return false;
+    }
+    /* strtod also accepts hex floats and "inf"/"nan"; only plain literals count */
+    for (const char *c = text; c < end; c++) {
+        if (!isdigit((unsigned char)*c) && !strchr("+-.eE", *c)) {
+            return false;
+        }
+    }
+    if (*end != '\0') {
+        int power = size_suffix_power(end);
+        if (power == 0) {
+            return false;
+        }
+        value *= pow(1024.0, (double)power);
+        /* "1e308T" overflows only once scaled */
+        if (!isfinite(value)) {
+            return false;
+        }
+    }
+    *value_out = value;
+    return true;
+}
+
+bool parse_int_level(const char *text, int64_t *value_out) {
+    if (!text || !*text || isspace((unsigned char)*text)) {
+        return false;
+    }
+    const char *digits = (*text == '+' || *text == '-') ? text + 1 : text;
+    if (!isdigit((unsigned char)*digits)) {
+        return false;
+    }
+    char *end;
+    errno = 0;
+    long long value = strtoll(text, &end, 10);
+    if (errno == ERANGE) {
+        return false;
+    }
+    if (*end != '\0') {
+        int power = size_suffix_power(end);
+        if (power == 0) {
+            return false;
+        }
+        long long scale = 1LL << (10 * power);
+        if (value > LLONG_MAX / scale || value < LLONG_MIN / scale) {
+            return false;
+        }
+        value *= scale;
+    }
+    *value_out = (int64_t)value;
+    return true;
+}
+
+bool parse_bool_level(const char *text, bool *value_out) {
+    static const char *const names[][2] = {
+        { "false", "true" }, { "no", "yes" }, { "off", "on" }
+    };
+    if (!text) {
+        return false;
+    }
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        for (int b = 0; b < 2; b++) {
+            if (strcasecmp(text, names[i][b]) == 0) {
+                *value_out = b == 1;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void classify_factor_levels(Factor *factor) {
+    bool all_bool = factor->level_count > 0;
+    bool all_int = all_bool;
+    bool all_numeric = all_bool;
+    for (size_t lv = 0; lv < factor->level_count; lv++) {
+        const char *text = factor->values[lv];
+        bool flag;
+        if (all_bool && parse_bool_level(text, &flag)) {
+            factor->int_values[lv] = flag;
+            factor->numeric_values[lv] = flag;
+            all_int = all_numeric = false;
+            continue;
+        }
+        all_bool = false;
+        if (all_int && parse_int_level(text, &factor->int_values[lv])) {
+            factor->numeric_values[lv] = (double)factor->int_values[lv];
+            continue;
+        }
+        all_int = false;
+        if (!all_numeric || !parse_numeric_level(text, &factor->numeric_values[lv])) {
+            all_numeric = false;
+            break;
+        }
+    }
+    factor->type = all_bool ? LEVEL_BOOL
+                 : all_int ? LEVEL_INT
+                 : all_numeric ? LEVEL_FLOAT
+                 : LEVEL_STRING;
+    factor->numeric = factor->type == LEVEL_INT || factor->type == LEVEL_FLOAT;
+}
+
+/* Parse a changeover cost line (e.g. "compiler_flags: 120") */
+static int parse_changeover_line(const char *line, char *name, double *cost, char *error_buf) {
+    const char *colon_pos = strchr(line, ':');
+    size_t name_len = (size_t)(colon_pos - line);
+    if (name_len >= MAX_FACTOR_NAME) {
+        set_error(error_buf, "Factor name too long (max %d)", MAX_FACTOR_NAME - 1);
+        return -1;
+    }
+    strncpy(name, line, name_len);
+    name[name_len] = '\0';
+    trim_whitespace(name);
+
+    char *endptr;
+    *cost = strtod(colon_pos + 1, &endptr);
+    while (*endptr && isspace((unsigned char)*endptr)) {
+        endptr++;
+    }
+    if (endptr == colon_pos + 1 || *endptr != '\0' || !isfinite(*cost) || *cost < 0.0) {
+        set_error(error_buf, "Invalid changeover cost for '%s' (expected a number >= 0)", name);
+        return -1;
+    }
+    return 0;
+}
+
+/* Mark the factors of a "whole_plot: a, b" list; every name must be defined */
+static int parse_whole_plot_list(char *list, ExperimentDef *def, char *error_buf) {
+    size_t marked = 0;
+    char *saveptr = NULL;
+    for (char *tok = strtok_r(list, ",", &saveptr); tok; tok = strtok_r(NULL, ",", &saveptr)) {
+        char *name = trim_whitespace(tok);
+        if (*name == '\0') continue;
+        size_t f = 0;
+        while (f < def->factor_count && strcmp(def->factors[f].name, name) != 0) {
+            f++;
+        }
+        if (f == def->factor_count) {
+            set_error(error_buf, "Whole-plot factor '%s' is not defined", name);
+            return -1;
+        }
+        def->factors[f].whole_plot = true;
+        marked++;
+    }
+    if (marked == 0) {
+        set_error(error_buf, "whole_plot lists no factors");
+        return -1;
+    }
     return 0;
 }
 
@@ -175,9 +327,21 @@ int parse_experiment_def_from_string(const char *content, ExperimentDef *def, ch
     char *content_copy = xmalloc(strlen(content) + 1);
     strcpy(content_copy, content);
 
-    char *line = strtok(content_copy, "\n");
+    /* strtok_r: definitions may be parsed concurrently (e.g. `taguchi batch`) */
+    char *saveptr = NULL;
+    char *line = strtok_r(content_copy, "\n", &saveptr);
     int line_num = 1;
     int in_factors_section = 0;  // 0 = not in factors section, 1 = in factors section
+    int in_changeover_section = 0;
+
+    /* Changeover costs may be listed before their factors; resolved below */
+    char cost_names[MAX_FACTORS][MAX_FACTOR_NAME];
+    double cost_values[MAX_FACTORS];
+    size_t cost_count = 0;
+
+    /* Same for the whole-plot factor list; split-plot keys need it */
+    char *whole_plot_list = NULL;
+    bool split_plot_keys = false;
 
     while (line != NULL) {
         // Check original line for leading whitespace before trimming
@@ -188,7 +352,7 @@ int parse_experiment_def_from_string(const char *content, ExperimentDef *def, ch
 
         // Skip empty lines and comments
         if (strlen(trimmed_line) == 0 || trimmed_line[0] == '#') {
-            line = strtok(NULL, "\n");
+            line = strtok_r(NULL, "\n", &saveptr);
             line_num++;
             continue;
         }
@@ -196,10 +360,62 @@ int parse_experiment_def_from_string(const char *content, ExperimentDef *def, ch
         // Check for factors section indicator
         if (strcmp(trimmed_line, "factors:") == 0) {
             in_factors_section = 1;
+            in_changeover_section = 0;
+        }
+        else if (strcmp(trimmed_line, "changeover:") == 0) {
+            in_factors_section = 0;
+            in_changeover_section = 1;
+        }
+        // Split-plot keys (top level only, so factors may use these names)
+        else if (!isspace((unsigned char)first_char_original) &&
+                 strncmp(trimmed_line, "whole_plot:", 11) == 0) {
+            in_factors_section = 0;
+            in_changeover_section = 0;
+            free(whole_plot_list);
+            whole_plot_list = xmalloc(strlen(trimmed_line + 11) + 1);
+            strcpy(whole_plot_list, trimmed_line + 11);
+        }
+        else if (!isspace((unsigned char)first_char_original) &&
+                 strncmp(trimmed_line, "whole_plot_array:", 17) == 0) {
+            in_factors_section = 0;
+            in_changeover_section = 0;
+            const char *value = trimmed_line + 17;
+            while (*value && isspace((unsigned char)*value)) {
+                value++;
+            }
+            if (strlen(value) >= sizeof(def->whole_plot_array)) {
+                set_error(error_buf, "Whole-plot array type too long");
+                free(whole_plot_list);
+                free(content_copy);
+                return -1;
+            }
+            strcpy(def->whole_plot_array, value);
+            split_plot_keys = true;
+        }
+        else if (!isspace((unsigned char)first_char_original) &&
+                 strncmp(trimmed_line, "split_plot:", 11) == 0) {
+            in_factors_section = 0;
+            in_changeover_section = 0;
+            const char *value = trimmed_line + 11;
+            while (*value && isspace((unsigned char)*value)) {
+                value++;
+            }
+            if (strcmp(value, "crossed") == 0) {
+                def->split_plot_layout = SPLIT_PLOT_CROSSED;
+            } else if (strcmp(value, "nested") == 0) {
+                def->split_plot_layout = SPLIT_PLOT_NESTED;
+            } else {
+                set_error(error_buf, "Invalid split_plot layout '%s' (expected crossed or nested)", value);
+                free(whole_plot_list);
+                free(content_copy);
+                return -1;
+            }
+            split_plot_keys = true;
         }
         // Check for array specification
         else if (strncmp(trimmed_line, "array:", 6) == 0) {
             in_factors_section = 0;  // No longer in factors section
+            in_changeover_section = 0;
 
             // Parse the array type
             const char *array_start = trimmed_line + 6;
@@ -209,6 +425,7 @@ int parse_experiment_def_from_string(const char *content, ExperimentDef *def, ch
 
             if (strlen(array_start) >= sizeof(def->array_type)) {
                 set_error(error_buf, "Array type too long");
+                free(whole_plot_list);
                 free(content_copy);
                 return -1;
             }
@@ -225,12 +442,14 @@ int parse_experiment_def_from_string(const char *content, ExperimentDef *def, ch
                 // This is an indented factor line like "  cache_size: 64M, 128M, 256M"
                 if (def->factor_count >= MAX_FACTORS) {
                     set_error(error_buf, "Too many factors (max %d)", MAX_FACTORS);
+                    free(whole_plot_list);
                     free(content_copy);
                     return -1;
                 }
 
                 Factor *current_factor = &def->factors[def->factor_count];
                 if (parse_factor_line(trimmed_line, current_factor, error_buf) != 0) {  // Use trimmed line
+                    free(whole_plot_list);
                     free(content_copy);
                     return -1;
                 }
@@ -238,8 +457,25 @@ int parse_experiment_def_from_string(const char *content, ExperimentDef *def, ch
                 def->factor_count++;
             }
         }
+        else if (in_changeover_section == 1) {
+            if ((first_char_original == ' ' || first_char_original == '\t') && strchr(trimmed_line, ':')) {
+                if (cost_count >= MAX_FACTORS) {
+                    set_error(error_buf, "Too many changeover entries (max %d)", MAX_FACTORS);
+                    free(whole_plot_list);
+                    free(content_copy);
+                    return -1;
+                }
+                if (parse_changeover_line(trimmed_line, cost_names[cost_count],
+                                          &cost_values[cost_count], error_buf) != 0) {
+                    free(whole_plot_list);
+                    free(content_copy);
+                    return -1;
+                }
+                cost_count++;
+            }
+        }
 
-        line = strtok(NULL, "\n");
+        line = strtok_r(NULL, "\n", &saveptr);
         line_num++;
     }
 
@@ -248,9 +484,31 @@ int parse_experiment_def_from_string(const char *content, ExperimentDef *def, ch
     // Validate we have required information
     if (def->factor_count == 0) {
         set_error(error_buf, "No factors defined in experiment");
+        free(whole_plot_list);
         return -1;
     }
 
+    if (whole_plot_list) {
+        int rc = parse_whole_plot_list(whole_plot_list, def, error_buf);
+        free(whole_plot_list);
+        if (rc != 0) return -1;
+    } else if (split_plot_keys) {
+        set_error(error_buf, "split_plot and whole_plot_array require a whole_plot factor list");
+        return -1;
+    }
+
+    for (size_t c = 0; c < cost_count; c++) {
+        size_t f = 0;
+        while (f < def->factor_count && strcmp(def->factors[f].name, cost_names[c]) != 0) {
+            f++;
+        }
+        if (f == def->factor_count) {
+            set_error(error_buf, "Changeover cost for unknown factor '%s'", cost_names[c]);
+            return -1;
+        }
+        def->factors[f].changeover_cost = cost_values[c];
+    }
+
     // Array type is now optional for auto-selection
     // If specified, validate its format
     if (strlen(def->array_type) > 0) {
@@ -3,19 +3,43 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include "../../src/config.h"  // Include config for constants
 
+/* Type shared by all level values of a factor, from the most specific
+ * that fits every level (values match taguchi_level_type_t) */
+typedef enum {
+    LEVEL_STRING = 0,
+    LEVEL_BOOL = 1,          /* true/false, yes/no, on/off */
+    LEVEL_INT = 2,           /* integers, size suffixes applied */
+    LEVEL_FLOAT = 3          /* any other number (see parse_numeric_level) */
+} LevelType;
+
 /* Internal structures for experiment definition (implementation details) */
 typedef struct {
     char name[MAX_FACTOR_NAME];
     char values[MAX_LEVELS][MAX_LEVEL_VALUE];
     size_t level_count;
+    double changeover_cost;  /* cost of changing level between runs (0 = free) */
+    bool whole_plot;         /* hard-to-change factor of a split-plot design */
+    bool numeric;            /* type is LEVEL_INT or LEVEL_FLOAT */
+    LevelType type;
+    double numeric_values[MAX_LEVELS];  /* level values as numbers (bools as 0/1) */
+    int64_t int_values[MAX_LEVELS];     /* exact values of LEVEL_INT and LEVEL_BOOL */
 } Factor;
 
+/* How a split-plot design combines whole-plot and sub-plot factors */
+typedef enum {
+    SPLIT_PLOT_CROSSED = 0,  /* whole-plot array x sub-plot array */
+    SPLIT_PLOT_NESTED = 1    /* one array, runs grouped by whole-plot levels */
+} SplitPlotLayout;
+
 typedef struct {
     Factor factors[MAX_FACTORS];
     size_t factor_count;
     char array_type[8];  /* "L4", "L9", "L16", "L27", etc. */
+    char whole_plot_array[8];       /* crossed split-plot: array for whole plots ("" = auto) */
+    SplitPlotLayout split_plot_layout;
 } ExperimentDef;
 
 /* Parse experiment definition from string content */
@@ -31,6 +55,21 @@ bool validate_experiment_def(
     char *error_buf
 );
 
+/* Parse a level value as a number: a decimal or exponent literal, optionally
+ * followed by a binary size suffix K, M, G or T ("64M" = 64 * 2^20) */
+bool parse_numeric_level(const char *text, double *value_out);
+
+/* Parse a level value as an integer: digits with an optional sign and size
+ * suffix, no point or exponent, within int64_t after the suffix */
+bool parse_int_level(const char *text, int64_t *value_out);
+
+/* Parse a level value as a boolean (true/false, yes/no, on/off, any case) */
+bool parse_bool_level(const char *text, bool *value_out);
+
+/* Set factor->type and the typed level values from the level strings, once
+ * per definition, so consumers never parse level strings themselves */
+void classify_factor_levels(Factor *factor);
+
 /* Free resources used by experiment definition */
 void free_experiment_def(ExperimentDef *def);
 
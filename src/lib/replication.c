@@ -0,0 +1,285 @@
+#include "replication.h"
+#include "stats.h"
+#include "utils.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* Per-run replicate statistics and the pooled within-run variance */
+typedef struct {
+    CompiledDesign design;
+    size_t *n;              /* results per run */
+    double *mean;           /* run means */
+    double pooled_var;      /* 0 while error_df is 0 */
+    size_t error_df;        /* sum over runs of (n - 1) */
+} RunStats;
+
+static int run_stats_init(const ResultSet *results, RunStats *rs, char *error_buf) {
+    memset(rs, 0, sizeof(*rs));
+    if (acquire_design(NULL, results->experiment_def, &rs->design, error_buf) != 0) {
+        return -1;
+    }
+    size_t rows = rs->design.rows;
+    rs->n = xcalloc(rows + 1, sizeof(size_t));
+    rs->mean = xcalloc(rows + 1, sizeof(double));
+
+    for (size_t i = 0; i < results->count; i++) {
+        size_t run_id = results->run_ids[i];
+        if (run_id < 1 || run_id > rows) continue;
+        rs->n[run_id - 1]++;
+        rs->mean[run_id - 1] += results->responses[i];
+    }
+    for (size_t r = 0; r < rows; r++) {
+        if (rs->n[r] > 0) rs->mean[r] /= (double)rs->n[r];
+        if (rs->n[r] > 1) rs->error_df += rs->n[r] - 1;
+    }
+
+    /* Second pass for the squared deviations from run means */
+    double ss = 0.0;
+    for (size_t i = 0; i < results->count; i++) {
+        size_t run_id = results->run_ids[i];
+        if (run_id < 1 || run_id > rows) continue;
+        double d = results->responses[i] - rs->mean[run_id - 1];
+        ss += d * d;
+    }
+    if (rs->error_df > 0) rs->pooled_var = ss / (double)rs->error_df;
+    return 0;
+}
+
+static void run_stats_free(RunStats *rs) {
+    free(rs->n);
+    free(rs->mean);
+    free_compiled_design(&rs->design);
+}
+
+/* Level means of factor f and the variance of each (in units of the pooled
+ * variance); runs_out counts runs with results.  Empty levels get NAN. */
+static void level_stats(const RunStats *rs, size_t f, size_t level_count,
+                        double *means, double *var_units, size_t *runs_out) {
+    for (size_t lv = 0; lv < level_count; lv++) {
+        means[lv] = 0.0;
+        var_units[lv] = 0.0;
+        runs_out[lv] = 0;
+    }
+    for (size_t r = 0; r < rs->design.rows; r++) {
+        if (rs->n[r] == 0) continue;
+        size_t lv = rs->design.levels[r * rs->design.factor_count + f];
+        if (lv >= level_count) continue;
+        means[lv] += rs->mean[r];
+        var_units[lv] += 1.0 / (double)rs->n[r];
+        runs_out[lv]++;
+    }
+    for (size_t lv = 0; lv < level_count; lv++) {
+        if (runs_out[lv] == 0) {
+            means[lv] = NAN;
+            continue;
+        }
+        double k = (double)runs_out[lv];
+        means[lv] /= k;
+        var_units[lv] /= k * k;
+    }
+}
+
+static bool valid_confidence(double confidence) {
+    return confidence > 0.0 && confidence < 1.0;
+}
+
+int replication_level_intervals(const ResultSet *results, size_t factor_index, double confidence,
+                                double *means_out, double *half_widths_out, size_t level_count,
+                                char *error_buf) {
+    if (!results || !results->experiment_def || !means_out || !half_widths_out) {
+        set_error(error_buf, "Invalid parameters to replication_level_intervals");
+        return -1;
+    }
+    const ExperimentDef *def = results->experiment_def;
+    if (factor_index >= def->factor_count) {
+        set_error(error_buf, "Factor index %zu out of range", factor_index);
+        return -1;
+    }
+    if (level_count != def->factors[factor_index].level_count) {
+        set_error(error_buf, "Factor '%s' has %zu levels, got room for %zu",
+                  def->factors[factor_index].name, def->factors[factor_index].level_count,
+                  level_count);
+        return -1;
+    }
+    if (!valid_confidence(confidence)) {
+        set_error(error_buf, "Confidence must be between 0 and 1, got %g", confidence);
+        return -1;
+    }
+
+    RunStats rs;
+    if (run_stats_init(results, &rs, error_buf) != 0) {
+        return -1;
+    }
+    if (rs.error_df == 0) {
+        set_error(error_buf, "Confidence intervals need at least one replicated run");
+        run_stats_free(&rs);
+        return -1;
+    }
+
+    double *var_units = xmalloc(level_count * sizeof(double));
+    size_t *runs = xmalloc(level_count * sizeof(size_t));
+    level_stats(&rs, factor_index, level_count, means_out, var_units, runs);
+    double t = t_distribution_quantile(1.0 - (1.0 - confidence) / 2.0, (double)rs.error_df);
+    for (size_t lv = 0; lv < level_count; lv++) {
+        half_widths_out[lv] = runs[lv] > 0 ? t * sqrt(rs.pooled_var * var_units[lv]) : INFINITY;
+    }
+
+    free(runs);
+    free(var_units);
+    run_stats_free(&rs);
+    return 0;
+}
+
+/* Factor order for picking the top factors: largest level-mean range first */
+typedef struct {
+    size_t factor;
+    double range;
+} RankedFactor;
+
+static int compare_ranked(const void *a, const void *b) {
+    const RankedFactor *x = a, *y = b;
+    if (x->range != y->range) return x->range > y->range ? -1 : 1;
+    return x->factor < y->factor ? -1 : (x->factor > y->factor);
+}
+
+/* Candidate replicate, ordered by score then run */
+typedef struct {
+    size_t row;
+    double score;
+} Candidate;
+
+static int compare_candidates(const void *a, const void *b) {
+    const Candidate *x = a, *y = b;
+    if (x->score != y->score) return x->score > y->score ? -1 : 1;
+    return x->row < y->row ? -1 : (x->row > y->row);
+}
+
+int replication_plan(const ResultSet *results, const taguchi_replication_options_t *opts,
+                     size_t *run_ids_out, size_t max_runs, size_t *count_out,
+                     taguchi_replication_status_t *status_out, char *error_buf) {
+    if (!results || !results->experiment_def || !opts || !count_out ||
+        (max_runs > 0 && !run_ids_out)) {
+        set_error(error_buf, "Invalid parameters to replication_plan");
+        return -1;
+    }
+    if (!valid_confidence(opts->confidence)) {
+        set_error(error_buf, "Confidence must be between 0 and 1, got %g", opts->confidence);
+        return -1;
+    }
+
+    const ExperimentDef *def = results->experiment_def;
+    RunStats rs;
+    if (run_stats_init(results, &rs, error_buf) != 0) {
+        return -1;
+    }
+    size_t rows = rs.design.rows;
+    size_t top = opts->top_factors;
+    if (top == 0 || top > def->factor_count) top = def->factor_count;
+
+    taguchi_replication_status_t status;
+    memset(&status, 0, sizeof(status));
+    status.top_factors = top;
+    status.error_df = rs.error_df;
+    status.pooled_sd = sqrt(rs.pooled_var);
+    *count_out = 0;
+
+    /* Every run needs a result and the variance a replicate before the
+     * intervals mean anything */
+    size_t count = 0;
+    for (size_t r = 0; r < rows && count < max_runs; r++) {
+        if (rs.n[r] == 0) run_ids_out[count++] = r + 1;
+    }
+    for (size_t r = 0; r < rows && count < max_runs && rs.error_df == 0; r++) {
+        if (rs.n[r] == 1) run_ids_out[count++] = r + 1;
+    }
+    bool missing = false;
+    for (size_t r = 0; r < rows; r++) {
+        if (rs.n[r] == 0) missing = true;
+    }
+    if (missing || rs.error_df == 0) {
+        *count_out = count;
+        if (status_out) *status_out = status;
+        run_stats_free(&rs);
+        return 0;
+    }
+
+    double t = t_distribution_quantile(1.0 - (1.0 - opts->confidence) / 2.0, (double)rs.error_df);
+    double means[MAX_LEVELS], var_units[MAX_LEVELS];
+    size_t runs[MAX_LEVELS];
+
+    RankedFactor *ranked = xmalloc(def->factor_count * sizeof(RankedFactor) + 1);
+    for (size_t f = 0; f < def->factor_count; f++) {
+        level_stats(&rs, f, def->factors[f].level_count, means, var_units, runs);
+        double lo = means[0], hi = means[0];
+        for (size_t lv = 1; lv < def->factors[f].level_count; lv++) {
+            if (means[lv] < lo) lo = means[lv];
+            if (means[lv] > hi) hi = means[lv];
+        }
+        ranked[f].factor = f;
+        ranked[f].range = hi - lo;
+    }
+    qsort(ranked, def->factor_count, sizeof(RankedFactor), compare_ranked);
+
+    Candidate *cand = xcalloc(rows + 1, sizeof(Candidate));
+    for (size_t r = 0; r < rows; r++) {
+        cand[r].row = r;
+    }
+    for (size_t i = 0; i < top; i++) {
+        size_t f = ranked[i].factor;
+        size_t levels = def->factors[f].level_count;
+        level_stats(&rs, f, levels, means, var_units, runs);
+
+        /* Best and runner-up level in the requested direction */
+        size_t best = 0, second = SIZE_MAX;
+        for (size_t lv = 1; lv < levels; lv++) {
+            bool better = opts->higher_is_better ? means[lv] > means[best] : means[lv] < means[best];
+            if (better) best = lv;
+        }
+        for (size_t lv = 0; lv < levels; lv++) {
+            if (lv == best) continue;
+            bool better = second == SIZE_MAX ||
+                (opts->higher_is_better ? means[lv] > means[second] : means[lv] < means[second]);
+            if (better) second = lv;
+        }
+        if (second == SIZE_MAX) {
+            status.resolved++;
+            continue;
+        }
+
+        double var = rs.pooled_var * (var_units[best] + var_units[second]);
+        double gap = fabs(means[best] - means[second]);
+        if (var <= 0.0 || gap > t * sqrt(var)) {
+            status.resolved++;
+            continue;
+        }
+
+        /* One more result of run r cuts its level mean's variance by
+         * pooled_var / k^2 * (1/n - 1/(n+1)); weigh that against the
+         * variance of the contested difference */
+        for (size_t r = 0; r < rows; r++) {
+            size_t lv = rs.design.levels[r * rs.design.factor_count + f];
+            if (lv != best && lv != second) continue;
+            double k = (double)runs[lv];
+            double n = (double)rs.n[r];
+            double cut = rs.pooled_var / (k * k) * (1.0 / n - 1.0 / (n + 1.0));
+            cand[r].score += cut / var;
+        }
+    }
+    status.stable = status.resolved == top;
+
+    if (!status.stable) {
+        qsort(cand, rows, sizeof(Candidate), compare_candidates);
+        for (size_t i = 0; i < rows && count < max_runs && cand[i].score > 0.0; i++) {
+            run_ids_out[count++] = cand[i].row + 1;
+        }
+    }
+    *count_out = count;
+    if (status_out) *status_out = status;
+
+    free(cand);
+    free(ranked);
+    run_stats_free(&rs);
+    return 0;
+}
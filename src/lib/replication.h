@@ -0,0 +1,41 @@
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "analyzer.h"    // For ResultSet
+
+/*
+ * Adaptive replication.
+ *
+ * Level means are averages of run means and their variance comes from the
+ * pooled spread of replicates within runs, so each extra result of run r
+ * shrinks the variance of every level mean r contributes to by a known
+ * amount.  The planner spends replicates where that shrinkage matters: on
+ * the best and runner-up levels of the top factors whose recommendation is
+ * not yet resolved at the requested confidence.
+ */
+
+/* Confidence intervals of level means (see taguchi_level_intervals) */
+int replication_level_intervals(
+    const ResultSet *results,
+    size_t factor_index,
+    double confidence,
+    double *means_out,
+    double *half_widths_out,
+    size_t level_count,
+    char *error_buf
+);
+
+/* Next round of replicates (see taguchi_plan_replicates) */
+int replication_plan(
+    const ResultSet *results,
+    const taguchi_replication_options_t *opts,
+    size_t *run_ids_out,
+    size_t max_runs,
+    size_t *count_out,
+    taguchi_replication_status_t *status_out,
+    char *error_buf
+);
+
+#endif /* REPLICATION_H */
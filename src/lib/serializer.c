@@ -1,6 +1,7 @@
 #include "serializer.h"
 #include "utils.h"
 #include "generator.h"
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -53,15 +54,77 @@ char *escape_json_string(const char *input) {
     return escaped;
 }
 
+/* Make room for `needed` more bytes (and the terminator) after pos */
+static void json_reserve(char **json, size_t *size, size_t pos, size_t needed) {
+    if (pos + needed < *size) return;
+    while (pos + needed >= *size) {
+        *size *= 2;
+    }
+    *json = xrealloc(*json, *size);
+}
+
+/* Append input as an escaped JSON string body, without a temporary copy */
+static size_t json_append_escaped(char **json, size_t *size, size_t pos, const char *input) {
+    size_t len = strlen(input);
+    // In worst case, we might need to escape every character
+    json_reserve(json, size, pos, len * 2);
+    char *out = *json;
+    for (size_t i = 0; i < len; i++) {
+        char escape = 0;
+        switch (input[i]) {
+            case '"': escape = '"'; break;
+            case '\\': escape = '\\'; break;
+            case '\b': escape = 'b'; break;
+            case '\f': escape = 'f'; break;
+            case '\n': escape = 'n'; break;
+            case '\r': escape = 'r'; break;
+            case '\t': escape = 't'; break;
+            default: break;
+        }
+        if (escape) {
+            out[pos++] = '\\';
+            out[pos++] = escape;
+        } else {
+            out[pos++] = input[i];
+        }
+    }
+    out[pos] = '\0';
+    return pos;
+}
+
+/* Append a typed level value: the shortest number that reads back exactly */
+static size_t json_append_level(char **json, size_t *size, size_t pos, const Factor *factor,
+                                size_t level) {
+    json_reserve(json, size, pos, 32);
+    switch (factor->type) {
+        case LEVEL_BOOL:
+            return pos + (size_t)snprintf(*json + pos, *size - pos, "%s",
+                                          factor->int_values[level] ? "true" : "false");
+        case LEVEL_INT:
+            return pos + (size_t)snprintf(*json + pos, *size - pos, "%" PRId64,
+                                          factor->int_values[level]);
+        default: {
+            double value = factor->numeric_values[level];
+            int written = snprintf(*json + pos, *size - pos, "%.15g", value);
+            if (strtod(*json + pos, NULL) != value) {
+                written = snprintf(*json + pos, *size - pos, "%.17g", value);
+            }
+            return pos + (size_t)written;
+        }
+    }
+}
+
 /* Serialize runs to JSON format */
-char *serialize_runs_to_json(const ExperimentRun *runs, size_t count) {
+char *serialize_runs_to_json(const ExperimentDef *def, const ExperimentRun *const *runs,
+                             size_t count) {
     if (!runs || count == 0) {
         char *result = xmalloc(3); // Just "[]"
         strcpy(result, "[]");
         return result;
     }
     
-    // Rough estimate of buffer size needed - we'll realloc as necessary
+    // Rough estimate of buffer size needed - grown as necessary, so the
+    // only allocations are this buffer's
     size_t estimated_size = count * BUFFER_SIZE; // Start with estimated size
     char *json = xmalloc(estimated_size);
     size_t pos = 0;
@@ -70,44 +133,41 @@ char *serialize_runs_to_json(const ExperimentRun *runs, size_t count) {
     pos += snprintf(json + pos, estimated_size - pos, "[\n");
     
     for (size_t i = 0; i < count; i++) {
-        const ExperimentRun *run = &runs[i];
+        const ExperimentRun *run = runs[i];
         
         // Start object
+        json_reserve(&json, &estimated_size, pos, 64);
         pos += snprintf(json + pos, estimated_size - pos, "  {\"run_id\": %zu", run->run_id);
         
-        // Add all factor values
+        // Add all factor values, escaped straight into the buffer
         for (size_t j = 0; j < run->factor_count; j++) {
-            // Escape the factor name and value
-            char *escaped_name = escape_json_string(run->factor_names[j]);
-            char *escaped_value = escape_json_string(run->values[j]);
-            
-            size_t needed = strlen(escaped_name) + strlen(escaped_value) + 10; // Extra for formatting
-            if (pos + needed >= estimated_size) {
-                estimated_size *= 2;
-                json = xrealloc(json, estimated_size);
+            json_reserve(&json, &estimated_size, pos, 8);
+            memcpy(json + pos, ", \"", 3);
+            pos = json_append_escaped(&json, &estimated_size, pos + 3, run->factor_names[j]);
+            json_reserve(&json, &estimated_size, pos, 8);
+            const Factor *factor = def && j < def->factor_count ? &def->factors[j] : NULL;
+            size_t level = run->level_indices[j];
+            if (factor && factor->type != LEVEL_STRING && level < factor->level_count) {
+                memcpy(json + pos, "\": ", 3);
+                pos = json_append_level(&json, &estimated_size, pos + 3, factor, level);
+                continue;
             }
-            
-            pos += snprintf(json + pos, estimated_size - pos, ", \"%s\": \"%s\"", 
-                          escaped_name, escaped_value);
-            
-            free(escaped_name);
-            free(escaped_value);
+            memcpy(json + pos, "\": \"", 4);
+            pos = json_append_escaped(&json, &estimated_size, pos + 4, run->values[j]);
+            json_reserve(&json, &estimated_size, pos, 8);
+            json[pos++] = '"';
         }
         
         // Close object
+        json_reserve(&json, &estimated_size, pos, 8);
         if (i == count - 1) {
             pos += snprintf(json + pos, estimated_size - pos, "}\n");
         } else {
             pos += snprintf(json + pos, estimated_size - pos, "},\n");
         }
-        
-        // Resize if needed
-        if (pos > estimated_size * 3 / 4) { // Resize if we're 75% full
-            estimated_size *= 2;
-            json = xrealloc(json, estimated_size);
-        }
     }
     
+    json_reserve(&json, &estimated_size, pos, 8);
     pos += snprintf(json + pos, estimated_size - pos, "]");
     
     // Resize to exact size needed
@@ -3,10 +3,13 @@
 
 #include <stddef.h>
 #include "generator.h"  // For ExperimentRun
+#include "parser.h"     // For ExperimentDef
 #include "../config.h"  // For constants
 
-/* Serialize runs to JSON format */
-char *serialize_runs_to_json(const ExperimentRun *runs, size_t count);
+/* Serialize runs to JSON format; with def, factor values are written by the
+ * factor's level type (numbers, true/false) instead of as strings */
+char *serialize_runs_to_json(const ExperimentDef *def, const ExperimentRun *const *runs,
+                             size_t count);
 
 /* Serialize effects to JSON format (forward declaration - will be needed for analyzer) */
 struct MainEffect;  // Forward declaration
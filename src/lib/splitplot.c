@@ -0,0 +1,382 @@
+#include "splitplot.h"
+#include "stats.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+bool def_is_split_plot(const ExperimentDef *def) {
+    for (size_t f = 0; f < def->factor_count; f++) {
+        if (def->factors[f].whole_plot) return true;
+    }
+    return false;
+}
+
+/* Whole-plot array x sub-plot array; run w * S + s is sub-plot row s of whole plot w */
+static int compile_crossed(taguchi_context_t *ctx, const ExperimentDef *def,
+                           CompiledDesign *out, char *error_buf) {
+    ExperimentDef *wp_def = xcalloc(1, sizeof(ExperimentDef));
+    ExperimentDef *sp_def = xcalloc(1, sizeof(ExperimentDef));
+    size_t sub_index[MAX_FACTORS];  /* factor position in its sub-definition */
+
+    for (size_t f = 0; f < def->factor_count; f++) {
+        ExperimentDef *target = def->factors[f].whole_plot ? wp_def : sp_def;
+        sub_index[f] = target->factor_count;
+        target->factors[target->factor_count] = def->factors[f];
+        target->factors[target->factor_count].whole_plot = false;
+        target->factor_count++;
+    }
+    strcpy(wp_def->array_type, def->whole_plot_array);
+    strcpy(sp_def->array_type, def->array_type);
+
+    int rc = -1;
+    char sub_error[TAGUCHI_ERROR_SIZE];
+    CompiledDesign wp, sp;
+    memset(&wp, 0, sizeof(wp));
+    memset(&sp, 0, sizeof(sp));
+
+    if (sp_def->factor_count == 0) {
+        set_error(error_buf, "Split-plot design needs at least one sub-plot factor");
+        goto done;
+    }
+    if (compile_design(ctx, wp_def, &wp, sub_error) != 0) {
+        set_error(error_buf, "Whole-plot design: %s", sub_error);
+        goto done;
+    }
+    if (compile_design(ctx, sp_def, &sp, sub_error) != 0) {
+        set_error(error_buf, "Sub-plot design: %s", sub_error);
+        goto done;
+    }
+
+    size_t rows = wp.rows * sp.rows;
+    if (rows > MAX_EXPERIMENTS) {
+        set_error(error_buf, "Split-plot design %s x %s has %zu runs (max %d)",
+                  wp.array_name, sp.array_name, rows, MAX_EXPERIMENTS);
+        goto done;
+    }
+
+    size_t fc = def->factor_count;
+    uint8_t *levels = xmalloc(rows * fc + 1);
+    for (size_t w = 0; w < wp.rows; w++) {
+        for (size_t s = 0; s < sp.rows; s++) {
+            uint8_t *row = &levels[(w * sp.rows + s) * fc];
+            for (size_t f = 0; f < fc; f++) {
+                row[f] = def->factors[f].whole_plot
+                    ? wp.levels[w * wp.factor_count + sub_index[f]]
+                    : sp.levels[s * sp.factor_count + sub_index[f]];
+            }
+        }
+    }
+
+    memset(out, 0, sizeof(*out));
+    for (size_t f = 0; f < fc; f++) {
+        const CompiledDesign *src = def->factors[f].whole_plot ? &wp : &sp;
+        out->col_start[f] = src->col_start[sub_index[f]];
+        out->col_count[f] = src->col_count[sub_index[f]];
+    }
+    strcpy(out->array_name, sp.array_name);
+    strcpy(out->whole_plot_array, wp.array_name);
+    out->rows = rows;
+    out->factor_count = fc;
+    out->levels = levels;
+    out->owned = levels;
+    out->plot_rows = sp.rows;
+    rc = 0;
+
+done:
+    free_compiled_design(&wp);
+    free_compiled_design(&sp);
+    free(sp_def);
+    free(wp_def);
+    return rc;
+}
+
+/* Row of the level matrix with its whole-plot levels packed for sorting */
+typedef struct {
+    const uint8_t *key;
+    size_t key_len;
+    size_t row;
+} PlotSortKey;
+
+static int compare_plot_keys(const void *a, const void *b) {
+    const PlotSortKey *ka = a, *kb = b;
+    int c = memcmp(ka->key, kb->key, ka->key_len);
+    if (c != 0) return c;
+    /* Stable: keep array order inside a whole plot */
+    return (ka->row > kb->row) - (ka->row < kb->row);
+}
+
+/* One array for all factors, rows grouped by whole-plot level combination */
+static int compile_nested(taguchi_context_t *ctx, const ExperimentDef *def,
+                          CompiledDesign *out, char *error_buf) {
+    if (def->whole_plot_array[0] != '\0') {
+        set_error(error_buf, "whole_plot_array applies to crossed split-plot designs only");
+        return -1;
+    }
+    ExperimentDef *flat = xmalloc(sizeof(ExperimentDef));
+    memcpy(flat, def, sizeof(ExperimentDef));
+    size_t wp_cols[MAX_FACTORS];
+    size_t wp_count = 0;
+    for (size_t f = 0; f < flat->factor_count; f++) {
+        if (flat->factors[f].whole_plot) wp_cols[wp_count++] = f;
+        flat->factors[f].whole_plot = false;
+    }
+    int rc = compile_design(ctx, flat, out, error_buf);
+    free(flat);
+    if (rc != 0) return -1;
+
+    size_t rows = out->rows, fc = out->factor_count;
+    uint8_t *packed = xmalloc(rows * wp_count + 1);
+    PlotSortKey *keys = xmalloc(rows * sizeof(PlotSortKey));
+    for (size_t r = 0; r < rows; r++) {
+        for (size_t k = 0; k < wp_count; k++) {
+            packed[r * wp_count + k] = out->levels[r * fc + wp_cols[k]];
+        }
+        keys[r].key = &packed[r * wp_count];
+        keys[r].key_len = wp_count;
+        keys[r].row = r;
+    }
+    qsort(keys, rows, sizeof(PlotSortKey), compare_plot_keys);
+
+    uint8_t *sorted = xmalloc(rows * fc + 1);
+    for (size_t r = 0; r < rows; r++) {
+        memcpy(&sorted[r * fc], &out->levels[keys[r].row * fc], fc);
+    }
+    free(keys);
+    free(packed);
+    free(out->owned);
+    out->levels = sorted;
+    out->owned = sorted;
+    out->plot_rows = 0;
+    return 0;
+}
+
+int compile_split_plot_design(taguchi_context_t *ctx, const ExperimentDef *def,
+                              CompiledDesign *out, char *error_buf) {
+    if (def->split_plot_layout == SPLIT_PLOT_NESTED) {
+        return compile_nested(ctx, def, out, error_buf);
+    }
+    return compile_crossed(ctx, def, out, error_buf);
+}
+
+size_t split_plot_whole_plots(const ExperimentDef *def, const CompiledDesign *design,
+                              size_t *plot_of_row) {
+    if (design->plot_rows > 0) {
+        for (size_t r = 0; r < design->rows; r++) {
+            plot_of_row[r] = r / design->plot_rows;
+        }
+        return design->rows / design->plot_rows;
+    }
+
+    /* Nested: a new whole plot starts wherever a whole-plot level changes */
+    size_t fc = design->factor_count;
+    size_t plots = 0;
+    for (size_t r = 0; r < design->rows; r++) {
+        bool changed = (r == 0);
+        for (size_t f = 0; !changed && f < fc; f++) {
+            changed = def->factors[f].whole_plot &&
+                      design->levels[r * fc + f] != design->levels[(r - 1) * fc + f];
+        }
+        if (changed) plots++;
+        plot_of_row[r] = plots - 1;
+    }
+    return plots;
+}
+
+/* Sum of squares and df of one factor over the observations in y */
+static double factor_sum_squares(const ResultSet *results, const CompiledDesign *design,
+                                 size_t factor, const double *y, double center,
+                                 size_t level_count, size_t *df_out) {
+    double sums[MAX_LEVELS] = {0};
+    size_t counts[MAX_LEVELS] = {0};
+    for (size_t i = 0; i < results->count; i++) {
+        size_t run_id = results->run_ids[i];
+        if (run_id < 1 || run_id > design->rows) continue;
+        size_t lv = design->levels[(run_id - 1) * design->factor_count + factor];
+        sums[lv] += y[i];
+        counts[lv]++;
+    }
+    double ss = 0.0;
+    size_t seen = 0;
+    for (size_t lv = 0; lv < level_count; lv++) {
+        if (counts[lv] == 0) continue;
+        double d = sums[lv] / (double)counts[lv] - center;
+        ss += (double)counts[lv] * d * d;
+        seen++;
+    }
+    *df_out = seen > 0 ? seen - 1 : 0;
+    return ss;
+}
+
+/* True if the factor keeps one level inside every observed whole plot */
+static bool constant_within_plots(const ResultSet *results, const CompiledDesign *design,
+                                  const size_t *plot_of_row, size_t plots, size_t factor) {
+    int *plot_level = xmalloc(plots * sizeof(int));
+    for (size_t p = 0; p < plots; p++) {
+        plot_level[p] = -1;
+    }
+    bool constant = true;
+    for (size_t i = 0; constant && i < results->count; i++) {
+        size_t run_id = results->run_ids[i];
+        if (run_id < 1 || run_id > design->rows) continue;
+        size_t p = plot_of_row[run_id - 1];
+        int lv = design->levels[(run_id - 1) * design->factor_count + factor];
+        if (plot_level[p] < 0) {
+            plot_level[p] = lv;
+        } else if (plot_level[p] != lv) {
+            constant = false;
+        }
+    }
+    free(plot_level);
+    return constant;
+}
+
+static void fill_row(taguchi_anova_row_t *row, const char *source, taguchi_stratum_t stratum,
+                     bool is_error, double ss, size_t df) {
+    memset(row, 0, sizeof(*row));
+    snprintf(row->source, sizeof(row->source), "%s", source);
+    row->stratum = stratum;
+    row->is_error = is_error;
+    row->sum_squares = ss;
+    row->df = df;
+    row->mean_square = df > 0 ? ss / (double)df : NAN;
+    row->f_ratio = NAN;
+    row->p_value = NAN;
+}
+
+/* F test of rows[begin, end) against their stratum's error row */
+static void test_against(taguchi_anova_row_t *rows, size_t begin, size_t end,
+                         const taguchi_anova_row_t *error) {
+    for (size_t i = begin; i < end; i++) {
+        taguchi_anova_row_t *row = &rows[i];
+        if (row->df == 0 || error->df == 0) continue;
+        if (error->mean_square > 0.0) {
+            row->f_ratio = row->mean_square / error->mean_square;
+            row->p_value = f_distribution_sf(row->f_ratio, (double)row->df, (double)error->df);
+        } else if (row->mean_square > 0.0) {
+            row->f_ratio = INFINITY;
+            row->p_value = 0.0;
+        }
+    }
+}
+
+int split_plot_anova(const ResultSet *results, taguchi_anova_row_t **rows_out,
+                     size_t *count_out, char *error_buf) {
+    if (!results || !results->experiment_def || !rows_out || !count_out) {
+        set_error(error_buf, "Invalid parameters to split_plot_anova");
+        return -1;
+    }
+    const ExperimentDef *def = results->experiment_def;
+    if (!def_is_split_plot(def)) {
+        set_error(error_buf, "Not a split-plot design (no whole_plot factors)");
+        return -1;
+    }
+
+    CompiledDesign design;
+    if (acquire_design(NULL, def, &design, error_buf) != 0) {
+        return -1;
+    }
+    size_t *plot_of_row = xmalloc(design.rows * sizeof(size_t) + 1);
+    size_t plots = split_plot_whole_plots(def, &design, plot_of_row);
+
+    /* Plot totals and grand mean over observations with a valid run */
+    double *plot_sum = xcalloc(plots, sizeof(double));
+    size_t *plot_n = xcalloc(plots, sizeof(size_t));
+    double total = 0.0;
+    size_t n = 0;
+    for (size_t i = 0; i < results->count; i++) {
+        size_t run_id = results->run_ids[i];
+        if (run_id < 1 || run_id > design.rows) continue;
+        size_t p = plot_of_row[run_id - 1];
+        plot_sum[p] += results->responses[i];
+        plot_n[p]++;
+        total += results->responses[i];
+        n++;
+    }
+    if (n < 2) {
+        set_error(error_buf, "Split-plot analysis needs at least 2 results");
+        free(plot_n);
+        free(plot_sum);
+        free(plot_of_row);
+        free_compiled_design(&design);
+        return -1;
+    }
+    double grand = total / (double)n;
+
+    /* Within-plot residuals carry the sub-plot stratum */
+    double *within = xmalloc(results->count * sizeof(double) + 1);
+    double ss_total = 0.0, ss_plots = 0.0;
+    size_t plots_seen = 0;
+    for (size_t p = 0; p < plots; p++) {
+        if (plot_n[p] == 0) continue;
+        double d = plot_sum[p] / (double)plot_n[p] - grand;
+        ss_plots += (double)plot_n[p] * d * d;
+        plots_seen++;
+    }
+    for (size_t i = 0; i < results->count; i++) {
+        size_t run_id = results->run_ids[i];
+        within[i] = 0.0;
+        if (run_id < 1 || run_id > design.rows) continue;
+        size_t p = plot_of_row[run_id - 1];
+        double d = results->responses[i] - grand;
+        ss_total += d * d;
+        within[i] = results->responses[i] - plot_sum[p] / (double)plot_n[p];
+    }
+
+    /* Factors constant within whole plots (declared or confounded) go to the
+     * whole-plot stratum; rows: wp factors, wp error, sp factors, sp error */
+    size_t fc = def->factor_count;
+    taguchi_anova_row_t *rows = xmalloc((fc + 2) * sizeof(taguchi_anova_row_t));
+    bool *between = xmalloc(fc * sizeof(bool) + 1);
+    size_t count = 0;
+    double wp_ss = 0.0, sp_ss = 0.0;
+    size_t wp_df = 0, sp_df = 0;
+
+    for (size_t f = 0; f < fc; f++) {
+        between[f] = def->factors[f].whole_plot ||
+                     constant_within_plots(results, &design, plot_of_row, plots, f);
+    }
+    for (size_t f = 0; f < fc; f++) {
+        if (!between[f]) continue;
+        size_t df;
+        double ss = factor_sum_squares(results, &design, f, results->responses, grand,
+                                       def->factors[f].level_count, &df);
+        fill_row(&rows[count++], def->factors[f].name, TAGUCHI_STRATUM_WHOLE_PLOT, false, ss, df);
+        wp_ss += ss;
+        wp_df += df;
+    }
+    size_t wp_error = count;
+    size_t wp_error_df = plots_seen - 1 > wp_df ? plots_seen - 1 - wp_df : 0;
+    fill_row(&rows[count++], "error", TAGUCHI_STRATUM_WHOLE_PLOT, true,
+             wp_error_df > 0 ? fmax(ss_plots - wp_ss, 0.0) : 0.0, wp_error_df);
+    test_against(rows, 0, wp_error, &rows[wp_error]);
+
+    size_t sp_begin = count;
+    for (size_t f = 0; f < fc; f++) {
+        if (between[f]) continue;
+        size_t df;
+        double ss = factor_sum_squares(results, &design, f, within, 0.0,
+                                       def->factors[f].level_count, &df);
+        fill_row(&rows[count++], def->factors[f].name, TAGUCHI_STRATUM_SUB_PLOT, false, ss, df);
+        sp_ss += ss;
+        sp_df += df;
+    }
+    size_t sp_error = count;
+    size_t within_df = n - plots_seen;
+    size_t sp_error_df = within_df > sp_df ? within_df - sp_df : 0;
+    fill_row(&rows[count++], "error", TAGUCHI_STRATUM_SUB_PLOT, true,
+             sp_error_df > 0 ? fmax(ss_total - ss_plots - sp_ss, 0.0) : 0.0, sp_error_df);
+    test_against(rows, sp_begin, sp_error, &rows[sp_error]);
+
+    free(between);
+    free(within);
+    free(plot_n);
+    free(plot_sum);
+    free(plot_of_row);
+    free_compiled_design(&design);
+
+    *rows_out = rows;
+    *count_out = count;
+    return 0;
+}
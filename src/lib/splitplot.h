@@ -0,0 +1,47 @@
+#ifndef SPLITPLOT_H
+#define SPLITPLOT_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "parser.h"      // For ExperimentDef
+#include "generator.h"   // For CompiledDesign
+#include "analyzer.h"    // For ResultSet
+
+/*
+ * Split-plot designs.
+ *
+ * Whole-plot factors are hard to change, so runs are grouped into whole
+ * plots that share their levels.  A crossed layout runs the whole sub-plot
+ * array inside every row of a separate whole-plot array (whole-plot levels
+ * change at most once per whole plot); a nested layout keeps one array and
+ * sorts its rows by whole-plot levels.  Analysis then tests each factor
+ * against the error of its own stratum.
+ */
+
+/* True if any factor of def is a whole-plot factor */
+bool def_is_split_plot(const ExperimentDef *def);
+
+/* Compile a split-plot definition; called by compile_design */
+int compile_split_plot_design(
+    taguchi_context_t *ctx,
+    const ExperimentDef *def,
+    CompiledDesign *out,
+    char *error_buf
+);
+
+/* Fill plot_of_row[design->rows] with 0-based whole-plot numbers; returns the plot count */
+size_t split_plot_whole_plots(
+    const ExperimentDef *def,
+    const CompiledDesign *design,
+    size_t *plot_of_row
+);
+
+/* Split-plot ANOVA of results (see taguchi_split_plot_anova) */
+int split_plot_anova(
+    const ResultSet *results,
+    taguchi_anova_row_t **rows_out,
+    size_t *count_out,
+    char *error_buf
+);
+
+#endif /* SPLITPLOT_H */
@@ -0,0 +1,18 @@
+#ifndef STATS_H
+#define STATS_H
+
+/* Distribution functions used by the significance tests */
+
+/* Regularized incomplete beta function I_x(a, b), for a, b > 0 and 0 <= x <= 1 */
+double incomplete_beta(double x, double a, double b);
+
+/* Upper tail P(F > f) of the F distribution with (df1, df2) degrees of freedom */
+double f_distribution_sf(double f, double df1, double df2);
+
+/* Upper tail P(T > t) of Student's t distribution with df degrees of freedom */
+double t_distribution_sf(double t, double df);
+
+/* The t with P(T <= t) = p, for 0 < p < 1 */
+double t_distribution_quantile(double p, double df);
+
+#endif /* STATS_H */
@@ -4,11 +4,20 @@
 #include "generator.h"
 #include "serializer.h"
 #include "analyzer.h"
+#include "design_cache.h"
+#include "ingest.h"
+#include "changeover.h"
+#include "splitplot.h"
+#include "replication.h"
+#include "effectdiff.h"
+#include "curves.h"
+#include "bitmap.h"
 #include "utils.h"
 #include "../config.h"  // Include config for constants
 #include <stdlib.h>     // For malloc, free
 #include <stdio.h>      // For snprintf
 #include <string.h>
+#include <math.h>
 
 /*
  * ============================================================================
@@ -29,10 +38,19 @@ struct taguchi_result_set {
     ResultSet internal_results;
 };
 
+struct taguchi_ingest {
+    IngestQueue *queue;
+    const taguchi_experiment_def_t *def;
+};
+
 struct taguchi_main_effect {
     MainEffect internal_effect;
 };
 
+struct taguchi_run_index {
+    RunIndex index;
+};
+
 /*
  * ============================================================================
  * Experiment Definition API Implementation
@@ -90,6 +108,7 @@ int taguchi_add_factor(taguchi_experiment_def_t *def, const char *name, const ch
         }
         strcpy(new_factor->values[i], levels[i]);
     }
+    classify_factor_levels(new_factor);
 
     def->internal_def.factor_count++;
     return 0;
@@ -112,6 +131,61 @@ const char *taguchi_def_get_factor_name(const taguchi_experiment_def_t *def, siz
     return def->internal_def.factors[index].name;
 }
 
+size_t taguchi_def_get_level_count(const taguchi_experiment_def_t *def, size_t index) {
+    if (!def) return 0;
+    if (index >= def->internal_def.factor_count) return 0;
+
+    return def->internal_def.factors[index].level_count;
+}
+
+taguchi_level_type_t taguchi_def_get_level_type(const taguchi_experiment_def_t *def, size_t index) {
+    if (!def || index >= def->internal_def.factor_count) return TAGUCHI_LEVEL_STRING;
+    return (taguchi_level_type_t)def->internal_def.factors[index].type;
+}
+
+const char *taguchi_level_type_name(taguchi_level_type_t type) {
+    switch (type) {
+        case TAGUCHI_LEVEL_BOOL: return "bool";
+        case TAGUCHI_LEVEL_INT: return "int";
+        case TAGUCHI_LEVEL_FLOAT: return "float";
+        default: return "string";
+    }
+}
+
+const int64_t *taguchi_def_get_int_levels(const taguchi_experiment_def_t *def, size_t index) {
+    if (!def || index >= def->internal_def.factor_count) return NULL;
+    const Factor *factor = &def->internal_def.factors[index];
+    bool exact = factor->type == LEVEL_INT || factor->type == LEVEL_BOOL;
+    return exact ? factor->int_values : NULL;
+}
+
+const double *taguchi_def_get_numeric_levels(const taguchi_experiment_def_t *def, size_t index) {
+    if (!def || index >= def->internal_def.factor_count) return NULL;
+    const Factor *factor = &def->internal_def.factors[index];
+    return factor->numeric ? factor->numeric_values : NULL;
+}
+
+double taguchi_def_get_changeover_cost(const taguchi_experiment_def_t *def, size_t index) {
+    if (!def) return 0.0;
+    if (index >= def->internal_def.factor_count) return 0.0;
+
+    return def->internal_def.factors[index].changeover_cost;
+}
+
+int taguchi_def_set_changeover_cost(taguchi_experiment_def_t *def, size_t index, double cost, char *error_buf) {
+    if (!def || index >= def->internal_def.factor_count) {
+        set_error(error_buf, "Invalid parameters to taguchi_def_set_changeover_cost");
+        return -1;
+    }
+    if (!isfinite(cost) || cost < 0.0) {
+        set_error(error_buf, "Invalid changeover cost for '%s' (expected a number >= 0)",
+                  def->internal_def.factors[index].name);
+        return -1;
+    }
+    def->internal_def.factors[index].changeover_cost = cost;
+    return 0;
+}
+
 void taguchi_free_definition(taguchi_experiment_def_t *def) {
     if (def) {
         free_experiment_def(&def->internal_def);
@@ -157,6 +231,16 @@ int taguchi_get_array_info(const char *name, size_t *rows_out, size_t *cols_out,
     return 0;
 }
 
+/*
+ * ============================================================================
+ * Design Cache API Implementation
+ * ============================================================================
+ */
+
+int taguchi_set_design_cache_dir(const char *dir, char *error_buf) {
+    return taguchi_context_set_design_cache_dir(NULL, dir, error_buf);
+}
+
 /*
  * ============================================================================
  * Generation API Implementation
@@ -164,6 +248,10 @@ int taguchi_get_array_info(const char *name, size_t *rows_out, size_t *cols_out,
  */
 
 int taguchi_generate_runs(const taguchi_experiment_def_t *def, taguchi_experiment_run_t ***runs_out, size_t *count_out, char *error_buf) {
+    return taguchi_generate_runs_ctx(NULL, def, runs_out, count_out, error_buf);
+}
+
+int taguchi_generate_runs_ctx(taguchi_context_t *ctx, const taguchi_experiment_def_t *def, taguchi_experiment_run_t ***runs_out, size_t *count_out, char *error_buf) {
     if (!def || !runs_out || !count_out) {
         set_error(error_buf, "Invalid parameters to taguchi_generate_runs");
         return -1;
@@ -172,24 +260,27 @@ int taguchi_generate_runs(const taguchi_experiment_def_t *def, taguchi_experimen
     ExperimentRun *internal_runs = NULL;
     size_t internal_count = 0;
     
-    int result = generate_experiments(&def->internal_def, &internal_runs, &internal_count, error_buf);
+    int result = generate_experiments_in(ctx, &def->internal_def, &internal_runs, &internal_count, error_buf);
     if (result != 0) {
         return -1;
     }
     
-    // Convert internal runs to opaque handles
-    taguchi_experiment_run_t **external_runs = xmalloc(internal_count * sizeof(taguchi_experiment_run_t*));
+    /*
+     * Handles point into the internal run array instead of copying each run:
+     * a handle wraps exactly one ExperimentRun, so &internal_runs[i] is a
+     * valid handle.  The array itself is kept in the slot after the last
+     * handle for taguchi_free_runs, so generation makes no per-run
+     * allocation.
+     */
+    taguchi_experiment_run_t **external_runs = xmalloc((internal_count + 1) * sizeof(taguchi_experiment_run_t*));
     for (size_t i = 0; i < internal_count; i++) {
-        external_runs[i] = xmalloc(sizeof(taguchi_experiment_run_t));
-        memcpy(&external_runs[i]->internal_run, &internal_runs[i], sizeof(ExperimentRun));
+        external_runs[i] = (taguchi_experiment_run_t *)&internal_runs[i];
     }
+    external_runs[internal_count] = (taguchi_experiment_run_t *)internal_runs;
     
     *runs_out = external_runs;
     *count_out = internal_count;
     
-    // Free the temporary internal structure array (but not the data itself)
-    free(internal_runs);
-    
     return 0;
 }
 
@@ -225,6 +316,22 @@ size_t taguchi_run_get_id(const taguchi_experiment_run_t *run) {
     return run->internal_run.run_id;
 }
 
+size_t taguchi_run_get_level_index(const taguchi_experiment_run_t *run, size_t factor_index) {
+    if (!run) return 0;
+    if (factor_index >= run->internal_run.factor_count) return 0;
+    return run->internal_run.level_indices[factor_index];
+}
+
+const size_t *taguchi_run_get_level_indices(const taguchi_experiment_run_t *run) {
+    if (!run) return NULL;
+    return run->internal_run.level_indices;
+}
+
+const char *taguchi_run_get_value_at_index(const taguchi_experiment_run_t *run, size_t index) {
+    if (!run || index >= run->internal_run.factor_count) return NULL;
+    return run->internal_run.values[index];
+}
+
 const char **taguchi_run_get_factor_names(const taguchi_experiment_run_t *run) {
     if (!run) return NULL;
 
@@ -239,15 +346,48 @@ const char **taguchi_run_get_factor_names(const taguchi_experiment_run_t *run) {
 
 void taguchi_free_runs(taguchi_experiment_run_t **runs, size_t count) {
     if (runs) {
-        for (size_t i = 0; i < count; i++) {
-            if (runs[i]) {
-                free(runs[i]);
-            }
-        }
+        /* All handles live in one run array, stored after the last handle */
+        free(runs[count]);
         free(runs);
     }
 }
 
+/*
+ * ============================================================================
+ * Run Ordering API Implementation
+ * ============================================================================
+ */
+
+int taguchi_plan_run_order(const taguchi_experiment_def_t *def, size_t *order_out, size_t count,
+                           double *cost_out, double *array_order_cost_out, char *error_buf) {
+    if (!def || !order_out) {
+        set_error(error_buf, "Invalid parameters to taguchi_plan_run_order");
+        return -1;
+    }
+
+    CompiledDesign design;
+    if (acquire_design(NULL, &def->internal_def, &design, error_buf) != 0) {
+        return -1;
+    }
+    if (count != design.rows) {
+        set_error(error_buf, "Run order needs room for %zu runs, got %zu", design.rows, count);
+        free_compiled_design(&design);
+        return -1;
+    }
+
+    double cost = changeover_order(&def->internal_def, &design, order_out);
+    if (cost_out) *cost_out = cost;
+    if (array_order_cost_out) {
+        double array_cost = 0.0;
+        for (size_t i = 1; i < design.rows; i++) {
+            array_cost += changeover_distance(&def->internal_def, &design, i - 1, i);
+        }
+        *array_order_cost_out = array_cost;
+    }
+    free_compiled_design(&design);
+    return 0;
+}
+
 /*
  * ============================================================================
  * Results API Implementation
@@ -282,6 +422,22 @@ int taguchi_add_result(taguchi_result_set_t *results, size_t run_id, double resp
     return result;
 }
 
+size_t taguchi_result_count(const taguchi_result_set_t *results) {
+    return results ? results->internal_results.count : 0;
+}
+
+int taguchi_result_get(const taguchi_result_set_t *results, size_t index, size_t *run_id_out,
+                       double *response_out) {
+    if (!results || index >= results->internal_results.count) return -1;
+    if (run_id_out) *run_id_out = results->internal_results.run_ids[index];
+    if (response_out) *response_out = results->internal_results.responses[index];
+    return 0;
+}
+
+const char *taguchi_result_metric(const taguchi_result_set_t *results) {
+    return results ? results->internal_results.metric_name : NULL;
+}
+
 void taguchi_free_result_set(taguchi_result_set_t *results) {
     if (results) {
         // Use analyzer module's free function
@@ -306,7 +462,26 @@ void taguchi_free_result_set(taguchi_result_set_t *results) {
  * ============================================================================
  */
 
+/* Wrap internal effects in opaque handles, taking over their level_means */
+static taguchi_main_effect_t **wrap_effects(MainEffect *internal_effects, size_t count) {
+    taguchi_main_effect_t **external_effects = xmalloc(count * sizeof(taguchi_main_effect_t *) + 1);
+    for (size_t i = 0; i < count; i++) {
+        external_effects[i] = xmalloc(sizeof(taguchi_main_effect_t));
+        memcpy(&external_effects[i]->internal_effect, &internal_effects[i], sizeof(MainEffect));
+        /* Null out level_means in the source so free_main_effects won't double-free */
+        internal_effects[i].level_means = NULL;
+    }
+
+    /* Free the internal array shell (level_means ownership transferred above) */
+    free(internal_effects);
+    return external_effects;
+}
+
 int taguchi_calculate_main_effects(const taguchi_result_set_t *results, taguchi_main_effect_t ***effects_out, size_t *count_out, char *error_buf) {
+    return taguchi_calculate_main_effects_ctx(NULL, results, effects_out, count_out, error_buf);
+}
+
+int taguchi_calculate_main_effects_ctx(taguchi_context_t *ctx, const taguchi_result_set_t *results, taguchi_main_effect_t ***effects_out, size_t *count_out, char *error_buf) {
     if (!results || !effects_out || !count_out) {
         set_error(error_buf, "Invalid parameters to taguchi_calculate_main_effects");
         return -1;
@@ -315,25 +490,13 @@ int taguchi_calculate_main_effects(const taguchi_result_set_t *results, taguchi_
     MainEffect *internal_effects = NULL;
     size_t internal_count = 0;
 
-    int rc = calculate_main_effects(&results->internal_results, &internal_effects, &internal_count);
+    int rc = calculate_main_effects_in(ctx, &results->internal_results, &internal_effects, &internal_count);
     if (rc != 0) {
         set_error(error_buf, "Failed to calculate main effects");
         return -1;
     }
 
-    /* Wrap internal effects in opaque handles */
-    taguchi_main_effect_t **external_effects = xmalloc(internal_count * sizeof(taguchi_main_effect_t *));
-    for (size_t i = 0; i < internal_count; i++) {
-        external_effects[i] = xmalloc(sizeof(taguchi_main_effect_t));
-        memcpy(&external_effects[i]->internal_effect, &internal_effects[i], sizeof(MainEffect));
-        /* Null out level_means in the source so free_main_effects won't double-free */
-        internal_effects[i].level_means = NULL;
-    }
-
-    /* Free the internal array shell (level_means ownership transferred above) */
-    free(internal_effects);
-
-    *effects_out = external_effects;
+    *effects_out = wrap_effects(internal_effects, internal_count);
     *count_out = internal_count;
     return 0;
 }
@@ -386,6 +549,356 @@ int taguchi_recommend_optimal(const taguchi_main_effect_t **effects, size_t effe
     return rc;
 }
 
+/*
+ * ============================================================================
+ * Split-Plot Analysis API Implementation
+ * ============================================================================
+ */
+
+bool taguchi_def_is_split_plot(const taguchi_experiment_def_t *def) {
+    if (!def) return false;
+    return def_is_split_plot(&def->internal_def);
+}
+
+bool taguchi_def_is_whole_plot_factor(const taguchi_experiment_def_t *def, size_t index) {
+    if (!def) return false;
+    if (index >= def->internal_def.factor_count) return false;
+
+    return def->internal_def.factors[index].whole_plot;
+}
+
+size_t taguchi_get_whole_plots(const taguchi_experiment_def_t *def, size_t *plot_out, size_t count, char *error_buf) {
+    if (!def || !plot_out) {
+        set_error(error_buf, "Invalid parameters to taguchi_get_whole_plots");
+        return 0;
+    }
+
+    CompiledDesign design;
+    if (acquire_design(NULL, &def->internal_def, &design, error_buf) != 0) {
+        return 0;
+    }
+    size_t plots = 0;
+    if (count != design.rows) {
+        set_error(error_buf, "Whole plots need room for %zu runs, got %zu", design.rows, count);
+    } else {
+        plots = split_plot_whole_plots(&def->internal_def, &design, plot_out);
+        for (size_t i = 0; i < count; i++) {
+            plot_out[i]++;
+        }
+    }
+    free_compiled_design(&design);
+    return plots;
+}
+
+int taguchi_split_plot_anova(const taguchi_result_set_t *results, taguchi_anova_row_t **rows_out,
+                             size_t *count_out, char *error_buf) {
+    if (!results || !rows_out || !count_out) {
+        set_error(error_buf, "Invalid parameters to taguchi_split_plot_anova");
+        return -1;
+    }
+    return split_plot_anova(&results->internal_results, rows_out, count_out, error_buf);
+}
+
+void taguchi_free_anova(taguchi_anova_row_t *rows) {
+    free(rows);
+}
+
+/*
+ * ============================================================================
+ * Adaptive Replication API Implementation
+ * ============================================================================
+ */
+
+void taguchi_replication_options_init(taguchi_replication_options_t *opts) {
+    if (!opts) return;
+    memset(opts, 0, sizeof(*opts));
+    opts->confidence = 0.95;
+    opts->higher_is_better = true;
+    opts->top_factors = 3;
+}
+
+int taguchi_level_intervals(const taguchi_result_set_t *results, size_t factor_index,
+                            double confidence, double *means_out, double *half_widths_out,
+                            size_t level_count, char *error_buf) {
+    if (!results) {
+        set_error(error_buf, "Invalid parameters to taguchi_level_intervals");
+        return -1;
+    }
+    return replication_level_intervals(&results->internal_results, factor_index, confidence,
+                                       means_out, half_widths_out, level_count, error_buf);
+}
+
+int taguchi_plan_replicates(const taguchi_result_set_t *results,
+                            const taguchi_replication_options_t *opts,
+                            size_t *run_ids_out, size_t max_runs, size_t *count_out,
+                            taguchi_replication_status_t *status_out, char *error_buf) {
+    if (!results) {
+        set_error(error_buf, "Invalid parameters to taguchi_plan_replicates");
+        return -1;
+    }
+    taguchi_replication_options_t defaults;
+    if (!opts) {
+        taguchi_replication_options_init(&defaults);
+        opts = &defaults;
+    }
+    return replication_plan(&results->internal_results, opts, run_ids_out, max_runs,
+                            count_out, status_out, error_buf);
+}
+
+/*
+ * ============================================================================
+ * Campaign Comparison API Implementation
+ * ============================================================================
+ */
+
+void taguchi_compare_options_init(taguchi_compare_options_t *opts) {
+    if (!opts) return;
+    memset(opts, 0, sizeof(*opts));
+    opts->seed = 1;
+    opts->alpha = 0.05;
+}
+
+int taguchi_compare_results(const taguchi_result_set_t *a, const taguchi_result_set_t *b,
+                            const taguchi_compare_options_t *opts,
+                            taguchi_factor_change_t **changes_out, size_t *count_out,
+                            taguchi_comparison_summary_t *summary_out, char *error_buf) {
+    return taguchi_compare_results_ctx(NULL, a, b, opts, changes_out, count_out, summary_out,
+                                       error_buf);
+}
+
+int taguchi_compare_results_ctx(taguchi_context_t *ctx, const taguchi_result_set_t *a,
+                                const taguchi_result_set_t *b,
+                                const taguchi_compare_options_t *opts,
+                                taguchi_factor_change_t **changes_out, size_t *count_out,
+                                taguchi_comparison_summary_t *summary_out, char *error_buf) {
+    if (!a || !b || !changes_out || !count_out) {
+        set_error(error_buf, "Invalid parameters to taguchi_compare_results");
+        return -1;
+    }
+    taguchi_compare_options_t defaults;
+    if (!opts) {
+        taguchi_compare_options_init(&defaults);
+        opts = &defaults;
+    }
+    return effect_diff(ctx, &a->internal_results, &b->internal_results, opts, changes_out,
+                       count_out, summary_out, error_buf);
+}
+
+void taguchi_free_factor_changes(taguchi_factor_change_t *changes, size_t count) {
+    if (!changes) return;
+    for (size_t i = 0; i < count; i++) {
+        free(changes[i].delta);
+        free(changes[i].std_error);
+    }
+    free(changes);
+}
+
+/*
+ * ============================================================================
+ * Response Curve API Implementation
+ * ============================================================================
+ */
+
+void taguchi_curve_options_init(taguchi_curve_options_t *opts) {
+    if (!opts) return;
+    opts->degree = 2;
+    opts->higher_is_better = true;
+}
+
+int taguchi_fit_response_curves(const taguchi_result_set_t *results,
+                                const taguchi_curve_options_t *opts,
+                                taguchi_response_curve_t **curves_out, size_t *count_out,
+                                char *error_buf) {
+    return taguchi_fit_response_curves_ctx(NULL, results, opts, curves_out, count_out, error_buf);
+}
+
+int taguchi_fit_response_curves_ctx(taguchi_context_t *ctx, const taguchi_result_set_t *results,
+                                    const taguchi_curve_options_t *opts,
+                                    taguchi_response_curve_t **curves_out, size_t *count_out,
+                                    char *error_buf) {
+    if (!results || !curves_out || !count_out) {
+        set_error(error_buf, "Invalid parameters to taguchi_fit_response_curves");
+        return -1;
+    }
+    taguchi_curve_options_t defaults;
+    if (!opts) {
+        taguchi_curve_options_init(&defaults);
+        opts = &defaults;
+    }
+    return fit_response_curves(ctx, &results->internal_results, opts, curves_out, count_out,
+                               error_buf);
+}
+
+double taguchi_curve_predict(const taguchi_response_curve_t *curve, double x) {
+    if (!curve) return NAN;
+    return response_curve_at(curve, x);
+}
+
+void taguchi_free_response_curves(taguchi_response_curve_t *curves) {
+    free(curves);
+}
+
+/*
+ * ============================================================================
+ * Run Index API Implementation
+ * ============================================================================
+ */
+
+taguchi_run_index_t *taguchi_run_index_create(const taguchi_experiment_def_t *def, char *error_buf) {
+    if (!def) {
+        set_error(error_buf, "Invalid parameters to taguchi_run_index_create");
+        return NULL;
+    }
+    taguchi_run_index_t *index = xmalloc(sizeof(taguchi_run_index_t));
+    if (run_index_build(NULL, &def->internal_def, &index->index, error_buf) != 0) {
+        free(index);
+        return NULL;
+    }
+    return index;
+}
+
+size_t taguchi_run_index_run_count(const taguchi_run_index_t *index) {
+    return index ? index->index.rows : 0;
+}
+
+size_t taguchi_run_index_words(const taguchi_run_index_t *index) {
+    return index ? index->index.words : 0;
+}
+
+const uint64_t *taguchi_run_index_level(const taguchi_run_index_t *index, size_t factor_index,
+                                        size_t level_index) {
+    return index ? run_index_level(&index->index, factor_index, level_index) : NULL;
+}
+
+int taguchi_run_index_select(const taguchi_run_index_t *index, const char *factor_name,
+                             const char *value, uint64_t *bits_out, char *error_buf) {
+    if (!index) {
+        set_error(error_buf, "Invalid parameters to taguchi_run_index_select");
+        return -1;
+    }
+    return run_index_select(&index->index, factor_name, value, bits_out, error_buf);
+}
+
+void taguchi_run_index_free(taguchi_run_index_t *index) {
+    if (index) {
+        run_index_free(&index->index);
+        free(index);
+    }
+}
+
+void taguchi_bitset_and(uint64_t *dst, const uint64_t *src, size_t words) {
+    if (dst && src) bitset_and(dst, src, words);
+}
+
+void taguchi_bitset_or(uint64_t *dst, const uint64_t *src, size_t words) {
+    if (dst && src) bitset_or(dst, src, words);
+}
+
+size_t taguchi_bitset_count(const uint64_t *bits, size_t words) {
+    return bits ? bitset_count(bits, words) : 0;
+}
+
+size_t taguchi_bitset_runs(const uint64_t *bits, size_t words, size_t *ids_out, size_t max_ids) {
+    return bits ? bitset_runs(bits, words, ids_out, max_ids) : 0;
+}
+
+int taguchi_calculate_conditional_effects(const taguchi_result_set_t *results,
+                                          const taguchi_run_index_t *index,
+                                          const uint64_t *subset,
+                                          taguchi_main_effect_t ***effects_out,
+                                          size_t *count_out, char *error_buf) {
+    if (!results || !index || !effects_out || !count_out) {
+        set_error(error_buf, "Invalid parameters to taguchi_calculate_conditional_effects");
+        return -1;
+    }
+    MainEffect *internal_effects = NULL;
+    size_t internal_count = 0;
+    if (conditional_main_effects(&results->internal_results, &index->index, subset,
+                                 &internal_effects, &internal_count, error_buf) != 0) {
+        return -1;
+    }
+    *effects_out = wrap_effects(internal_effects, internal_count);
+    *count_out = internal_count;
+    return 0;
+}
+
+/*
+ * ============================================================================
+ * Concurrent Ingestion API Implementation
+ * ============================================================================
+ */
+
+taguchi_ingest_t *taguchi_ingest_create(const taguchi_experiment_def_t *def, size_t capacity, char *error_buf) {
+    if (!def) {
+        set_error(error_buf, "Invalid parameters to taguchi_ingest_create");
+        return NULL;
+    }
+    IngestQueue *queue = ingest_create(&def->internal_def, capacity, error_buf);
+    if (!queue) return NULL;
+
+    taguchi_ingest_t *ingest = xmalloc(sizeof(taguchi_ingest_t));
+    ingest->queue = queue;
+    ingest->def = def;
+    return ingest;
+}
+
+int taguchi_ingest_push(taguchi_ingest_t *ingest, size_t run_id, double response_value) {
+    return ingest ? ingest_push(ingest->queue, run_id, response_value) : -1;
+}
+
+size_t taguchi_ingest_drain(taguchi_ingest_t *ingest, size_t max_items) {
+    return ingest ? ingest_drain(ingest->queue, max_items) : 0;
+}
+
+int taguchi_ingest_snapshot_effects(const taguchi_ingest_t *ingest, taguchi_main_effect_t ***effects_out,
+                                    size_t *count_out, size_t *observations_out, char *error_buf) {
+    if (!ingest || !effects_out || !count_out) {
+        set_error(error_buf, "Invalid parameters to taguchi_ingest_snapshot_effects");
+        return -1;
+    }
+    MainEffect *internal_effects = NULL;
+    size_t internal_count = 0;
+    if (ingest_snapshot_effects(ingest->queue, &internal_effects, &internal_count, observations_out) != 0) {
+        set_error(error_buf, "Failed to snapshot main effects");
+        return -1;
+    }
+    *effects_out = wrap_effects(internal_effects, internal_count);
+    *count_out = internal_count;
+    return 0;
+}
+
+int taguchi_ingest_run_stats(const taguchi_ingest_t *ingest, size_t run_id, double *mean_out, size_t *count_out) {
+    return ingest ? ingest_run_stats(ingest->queue, run_id, mean_out, count_out) : -1;
+}
+
+size_t taguchi_ingest_dropped(const taguchi_ingest_t *ingest) {
+    return ingest ? ingest_dropped(ingest->queue) : 0;
+}
+
+size_t taguchi_ingest_rejected(const taguchi_ingest_t *ingest) {
+    return ingest ? ingest_rejected(ingest->queue) : 0;
+}
+
+taguchi_result_set_t *taguchi_ingest_to_result_set(const taguchi_ingest_t *ingest, const char *metric_name) {
+    if (!ingest || !metric_name) return NULL;
+    ResultSet *internal = ingest_to_result_set(ingest->queue, metric_name);
+    if (!internal) return NULL;
+
+    taguchi_result_set_t *results = xmalloc(sizeof(taguchi_result_set_t));
+    memcpy(&results->internal_results, internal, sizeof(ResultSet));
+    results->internal_results.experiment_def = (ExperimentDef *)&ingest->def->internal_def;
+    /* Arrays now belong to the handle; only the shell is freed */
+    free(internal);
+    return results;
+}
+
+void taguchi_ingest_free(taguchi_ingest_t *ingest) {
+    if (ingest) {
+        ingest_free(ingest->queue);
+        free(ingest);
+    }
+}
+
 /*
  * ============================================================================
  * Serialization API Implementation
@@ -399,14 +912,30 @@ char *taguchi_runs_to_json(const taguchi_experiment_run_t **runs, size_t count)
         return result;
     }
 
-    // Convert taguchi_experiment_run_t array to internal ExperimentRun array for serialization
-    // For now, we'll assume the internal structure is compatible
-    ExperimentRun *internal_runs = xmalloc(count * sizeof(ExperimentRun));
+    // Point at the internal runs rather than copying them
+    const ExperimentRun **internal_runs = xmalloc(count * sizeof(ExperimentRun *));
+    for (size_t i = 0; i < count; i++) {
+        internal_runs[i] = &runs[i]->internal_run;
+    }
+
+    char *json_result = serialize_runs_to_json(NULL, internal_runs, count);
+
+    free(internal_runs);
+    return json_result;
+}
+
+char *taguchi_runs_to_typed_json(const taguchi_experiment_def_t *def,
+                                 const taguchi_experiment_run_t **runs, size_t count) {
+    if (!def || !runs || count == 0) {
+        return taguchi_runs_to_json(runs, count);
+    }
+
+    const ExperimentRun **internal_runs = xmalloc(count * sizeof(ExperimentRun *));
     for (size_t i = 0; i < count; i++) {
-        memcpy(&internal_runs[i], &runs[i]->internal_run, sizeof(ExperimentRun));
+        internal_runs[i] = &runs[i]->internal_run;
     }
 
-    char *json_result = serialize_runs_to_json(internal_runs, count);
+    char *json_result = serialize_runs_to_json(&def->internal_def, internal_runs, count);
 
     free(internal_runs);
     return json_result;
@@ -432,7 +961,12 @@ char *taguchi_effects_to_json(const taguchi_main_effect_t **effects, size_t coun
             e->factor_name, e->range);
         for (size_t lv = 0; lv < e->level_count; lv++) {
             if (lv > 0) pos += (size_t)snprintf(json + pos, buf_size - pos, ", ");
-            pos += (size_t)snprintf(json + pos, buf_size - pos, "%.6f", e->level_means[lv]);
+            /* Levels left empty by a conditional analysis have no mean */
+            if (isnan(e->level_means[lv])) {
+                pos += (size_t)snprintf(json + pos, buf_size - pos, "null");
+            } else {
+                pos += (size_t)snprintf(json + pos, buf_size - pos, "%.6f", e->level_means[lv]);
+            }
         }
         pos += (size_t)snprintf(json + pos, buf_size - pos, "]}%s\n",
             (i < count - 1) ? "," : "");
@@ -0,0 +1,228 @@
+/*
+ * Allocation budgets of library hot paths.
+ *
+ * This binary is linked with -Wl,--wrap=malloc (and calloc, realloc,
+ * free), so every allocation made by the library objects linked into it
+ * goes through the counters below; libc's own internal allocations do not.
+ * Each scenario measures one API call between alloc_begin() and
+ * alloc_end() and fails when it makes more allocation calls or requests
+ * more bytes than its budget, or leaks.  Per-run costs are the slope
+ * between two designs of different size with the same factors, so a
+ * budget of 0 calls per run means generation cost does not grow with the
+ * design.
+ *
+ * Budgets are tight on purpose: when a change lowers a count, lower the
+ * budget with it.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "include/taguchi.h"
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+static size_t alloc_calls;      /* malloc, calloc and realloc calls */
+static size_t alloc_bytes;      /* bytes they requested */
+static size_t free_calls;       /* free of a non-NULL pointer, realloc to a new block */
+
+void *__wrap_malloc(size_t size) {
+    __atomic_add_fetch(&alloc_calls, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&alloc_bytes, size, __ATOMIC_RELAXED);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    __atomic_add_fetch(&alloc_calls, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&alloc_bytes, count * size, __ATOMIC_RELAXED);
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    __atomic_add_fetch(&alloc_calls, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&alloc_bytes, size, __ATOMIC_RELAXED);
+    /* Growing a block in place or moving it keeps one live block */
+    if (ptr) __atomic_add_fetch(&free_calls, 1, __ATOMIC_RELAXED);
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void *ptr) {
+    if (ptr) __atomic_add_fetch(&free_calls, 1, __ATOMIC_RELAXED);
+    __real_free(ptr);
+}
+
+typedef struct {
+    size_t calls;
+    size_t bytes;
+    size_t frees;
+} AllocCount;
+
+static AllocCount alloc_start;
+
+static void alloc_begin(void) {
+    alloc_start.calls = __atomic_load_n(&alloc_calls, __ATOMIC_RELAXED);
+    alloc_start.bytes = __atomic_load_n(&alloc_bytes, __ATOMIC_RELAXED);
+    alloc_start.frees = __atomic_load_n(&free_calls, __ATOMIC_RELAXED);
+}
+
+static AllocCount alloc_end(void) {
+    AllocCount c;
+    c.calls = __atomic_load_n(&alloc_calls, __ATOMIC_RELAXED) - alloc_start.calls;
+    c.bytes = __atomic_load_n(&alloc_bytes, __ATOMIC_RELAXED) - alloc_start.bytes;
+    c.frees = __atomic_load_n(&free_calls, __ATOMIC_RELAXED) - alloc_start.frees;
+    return c;
+}
+
+static int failures = 0;
+
+static void check_budget(const char *scenario, size_t measured, size_t budget, const char *unit) {
+    if (measured > budget) {
+        printf("  FAIL: %-44s %8zu %s (budget %zu)\n", scenario, measured, unit, budget);
+        failures++;
+    } else {
+        printf("  PASS: %-44s %8zu %s (budget %zu)\n", scenario, measured, unit, budget);
+    }
+}
+
+static void check_balanced(const char *scenario, AllocCount c) {
+    if (c.frees != c.calls) {
+        printf("  FAIL: %-44s %zu allocations, %zu frees\n", scenario, c.calls, c.frees);
+        failures++;
+    }
+}
+
+/* 13 three-level factors fit both L27 and L81 */
+static char *def_text(const char *array) {
+    static char buf[1024];
+    size_t pos = (size_t)snprintf(buf, sizeof(buf), "factors:\n");
+    for (int f = 0; f < 13; f++) {
+        pos += (size_t)snprintf(buf + pos, sizeof(buf) - pos,
+                                "  factor_%02d: low, mid, high\n", f);
+    }
+    snprintf(buf + pos, sizeof(buf) - pos, "array: %s\n", array);
+    return buf;
+}
+
+typedef struct {
+    AllocCount generate;
+    AllocCount free_runs;
+    size_t runs;
+} GenerateCost;
+
+static GenerateCost generate_cost(taguchi_context_t *ctx, const char *array) {
+    char error[TAGUCHI_ERROR_SIZE];
+    GenerateCost cost;
+    taguchi_experiment_def_t *def = taguchi_parse_definition(def_text(array), error);
+    taguchi_experiment_run_t **runs = NULL;
+    alloc_begin();
+    if (taguchi_generate_runs_ctx(ctx, def, &runs, &cost.runs, error) != 0) {
+        printf("  FAIL: generate %s: %s\n", array, error);
+        exit(1);
+    }
+    cost.generate = alloc_end();
+    alloc_begin();
+    taguchi_free_runs(runs, cost.runs);
+    cost.free_runs = alloc_end();
+    taguchi_free_definition(def);
+    return cost;
+}
+
+/* Effects of an L27 design with `replicates` results per run */
+static AllocCount effects_cost(taguchi_context_t *ctx, size_t replicates) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(def_text("L27"), error);
+    taguchi_result_set_t *results = taguchi_create_result_set(def, "y");
+    for (size_t rep = 0; rep < replicates; rep++) {
+        for (size_t id = 1; id <= 27; id++) {
+            taguchi_add_result(results, id, (double)(id * 7 % 11) + (double)rep, error);
+        }
+    }
+    taguchi_main_effect_t **effects = NULL;
+    size_t count = 0;
+    alloc_begin();
+    if (taguchi_calculate_main_effects_ctx(ctx, results, &effects, &count, error) != 0) {
+        printf("  FAIL: effects: %s\n", error);
+        exit(1);
+    }
+    taguchi_free_effects(effects, count);
+    AllocCount c = alloc_end();
+    taguchi_free_result_set(results);
+    taguchi_free_definition(def);
+    return c;
+}
+
+int main(void) {
+    char error[TAGUCHI_ERROR_SIZE];
+    printf("=== Allocation Budget Tests ===\n");
+
+    /* One worker: chunks run inline, so counts do not depend on scheduling */
+    taguchi_context_options_t opts;
+    taguchi_context_options_init(&opts);
+    opts.max_workers = 1;
+    taguchi_context_t *ctx = taguchi_context_create(&opts, error);
+    if (!ctx) {
+        printf("  FAIL: context: %s\n", error);
+        return 1;
+    }
+    /* Warm up lazily initialised state (array catalog, default context) */
+    generate_cost(ctx, "L27");
+    effects_cost(ctx, 1);
+
+    /* --- parse --- */
+    alloc_begin();
+    taguchi_experiment_def_t *def = taguchi_parse_definition(def_text("L27"), error);
+    AllocCount parse = alloc_end();
+    alloc_begin();
+    taguchi_free_definition(def);
+    AllocCount parse_free = alloc_end();
+    parse.frees += parse_free.frees;
+    /* The definition (fixed-size factor table, typed level values included)
+     * and one copy of the text */
+    check_budget("parse: allocations", parse.calls, 2, "calls");
+    check_budget("parse: bytes", parse.bytes, 1019000, "bytes");
+    check_balanced("parse", parse);
+
+    /* --- generate --- */
+    GenerateCost small = generate_cost(ctx, "L27");
+    GenerateCost large = generate_cost(ctx, "L81");
+    size_t extra_runs = large.runs - small.runs;
+    size_t per_run_calls = (large.generate.calls - small.generate.calls) / extra_runs;
+    size_t per_run_bytes = (large.generate.bytes - small.generate.bytes) / extra_runs;
+    check_budget("generate: fixed allocations", small.generate.calls - per_run_calls * small.runs,
+                 3, "calls");
+    /* One ExperimentRun plus its handle pointer, no copies */
+    check_budget("generate: allocations per run", per_run_calls, 0, "calls");
+    check_budget("generate: bytes per run", per_run_bytes, 52000, "bytes");
+    small.generate.frees += small.free_runs.frees;
+    large.generate.frees += large.free_runs.frees;
+    check_balanced("generate L27", small.generate);
+    check_balanced("generate L81", large.generate);
+
+    /* --- effects --- */
+    AllocCount once = effects_cost(ctx, 1);
+    AllocCount ten = effects_cost(ctx, 10);
+    check_budget("effects: allocations", once.calls, 56, "calls");
+    check_budget("effects: extra allocations for 10x results", ten.calls - once.calls, 0, "calls");
+    check_balanced("effects", ten);
+
+    /* --- serialization --- */
+    def = taguchi_parse_definition(def_text("L81"), error);
+    taguchi_experiment_run_t **runs = NULL;
+    size_t run_count = 0;
+    taguchi_generate_runs_ctx(ctx, def, &runs, &run_count, error);
+    alloc_begin();
+    char *json = taguchi_runs_to_json((const taguchi_experiment_run_t **)runs, run_count);
+    taguchi_free_string(json);
+    AllocCount runs_json = alloc_end();
+    /* Handle pointers, the output buffer and its final trim; no per-cell escaping copies */
+    check_budget("serialize runs: allocations", runs_json.calls, 3, "calls");
+    check_balanced("serialize runs", runs_json);
+    taguchi_free_runs(runs, run_count);
+    taguchi_free_definition(def);
+
+    printf("\nAllocation budget tests: %s\n", failures == 0 ? "all within budget" : "FAILED");
+    taguchi_context_free(ctx);
+    return failures == 0 ? 0 : 1;
+}
@@ -3,6 +3,7 @@
 #include "src/lib/parser.h"
 #include "src/lib/generator.h"
 #include "src/lib/arrays.h"
+#include "include/taguchi.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -85,6 +86,36 @@ TEST(analyzer_result_set_grows) {
     free_result_set(rs);
 }
 
+/* Test: public accessors return results in the order added */
+TEST(analyzer_result_accessors) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(
+        "factors:\n  A: a1, a2, a3\n  B: b1, b2, b3\narray: L9\n", error);
+    ASSERT_NOT_NULL(def);
+    taguchi_result_set_t *results = taguchi_create_result_set(def, "latency");
+    ASSERT_NOT_NULL(results);
+    ASSERT_STR_EQ(taguchi_result_metric(results), "latency");
+    ASSERT_EQ(taguchi_result_count(results), (size_t)0);
+
+    taguchi_add_result(results, 3, 30.0, error);
+    taguchi_add_result(results, 1, 10.0, error);
+    taguchi_add_result(results, 3, 31.0, error);
+    ASSERT_EQ(taguchi_result_count(results), (size_t)3);
+
+    size_t run_id = 0;
+    double response = 0.0;
+    ASSERT_EQ(taguchi_result_get(results, 2, &run_id, &response), 0);
+    ASSERT_EQ(run_id, (size_t)3);
+    ASSERT_DOUBLE_EQ(response, 31.0, 1e-12);
+    ASSERT_EQ(taguchi_result_get(results, 1, &run_id, NULL), 0);
+    ASSERT_EQ(run_id, (size_t)1);
+    ASSERT_EQ(taguchi_result_get(results, 3, &run_id, &response), -1);
+    ASSERT_EQ(taguchi_result_count(NULL), (size_t)0);
+
+    taguchi_free_result_set(results);
+    taguchi_free_definition(def);
+}
+
 /* Test: calculate main effects for a simple L9 experiment */
 TEST(analyzer_main_effects_l9) {
     ExperimentDef def;
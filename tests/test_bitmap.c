@@ -0,0 +1,183 @@
+#include "test_framework.h"
+#include "include/taguchi.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* 81 runs: bitsets span two words */
+static const char *bitmap_l81_def =
+    "factors:\n"
+    "  compression: none, lz4, zstd\n"
+    "  threads: 8, 16, 64\n"
+    "  cache: 1, 2, 1\n"
+    "  mode: a, b, c\n"
+    "array: L81\n";
+
+static double bitmap_response(const taguchi_experiment_run_t *run) {
+    /* compression and threads interact: zstd only pays off with 64 threads */
+    size_t c = taguchi_run_get_level_index(run, 0);
+    size_t t = taguchi_run_get_level_index(run, 1);
+    size_t m = taguchi_run_get_level_index(run, 3);
+    double y = 100.0 + 5.0 * (double)t + (double)m;
+    if (c == 2 && t == 2) y += 30.0;
+    return y;
+}
+
+static bool bit_set(const uint64_t *bits, size_t run_id) {
+    return (bits[(run_id - 1) / 64] >> ((run_id - 1) % 64)) & 1;
+}
+
+TEST(run_index_matches_generated_runs) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(bitmap_l81_def, error);
+    ASSERT_NOT_NULL(def);
+    taguchi_run_index_t *index = taguchi_run_index_create(def, error);
+    ASSERT_NOT_NULL(index);
+    taguchi_experiment_run_t **runs = NULL;
+    size_t count = 0;
+    ASSERT_EQ(taguchi_generate_runs(def, &runs, &count, error), 0);
+
+    ASSERT_EQ(taguchi_run_index_run_count(index), count);
+    ASSERT_EQ(taguchi_run_index_words(index), 2u);
+    for (size_t f = 0; f < 4; f++) {
+        size_t total = 0;
+        for (size_t lv = 0; lv < 3; lv++) {
+            const uint64_t *bits = taguchi_run_index_level(index, f, lv);
+            ASSERT_NOT_NULL(bits);
+            total += taguchi_bitset_count(bits, 2);
+            for (size_t r = 0; r < count; r++) {
+                bool uses = taguchi_run_get_level_index(runs[r], f) == lv;
+                ASSERT_EQ(bit_set(bits, taguchi_run_get_id(runs[r])), uses);
+            }
+        }
+        ASSERT_EQ(total, count);
+    }
+    ASSERT_NULL(taguchi_run_index_level(index, 4, 0));
+    ASSERT_NULL(taguchi_run_index_level(index, 0, 3));
+
+    taguchi_free_runs(runs, count);
+    taguchi_run_index_free(index);
+    taguchi_free_definition(def);
+}
+
+TEST(run_index_select_combines_queries) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(bitmap_l81_def, error);
+    taguchi_run_index_t *index = taguchi_run_index_create(def, error);
+    ASSERT_NOT_NULL(index);
+    taguchi_experiment_run_t **runs = NULL;
+    size_t count = 0;
+    ASSERT_EQ(taguchi_generate_runs(def, &runs, &count, error), 0);
+
+    uint64_t zstd[2], fast[2], either[2], cache1[2];
+    ASSERT_EQ(taguchi_run_index_select(index, "compression", "zstd", zstd, error), 0);
+    ASSERT_EQ(taguchi_run_index_select(index, "threads", "64", fast, error), 0);
+    /* "1" names two levels of cache */
+    ASSERT_EQ(taguchi_run_index_select(index, "cache", "1", cache1, error), 0);
+    ASSERT_EQ(taguchi_bitset_count(cache1, 2), 54u);
+
+    memcpy(either, zstd, sizeof(either));
+    taguchi_bitset_or(either, fast, 2);
+    taguchi_bitset_and(zstd, fast, 2);
+
+    size_t both = 0, any = 0;
+    for (size_t r = 0; r < count; r++) {
+        bool z = strcmp(taguchi_run_get_value(runs[r], "compression"), "zstd") == 0;
+        bool t = strcmp(taguchi_run_get_value(runs[r], "threads"), "64") == 0;
+        size_t id = taguchi_run_get_id(runs[r]);
+        ASSERT_EQ(bit_set(zstd, id), z && t);
+        ASSERT_EQ(bit_set(either, id), z || t);
+        both += z && t;
+        any += z || t;
+    }
+    ASSERT_EQ(taguchi_bitset_count(zstd, 2), both);
+    ASSERT_EQ(taguchi_bitset_count(either, 2), any);
+
+    size_t ids[81];
+    ASSERT_EQ(taguchi_bitset_runs(zstd, 2, ids, 81), both);
+    for (size_t i = 0; i < both; i++) {
+        ASSERT_TRUE(bit_set(zstd, ids[i]));
+        if (i > 0) ASSERT_LT(ids[i - 1], ids[i]);
+    }
+    /* Truncated listing still reports the total */
+    ASSERT_EQ(taguchi_bitset_runs(zstd, 2, ids, 2), both);
+
+    ASSERT_EQ(taguchi_run_index_select(index, "compression", "gzip", zstd, error), -1);
+    ASSERT_NOT_NULL(strstr(error, "gzip"));
+    ASSERT_EQ(taguchi_run_index_select(index, "codec", "zstd", zstd, error), -1);
+
+    taguchi_free_runs(runs, count);
+    taguchi_run_index_free(index);
+    taguchi_free_definition(def);
+}
+
+TEST(conditional_effects_match_filtered_results) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(bitmap_l81_def, error);
+    taguchi_run_index_t *index = taguchi_run_index_create(def, error);
+    taguchi_experiment_run_t **runs = NULL;
+    size_t count = 0;
+    ASSERT_EQ(taguchi_generate_runs(def, &runs, &count, error), 0);
+
+    /* Replicate run 1 so run means, not results, must be averaged */
+    taguchi_result_set_t *results = taguchi_create_result_set(def, "y");
+    for (size_t r = 0; r < count; r++) {
+        taguchi_add_result(results, taguchi_run_get_id(runs[r]), bitmap_response(runs[r]), error);
+    }
+    taguchi_add_result(results, 1, bitmap_response(runs[0]) + 9.0, error);
+
+    /* All runs: the ordinary main effects */
+    uint64_t all[2] = { ~UINT64_C(0), ~UINT64_C(0) };
+    taguchi_main_effect_t **cond = NULL, **plain = NULL;
+    size_t cond_count = 0, plain_count = 0;
+    ASSERT_EQ(taguchi_calculate_conditional_effects(results, index, all, &cond, &cond_count,
+                                                    error), 0);
+    ASSERT_EQ(taguchi_calculate_main_effects(results, &plain, &plain_count, error), 0);
+    ASSERT_EQ(cond_count, plain_count);
+    for (size_t f = 0; f < cond_count; f++) {
+        size_t n = 0;
+        const double *a = taguchi_effect_get_level_means(cond[f], &n);
+        const double *b = taguchi_effect_get_level_means(plain[f], NULL);
+        for (size_t lv = 0; lv < n; lv++) ASSERT_DOUBLE_EQ(a[lv], b[lv], 1e-9);
+    }
+    taguchi_free_effects(cond, cond_count);
+    taguchi_free_effects(plain, plain_count);
+
+    /* Given compression=zstd, threads=64 carries the interaction */
+    uint64_t zstd[2];
+    ASSERT_EQ(taguchi_run_index_select(index, "compression", "zstd", zstd, error), 0);
+    ASSERT_EQ(taguchi_calculate_conditional_effects(results, index, zstd, &cond, &cond_count,
+                                                    error), 0);
+    size_t n = 0;
+    const double *comp = taguchi_effect_get_level_means(cond[0], &n);
+    ASSERT_TRUE(isnan(comp[0]));
+    ASSERT_TRUE(isnan(comp[1]));
+    ASSERT_FALSE(isnan(comp[2]));
+    ASSERT_DOUBLE_EQ(taguchi_effect_get_range(cond[0]), 0.0, 1e-12);
+    const double *threads = taguchi_effect_get_level_means(cond[1], &n);
+    ASSERT_DOUBLE_EQ(threads[2] - threads[1], 35.0, 1e-9);
+    ASSERT_DOUBLE_EQ(threads[1] - threads[0], 5.0, 1e-9);
+
+    char rec[256];
+    ASSERT_EQ(taguchi_recommend_optimal((const taguchi_main_effect_t **)cond, cond_count, true,
+                                        rec, sizeof(rec)), 0);
+    ASSERT_NOT_NULL(strstr(rec, "compression=level_3"));
+    char *json = taguchi_effects_to_json((const taguchi_main_effect_t **)cond, cond_count);
+    ASSERT_NOT_NULL(strstr(json, "[null, null, "));
+    taguchi_free_string(json);
+    taguchi_free_effects(cond, cond_count);
+
+    /* A result set of another definition is refused */
+    taguchi_experiment_def_t *other = taguchi_parse_definition(bitmap_l81_def, error);
+    taguchi_result_set_t *foreign = taguchi_create_result_set(other, "y");
+    ASSERT_EQ(taguchi_calculate_conditional_effects(foreign, index, all, &cond, &cond_count,
+                                                    error), -1);
+    taguchi_free_result_set(foreign);
+    taguchi_free_definition(other);
+
+    taguchi_free_result_set(results);
+    taguchi_free_runs(runs, count);
+    taguchi_run_index_free(index);
+    taguchi_free_definition(def);
+}
@@ -0,0 +1,126 @@
+#include "test_framework.h"
+#include "src/lib/changeover.h"
+#include "src/lib/generator.h"
+#include "src/lib/parser.h"
+#include "include/taguchi.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *changeover_l9_def =
+    "factors:\n"
+    "  flags: O0, O2, O3\n"
+    "  alloc: glibc, jemalloc, tcmalloc\n"
+    "  threads: 1, 2, 4\n"
+    "changeover:\n"
+    "  flags: 100\n"
+    "  alloc: 10\n"
+    "array: L9\n";
+
+static void assert_permutation(const size_t *order, size_t count) {
+    bool *seen = calloc(count, sizeof(bool));
+    ASSERT_NOT_NULL(seen);
+    for (size_t i = 0; i < count; i++) {
+        ASSERT_LT(order[i], count);
+        ASSERT_FALSE(seen[order[i]]);
+        seen[order[i]] = true;
+    }
+    free(seen);
+}
+
+TEST(parse_changeover_costs) {
+    ExperimentDef def;
+    char error[256];
+    ASSERT_EQ(parse_experiment_def_from_string(changeover_l9_def, &def, error), 0);
+    ASSERT_EQ(def.factor_count, 3);
+    ASSERT_DOUBLE_EQ(def.factors[0].changeover_cost, 100.0, 1e-12);
+    ASSERT_DOUBLE_EQ(def.factors[1].changeover_cost, 10.0, 1e-12);
+    ASSERT_DOUBLE_EQ(def.factors[2].changeover_cost, 0.0, 1e-12);
+
+    /* The section may come before the factors it names */
+    ASSERT_EQ(parse_experiment_def_from_string(
+        "changeover:\n  b: 2.5\nfactors:\n  a: 1, 2\n  b: x, y\narray: L4\n", &def, error), 0);
+    ASSERT_DOUBLE_EQ(def.factors[1].changeover_cost, 2.5, 1e-12);
+}
+
+TEST(parse_changeover_rejects_bad_entries) {
+    ExperimentDef def;
+    char error[256];
+    ASSERT_EQ(parse_experiment_def_from_string(
+        "factors:\n  a: 1, 2\nchangeover:\n  a: -1\narray: L4\n", &def, error), -1);
+    ASSERT_NOT_NULL(strstr(error, "Invalid changeover cost"));
+    ASSERT_EQ(parse_experiment_def_from_string(
+        "factors:\n  a: 1, 2\nchangeover:\n  a: cheap\narray: L4\n", &def, error), -1);
+    ASSERT_NOT_NULL(strstr(error, "Invalid changeover cost"));
+    ASSERT_EQ(parse_experiment_def_from_string(
+        "factors:\n  a: 1, 2\nchangeover:\n  b: 5\narray: L4\n", &def, error), -1);
+    ASSERT_NOT_NULL(strstr(error, "unknown factor 'b'"));
+}
+
+TEST(changeover_order_beats_array_order) {
+    ExperimentDef def;
+    char error[256];
+    ASSERT_EQ(parse_experiment_def_from_string(changeover_l9_def, &def, error), 0);
+    CompiledDesign design;
+    ASSERT_EQ(acquire_design(NULL, &def, &design, error), 0);
+
+    size_t order[9];
+    double cost = changeover_order(&def, &design, order);
+    assert_permutation(order, design.rows);
+    ASSERT_DOUBLE_EQ(cost, changeover_path_cost(&def, &design, order, design.rows), 1e-9);
+
+    /* Optimum: flags changes twice, alloc twice within each flags block */
+    ASSERT_DOUBLE_EQ(cost, 260.0, 1e-9);
+    size_t flag_changes = 0;
+    for (size_t i = 1; i < design.rows; i++) {
+        if (design.levels[order[i] * design.factor_count] !=
+            design.levels[order[i - 1] * design.factor_count]) {
+            flag_changes++;
+        }
+    }
+    ASSERT_EQ(flag_changes, 2);
+    free_compiled_design(&design);
+}
+
+TEST(changeover_order_keeps_array_order_without_costs) {
+    ExperimentDef def;
+    char error[256];
+    ASSERT_EQ(parse_experiment_def_from_string(
+        "factors:\n  a: 1, 2, 3\n  b: x, y, z\narray: L9\n", &def, error), 0);
+    CompiledDesign design;
+    ASSERT_EQ(acquire_design(NULL, &def, &design, error), 0);
+
+    size_t order[9];
+    ASSERT_DOUBLE_EQ(changeover_order(&def, &design, order), 0.0, 1e-12);
+    for (size_t i = 0; i < design.rows; i++) {
+        ASSERT_EQ(order[i], i);
+    }
+    free_compiled_design(&design);
+}
+
+TEST(plan_run_order_large_design) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_create_definition("L243");
+    ASSERT_NOT_NULL(def);
+    const char *levels[] = { "1", "2", "3" };
+    char name[16];
+    for (int f = 0; f < 6; f++) {
+        snprintf(name, sizeof(name), "f%d", f);
+        ASSERT_EQ(taguchi_add_factor(def, name, levels, 3, error), 0);
+    }
+    ASSERT_EQ(taguchi_def_set_changeover_cost(def, 0, 50.0, error), 0);
+    ASSERT_EQ(taguchi_def_set_changeover_cost(def, 3, 5.0, error), 0);
+    ASSERT_EQ(taguchi_def_set_changeover_cost(def, 1, -1.0, error), -1);
+    ASSERT_DOUBLE_EQ(taguchi_def_get_changeover_cost(def, 0), 50.0, 1e-12);
+    ASSERT_DOUBLE_EQ(taguchi_def_get_changeover_cost(def, 1), 0.0, 1e-12);
+
+    size_t order[243];
+    double cost, array_cost;
+    ASSERT_EQ(taguchi_plan_run_order(def, order, 10, &cost, &array_cost, error), -1);
+    ASSERT_EQ(taguchi_plan_run_order(def, order, 243, &cost, &array_cost, error), 0);
+    assert_permutation(order, 243);
+    ASSERT_LT(cost, array_cost);
+    /* f0 changes level at most twice plus whatever f3 forces */
+    ASSERT_TRUE(cost <= 2 * 50.0 + 242 * 5.0);
+    taguchi_free_definition(def);
+}
@@ -0,0 +1,137 @@
+#!/bin/sh
+# tests/test_cli_batch.sh
+#
+# CLI integration tests for the `batch` command (many definitions processed
+# on a thread pool with per-file output capture).
+#
+# Run via: make test   (or directly: bash tests/test_cli_batch.sh)
+
+TAGUCHI="${TAGUCHI:-./build/taguchi}"
+
+# ---- setup ------------------------------------------------------------------
+TMPDIR_TEST="$(mktemp -d)"
+trap 'rm -rf "$TMPDIR_TEST"' EXIT
+
+PASS=0
+FAIL=0
+
+pass() { printf "  PASS: %s\n" "$1"; PASS=$((PASS + 1)); }
+fail() { printf "  FAIL: %s\n" "$1"; FAIL=$((FAIL + 1)); }
+
+# command must exit 0 AND output must match grep pattern
+check_output() {
+    local name="$1" pattern="$2"; shift 2
+    local out rc
+    out=$("$@" 2>&1); rc=$?
+    if [ "$rc" -ne 0 ]; then
+        fail "$name  (command failed: $out)"
+    elif echo "$out" | grep -q "$pattern"; then
+        pass "$name"
+    else
+        fail "$name  (pattern '$pattern' not in: $out)"
+    fi
+}
+
+# command must exit non-0 AND stderr/stdout must match grep pattern
+check_fails_with() {
+    local name="$1" pattern="$2"; shift 2
+    local out rc
+    out=$("$@" 2>&1); rc=$?
+    if [ "$rc" -eq 0 ]; then
+        fail "$name  (expected failure but command succeeded)"
+    elif echo "$out" | grep -q "$pattern"; then
+        pass "$name"
+    else
+        fail "$name  (expected pattern '$pattern' not in: $out)"
+    fi
+}
+
+# file must contain grep pattern
+check_file() {
+    local name="$1" pattern="$2" file="$3"
+    if [ -f "$file" ] && grep -q "$pattern" "$file"; then
+        pass "$name"
+    else
+        fail "$name  (pattern '$pattern' not in $file)"
+    fi
+}
+
+# ---- shared fixtures --------------------------------------------------------
+
+for n in 1 2 3 4 5 6; do
+    cat > "$TMPDIR_TEST/exp$n.tgu" << EOF2
+factors:
+  threads: 1, 2, 4
+  cache: small, medium, large
+array: L9
+EOF2
+done
+cat > "$TMPDIR_TEST/bad.tgu" << 'EOF2'
+array: L9
+EOF2
+
+MANIFEST="$TMPDIR_TEST/manifest.txt"
+cat > "$MANIFEST" << EOF2
+# comment lines and blanks are ignored
+$TMPDIR_TEST/exp1.tgu
+
+$TMPDIR_TEST/exp2.tgu
+EOF2
+
+# ---- tests ------------------------------------------------------------------
+
+printf "Batch Command Tests:\n"
+
+check_output "batch validate: all files valid" \
+    "Batch validate: 6 file(s), 6 succeeded, 0 failed" \
+    "$TAGUCHI" batch validate -j 4 "$TMPDIR_TEST"/exp*.tgu
+
+# Output must match the single-file command, in input order
+SINGLE=$("$TAGUCHI" generate "$TMPDIR_TEST/exp1.tgu" 2>&1)
+BATCH=$("$TAGUCHI" batch generate -j 4 "$TMPDIR_TEST"/exp*.tgu 2>&1)
+if echo "$BATCH" | grep -F -q "$(echo "$SINGLE" | tail -1)"; then
+    pass "batch generate: per-file output matches generate"
+else
+    fail "batch generate: output differs from single-file generate"
+fi
+ORDER=$(echo "$BATCH" | grep '^==> ' | sed 's/.*exp\([0-9]\).*/\1/' | tr -d '\n')
+if [ "$ORDER" = "123456" ]; then
+    pass "batch generate: results reported in input order"
+else
+    fail "batch generate: unexpected order '$ORDER'"
+fi
+
+check_output "batch: manifest files are read" \
+    "2 file(s), 2 succeeded" \
+    "$TAGUCHI" batch suggest-array --manifest "$MANIFEST"
+
+check_fails_with "batch: failing file reported in summary" \
+    "FAILED: .*bad.tgu" \
+    "$TAGUCHI" batch validate "$TMPDIR_TEST/exp1.tgu" "$TMPDIR_TEST/bad.tgu"
+
+OUTDIR="$TMPDIR_TEST/out"
+mkdir -p "$OUTDIR"
+"$TAGUCHI" batch generate --output-dir "$OUTDIR" "$TMPDIR_TEST"/exp1.tgu "$TMPDIR_TEST"/exp2.tgu >/dev/null 2>&1
+check_file "batch --output-dir: one file per input" \
+    "Run 9" "$OUTDIR/exp2.generate.out"
+
+mkdir -p "$TMPDIR_TEST/sub"
+cp "$TMPDIR_TEST/exp1.tgu" "$TMPDIR_TEST/sub/exp1.tgu"
+check_fails_with "batch --output-dir: colliding names rejected" \
+    "same output file" \
+    "$TAGUCHI" batch generate --output-dir "$OUTDIR" "$TMPDIR_TEST/exp1.tgu" "$TMPDIR_TEST/sub/exp1.tgu"
+
+check_fails_with "failure: unsupported subcommand rejected" \
+    "cannot be batched" \
+    "$TAGUCHI" batch run "$TMPDIR_TEST/exp1.tgu"
+
+check_fails_with "failure: invalid job count rejected" \
+    "invalid job count" \
+    "$TAGUCHI" batch validate -j 0 "$TMPDIR_TEST/exp1.tgu"
+
+# --- summary -----------------------------------------------------------------
+
+printf "\nBatch command tests: %d passed, %d failed\n" "$PASS" "$FAIL"
+
+[ "$FAIL" -eq 0 ] || exit 1
+exit 0
@@ -0,0 +1,188 @@
+#!/bin/sh
+# tests/test_cli_compare.sh
+#
+# CLI integration tests for the `compare` command (A/B diff of the main
+# effects of two campaigns on one design).
+#
+# Run via: make test   (or directly: bash tests/test_cli_compare.sh)
+
+TAGUCHI="${TAGUCHI:-./build/taguchi}"
+
+# ---- setup ------------------------------------------------------------------
+TMPDIR_TEST="$(mktemp -d)"
+trap 'rm -rf "$TMPDIR_TEST"' EXIT
+
+PASS=0
+FAIL=0
+
+pass() { printf "  PASS: %s\n" "$1"; PASS=$((PASS + 1)); }
+fail() { printf "  FAIL: %s\n" "$1"; FAIL=$((FAIL + 1)); }
+
+# command must exit 0 AND output must match grep pattern
+check_output() {
+    local name="$1" pattern="$2"; shift 2
+    local out rc
+    out=$("$@" 2>&1); rc=$?
+    if [ "$rc" -ne 0 ]; then
+        fail "$name  (command failed: $out)"
+    elif echo "$out" | grep -q "$pattern"; then
+        pass "$name"
+    else
+        fail "$name  (pattern '$pattern' not in: $out)"
+    fi
+}
+
+# command must exit 0 AND output must NOT match grep pattern
+check_output_lacks() {
+    local name="$1" pattern="$2"; shift 2
+    local out rc
+    out=$("$@" 2>&1); rc=$?
+    if [ "$rc" -ne 0 ]; then
+        fail "$name  (command failed: $out)"
+    elif echo "$out" | grep -q "$pattern"; then
+        fail "$name  (unexpected pattern '$pattern' in: $out)"
+    else
+        pass "$name"
+    fi
+}
+
+# command must exit non-0 AND stderr/stdout must match grep pattern
+check_fails_with() {
+    local name="$1" pattern="$2"; shift 2
+    local out rc
+    out=$("$@" 2>&1); rc=$?
+    if [ "$rc" -eq 0 ]; then
+        fail "$name  (expected failure but command succeeded)"
+    elif echo "$out" | grep -q "$pattern"; then
+        pass "$name"
+    else
+        fail "$name  (expected pattern '$pattern' not in: $out)"
+    fi
+}
+
+# ---- shared fixtures --------------------------------------------------------
+
+TGU="$TMPDIR_TEST/exp.tgu"
+cat > "$TGU" << 'EOF2'
+factors:
+  cache: 64M, 128M, 256M
+  threads: 2, 4, 8
+array: L9
+EOF2
+
+# Release 1: cache adds 3 per level, threads 1 per level
+cat > "$TMPDIR_TEST/a.csv" << 'EOF2'
+run_id,throughput,latency
+1,10,5
+2,11,5
+3,12,5
+4,13,4
+5,14,4
+6,15,4
+7,16,3
+8,17,3
+9,18,3
+EOF2
+
+# Release 2: the cache effect grew; run 1 was replicated
+cat > "$TMPDIR_TEST/b.csv" << 'EOF2'
+run_id,throughput,latency
+1,10,5
+2,11,5
+3,12,5
+4,14,4
+5,15,4
+6,16,4
+7,20,2
+8,21,2
+9,22,2
+1,11,5
+EOF2
+
+# Release 3: every run 2 faster, effects unchanged
+awk -F, 'NR == 1 { print; next } { print $1 "," $2 + 2 "," $3 }' "$TMPDIR_TEST/a.csv" \
+    > "$TMPDIR_TEST/shifted.csv"
+
+# --- F test ------------------------------------------------------------------
+
+check_output "F: shift over the aligned runs" \
+    "Shift (B - A): +1.722 (se 0.329)" \
+    "$TAGUCHI" compare "$TGU" "$TMPDIR_TEST/a.csv" "$TMPDIR_TEST/b.csv" --metric throughput
+
+check_output "F: replicate error estimate" \
+    "Error estimate: replicates, sd 0.986 on 1 df" \
+    "$TAGUCHI" compare "$TGU" "$TMPDIR_TEST/a.csv" "$TMPDIR_TEST/b.csv" --metric throughput
+
+check_output "F: cache ranked first with its level deltas" \
+    "^1    cache .*6.000    9.833" \
+    "$TAGUCHI" compare "$TGU" "$TMPDIR_TEST/a.csv" "$TMPDIR_TEST/b.csv" --metric throughput
+
+check_output "F: per-level delta and standard error" \
+    "L1=-1.556 (0.458), L2=-0.722 (0.468), L3=+2.278 (0.468)" \
+    "$TAGUCHI" compare "$TGU" "$TMPDIR_TEST/a.csv" "$TMPDIR_TEST/b.csv" --metric throughput
+
+check_output "F: uniform shift changes no factor" \
+    "^2    threads .*1.0000   1.0000  no" \
+    "$TAGUCHI" compare "$TGU" "$TMPDIR_TEST/a.csv" "$TMPDIR_TEST/shifted.csv" --metric throughput
+
+check_output "F: residual error without replicates" \
+    "Error estimate: main-effects residual" \
+    "$TAGUCHI" compare "$TGU" "$TMPDIR_TEST/a.csv" "$TMPDIR_TEST/shifted.csv" --metric throughput
+
+# --- permutation test --------------------------------------------------------
+
+check_output "permutation: cache changed significantly" \
+    "^1    cache .*0.0010   0.0020  yes" \
+    "$TAGUCHI" compare "$TGU" "$TMPDIR_TEST/a.csv" "$TMPDIR_TEST/b.csv" --metric throughput \
+    --permutations 999 --seed 7
+
+P4=$("$TAGUCHI" --max-workers 4 compare "$TGU" "$TMPDIR_TEST/a.csv" "$TMPDIR_TEST/b.csv" \
+     --permutations 500 --seed 3 2>&1)
+P1=$("$TAGUCHI" --max-workers 1 compare "$TGU" "$TMPDIR_TEST/a.csv" "$TMPDIR_TEST/b.csv" \
+     --permutations 500 --seed 3 2>&1)
+if [ "$P1" = "$P4" ]; then
+    pass "permutation: p-values independent of worker count"
+else
+    fail "permutation: p-values independent of worker count"
+fi
+
+# --- exit status and inputs --------------------------------------------------
+
+"$TAGUCHI" compare "$TGU" "$TMPDIR_TEST/a.csv" "$TMPDIR_TEST/b.csv" --metric throughput \
+    --permutations 999 --fail-on-change > /dev/null 2>&1
+[ $? -eq 2 ] && pass "exit: --fail-on-change returns 2 on a change" \
+             || fail "exit: --fail-on-change returns 2 on a change"
+
+check_output "exit: --fail-on-change is 0 without a change" \
+    "Comparing throughput" \
+    "$TAGUCHI" compare "$TGU" "$TMPDIR_TEST/a.csv" "$TMPDIR_TEST/shifted.csv" \
+    --metric throughput --fail-on-change
+
+check_output "input: campaign B from stdin" \
+    "Comparing latency: - against" \
+    sh -c "\"$TAGUCHI\" compare \"$TGU\" \"$TMPDIR_TEST/a.csv\" - --metric latency < \"$TMPDIR_TEST/b.csv\""
+
+# --- expected failure cases --------------------------------------------------
+
+check_fails_with "failure: missing campaign" \
+    "requires <file.tgu> <a.csv> <b.csv>" \
+    "$TAGUCHI" compare "$TGU" "$TMPDIR_TEST/a.csv"
+
+check_fails_with "failure: two stdin inputs" \
+    "only one compare input can be read from stdin" \
+    "$TAGUCHI" compare "$TGU" - -
+
+check_fails_with "failure: alpha out of range" \
+    "Alpha must be between 0 and 1" \
+    "$TAGUCHI" compare "$TGU" "$TMPDIR_TEST/a.csv" "$TMPDIR_TEST/b.csv" --alpha 2
+
+check_fails_with "failure: invalid permutation count" \
+    "invalid value '0' for --permutations" \
+    "$TAGUCHI" compare "$TGU" "$TMPDIR_TEST/a.csv" "$TMPDIR_TEST/b.csv" --permutations 0
+
+# --- summary -----------------------------------------------------------------
+
+printf "\nCompare command tests: %d passed, %d failed\n" "$PASS" "$FAIL"
+
+[ "$FAIL" -eq 0 ] || exit 1
+exit 0
@@ -0,0 +1,219 @@
+#!/bin/sh
+# tests/test_cli_history.sh
+#
+# CLI integration tests for the `history` command (append-only campaign
+# store with list / trend / export queries).
+#
+# Run via: make test   (or directly: bash tests/test_cli_history.sh)
+
+TAGUCHI="${TAGUCHI:-./build/taguchi}"
+
+# ---- setup ------------------------------------------------------------------
+TMPDIR_TEST="$(mktemp -d)"
+trap 'rm -rf "$TMPDIR_TEST"' EXIT
+
+PASS=0
+FAIL=0
+
+pass() { printf "  PASS: %s\n" "$1"; PASS=$((PASS + 1)); }
+fail() { printf "  FAIL: %s\n" "$1"; FAIL=$((FAIL + 1)); }
+
+# command must exit 0 AND output must match grep pattern
+check_output() {
+    local name="$1" pattern="$2"; shift 2
+    local out rc
+    out=$("$@" 2>&1); rc=$?
+    if [ "$rc" -ne 0 ]; then
+        fail "$name  (command failed: $out)"
+    elif echo "$out" | grep -q "$pattern"; then
+        pass "$name"
+    else
+        fail "$name  (pattern '$pattern' not in: $out)"
+    fi
+}
+
+# command must exit 0 AND output must NOT match grep pattern
+check_output_lacks() {
+    local name="$1" pattern="$2"; shift 2
+    local out rc
+    out=$("$@" 2>&1); rc=$?
+    if [ "$rc" -ne 0 ]; then
+        fail "$name  (command failed: $out)"
+    elif echo "$out" | grep -q "$pattern"; then
+        fail "$name  (unexpected pattern '$pattern' in: $out)"
+    else
+        pass "$name"
+    fi
+}
+
+# command must exit non-0 AND stderr/stdout must match grep pattern
+check_fails_with() {
+    local name="$1" pattern="$2"; shift 2
+    local out rc
+    out=$("$@" 2>&1); rc=$?
+    if [ "$rc" -eq 0 ]; then
+        fail "$name  (expected failure but command succeeded)"
+    elif echo "$out" | grep -q "$pattern"; then
+        pass "$name"
+    else
+        fail "$name  (expected pattern '$pattern' not in: $out)"
+    fi
+}
+
+# ---- shared fixtures --------------------------------------------------------
+
+STORE="$TMPDIR_TEST/store"
+TGU="$TMPDIR_TEST/exp.tgu"
+cat > "$TGU" << 'EOF2'
+factors:
+  cache: 64M, 128M, 256M
+  threads: 2, 4, 8
+array: L9
+EOF2
+
+# Release 1: cache adds 3 per level, threads 1 per level
+cat > "$TMPDIR_TEST/r1.csv" << 'EOF2'
+run_id,throughput,latency
+1,10,5
+2,11,5
+3,12,5
+4,13,4
+5,14,4
+6,15,4
+7,16,3
+8,17,3
+9,18,3
+EOF2
+
+# Release 2: the cache effect grew; run 1 was replicated
+cat > "$TMPDIR_TEST/r2.csv" << 'EOF2'
+run_id,throughput,latency
+1,10,5
+2,11,5
+3,12,5
+4,14,4
+5,15,4
+6,16,4
+7,20,2
+8,21,2
+9,22,2
+1,11,5
+EOF2
+
+# --- record ------------------------------------------------------------------
+
+check_output "record: first campaign" \
+    "Recorded campaign #1: bench v1.0 2026-01-05 (9 runs, 9 results of throughput)" \
+    "$TAGUCHI" history record "$TGU" "$TMPDIR_TEST/r1.csv" --name bench --tag v1.0 \
+    --date 2026-01-05 --metric throughput --store "$STORE"
+
+check_output "record: second campaign counts replicates" \
+    "Recorded campaign #2: bench v1.1 2026-02-05 (9 runs, 10 results" \
+    "$TAGUCHI" history record "$TGU" "$TMPDIR_TEST/r2.csv" --name bench --tag v1.1 \
+    --date 2026-02-05 --metric throughput --store "$STORE"
+
+check_output "record: store from TAGUCHI_HISTORY_DIR" \
+    "Recorded campaign #3: latency-study" \
+    env TAGUCHI_HISTORY_DIR="$STORE" "$TAGUCHI" history record "$TGU" "$TMPDIR_TEST/r2.csv" \
+    --name latency-study --date 2026-03-01 --metric latency
+
+# --- list --------------------------------------------------------------------
+
+check_output "list: every campaign" \
+    "3 campaigns" \
+    "$TAGUCHI" history list --store "$STORE"
+
+check_output "list: filter by name" \
+    "2 campaigns" \
+    "$TAGUCHI" history list --name bench --store "$STORE"
+
+check_output "list: filter by tag" \
+    "^2  *2026-02-05  bench  *v1.1" \
+    "$TAGUCHI" history list --tag v1.1 --store "$STORE"
+
+check_output "list: filter by date range" \
+    "1 campaign$" \
+    "$TAGUCHI" history list --since 2026-01-10 --until 2026-02-28 --store "$STORE"
+
+# --- trend -------------------------------------------------------------------
+
+check_output "trend: cache range and change across releases" \
+    "2  *2026-02-05  v1.1  *throughput  *9.833   +3.833   64M=11.167, 128M=15.000, 256M=21.000" \
+    "$TAGUCHI" history trend --name bench --store "$STORE"
+
+check_output "trend: first campaign has no change" \
+    "1  *2026-01-05  v1.0  *throughput  *6.000  *64M=11.000" \
+    "$TAGUCHI" history trend --name bench --store "$STORE"
+
+check_output_lacks "trend: --factor shows only that factor" \
+    "^cache" \
+    "$TAGUCHI" history trend --name bench --factor threads --store "$STORE"
+
+check_output "trend: filtered by tag" \
+    "Effect trend for bench (1 campaign)" \
+    "$TAGUCHI" history trend --name bench --tag v1.0 --store "$STORE"
+
+# --- export ------------------------------------------------------------------
+
+"$TAGUCHI" history export 2 --store "$STORE" > "$TMPDIR_TEST/export.csv" 2>&1
+check_output "export: results round-trip through effects" \
+    "cache  *9.833   L1=11.167, L2=15.000, L3=21.000" \
+    "$TAGUCHI" effects "$TGU" "$TMPDIR_TEST/export.csv" --metric throughput
+
+check_output "export: rows carry factor values" \
+    "^7,256M,2,20$" \
+    cat "$TMPDIR_TEST/export.csv"
+
+printf 'run_id,response\n1,-1.014001\n2,0.1\n3,2\n4,3\n5,4\n6,5\n7,6\n8,7\n9,8\n' \
+    > "$TMPDIR_TEST/decimals.csv"
+"$TAGUCHI" history record "$TGU" "$TMPDIR_TEST/decimals.csv" --name decimals \
+    --store "$TMPDIR_TEST/decimals" > /dev/null 2>&1
+check_output "export: responses keep their recorded digits" \
+    "^1,64M,2,-1.014001$" \
+    "$TAGUCHI" history export 1 --store "$TMPDIR_TEST/decimals"
+
+check_output "export: --definition returns the recorded .tgu" \
+    "threads: 2, 4, 8" \
+    "$TAGUCHI" history export 1 --definition --store "$STORE"
+
+# --- expected failure cases --------------------------------------------------
+
+check_fails_with "failure: record without --name" \
+    "requires <file.tgu> <results.csv> and --name" \
+    "$TAGUCHI" history record "$TGU" "$TMPDIR_TEST/r1.csv" --store "$STORE"
+
+check_fails_with "failure: invalid date" \
+    "expects a date as YYYY-MM-DD" \
+    "$TAGUCHI" history record "$TGU" "$TMPDIR_TEST/r1.csv" --name bench --date 2026-02-30 \
+    --store "$STORE"
+
+check_fails_with "failure: missing store" \
+    "No history recorded in" \
+    "$TAGUCHI" history list --store "$TMPDIR_TEST/nowhere"
+
+check_fails_with "failure: unknown campaign" \
+    "no campaign #9" \
+    "$TAGUCHI" history export 9 --store "$STORE"
+
+check_fails_with "failure: unknown factor" \
+    "has factor 'codec'" \
+    "$TAGUCHI" history trend --name bench --factor codec --store "$STORE"
+
+# Damage the last record's effects block: its checksum no longer matches
+SEGMENT="$STORE/segment-000001.tgh"
+SIZE=$(wc -c < "$SEGMENT")
+printf '\252' | dd of="$SEGMENT" bs=1 seek=$((SIZE - 4)) conv=notrunc 2>/dev/null
+check_fails_with "failure: damaged record is detected" \
+    "Campaign #3: damaged record" \
+    "$TAGUCHI" history trend --name latency-study --store "$STORE"
+
+check_output "damage: other campaigns still readable" \
+    "Effect trend for bench (2 campaigns)" \
+    "$TAGUCHI" history trend --name bench --store "$STORE"
+
+# --- summary -----------------------------------------------------------------
+
+printf "\nHistory command tests: %d passed, %d failed\n" "$PASS" "$FAIL"
+
+[ "$FAIL" -eq 0 ] || exit 1
+exit 0
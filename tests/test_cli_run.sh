@@ -0,0 +1,435 @@
+#!/bin/sh
+# tests/test_cli_run.sh
+#
+# CLI integration tests for the `run` command (parallel runner, progress
+# tracking and Prometheus textfile export).
+#
+# Run via: make test   (or directly: bash tests/test_cli_run.sh)
+
+TAGUCHI="${TAGUCHI:-./build/taguchi}"
+
+# ---- setup ------------------------------------------------------------------
+TMPDIR_TEST="$(mktemp -d)"
+trap 'rm -rf "$TMPDIR_TEST"' EXIT
+
+PASS=0
+FAIL=0
+
+pass() { printf "  PASS: %s\n" "$1"; PASS=$((PASS + 1)); }
+fail() { printf "  FAIL: %s\n" "$1"; FAIL=$((FAIL + 1)); }
+
+# command must exit 0 AND output must match grep pattern
+check_output() {
+    local name="$1" pattern="$2"; shift 2
+    local out rc
+    out=$("$@" 2>&1); rc=$?
+    if [ "$rc" -ne 0 ]; then
+        fail "$name  (command failed: $out)"
+    elif echo "$out" | grep -q "$pattern"; then
+        pass "$name"
+    else
+        fail "$name  (pattern '$pattern' not in: $out)"
+    fi
+}
+
+# command must exit non-0 AND stderr/stdout must match grep pattern
+check_fails_with() {
+    local name="$1" pattern="$2"; shift 2
+    local out rc
+    out=$("$@" 2>&1); rc=$?
+    if [ "$rc" -eq 0 ]; then
+        fail "$name  (expected failure but command succeeded)"
+    elif echo "$out" | grep -q "$pattern"; then
+        pass "$name"
+    else
+        fail "$name  (expected pattern '$pattern' not in: $out)"
+    fi
+}
+
+# file must contain grep pattern
+check_file() {
+    local name="$1" pattern="$2" file="$3"
+    if [ -f "$file" ] && grep -q "$pattern" "$file"; then
+        pass "$name"
+    else
+        fail "$name  (pattern '$pattern' not in $file)"
+    fi
+}
+
+# ---- shared fixtures --------------------------------------------------------
+
+TGU="$TMPDIR_TEST/exp.tgu"
+cat > "$TGU" << 'EOF'
+factors:
+  threads: 1, 2, 4
+  cache: small, medium, large
+array: L9
+EOF
+
+# ---- tests ------------------------------------------------------------------
+
+printf "Run Command Tests:\n"
+
+check_output "run: sequential campaign completes all runs" \
+    "All experiment runs completed" \
+    "$TAGUCHI" run "$TGU" 'true'
+
+check_output "run: factor values exported to child environment" \
+    "threads=4 cache=large" \
+    "$TAGUCHI" run "$TGU" 'echo "threads=$TAGUCHI_threads cache=$TAGUCHI_cache"'
+
+OUT=$("$TAGUCHI" run "$TGU" 'true' -j 4 2>&1)
+N=$(echo "$OUT" | grep -c "completed with exit code 0")
+if [ "$N" -eq 9 ]; then
+    pass "run -j 4: every run reported exactly once"
+else
+    fail "run -j 4: expected 9 completions, got $N"
+fi
+
+# A run's exit must be reaped once, by its own slot, however slots are
+# reused while siblings are still between fork and exec
+DUPS=0
+i=0
+while [ "$i" -lt 50 ]; do
+    i=$((i + 1))
+    OUT=$("$TAGUCHI" run "$TGU" '[ "$TAGUCHI_RUN_ID" -ne 5 ]' -j 3 2>&1)
+    N=$(echo "$OUT" | grep -c "^Run [0-9]* completed")
+    U=$(echo "$OUT" | grep "^Run [0-9]* completed" | sort -u | wc -l)
+    if [ "$N" -ne 9 ] || [ "$U" -ne 9 ]; then DUPS=$((DUPS + 1)); fi
+done
+if [ "$DUPS" -eq 0 ]; then
+    pass "run -j 3: every run reaped once over 50 campaigns"
+else
+    fail "run -j 3: $DUPS of 50 campaigns reaped a run twice or lost one"
+fi
+
+# Parallel runs must overlap: 9 runs of 0.3 s at -j 9 finish well under 9 x 0.3 s
+START=$(date +%s%N)
+"$TAGUCHI" run "$TGU" 'sleep 0.3' -j 9 >/dev/null 2>&1
+END=$(date +%s%N)
+MS=$(( (END - START) / 1000000 ))
+if [ "$MS" -lt 2000 ]; then
+    pass "run -j 9: runs execute concurrently (${MS} ms)"
+else
+    fail "run -j 9: took ${MS} ms, runs appear serialized"
+fi
+
+PROM="$TMPDIR_TEST/taguchi.prom"
+"$TAGUCHI" run "$TGU" '[ "$TAGUCHI_RUN_ID" -ne 5 ]' -j 3 --metrics-file "$PROM" >/dev/null 2>&1
+check_file "metrics file: runs_total gauge" \
+    '^taguchi_runs_total{experiment=".*exp.tgu"} 9$' "$PROM"
+check_file "metrics file: all runs done" \
+    '^taguchi_runs_done{.*} 9$' "$PROM"
+check_file "metrics file: failed run counted" \
+    '^taguchi_runs_failed{.*} 1$' "$PROM"
+check_file "metrics file: nothing left in flight" \
+    '^taguchi_runs_in_flight{.*} 0$' "$PROM"
+check_file "metrics file: ETA reaches zero" \
+    '^taguchi_eta_seconds{.*} 0.000$' "$PROM"
+check_file "metrics file: TYPE annotations present" \
+    '^# TYPE taguchi_run_duration_ewma_seconds gauge$' "$PROM"
+if ls "$TMPDIR_TEST"/*.tmp >/dev/null 2>&1; then
+    fail "metrics file: temporary file left behind"
+else
+    pass "metrics file: temporary file renamed into place"
+fi
+
+RES="$TMPDIR_TEST/results.csv"
+"$TAGUCHI" run "$TGU" 'true' -j 2 --results "$RES" >/dev/null 2>&1
+check_file "results file: header row" \
+    '^run_id,exit_code,wall_seconds$' "$RES"
+N=$(grep -c '^[0-9]*,0,[0-9.]*$' "$RES")
+if [ "$N" -eq 9 ]; then
+    pass "results file: one row per run"
+else
+    fail "results file: expected 9 rows, got $N"
+fi
+check_output "results file: wall_seconds usable as analyze metric" \
+    "Optimal Configuration" \
+    "$TAGUCHI" analyze "$TGU" "$RES" --metric wall_seconds --minimize
+
+# Hardware counters may be unavailable (containers, VMs); the run must still
+# succeed and record whatever events could be opened, including fallbacks.
+PERF_RES="$TMPDIR_TEST/perf.csv"
+if "$TAGUCHI" run "$TGU" 'true' --results "$PERF_RES" \
+        --perf-counters cycles,page-faults >/dev/null 2>&1; then
+    pass "perf counters: run succeeds with or without PMU access"
+else
+    fail "perf counters: run failed"
+fi
+if head -1 "$PERF_RES" | grep -q '^run_id,exit_code,wall_seconds'; then
+    pass "perf counters: counter columns follow the fixed columns"
+else
+    fail "perf counters: unexpected header $(head -1 "$PERF_RES")"
+fi
+
+# --- changeover ordering and hooks ------------------------------------------
+
+CO_TGU="$TMPDIR_TEST/changeover.tgu"
+cat > "$CO_TGU" <<'EOF'
+factors:
+  flags: O0, O2, O3
+  alloc: glibc, jemalloc, tcmalloc
+  threads: 1, 2, 4
+changeover:
+  flags: 100
+  alloc: 10
+array: L9
+EOF
+
+check_output "changeover: costs reorder runs by default" \
+    "changeover cost 260 (array order 280)" \
+    "$TAGUCHI" run "$CO_TGU" 'true' --no-progress
+
+ORDER_LOG="$TMPDIR_TEST/order.log"
+"$TAGUCHI" run "$CO_TGU" 'echo "$TAGUCHI_flags" >> '"$ORDER_LOG" --no-progress >/dev/null 2>&1
+BLOCKS=$(uniq "$ORDER_LOG" | wc -l | tr -d ' ')
+if [ "$BLOCKS" -eq 3 ]; then
+    pass "changeover: each flags level runs as one block"
+else
+    fail "changeover: flags changed level $BLOCKS times: $(tr '\n' ' ' < "$ORDER_LOG")"
+fi
+
+OUT=$("$TAGUCHI" run "$CO_TGU" 'true' --no-progress --order array 2>&1)
+if echo "$OUT" | grep -q "Run order"; then
+    fail "changeover: --order array should keep array order ($OUT)"
+else
+    pass "changeover: --order array keeps array order"
+fi
+
+HOOK_LOG="$TMPDIR_TEST/hooks.log"
+check_output "hooks: setup/teardown counted" \
+    "Hooks: 3 setup(s), 3 teardown(s)" \
+    "$TAGUCHI" run "$CO_TGU" 'echo "run $TAGUCHI_flags" >> '"$HOOK_LOG" --no-progress \
+        --setup 'flags=echo "setup $TAGUCHI_flags" >> '"$HOOK_LOG" \
+        --teardown 'flags=echo "teardown $TAGUCHI_flags" >> '"$HOOK_LOG"
+# Every run must happen between the setup and teardown of its level
+if awk '/^setup/ { cur = $2; next }
+        /^teardown/ { if ($2 != cur) bad = 1; cur = ""; next }
+        /^run/ { if ($2 != cur) bad = 1 }
+        END { exit bad }' "$HOOK_LOG"; then
+    pass "hooks: runs bracketed by their level's setup and teardown"
+else
+    fail "hooks: unexpected sequence: $(tr '\n' ';' < "$HOOK_LOG")"
+fi
+
+check_fails_with "hooks: failing setup aborts the campaign" \
+    "Setup for flags failed" \
+    "$TAGUCHI" run "$CO_TGU" 'true' --no-progress --setup 'flags=exit 3'
+
+# The second flags setup fails at run 4 (O2/glibc), while alloc still has
+# run 3's tcmalloc set up: that is the level its final teardown must see
+PARTIAL_LOG="$TMPDIR_TEST/partial.log"
+"$TAGUCHI" run "$CO_TGU" 'true' --no-progress --order array \
+    --setup 'flags=test ! -e '"$TMPDIR_TEST/flags.once"' && touch '"$TMPDIR_TEST/flags.once" \
+    --setup 'alloc=echo "setup $TAGUCHI_alloc" >> '"$PARTIAL_LOG" \
+    --teardown 'alloc=echo "teardown $TAGUCHI_alloc" >> '"$PARTIAL_LOG" >/dev/null 2>&1
+if [ "$(tail -1 "$PARTIAL_LOG")" = "teardown tcmalloc" ]; then
+    pass "hooks: failed setup tears down the levels actually set up"
+else
+    fail "hooks: unexpected sequence after failed setup: $(tr '\n' ';' < "$PARTIAL_LOG")"
+fi
+
+check_fails_with "hooks: unknown factor rejected" \
+    "hook for unknown factor 'nope'" \
+    "$TAGUCHI" run "$CO_TGU" 'true' --setup 'nope=true'
+
+check_fails_with "hooks: parallel runs rejected" \
+    "require sequential runs" \
+    "$TAGUCHI" run "$CO_TGU" 'true' -j 2 --setup 'flags=true'
+
+check_fails_with "failure: unknown perf event rejected" \
+    "Unknown perf event" \
+    "$TAGUCHI" run "$TGU" 'true' --perf-counters bogus-event
+
+check_fails_with "failure: invalid job count rejected" \
+    "invalid job count" \
+    "$TAGUCHI" run "$TGU" 'true' -j 0
+
+check_fails_with "failure: unknown option rejected" \
+    "unknown run option" \
+    "$TAGUCHI" run "$TGU" 'true' --bogus
+
+# --- adaptive concurrency (-j auto) -----------------------------------------
+
+# Canned /proc trees: one idle host, one under memory pressure
+make_proc() {
+    mkdir -p "$1/pressure"
+    for r in cpu memory io; do
+        printf 'some avg10=%s avg60=0.00 avg300=0.00 total=0\nfull avg10=0.00 avg60=0.00 avg300=0.00 total=0\n' \
+            "$2" > "$1/pressure/$r"
+    done
+    printf 'MemTotal: 1000 kB\nMemFree: 100 kB\nMemAvailable: 500 kB\n' > "$1/meminfo"
+}
+make_proc "$TMPDIR_TEST/proc_idle" 0.50
+make_proc "$TMPDIR_TEST/proc_busy" 0.50
+printf 'some avg10=35.00 avg60=20.00 avg300=5.00 total=0\n' > "$TMPDIR_TEST/proc_busy/pressure/memory"
+
+AUTO_RES="$TMPDIR_TEST/auto.csv"
+check_output "auto jobs: idle host ramps to the cap" \
+    "Concurrency: auto, peak limit 4 of 4" \
+    env TAGUCHI_PROC_ROOT="$TMPDIR_TEST/proc_idle" \
+    "$TAGUCHI" run "$TGU" 'sleep 0.2' -j auto:4 --no-progress --results "$AUTO_RES"
+PEAK=$(tail -n +2 "$AUTO_RES" | cut -d, -f4 | sort -n | tail -1)
+if head -1 "$AUTO_RES" | grep -q ',concurrency$' && [ "$PEAK" -gt 1 ]; then
+    pass "auto jobs: results record per-run concurrency"
+else
+    fail "auto jobs: unexpected results: $(tr '\n' ' ' < "$AUTO_RES")"
+fi
+
+AUTO_BUSY="$TMPDIR_TEST/auto_busy.csv"
+env TAGUCHI_PROC_ROOT="$TMPDIR_TEST/proc_busy" \
+    "$TAGUCHI" run "$TGU" 'sleep 0.1' -j auto:4 --no-progress --results "$AUTO_BUSY" >/dev/null 2>&1
+if [ "$(tail -n +2 "$AUTO_BUSY" | cut -d, -f4 | sort -u)" = "1" ]; then
+    pass "auto jobs: memory pressure keeps runs sequential"
+else
+    fail "auto jobs: ran concurrently under pressure: $(tr '\n' ' ' < "$AUTO_BUSY")"
+fi
+
+check_output "auto jobs: missing pressure files only warn" \
+    "will not throttle" \
+    env TAGUCHI_PROC_ROOT="$TMPDIR_TEST/no_such_proc" \
+    "$TAGUCHI" run "$TGU" 'true' -j auto:2 --no-progress
+
+check_fails_with "auto jobs: invalid cap rejected" \
+    "invalid job count 'auto:0'" \
+    "$TAGUCHI" run "$TGU" 'true' -j auto:0
+
+# --- adaptive replication ----------------------------------------------------
+
+ADAPT_TGU="$TMPDIR_TEST/adaptive.tgu"
+cat > "$ADAPT_TGU" <<'EOF'
+factors:
+  a: 1, 2
+  b: 1, 2
+  c: 1, 2
+array: L4
+EOF
+
+# a=2 is 0.3s slower; replicates vary by up to 20ms
+ADAPT_RES="$TMPDIR_TEST/adaptive.csv"
+check_output "adaptive: stops once the top factor is resolved" \
+    "recommendation stable at 95% confidence after 8 run(s)" \
+    "$TAGUCHI" run "$ADAPT_TGU" 'sleep 0.$(( (TAGUCHI_a - 1) * 3 ))$(( $$ % 3 ))' \
+        --adaptive --minimize --top 1 --no-progress --results "$ADAPT_RES"
+ROWS=$(tail -n +2 "$ADAPT_RES" | wc -l | tr -d ' ')
+if [ "$ROWS" -eq 8 ]; then
+    pass "adaptive: results file holds every replicate"
+else
+    fail "adaptive: expected 8 result rows, got $ROWS"
+fi
+
+check_output "adaptive: budget ends an unresolvable campaign" \
+    "run budget reached with 1 of 1 top factor(s) unresolved" \
+    "$TAGUCHI" run "$ADAPT_TGU" 'sleep 0.0$(( $$ % 5 ))' --adaptive --top 1 --max-runs 8 \
+        --confidence 0.9999 --no-progress
+
+check_fails_with "adaptive: tuning flags require --adaptive" \
+    "require --adaptive" \
+    "$TAGUCHI" run "$ADAPT_TGU" 'true' --confidence 0.9
+
+check_fails_with "adaptive: budget below the first round rejected" \
+    "below the first round" \
+    "$TAGUCHI" run "$ADAPT_TGU" 'true' --adaptive --max-runs 5
+
+# --- split-plot designs ------------------------------------------------------
+
+SP_TGU="$TMPDIR_TEST/splitplot.tgu"
+cat > "$SP_TGU" <<'EOF'
+factors:
+  flags: O0, O2, O3
+  alloc: glibc, jemalloc, tcmalloc
+  threads: 1, 2, 4
+whole_plot: flags
+whole_plot_array: L9
+array: L9
+EOF
+
+check_output "split-plot: generate groups runs into whole plots" \
+    "Whole plot 9: flags=O3" \
+    "$TAGUCHI" generate "$SP_TGU"
+
+SP_LOG="$TMPDIR_TEST/splitplot.log"
+"$TAGUCHI" run "$SP_TGU" 'echo "$TAGUCHI_flags" >> '"$SP_LOG" --no-progress >/dev/null 2>&1
+BLOCKS=$(uniq "$SP_LOG" | wc -l | tr -d ' ')
+if [ "$BLOCKS" -eq 3 ]; then
+    pass "split-plot: flags changes once per whole plot"
+else
+    fail "split-plot: flags changed level $BLOCKS times"
+fi
+
+SP_CSV="$TMPDIR_TEST/splitplot.csv"
+awk 'BEGIN { print "run_id,response"; for (i = 1; i <= 81; i++) print i "," (i % 9) + int((i - 1) / 27) * 3 }' > "$SP_CSV"
+check_output "split-plot: analyze prints stratified ANOVA" \
+    "Split-Plot ANOVA" \
+    "$TAGUCHI" analyze "$SP_TGU" "$SP_CSV"
+
+check_fails_with "split-plot: unknown whole-plot factor rejected" \
+    "Whole-plot factor 'nope' is not defined" \
+    sh -c "printf 'factors:\n  a: 1, 2\nwhole_plot: nope\narray: L4\n' > '$TMPDIR_TEST/bad_sp.tgu' && '$TAGUCHI' generate '$TMPDIR_TEST/bad_sp.tgu'"
+
+# --- log capture ---------------------------------------------------------------
+
+LOG_DIR="$TMPDIR_TEST/logs"
+LOG_RES="$TMPDIR_TEST/logcap.csv"
+# Every run prints ~195 KB; run 5 fails
+LOG_SCRIPT='yes "iteration ok" | head -c 195000; echo "latency: ${TAGUCHI_threads}5 ms"; [ "$TAGUCHI_RUN_ID" != 5 ]'
+LOG_OUT=$("$TAGUCHI" run "$TGU" "$LOG_SCRIPT" -j 2 --no-progress --log-dir "$LOG_DIR" \
+    --log-max-bytes 64K --log-ring 1K --log-metric latency="latency:" --results "$LOG_RES" 2>&1)
+
+check_file "log capture: metric parsed from the stream" "^1,0,[0-9.]*,15$" "$LOG_RES"
+
+if [ -f "$LOG_DIR/run-9.log.gz" ] && gzip -dc "$LOG_DIR/run-9.log.gz" | tail -n 1 | grep -q "log capped at 65536 bytes"; then
+    pass "log capture: compressed log stops at the cap"
+else
+    fail "log capture: run-9.log.gz missing or not capped"
+fi
+
+if echo "$LOG_OUT" | grep -q "Run 5 output (first 512 and last 512 of 195015 bytes)" &&
+   echo "$LOG_OUT" | grep -q "^latency: 25 ms" && ! echo "$LOG_OUT" | grep -q "Run 4 output"; then
+    pass "log capture: failed run shows head and tail only"
+else
+    fail "log capture: unexpected excerpt in: $(echo "$LOG_OUT" | head -n 20)"
+fi
+
+check_fails_with "log capture: size options need capture" \
+    "require --log-dir or --log-metric" \
+    "$TAGUCHI" run "$TGU" 'true' --log-ring 1K
+
+# --- retries -------------------------------------------------------------------
+
+RETRY_DIR="$TMPDIR_TEST/retry"
+mkdir -p "$RETRY_DIR"
+# Run 2 is SIGKILLed on its first attempt, run 3 always fails with 75, run 4 with 1
+RETRY_SCRIPT='f='"$RETRY_DIR"'/n.$TAGUCHI_RUN_ID; n=$(cat $f 2>/dev/null || echo 0); echo $((n + 1)) > $f
+[ "$TAGUCHI_RUN_ID" = 2 ] && [ "$n" = 0 ] && kill -9 $$
+[ "$TAGUCHI_RUN_ID" = 3 ] && exit 75
+[ "$TAGUCHI_RUN_ID" = 4 ] && exit 1
+exit 0'
+check_output "retries: retryable failures are rescheduled" \
+    "Retries: 3 attempt(s) retried, 1 run(s) recovered, 1 gave up" \
+    "$TAGUCHI" run "$TGU" "$RETRY_SCRIPT" -j 3 --retries 2 --retry-backoff 0.1 --no-progress \
+        --journal "$RETRY_DIR/journal.csv" --results "$RETRY_DIR/results.csv"
+check_file "retries: journal records every attempt" "^3,3,75,[0-9.]*,retryable,give_up$" "$RETRY_DIR/journal.csv"
+check_file "retries: permanent failure not retried" "^4,1,1,[0-9.]*,permanent,done$" "$RETRY_DIR/journal.csv"
+check_file "retries: results keep the final attempt" "^2,0,[0-9.]*,2$" "$RETRY_DIR/results.csv"
+RETRY_ROWS=$(tail -n +2 "$RETRY_DIR/results.csv" | wc -l | tr -d ' ')
+if [ "$RETRY_ROWS" -eq 9 ]; then
+    pass "retries: one results row per run"
+else
+    fail "retries: expected 9 result rows, got $RETRY_ROWS"
+fi
+
+check_fails_with "retries: unknown retryable code rejected" \
+    "unknown retryable code 'NOPE'" \
+    "$TAGUCHI" run "$TGU" 'true' --retries 1 --retry-on 75,NOPE
+check_fails_with "retries: policy options need --retries" \
+    "require --retries N" \
+    "$TAGUCHI" run "$TGU" 'true' --retry-backoff 2
+
+# --- summary -----------------------------------------------------------------
+
+printf "\nRun command tests: %d passed, %d failed\n" "$PASS" "$FAIL"
+
+[ "$FAIL" -eq 0 ] || exit 1
+exit 0
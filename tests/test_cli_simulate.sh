@@ -0,0 +1,138 @@
+#!/bin/sh
+# tests/test_cli_simulate.sh
+#
+# CLI integration tests for the `simulate` command (synthetic responses from a
+# ground-truth model, effect recovery check and benchmark mode).
+#
+# Run via: make test   (or directly: bash tests/test_cli_simulate.sh)
+
+TAGUCHI="${TAGUCHI:-./build/taguchi}"
+
+# ---- setup ------------------------------------------------------------------
+TMPDIR_TEST="$(mktemp -d)"
+trap 'rm -rf "$TMPDIR_TEST"' EXIT
+
+PASS=0
+FAIL=0
+
+pass() { printf "  PASS: %s\n" "$1"; PASS=$((PASS + 1)); }
+fail() { printf "  FAIL: %s\n" "$1"; FAIL=$((FAIL + 1)); }
+
+# command must exit 0 AND output must match grep pattern
+check_output() {
+    local name="$1" pattern="$2"; shift 2
+    local out rc
+    out=$("$@" 2>&1); rc=$?
+    if [ "$rc" -ne 0 ]; then
+        fail "$name  (command failed: $out)"
+    elif echo "$out" | grep -q "$pattern"; then
+        pass "$name"
+    else
+        fail "$name  (pattern '$pattern' not in: $out)"
+    fi
+}
+
+# command must exit non-0 AND stderr/stdout must match grep pattern
+check_fails_with() {
+    local name="$1" pattern="$2"; shift 2
+    local out rc
+    out=$("$@" 2>&1); rc=$?
+    if [ "$rc" -eq 0 ]; then
+        fail "$name  (expected failure but command succeeded)"
+    elif echo "$out" | grep -q "$pattern"; then
+        pass "$name"
+    else
+        fail "$name  (expected pattern '$pattern' not in: $out)"
+    fi
+}
+
+# file must contain grep pattern
+check_file() {
+    local name="$1" pattern="$2" file="$3"
+    if [ -f "$file" ] && grep -q "$pattern" "$file"; then
+        pass "$name"
+    else
+        fail "$name  (pattern '$pattern' not in $file)"
+    fi
+}
+
+# ---- shared fixtures --------------------------------------------------------
+
+TGU="$TMPDIR_TEST/exp.tgu"
+cat > "$TGU" << 'EOF2'
+factors:
+  a: 1, 2, 3
+  b: x, y, z
+  c: p, q, r
+array: L9
+EOF2
+
+# ---- tests ------------------------------------------------------------------
+
+printf "Simulate Command Tests:\n"
+
+check_output "simulate: results CSV header" \
+    "^run_id,response$" \
+    "$TAGUCHI" simulate "$TGU"
+
+A=$("$TAGUCHI" simulate "$TGU" --seed 7 2>&1)
+B=$("$TAGUCHI" simulate "$TGU" --seed 7 2>&1)
+C=$("$TAGUCHI" simulate "$TGU" --seed 8 2>&1)
+if [ "$A" = "$B" ] && [ "$A" != "$C" ]; then
+    pass "simulate: output is deterministic for a seed"
+else
+    fail "simulate: seeded output not reproducible"
+fi
+
+N=$("$TAGUCHI" simulate "$TGU" --replicates 5 | grep -c '^[0-9]*,')
+if [ "$N" -eq 45 ]; then
+    pass "simulate: one row per run and replicate"
+else
+    fail "simulate: expected 45 rows, got $N"
+fi
+
+N=$("$TAGUCHI" simulate "$TGU" --replicates 20 --missing 0.5 | grep -c '^[0-9]*,')
+if [ "$N" -gt 40 ] && [ "$N" -lt 140 ]; then
+    pass "simulate --missing: observations dropped ($N of 180 kept)"
+else
+    fail "simulate --missing: unexpected row count $N"
+fi
+
+RES="$TMPDIR_TEST/sim.csv"
+"$TAGUCHI" simulate "$TGU" --effect a=0,1,5 --scale 0 --noise 0 --metric latency --output "$RES"
+check_output "simulate --output: file is analyzable" \
+    "L1=0.000, L2=1.000, L3=5.000" \
+    "$TAGUCHI" effects "$TGU" "$RES" --metric latency
+
+check_output "simulate --check: additive truth recovered" \
+    "best level recovered for 3/3 factors" \
+    "$TAGUCHI" simulate "$TGU" --effect a=0,1,5 --noise 0.05 --replicates 20 --check --tolerance 0.05
+
+# In L9 the b x c interaction is aliased with column a, so a strong
+# interaction must show up as error in a's estimated effect
+check_fails_with "simulate --check: aliased interaction exceeds tolerance" \
+    "exceeds tolerance" \
+    "$TAGUCHI" simulate "$TGU" --effect a=0,1,5 --interaction b:c=2 --noise 0 --check --tolerance 0.05
+
+check_output "simulate --bench: throughput reported" \
+    "observations/s" \
+    "$TAGUCHI" simulate "$TGU" --bench 50 --replicates 4 --hetero 0.5
+
+check_fails_with "failure: wrong number of effect values" \
+    "needs 3 numeric values" \
+    "$TAGUCHI" simulate "$TGU" --effect a=0,1
+
+check_fails_with "failure: unknown factor in interaction" \
+    "invalid --interaction" \
+    "$TAGUCHI" simulate "$TGU" --interaction a:nope=1
+
+check_fails_with "failure: unknown option rejected" \
+    "unknown simulate option" \
+    "$TAGUCHI" simulate "$TGU" --bogus 1
+
+# --- summary -----------------------------------------------------------------
+
+printf "\nSimulate command tests: %d passed, %d failed\n" "$PASS" "$FAIL"
+
+[ "$FAIL" -eq 0 ] || exit 1
+exit 0
@@ -0,0 +1,155 @@
+#!/bin/sh
+# tests/test_cli_stdin.sh
+#
+# CLI integration tests for non-file inputs: '-' (stdin), /dev/fd/N and the
+# framed definition+results stream selected by passing the same input twice.
+#
+# Run via: make test   (or directly: bash tests/test_cli_stdin.sh)
+
+TAGUCHI="${TAGUCHI:-./build/taguchi}"
+
+# ---- setup ------------------------------------------------------------------
+TMPDIR_TEST="$(mktemp -d)"
+trap 'rm -rf "$TMPDIR_TEST"' EXIT
+
+PASS=0
+FAIL=0
+
+pass() { printf "  PASS: %s\n" "$1"; PASS=$((PASS + 1)); }
+fail() { printf "  FAIL: %s\n" "$1"; FAIL=$((FAIL + 1)); }
+
+# output of a shell pipeline must match grep pattern and the pipeline exit 0
+check_pipe() {
+    local name="$1" pattern="$2" cmd="$3"
+    local out rc
+    out=$(sh -c "$cmd" 2>&1); rc=$?
+    if [ "$rc" -ne 0 ]; then
+        fail "$name  (command failed: $out)"
+    elif echo "$out" | grep -q "$pattern"; then
+        pass "$name"
+    else
+        fail "$name  (pattern '$pattern' not in: $out)"
+    fi
+}
+
+# shell pipeline must exit non-0 and its output match grep pattern
+check_pipe_fails_with() {
+    local name="$1" pattern="$2" cmd="$3"
+    local out rc
+    out=$(sh -c "$cmd" 2>&1); rc=$?
+    if [ "$rc" -eq 0 ]; then
+        fail "$name  (expected failure but command succeeded)"
+    elif echo "$out" | grep -q "$pattern"; then
+        pass "$name"
+    else
+        fail "$name  (expected pattern '$pattern' not in: $out)"
+    fi
+}
+
+# ---- shared fixtures --------------------------------------------------------
+
+TGU="$TMPDIR_TEST/exp.tgu"
+cat > "$TGU" <<'TGU'
+factors:
+  a: 1, 2, 3
+  b: x, y, z
+array: L9
+TGU
+
+CSV="$TMPDIR_TEST/results.csv"
+printf 'run_id,response\n' > "$CSV"
+for i in 1 2 3 4 5 6 7 8 9; do
+    printf '%d,%d\n' "$i" "$((i * 10))" >> "$CSV"
+done
+
+# Build a framed stream: header, then each section prefixed by its byte count
+frame() {
+    printf 'TAGUCHI-STREAM 1\n'
+    printf 'definition %d\n' "$(wc -c < "$1")"
+    cat "$1"
+    if [ -n "$2" ]; then
+        printf 'results %d\n' "$(wc -c < "$2")"
+        cat "$2"
+    fi
+}
+STREAM="$TMPDIR_TEST/stream"
+frame "$TGU" "$CSV" > "$STREAM"
+DEF_ONLY="$TMPDIR_TEST/def_only"
+frame "$TGU" > "$DEF_ONLY"
+
+EXPECTED=$("$TAGUCHI" effects "$TGU" "$CSV")
+
+# --- tests -------------------------------------------------------------------
+
+check_pipe "generate: definition on stdin" \
+    "Run 9" \
+    "cat '$TGU' | '$TAGUCHI' generate -"
+
+check_pipe "generate --json: integer levels as numbers" \
+    '{"run_id": 1, "a": 1, "b": "x"}' \
+    "cat '$TGU' | '$TAGUCHI' generate - --json"
+
+check_pipe_fails_with "failure: unknown generate option" \
+    "unknown generate option '--xml'" \
+    "'$TAGUCHI' generate '$TGU' --xml"
+
+check_pipe "validate: definition on stdin" \
+    "Valid .tgu file" \
+    "cat '$TGU' | '$TAGUCHI' validate -"
+
+check_pipe "generate: framed stream without results" \
+    "Run 9" \
+    "'$TAGUCHI' generate - < '$DEF_ONLY'"
+
+check_pipe "effects: results on stdin" \
+    "L1=20.000, L2=50.000, L3=80.000" \
+    "cat '$CSV' | '$TAGUCHI' effects '$TGU' -"
+
+check_pipe "analyze: results on stdin" \
+    "Optimal Configuration: a=level_3" \
+    "cat '$CSV' | '$TAGUCHI' analyze '$TGU' -"
+
+check_pipe "effects: framed stream via '- -'" \
+    "L1=20.000, L2=50.000, L3=80.000" \
+    "cat '$STREAM' | '$TAGUCHI' effects - -"
+
+OUT=$(cat "$STREAM" | "$TAGUCHI" effects - -)
+if [ "$OUT" = "$EXPECTED" ]; then
+    pass "effects: framed stream output identical to file inputs"
+else
+    fail "effects: framed stream output differs from file inputs"
+fi
+
+check_pipe "effects: inherited descriptor /dev/fd/3" \
+    "L1=20.000, L2=50.000, L3=80.000" \
+    "'$TAGUCHI' effects '$TGU' /dev/fd/3 3< '$CSV'"
+
+SCRIPT="$TMPDIR_TEST/script.sh"
+printf '#!/bin/sh\necho "response: 1"\n' > "$SCRIPT"
+chmod +x "$SCRIPT"
+check_pipe "run: definition on stdin" \
+    "All experiment runs completed" \
+    "cat '$TGU' | '$TAGUCHI' run - '$SCRIPT' --no-progress"
+
+check_pipe_fails_with "failure: framed stream without results for effects" \
+    "no results section" \
+    "'$TAGUCHI' effects - - < '$DEF_ONLY'"
+
+check_pipe_fails_with "failure: truncated frame rejected" \
+    "bad or truncated" \
+    "head -c 40 '$STREAM' | '$TAGUCHI' effects - -"
+
+check_pipe_fails_with "failure: plain CSV is not a framed stream" \
+    "not a framed stream" \
+    "cat '$CSV' | '$TAGUCHI' effects - -"
+
+check_pipe_fails_with "failure: empty results on stdin" \
+    "No data rows" \
+    "'$TAGUCHI' effects '$TGU' - < /dev/null"
+
+# --- summary -----------------------------------------------------------------
+
+printf "\nStdin input tests: %d passed, %d failed\n" "$PASS" "$FAIL"
+
+[ "$FAIL" -eq 0 ] || exit 1
+exit 0
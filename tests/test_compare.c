@@ -0,0 +1,187 @@
+#include "test_framework.h"
+#include "include/taguchi.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *compare_l9_def =
+    "factors:\n"
+    "  cache: 64M, 128M, 256M\n"
+    "  threads: 2, 4, 8\n"
+    "  codec: lz4, zstd, none\n"
+    "array: L9\n";
+
+/* Noise-free response of a run plus extra[cache level] */
+static double l9_response(const taguchi_experiment_run_t *run, const double *extra) {
+    static const char *caches[3] = { "64M", "128M", "256M" };
+    static const char *threads[3] = { "2", "4", "8" };
+    double y = 10.0;
+    for (size_t lv = 0; lv < 3; lv++) {
+        if (strcmp(taguchi_run_get_value(run, "cache"), caches[lv]) == 0) y += 3.0 * lv + extra[lv];
+        if (strcmp(taguchi_run_get_value(run, "threads"), threads[lv]) == 0) y += (double)lv;
+    }
+    return y;
+}
+
+/* Results of every run; replicates alternate +-noise around the run mean */
+static taguchi_result_set_t *l9_results(taguchi_experiment_def_t *def, const double *extra,
+                                        double shift, size_t replicates, double noise) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_run_t **runs = NULL;
+    size_t count = 0;
+    ASSERT_EQ(taguchi_generate_runs(def, &runs, &count, error), 0);
+    taguchi_result_set_t *results = taguchi_create_result_set(def, "y");
+    for (size_t rep = 0; rep < replicates; rep++) {
+        for (size_t i = 0; i < count; i++) {
+            double y = l9_response(runs[i], extra) + shift + (rep % 2 ? -noise : noise);
+            ASSERT_EQ(taguchi_add_result(results, taguchi_run_get_id(runs[i]), y, error), 0);
+        }
+    }
+    taguchi_free_runs(runs, count);
+    return results;
+}
+
+static const taguchi_factor_change_t *find_change(const taguchi_factor_change_t *changes,
+                                                  size_t count, const char *name) {
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(changes[i].factor, name) == 0) return &changes[i];
+    }
+    return NULL;
+}
+
+TEST(compare_ranks_changed_factor) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(compare_l9_def, error);
+    ASSERT_NOT_NULL(def);
+    static const double none[3] = { 0.0, 0.0, 0.0 };
+    static const double grown[3] = { 0.0, 1.0, 3.0 };
+    taguchi_result_set_t *a = l9_results(def, none, 0.0, 2, 0.1);
+    taguchi_result_set_t *b = l9_results(def, grown, 2.0, 2, 0.1);
+
+    taguchi_factor_change_t *changes = NULL;
+    size_t count = 0;
+    taguchi_comparison_summary_t summary;
+    ASSERT_EQ(taguchi_compare_results(a, b, NULL, &changes, &count, &summary, error), 0);
+    ASSERT_EQ(count, 3);
+    ASSERT_EQ(summary.runs, 9);
+    ASSERT_EQ(summary.error_source, TAGUCHI_COMPARE_ERROR_REPLICATES);
+    ASSERT_EQ(summary.error_df, 18);
+    ASSERT_DOUBLE_EQ(summary.shift, 2.0 + 4.0 / 3.0, 1e-9);
+
+    /* Ranked first; its level effects moved by extra less their mean */
+    ASSERT_STR_EQ(changes[0].factor, "cache");
+    ASSERT_TRUE(changes[0].significant);
+    ASSERT_DOUBLE_EQ(changes[0].range_a, 6.0, 1e-9);
+    ASSERT_DOUBLE_EQ(changes[0].range_b, 9.0, 1e-9);
+    ASSERT_DOUBLE_EQ(changes[0].delta[0], -4.0 / 3.0, 1e-9);
+    ASSERT_DOUBLE_EQ(changes[0].delta[2], 5.0 / 3.0, 1e-9);
+    /* Replicate variance 0.02; a run difference of two 2-result means has 0.02 */
+    ASSERT_DOUBLE_EQ(changes[0].std_error[1], sqrt(0.02 * (1.0 / 3.0 - 1.0 / 9.0)), 1e-9);
+
+    /* A uniform shift changes no other factor */
+    const taguchi_factor_change_t *threads = find_change(changes, count, "threads");
+    ASSERT_NOT_NULL(threads);
+    ASSERT_FALSE(threads->significant);
+    ASSERT_DOUBLE_EQ(threads->sum_squares, 0.0, 1e-9);
+    ASSERT_DOUBLE_EQ(threads->p_value, 1.0, 1e-9);
+
+    taguchi_free_factor_changes(changes, count);
+    taguchi_free_result_set(b);
+    taguchi_free_result_set(a);
+    taguchi_free_definition(def);
+}
+
+TEST(compare_permutations_are_deterministic) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(compare_l9_def, error);
+    ASSERT_NOT_NULL(def);
+    static const double none[3] = { 0.0, 0.0, 0.0 };
+    static const double grown[3] = { 0.0, 1.0, 3.0 };
+    taguchi_result_set_t *a = l9_results(def, none, 0.0, 1, 0.0);
+    taguchi_result_set_t *b = l9_results(def, grown, 0.0, 1, 0.0);
+
+    /* L9 with three factors leaves 2 residual df */
+    taguchi_factor_change_t *changes = NULL;
+    size_t count = 0;
+    taguchi_comparison_summary_t summary;
+    ASSERT_EQ(taguchi_compare_results(a, b, NULL, &changes, &count, &summary, error), 0);
+    ASSERT_EQ(summary.error_source, TAGUCHI_COMPARE_ERROR_RESIDUAL);
+    ASSERT_EQ(summary.error_df, 2);
+    taguchi_free_factor_changes(changes, count);
+
+    taguchi_compare_options_t opts;
+    taguchi_compare_options_init(&opts);
+    opts.permutations = 4000;
+    opts.seed = 42;
+
+    double p_values[2][3];
+    for (size_t trial = 0; trial < 2; trial++) {
+        taguchi_context_options_t copts;
+        taguchi_context_options_init(&copts);
+        copts.max_workers = trial == 0 ? 1 : 4;
+        taguchi_context_t *ctx = taguchi_context_create(&copts, error);
+        ASSERT_NOT_NULL(ctx);
+        ASSERT_EQ(taguchi_compare_results_ctx(ctx, a, b, &opts, &changes, &count, &summary,
+                                              error), 0);
+        ASSERT_EQ(summary.permutations, 4000);
+        for (size_t i = 0; i < count; i++) {
+            p_values[trial][changes[i].factor_index] = changes[i].p_value;
+        }
+        ASSERT_STR_EQ(changes[0].factor, "cache");
+        ASSERT_TRUE(changes[0].p_value < 0.05);
+        taguchi_free_factor_changes(changes, count);
+        taguchi_context_free(ctx);
+    }
+    for (size_t f = 0; f < 3; f++) {
+        ASSERT_EQ(p_values[0][f], p_values[1][f]);
+    }
+    /* Unchanged factors reach the observed statistic of 0 in every shuffle */
+    ASSERT_EQ(p_values[0][1], 1.0);
+
+    taguchi_free_result_set(b);
+    taguchi_free_result_set(a);
+    taguchi_free_definition(def);
+}
+
+TEST(compare_rejects_mismatched_campaigns) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(compare_l9_def, error);
+    taguchi_experiment_def_t *other = taguchi_parse_definition(
+        "factors:\n  cache: 64M, 128M, 256M\n  threads: 2, 4, 8\narray: L9\n", error);
+    ASSERT_NOT_NULL(def);
+    ASSERT_NOT_NULL(other);
+    static const double none[3] = { 0.0, 0.0, 0.0 };
+    taguchi_result_set_t *a = l9_results(def, none, 0.0, 1, 0.0);
+    taguchi_result_set_t *b = l9_results(other, none, 0.0, 1, 0.0);
+
+    taguchi_factor_change_t *changes = NULL;
+    size_t count = 0;
+    ASSERT_EQ(taguchi_compare_results(a, b, NULL, &changes, &count, NULL, error), -1);
+    ASSERT_TRUE(strstr(error, "same design") != NULL);
+
+    /* A saturated, unreplicated comparison needs the permutation test */
+    taguchi_experiment_def_t *l4 = taguchi_parse_definition(
+        "factors:\n  a: 1, 2\n  b: 1, 2\n  c: 1, 2\narray: L4\n", error);
+    ASSERT_NOT_NULL(l4);
+    taguchi_result_set_t *c = taguchi_create_result_set(l4, "y");
+    taguchi_result_set_t *d = taguchi_create_result_set(l4, "y");
+    for (size_t id = 1; id <= 4; id++) {
+        ASSERT_EQ(taguchi_add_result(c, id, (double)id, error), 0);
+        ASSERT_EQ(taguchi_add_result(d, id, (double)(id * id), error), 0);
+    }
+    ASSERT_EQ(taguchi_compare_results(c, d, NULL, &changes, &count, NULL, error), -1);
+    ASSERT_TRUE(strstr(error, "No error estimate") != NULL);
+
+    /* Without shared runs there is nothing to compare */
+    taguchi_result_set_t *empty = taguchi_create_result_set(l4, "y");
+    ASSERT_EQ(taguchi_compare_results(c, empty, NULL, &changes, &count, NULL, error), -1);
+
+    taguchi_free_result_set(empty);
+    taguchi_free_result_set(d);
+    taguchi_free_result_set(c);
+    taguchi_free_result_set(b);
+    taguchi_free_result_set(a);
+    taguchi_free_definition(l4);
+    taguchi_free_definition(other);
+    taguchi_free_definition(def);
+}
@@ -0,0 +1,208 @@
+#include "test_framework.h"
+#include "include/taguchi.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *context_l27_def =
+    "factors:\n"
+    "  a: 1, 2, 3\n"
+    "  b: 1, 2, 3\n"
+    "  c: 1, 2, 3\n"
+    "  d: 1, 2, 3\n"
+    "  e: 1, 2, 3\n"
+    "  f: 1, 2, 3\n"
+    "  g: 1, 2, 3\n"
+    "array: L27\n";
+
+static taguchi_context_t *make_context(size_t workers) {
+    taguchi_context_options_t opts;
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_context_options_init(&opts);
+    opts.max_workers = workers;
+    taguchi_context_t *ctx = taguchi_context_create(&opts, error);
+    ASSERT_NOT_NULL(ctx);
+    return ctx;
+}
+
+static void count_hits(void *arg, size_t begin, size_t end) {
+    int *hits = arg;
+    for (size_t i = begin; i < end; i++) {
+        __atomic_fetch_add(&hits[i], 1, __ATOMIC_RELAXED);
+    }
+}
+
+TEST(parallel_for_covers_each_index_once) {
+    taguchi_context_t *ctx = make_context(4);
+    size_t n = 100000;
+    int *hits = calloc(n, sizeof(int));
+    ASSERT_NOT_NULL(hits);
+
+    taguchi_context_parallel_for(ctx, n, 1, count_hits, hits);
+    for (size_t i = 0; i < n; i++) {
+        ASSERT_EQ(hits[i], 1);
+    }
+    /* The pool is reusable and empty ranges are a no-op */
+    taguchi_context_parallel_for(ctx, n, 1000, count_hits, hits);
+    taguchi_context_parallel_for(ctx, 0, 1, count_hits, hits);
+    for (size_t i = 0; i < n; i++) {
+        ASSERT_EQ(hits[i], 2);
+    }
+    free(hits);
+    taguchi_context_free(ctx);
+}
+
+typedef struct {
+    taguchi_context_t *ctx;
+    int *hits;
+    size_t inner;
+} NestedJob;
+
+static void nested_outer(void *arg, size_t begin, size_t end) {
+    NestedJob *job = arg;
+    for (size_t i = begin; i < end; i++) {
+        taguchi_context_parallel_for(job->ctx, job->inner, 1, count_hits,
+                                     job->hits + i * job->inner);
+    }
+}
+
+TEST(parallel_for_nested_calls_complete) {
+    taguchi_context_t *ctx = make_context(4);
+    NestedJob job;
+    job.ctx = ctx;
+    job.inner = 500;
+    job.hits = calloc(64 * job.inner, sizeof(int));
+    ASSERT_NOT_NULL(job.hits);
+
+    taguchi_context_parallel_for(ctx, 64, 1, nested_outer, &job);
+    for (size_t i = 0; i < 64 * job.inner; i++) {
+        ASSERT_EQ(job.hits[i], 1);
+    }
+    free(job.hits);
+    taguchi_context_free(ctx);
+}
+
+static void single_chunk(void *arg, size_t begin, size_t end) {
+    size_t *chunks = arg;
+    chunks[0]++;
+    chunks[1] = begin;
+    chunks[2] = end;
+}
+
+TEST(single_worker_context_runs_inline) {
+    taguchi_context_t *ctx = make_context(1);
+    ASSERT_EQ(taguchi_context_get_max_workers(ctx), 1);
+
+    size_t chunks[3] = {0, 0, 0};
+    taguchi_context_parallel_for(ctx, 1000, 1, single_chunk, chunks);
+    ASSERT_EQ(chunks[0], 1);
+    ASSERT_EQ(chunks[1], 0);
+    ASSERT_EQ(chunks[2], 1000);
+
+    ASSERT_EQ(taguchi_context_set_max_workers(ctx, 3), 0);
+    ASSERT_EQ(taguchi_context_get_max_workers(ctx), 3);
+    taguchi_context_free(ctx);
+}
+
+static size_t alloc_calls;
+
+static void *counting_alloc(size_t size, void *user) {
+    __atomic_fetch_add((size_t *)user, 1, __ATOMIC_RELAXED);
+    return malloc(size);
+}
+
+static void counting_release(void *ptr, void *user) {
+    (void)user;
+    free(ptr);
+}
+
+/* Results with a known response for each run */
+static taguchi_result_set_t *make_results(const taguchi_experiment_def_t *def) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_run_t **runs = NULL;
+    size_t count = 0;
+    ASSERT_EQ(taguchi_generate_runs(def, &runs, &count, error), 0);
+
+    taguchi_result_set_t *results = taguchi_create_result_set(def, "y");
+    ASSERT_NOT_NULL(results);
+    for (size_t i = 0; i < count; i++) {
+        size_t id = taguchi_run_get_id(runs[i]);
+        ASSERT_EQ(taguchi_add_result(results, id, (double)(id * 7 % 11), error), 0);
+    }
+    taguchi_free_runs(runs, count);
+    return results;
+}
+
+TEST(context_allocator_and_effects_match_default) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(context_l27_def, error);
+    ASSERT_NOT_NULL(def);
+    taguchi_result_set_t *results = make_results(def);
+
+    taguchi_context_options_t opts;
+    taguchi_context_options_init(&opts);
+    opts.max_workers = 4;
+    opts.alloc = counting_alloc;
+    opts.release = counting_release;
+    opts.alloc_user = &alloc_calls;
+    taguchi_context_t *ctx = taguchi_context_create(&opts, error);
+    ASSERT_NOT_NULL(ctx);
+
+    taguchi_main_effect_t **a = NULL, **b = NULL;
+    size_t na = 0, nb = 0;
+    ASSERT_EQ(taguchi_calculate_main_effects(results, &a, &na, error), 0);
+    size_t before = alloc_calls;
+    ASSERT_EQ(taguchi_calculate_main_effects_ctx(ctx, results, &b, &nb, error), 0);
+    ASSERT_GT(alloc_calls, before);
+
+    ASSERT_EQ(na, 7);
+    ASSERT_EQ(na, nb);
+    for (size_t i = 0; i < na; i++) {
+        size_t la = 0, lb = 0;
+        const double *ma = taguchi_effect_get_level_means(a[i], &la);
+        const double *mb = taguchi_effect_get_level_means(b[i], &lb);
+        ASSERT_STR_EQ(taguchi_effect_get_factor(a[i]), taguchi_effect_get_factor(b[i]));
+        ASSERT_EQ(la, lb);
+        for (size_t l = 0; l < la; l++) {
+            ASSERT_DOUBLE_EQ(ma[l], mb[l], 1e-12);
+        }
+    }
+    taguchi_free_effects(a, na);
+    taguchi_free_effects(b, nb);
+    taguchi_free_result_set(results);
+    taguchi_free_definition(def);
+    taguchi_context_free(ctx);
+}
+
+TEST(generate_runs_ctx_matches_default) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(context_l27_def, error);
+    ASSERT_NOT_NULL(def);
+    taguchi_context_t *ctx = make_context(4);
+
+    taguchi_experiment_run_t **a = NULL, **b = NULL;
+    size_t na = 0, nb = 0;
+    ASSERT_EQ(taguchi_generate_runs(def, &a, &na, error), 0);
+    ASSERT_EQ(taguchi_generate_runs_ctx(ctx, def, &b, &nb, error), 0);
+    ASSERT_EQ(na, 27);
+    ASSERT_EQ(na, nb);
+    for (size_t i = 0; i < na; i++) {
+        ASSERT_EQ(taguchi_run_get_id(a[i]), taguchi_run_get_id(b[i]));
+        ASSERT_STR_EQ(taguchi_run_get_value(a[i], "g"), taguchi_run_get_value(b[i], "g"));
+    }
+    taguchi_free_runs(a, na);
+    taguchi_free_runs(b, nb);
+    taguchi_free_definition(def);
+    taguchi_context_free(ctx);
+}
+
+TEST(context_create_rejects_half_allocator) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_context_options_t opts;
+    taguchi_context_options_init(&opts);
+    opts.alloc = counting_alloc;
+    ASSERT_NULL(taguchi_context_create(&opts, error));
+    ASSERT_NOT_NULL(taguchi_default_context());
+    /* Freeing the default context is a no-op */
+    taguchi_context_free(taguchi_default_context());
+    ASSERT_GT(taguchi_context_get_max_workers(NULL), 0);
+}
@@ -0,0 +1,154 @@
+/* C++ wrapper tests (standalone: built with the C++ compiler) */
+#include "test_framework.h"
+#include "include/taguchi.hpp"
+#include <array>
+#include <ranges>
+#include <type_traits>
+#include <vector>
+
+static_assert(std::random_access_iterator<taguchi::Design::iterator>);
+static_assert(std::ranges::sized_range<taguchi::Design>);
+static_assert(std::random_access_iterator<taguchi::Effects::iterator>);
+static_assert(!std::is_copy_constructible_v<taguchi::Definition>);
+static_assert(!std::is_copy_constructible_v<taguchi::Design>);
+static_assert(!std::is_copy_constructible_v<taguchi::ResultSet>);
+static_assert(!std::is_copy_constructible_v<taguchi::Effects>);
+static_assert(std::is_nothrow_move_constructible_v<taguchi::Design>);
+static_assert(std::is_nothrow_move_constructible_v<taguchi::Definition>);
+
+/* A result set points at its definition, so a temporary cannot make one */
+template <class D>
+concept makes_results = requires(D &&def) { static_cast<D &&>(def).results("y"); };
+static_assert(makes_results<taguchi::Definition &>);
+static_assert(makes_results<const taguchi::Definition &>);
+static_assert(!makes_results<taguchi::Definition>);
+
+static const char *cpp_l9_def =
+    "factors:\n"
+    "  cache: 64M, 128M, 256M\n"
+    "  threads: 2, 4, 8\n"
+    "  mode: lo, hi\n"
+    "array: L9\n";
+
+TEST(cpp_design_views_match_c_api) {
+    taguchi::Definition def = taguchi::Definition::parse(cpp_l9_def);
+    def.validate();
+    ASSERT_EQ(def.factor_count(), 3u);
+    ASSERT(def.factor_name(1) == "threads");
+    ASSERT_EQ(def.level_count(2), 2u);
+    ASSERT_EQ(def.level_type(0), TAGUCHI_LEVEL_INT);
+    ASSERT_EQ(def.int_levels(0)[1], 128 << 20);
+    ASSERT_EQ(def.numeric_levels(1).size(), 3u);
+    ASSERT_EQ(def.level_type(2), TAGUCHI_LEVEL_STRING);
+    ASSERT(def.int_levels(2).empty());
+
+    taguchi::Design design = def.generate();
+    ASSERT_EQ(design.size(), 9u);
+
+    size_t expected_id = 1;
+    for (taguchi::Run run : design) {
+        ASSERT_EQ(run.id(), expected_id++);
+        ASSERT_EQ(run.factor_count(), 3u);
+        std::span<const size_t> levels = run.levels();
+        ASSERT_EQ(levels.size(), 3u);
+        for (size_t f = 0; f < levels.size(); f++) {
+            ASSERT_EQ(levels[f], taguchi_run_get_level_index(run.get(), f));
+            /* Views point at the library's storage, not a copy */
+            const char *c_value = taguchi_run_get_value(run.get(), run.factor_name(f).data());
+            ASSERT(run.value(f).data() == c_value);
+            ASSERT(run.value(f) == c_value);
+        }
+        ASSERT(run.value("mode") == run.value(2));
+        ASSERT(run.value("missing").empty());
+    }
+    ASSERT_EQ(design.level(4, 1), design[4].levels()[1]);
+    ASSERT_EQ(design.end() - design.begin(), 9);
+    ASSERT_EQ((design.begin() + 3)->id(), 4u);
+    ASSERT_EQ(design.handles().size(), 9u);
+    ASSERT(design.to_json().find("\"cache\"") != std::string::npos);
+}
+
+TEST(cpp_moves_transfer_ownership) {
+    taguchi::Definition def = taguchi::Definition::parse(cpp_l9_def);
+    taguchi::Design first = def.generate();
+    const taguchi_experiment_run_t *handle = first[0].get();
+
+    taguchi::Design second = std::move(first);
+    ASSERT_TRUE(first.empty());
+    ASSERT(first.begin() == first.end());
+    ASSERT(second[0].get() == handle);
+
+    taguchi::Design third;
+    third = std::move(second);
+    ASSERT_TRUE(second.empty());
+    ASSERT_EQ(third.size(), 9u);
+
+    taguchi::Definition moved = std::move(def);
+    ASSERT(def.get() == nullptr);
+    ASSERT_EQ(moved.factor_count(), 3u);
+}
+
+TEST(cpp_build_analyze_recommend) {
+    taguchi::Definition def = taguchi::Definition::create("L4");
+    std::array<const char *, 2> temp = {"low", "high"};
+    std::array<const char *, 2> speed = {"slow", "fast"};
+    def.add_factor("temp", temp);
+    def.add_factor("speed", speed);
+    def.validate();
+
+    taguchi::Design design = def.generate();
+    taguchi::ResultSet results = def.results("throughput");
+    for (taguchi::Run run : design) {
+        /* temp=high adds 10, speed=fast adds 1 */
+        double response = 100.0 + 10.0 * (double)run.levels()[0] + (double)run.levels()[1];
+        results.add(run.id(), response);
+    }
+
+    taguchi::Effects effects = results.main_effects();
+    ASSERT_EQ(effects.size(), 2u);
+    std::vector<std::string_view> factors;
+    for (taguchi::Effect effect : effects) factors.push_back(effect.factor());
+    ASSERT(factors[0] == "temp");
+    ASSERT(factors[1] == "speed");
+    std::span<const double> means = effects[0].level_means();
+    ASSERT_EQ(means.size(), 2u);
+    ASSERT_DOUBLE_EQ(means[1] - means[0], 10.0, 1e-9);
+    ASSERT_DOUBLE_EQ(effects[0].range(), 10.0, 1e-9);
+
+    char buf[256];
+    std::string_view best = effects.recommend(true, buf);
+    ASSERT(best.data() == buf);
+    ASSERT(best.find("temp=level_2") != std::string_view::npos);
+    ASSERT(best.find("speed=level_2") != std::string_view::npos);
+}
+
+TEST(cpp_errors_throw_library_message) {
+    bool thrown = false;
+    try {
+        taguchi::Definition::parse("factors:\n  a: 1, 2\narray: L999\n").generate();
+    } catch (const taguchi::error &e) {
+        thrown = true;
+        ASSERT(std::string_view(e.what()).size() > 0);
+    }
+    ASSERT_TRUE(thrown);
+
+    taguchi::Definition def = taguchi::Definition::create("L4");
+    thrown = false;
+    try {
+        def.add_factor("empty", std::span<const char *const>());
+    } catch (const taguchi::error &e) {
+        thrown = true;
+        ASSERT(std::string_view(e.what()).find("taguchi_add_factor") != std::string_view::npos);
+    }
+    ASSERT_TRUE(thrown);
+    ASSERT_EQ(def.factor_count(), 0u);
+}
+
+int main() {
+    RUN_TEST(cpp_design_views_match_c_api);
+    RUN_TEST(cpp_moves_transfer_ownership);
+    RUN_TEST(cpp_build_analyze_recommend);
+    RUN_TEST(cpp_errors_throw_library_message);
+    printf("C++ API tests passed!\n");
+    return 0;
+}
@@ -167,6 +167,27 @@ check_output "end-to-end: --minimize reflected in analyze output" \
     "minimizing" \
     "$TAGUCHI" analyze "$TGU" "$MULTI_CSV" --metric T_fridge_C --minimize
 
+# --- conditional effects (--where) -------------------------------------------
+# Runs 4-6 are both_ends: pressure means are those three runs alone
+
+check_output "where: pressure means given endpoint_type=both_ends" \
+    "pressure.*L1=3.100, L2=2.870, L3=3.330" \
+    "$TAGUCHI" effects "$TGU" "$MULTI_CSV" --metric system_COP --where endpoint_type=both_ends
+
+check_output "where: levels outside the slice show '-'" \
+    "endpoint_type.*L1=-, L2=3.215, L3=-" \
+    "$TAGUCHI" effects "$TGU" "$MULTI_CSV" --metric system_COP --where endpoint_type=both_ends \
+    --where pressure=low,high
+
+check_output "where: analyze reports the slice size" \
+    "Given endpoint_type=mixed,endpoint_only (6 of 9 runs)" \
+    "$TAGUCHI" analyze "$TGU" "$MULTI_CSV" --metric system_COP --where endpoint_type=mixed,endpoint_only
+
+check_fails_with \
+    "where: unknown level is rejected" \
+    "no level 'sideways'" \
+    "$TAGUCHI" effects "$TGU" "$MULTI_CSV" --metric system_COP --where pressure=sideways
+
 # --- expected failure cases --------------------------------------------------
 
 check_fails_with \
@@ -179,6 +200,48 @@ check_fails_with \
     "No header row" \
     "$TAGUCHI" effects "$TGU" "$NO_HDR_CSV" --metric system_COP
 
+# --- response curves of numeric factors -------------------------------------
+# threads peaks between the tested 4 and 8; cache grows with size
+
+NUM_TGU="$TMPDIR_TEST/numeric.tgu"
+cat > "$NUM_TGU" << 'EOF'
+factors:
+  threads: 2, 4, 8
+  cache: 64M, 128M, 256M
+  codec: lz4, zstd, none
+array: L9
+EOF
+
+NUM_CSV="$TMPDIR_TEST/numeric.csv"
+cat > "$NUM_CSV" << 'EOF'
+run_id,throughput
+1,92
+2,94
+3,97
+4,100
+5,101
+6,101
+7,92
+8,92
+9,92
+EOF
+
+check_output "curves: analyze interpolates the threads optimum" \
+    "threads .*100.0%  *4.78125  *101.209  L2=100.667$" \
+    "$TAGUCHI" analyze "$NUM_TGU" "$NUM_CSV"
+
+check_output "curves: cache optimum at the largest tested size" \
+    "cache .*2.68435e+08 .*(optimum at range end)" \
+    "$TAGUCHI" analyze "$NUM_TGU" "$NUM_CSV"
+
+check_output "curves: linear fit of threads ends at a range end" \
+    "threads .*19.2%  *2  .*(optimum at range end)" \
+    "$TAGUCHI" analyze "$NUM_TGU" "$NUM_CSV" --degree 1
+
+check_fails_with "curves: --degree outside 1-3 rejected" \
+    "invalid value '4' for --degree" \
+    "$TAGUCHI" analyze "$NUM_TGU" "$NUM_CSV" --degree 4
+
 # --- summary -----------------------------------------------------------------
 
 printf "\nCSV multi-column metric tests: %d passed, %d failed\n" "$PASS" "$FAIL"
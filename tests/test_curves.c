@@ -0,0 +1,159 @@
+#include "test_framework.h"
+#include "include/taguchi.h"
+#include "src/lib/parser.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *curves_l9_def =
+    "factors:\n"
+    "  threads: 2, 4, 8\n"
+    "  cache: 64M, 128M, 256M\n"
+    "  codec: lz4, zstd, none\n"
+    "array: L9\n";
+
+/* Peak at 5 threads, linear in cache size, codec has no effect */
+static taguchi_result_set_t *curves_l9_results(taguchi_experiment_def_t *def) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_run_t **runs = NULL;
+    size_t count = 0;
+    ASSERT_EQ(taguchi_generate_runs(def, &runs, &count, error), 0);
+    taguchi_result_set_t *results = taguchi_create_result_set(def, "y");
+    for (size_t i = 0; i < count; i++) {
+        double t = atof(taguchi_run_get_value(runs[i], "threads"));
+        double mib = atof(taguchi_run_get_value(runs[i], "cache"));
+        double y = 100.0 - (t - 5.0) * (t - 5.0) + mib / 64.0;
+        ASSERT_EQ(taguchi_add_result(results, taguchi_run_get_id(runs[i]), y, error), 0);
+    }
+    taguchi_free_runs(runs, count);
+    return results;
+}
+
+TEST(numeric_levels_detected_at_parse) {
+    double v = 0.0;
+    ASSERT_TRUE(parse_numeric_level("64M", &v));
+    ASSERT_EQ(v, 64.0 * 1024 * 1024);
+    ASSERT_TRUE(parse_numeric_level("8k", &v));
+    ASSERT_EQ(v, 8192.0);
+    ASSERT_TRUE(parse_numeric_level("1e-3", &v));
+    ASSERT_EQ(v, 1e-3);
+    ASSERT_TRUE(parse_numeric_level("-2", &v));
+    ASSERT_EQ(v, -2.0);
+    ASSERT_FALSE(parse_numeric_level("lz4", &v));
+    ASSERT_FALSE(parse_numeric_level("1.2.3", &v));
+    ASSERT_FALSE(parse_numeric_level("0x10", &v));
+    ASSERT_FALSE(parse_numeric_level("inf", &v));
+    ASSERT_FALSE(parse_numeric_level("1e308T", &v));
+    ASSERT_FALSE(parse_numeric_level("64MB", &v));
+
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(curves_l9_def, error);
+    ASSERT_NOT_NULL(def);
+    const double *threads = taguchi_def_get_numeric_levels(def, 0);
+    ASSERT_NOT_NULL(threads);
+    ASSERT_EQ(threads[2], 8.0);
+    ASSERT_NOT_NULL(taguchi_def_get_numeric_levels(def, 1));
+    ASSERT_TRUE(taguchi_def_get_numeric_levels(def, 2) == NULL);
+    ASSERT_TRUE(taguchi_def_get_numeric_levels(def, 3) == NULL);
+    taguchi_free_definition(def);
+}
+
+TEST(curve_interpolates_peak_between_levels) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(curves_l9_def, error);
+    ASSERT_NOT_NULL(def);
+    taguchi_result_set_t *results = curves_l9_results(def);
+
+    taguchi_response_curve_t *curves = NULL;
+    size_t count = 0;
+    ASSERT_EQ(taguchi_fit_response_curves(results, NULL, &curves, &count, error), 0);
+    ASSERT_EQ(count, 2);
+
+    /* Three unevenly spaced points: the quadratic is exact */
+    const taguchi_response_curve_t *threads = &curves[0];
+    ASSERT_STR_EQ(threads->factor, "threads");
+    ASSERT_EQ(threads->points, 3);
+    ASSERT_EQ(threads->degree, 2);
+    ASSERT_TRUE(threads->interior);
+    ASSERT_DOUBLE_EQ(threads->optimum, 5.0, 1e-9);
+    ASSERT_DOUBLE_EQ(threads->predicted, 100.0 + 7.0 / 3.0, 1e-9);
+    ASSERT_DOUBLE_EQ(threads->best_level_mean, 99.0 + 7.0 / 3.0, 1e-9);
+    ASSERT_DOUBLE_EQ(threads->fit_share, 1.0, 1e-9);
+    ASSERT_TRUE(threads->contrast[1] < 0.0);    /* a peak */
+    ASSERT_TRUE(isnan(threads->contrast[2]));
+    ASSERT_DOUBLE_EQ(taguchi_curve_predict(threads, 3.0), 96.0 + 7.0 / 3.0, 1e-9);
+
+    /* Linear in bytes: all of it in the linear contrast, best at an end */
+    const taguchi_response_curve_t *cache = &curves[1];
+    ASSERT_STR_EQ(cache->factor, "cache");
+    ASSERT_DOUBLE_EQ(cache->contrast_share[0], 1.0, 1e-9);
+    ASSERT_DOUBLE_EQ(cache->contrast_share[1], 0.0, 1e-9);
+    ASSERT_TRUE(cache->contrast[0] > 0.0);
+    ASSERT_FALSE(cache->interior);
+    ASSERT_EQ(cache->optimum, 256.0 * 1024 * 1024);
+    taguchi_free_response_curves(curves);
+
+    taguchi_curve_options_t opts;
+    taguchi_curve_options_init(&opts);
+    opts.higher_is_better = false;
+    opts.degree = 1;
+    ASSERT_EQ(taguchi_fit_response_curves(results, &opts, &curves, &count, error), 0);
+    ASSERT_EQ(curves[0].degree, 1);
+    ASSERT_FALSE(curves[0].interior);
+    ASSERT_EQ(curves[1].optimum, 64.0 * 1024 * 1024);
+    ASSERT_EQ(curves[1].best_level, 0);
+    taguchi_free_response_curves(curves);
+
+    opts.degree = 4;
+    ASSERT_EQ(taguchi_fit_response_curves(results, &opts, &curves, &count, error), -1);
+    ASSERT_TRUE(strstr(error, "degree") != NULL);
+
+    taguchi_free_result_set(results);
+    taguchi_free_definition(def);
+}
+
+TEST(cubic_curve_recovers_polynomial) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(
+        "factors:\n  x: 0, 1, 2, 3, 4\n  other: a, b, c, d, e\narray: L25\n", error);
+    ASSERT_NOT_NULL(def);
+    taguchi_experiment_run_t **runs = NULL;
+    size_t run_count = 0;
+    ASSERT_EQ(taguchi_generate_runs(def, &runs, &run_count, error), 0);
+    taguchi_result_set_t *results = taguchi_create_result_set(def, "y");
+    for (size_t i = 0; i < run_count; i++) {
+        double x = atof(taguchi_run_get_value(runs[i], "x"));
+        /* Stationary points at x = 2 -+ sqrt(7/6): a maximum, then a minimum */
+        double y = x * x * x - 6.0 * x * x + 8.5 * x;
+        ASSERT_EQ(taguchi_add_result(results, taguchi_run_get_id(runs[i]), y, error), 0);
+    }
+    taguchi_free_runs(runs, run_count);
+
+    taguchi_curve_options_t opts;
+    taguchi_curve_options_init(&opts);
+    opts.degree = 3;
+    taguchi_response_curve_t *curves = NULL;
+    size_t count = 0;
+    ASSERT_EQ(taguchi_fit_response_curves(results, &opts, &curves, &count, error), 0);
+    ASSERT_EQ(count, 1);
+    ASSERT_EQ(curves[0].points, 5);
+    ASSERT_DOUBLE_EQ(curves[0].fit_share, 1.0, 1e-9);
+    ASSERT_DOUBLE_EQ(taguchi_curve_predict(&curves[0], 2.5), 2.5 * 2.5 * 2.5 - 6.0 * 6.25 + 21.25,
+                     1e-9);
+    double x_max = 2.0 - sqrt(7.0 / 6.0);
+    ASSERT_TRUE(curves[0].interior);
+    ASSERT_DOUBLE_EQ(curves[0].optimum, x_max, 1e-9);
+    ASSERT_DOUBLE_EQ(curves[0].predicted, x_max * x_max * x_max - 6.0 * x_max * x_max + 8.5 * x_max,
+                     1e-9);
+    /* The best tested level is x = 1 */
+    ASSERT_EQ(curves[0].best_level, 1);
+    taguchi_free_response_curves(curves);
+
+    opts.higher_is_better = false;
+    ASSERT_EQ(taguchi_fit_response_curves(results, &opts, &curves, &count, error), 0);
+    ASSERT_DOUBLE_EQ(curves[0].optimum, 2.0 + sqrt(7.0 / 6.0), 1e-9);
+    taguchi_free_response_curves(curves);
+
+    taguchi_free_result_set(results);
+    taguchi_free_definition(def);
+}
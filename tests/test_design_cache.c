@@ -0,0 +1,194 @@
+#define _POSIX_C_SOURCE 200809L
+#include "test_framework.h"
+#include "src/lib/design_cache.h"
+#include "src/lib/generator.h"
+#include "src/lib/arrays.h"
+#include "src/lib/parser.h"
+#include "include/taguchi.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+
+static const char *cache_l9_def =
+    "factors:\n"
+    "  a: 1, 2, 3\n"
+    "  b: x, y, z\n"
+    "  c: lo, hi\n"
+    "array: L9\n";
+
+/* Fresh cache directory on the default context; removed again by remove_cache_dir */
+static void make_cache_dir(char *dir, size_t size) {
+    snprintf(dir, size, "/tmp/taguchi_cache_test.XXXXXX");
+    ASSERT_NOT_NULL(mkdtemp(dir));
+    ASSERT_EQ(taguchi_set_design_cache_dir(dir, NULL), 0);
+}
+
+static void remove_cache_dir(const char *dir) {
+    taguchi_set_design_cache_dir(NULL, NULL);
+    DIR *d = opendir(dir);
+    if (!d) return;
+    struct dirent *ent;
+    char path[1024];
+    while ((ent = readdir(d)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+        snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+        unlink(path);
+    }
+    closedir(d);
+    rmdir(dir);
+}
+
+static void entry_path_for(char *path, size_t size, const char *dir, const ExperimentDef *def) {
+    snprintf(path, size, "%s/%016llx.tgd", dir, (unsigned long long)design_cache_key(def));
+}
+
+TEST(compiled_design_matches_generated_runs) {
+    ExperimentDef def;
+    char error[256];
+    ASSERT_EQ(parse_experiment_def_from_string(cache_l9_def, &def, error), 0);
+
+    CompiledDesign design;
+    ASSERT_EQ(compile_design(NULL, &def, &design, error), 0);
+    ASSERT_STR_EQ(design.array_name, "L9");
+    ASSERT_EQ(design.rows, 9);
+    ASSERT_EQ(design.factor_count, 3);
+
+    ExperimentRun *runs = NULL;
+    size_t count = 0;
+    ASSERT_EQ(generate_experiments(&def, &runs, &count, error), 0);
+    ASSERT_EQ(count, design.rows);
+    for (size_t r = 0; r < count; r++) {
+        for (size_t f = 0; f < def.factor_count; f++) {
+            ASSERT_EQ(runs[r].level_indices[f], design.levels[r * design.factor_count + f]);
+        }
+    }
+    free_experiments(runs, count);
+    free_compiled_design(&design);
+}
+
+/* Definition text with one factor per entry of level_counts */
+static void kernel_def_text(char *buf, size_t size, const char *array,
+                            const size_t *level_counts, size_t count) {
+    size_t pos = (size_t)snprintf(buf, size, "factors:\n");
+    for (size_t f = 0; f < count; f++) {
+        pos += (size_t)snprintf(buf + pos, size - pos, "  f%zu: ", f);
+        for (size_t lv = 0; lv < level_counts[f]; lv++) {
+            pos += (size_t)snprintf(buf + pos, size - pos, "%sv%zu", lv ? ", " : "", lv);
+        }
+        pos += (size_t)snprintf(buf + pos, size - pos, "\n");
+    }
+    snprintf(buf + pos, size - pos, "array: %s\n", array);
+}
+
+TEST(compiled_design_kernels_match_reference) {
+    /* Single, paired, tripled and wider factors in every base */
+    static const struct {
+        const char *array;
+        size_t level_counts[5];
+        size_t count;
+    } cases[] = {
+        { "L64", { 2, 3, 5, 9, 2 }, 5 },
+        { "L81", { 3, 2, 9, 27, 3 }, 5 },
+        { "L125", { 5, 7, 27, 3, 2 }, 5 },
+        { "L18", { 2, 3, 3 }, 3 },
+    };
+    char text[2048];
+    char error[256];
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        ExperimentDef def;
+        kernel_def_text(text, sizeof(text), cases[i].array, cases[i].level_counts, cases[i].count);
+        ASSERT_EQ(parse_experiment_def_from_string(text, &def, error), 0);
+        CompiledDesign design;
+        ASSERT_EQ(compile_design(NULL, &def, &design, error), 0);
+        const OrthogonalArray *array = get_array(cases[i].array);
+        ASSERT_NOT_NULL(array);
+        ASSERT_EQ(design.rows, array->rows);
+
+        /* Columns read as base-`levels` digits, folded by the level count */
+        for (size_t r = 0; r < design.rows; r++) {
+            for (size_t f = 0; f < def.factor_count; f++) {
+                size_t value = 0;
+                for (size_t c = 0; c < design.col_count[f]; c++) {
+                    value = value * array->levels +
+                            (size_t)array->data[r * array->cols + design.col_start[f] + c];
+                }
+                ASSERT_EQ(design.levels[r * design.factor_count + f],
+                          value % def.factors[f].level_count);
+            }
+        }
+        free_compiled_design(&design);
+    }
+}
+
+TEST(cache_key_ignores_names_and_values) {
+    ExperimentDef a, b, c;
+    char error[256];
+    ASSERT_EQ(parse_experiment_def_from_string(cache_l9_def, &a, error), 0);
+    ASSERT_EQ(parse_experiment_def_from_string(
+        "factors:\n  speed: slow, medium, fast\n  mode: p, q, r\n  flag: on, off\narray: L9\n",
+        &b, error), 0);
+    ASSERT_EQ(parse_experiment_def_from_string(
+        "factors:\n  a: 1, 2, 3\n  b: x, y, z\n  c: lo, hi, mid\narray: L9\n",
+        &c, error), 0);
+    ASSERT_EQ(design_cache_key(&a), design_cache_key(&b));
+    ASSERT_NE(design_cache_key(&a), design_cache_key(&c));
+}
+
+TEST(cache_roundtrip_maps_stored_design) {
+    char dir[64];
+    make_cache_dir(dir, sizeof(dir));
+
+    ExperimentDef def;
+    char error[256];
+    ASSERT_EQ(parse_experiment_def_from_string(cache_l9_def, &def, error), 0);
+
+    CompiledDesign miss;
+    ASSERT_EQ(design_cache_load(dir, &def, &miss), -1);
+
+    /* First acquire compiles and stores, second maps the file */
+    CompiledDesign first, second;
+    ASSERT_EQ(acquire_design(NULL, &def, &first, error), 0);
+    ASSERT_NULL(first.mapping);
+    ASSERT_EQ(acquire_design(NULL, &def, &second, error), 0);
+    ASSERT_NOT_NULL(second.mapping);
+    ASSERT_STR_EQ(second.array_name, first.array_name);
+    ASSERT_EQ(second.rows, first.rows);
+    ASSERT_EQ(memcmp(second.levels, first.levels, first.rows * first.factor_count), 0);
+    ASSERT_EQ(memcmp(second.col_start, first.col_start, first.factor_count * sizeof(uint32_t)), 0);
+    free_compiled_design(&first);
+    free_compiled_design(&second);
+
+    remove_cache_dir(dir);
+}
+
+TEST(cache_rejects_corrupt_entry) {
+    char dir[64];
+    make_cache_dir(dir, sizeof(dir));
+
+    ExperimentDef def;
+    char error[256];
+    ASSERT_EQ(parse_experiment_def_from_string(cache_l9_def, &def, error), 0);
+
+    CompiledDesign design;
+    ASSERT_EQ(acquire_design(NULL, &def, &design, error), 0);
+    free_compiled_design(&design);
+
+    /* Truncate the entry: load must miss and generation must still succeed */
+    char path[1024];
+    entry_path_for(path, sizeof(path), dir, &def);
+    ASSERT_EQ(truncate(path, 20), 0);
+    ASSERT_EQ(design_cache_load(dir, &def, &design), -1);
+
+    ExperimentRun *runs = NULL;
+    size_t count = 0;
+    ASSERT_EQ(generate_experiments(&def, &runs, &count, error), 0);
+    ASSERT_EQ(count, 9);
+    free_experiments(runs, count);
+
+    /* ...and the entry was rewritten */
+    ASSERT_EQ(design_cache_load(dir, &def, &design), 0);
+    free_compiled_design(&design);
+
+    remove_cache_dir(dir);
+}
@@ -0,0 +1,204 @@
+#define _POSIX_C_SOURCE 200809L
+#include "test_framework.h"
+#include "include/taguchi.h"
+#include <stdint.h>
+#include <poll.h>
+#include <unistd.h>
+#include <pthread.h>
+
+static const char *future_l9_def =
+    "factors:\n"
+    "  a: 1, 2, 3\n"
+    "  b: x, y, z\n"
+    "  c: lo, hi\n"
+    "array: L9\n";
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int calls;
+    taguchi_future_status_t seen;
+} CallbackLog;
+
+static void record_completion(taguchi_future_t *future, void *user) {
+    CallbackLog *log = user;
+    pthread_mutex_lock(&log->lock);
+    log->calls++;
+    log->seen = taguchi_future_status(future);
+    pthread_cond_broadcast(&log->cond);
+    pthread_mutex_unlock(&log->lock);
+}
+
+static void wait_for_callback(CallbackLog *log) {
+    pthread_mutex_lock(&log->lock);
+    while (log->calls == 0) {
+        pthread_cond_wait(&log->cond, &log->lock);
+    }
+    pthread_mutex_unlock(&log->lock);
+}
+
+TEST(future_generate_signals_fd_and_callback) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(future_l9_def, error);
+    ASSERT_NOT_NULL(def);
+
+    CallbackLog log = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, TAGUCHI_FUTURE_PENDING };
+    taguchi_future_t *future = taguchi_generate_runs_async(NULL, def, record_completion, &log, error);
+    ASSERT_NOT_NULL(future);
+
+    /* The eventfd is pollable and becomes readable on completion */
+    int fd = taguchi_future_fd(future);
+    ASSERT(fd >= 0);
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    ASSERT_EQ(poll(&pfd, 1, 5000), 1);
+    uint64_t value = 0;
+    ASSERT_EQ(read(fd, &value, sizeof(value)), (ssize_t)sizeof(value));
+    ASSERT_EQ(value, 1);
+
+    ASSERT_EQ(taguchi_future_wait(future, -1), TAGUCHI_FUTURE_DONE);
+    wait_for_callback(&log);
+    ASSERT_EQ(log.calls, 1);
+    ASSERT_EQ(log.seen, TAGUCHI_FUTURE_DONE);
+
+    taguchi_experiment_run_t **runs = NULL;
+    size_t count = 0;
+    ASSERT_EQ(taguchi_future_take_runs(future, &runs, &count, error), 0);
+    ASSERT_EQ(count, 9);
+    ASSERT_STR_EQ(taguchi_run_get_value(runs[0], "b"), "x");
+    /* Ownership moved: a second take and a take of the wrong kind fail */
+    ASSERT_EQ(taguchi_future_take_runs(future, &runs, &count, error), -1);
+    taguchi_main_effect_t **effects = NULL;
+    ASSERT_EQ(taguchi_future_take_effects(future, &effects, &count, error), -1);
+
+    taguchi_free_runs(runs, 9);
+    taguchi_future_free(future);
+    taguchi_free_definition(def);
+}
+
+TEST(future_effects_match_sync) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(future_l9_def, error);
+    ASSERT_NOT_NULL(def);
+    taguchi_result_set_t *results = taguchi_create_result_set(def, "y");
+    for (size_t id = 1; id <= 9; id++) {
+        ASSERT_EQ(taguchi_add_result(results, id, (double)(id * id), error), 0);
+    }
+
+    taguchi_future_t *future = taguchi_calculate_main_effects_async(NULL, results, NULL, NULL, error);
+    ASSERT_NOT_NULL(future);
+    ASSERT_EQ(taguchi_future_wait(future, -1), TAGUCHI_FUTURE_DONE);
+    ASSERT_STR_EQ(taguchi_future_error(future), "");
+
+    taguchi_main_effect_t **a = NULL, **b = NULL;
+    size_t na = 0, nb = 0;
+    ASSERT_EQ(taguchi_future_take_effects(future, &a, &na, error), 0);
+    ASSERT_EQ(taguchi_calculate_main_effects(results, &b, &nb, error), 0);
+    ASSERT_EQ(na, nb);
+    for (size_t i = 0; i < na; i++) {
+        ASSERT_DOUBLE_EQ(taguchi_effect_get_range(a[i]), taguchi_effect_get_range(b[i]), 1e-12);
+    }
+    taguchi_free_effects(a, na);
+    taguchi_free_effects(b, nb);
+    taguchi_future_free(future);
+    taguchi_free_result_set(results);
+    taguchi_free_definition(def);
+}
+
+/* Holds a pool thread inside a parallel_for chunk until released */
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int started;
+    bool release;
+} Blocker;
+
+static void block_worker(void *arg, size_t begin, size_t end) {
+    (void)begin;
+    (void)end;
+    Blocker *b = arg;
+    pthread_mutex_lock(&b->lock);
+    b->started++;
+    pthread_cond_broadcast(&b->cond);
+    while (!b->release) {
+        pthread_cond_wait(&b->cond, &b->lock);
+    }
+    pthread_mutex_unlock(&b->lock);
+}
+
+static void *run_blocker(void *arg) {
+    void **args = arg;
+    taguchi_context_parallel_for(args[0], 2, 1, block_worker, args[1]);
+    return NULL;
+}
+
+TEST(future_cancel_before_start) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_context_options_t opts;
+    taguchi_context_options_init(&opts);
+    opts.max_workers = 2;
+    taguchi_context_t *ctx = taguchi_context_create(&opts, error);
+    ASSERT_NOT_NULL(ctx);
+    taguchi_experiment_def_t *def = taguchi_parse_definition(future_l9_def, error);
+    ASSERT_NOT_NULL(def);
+
+    /* Tie up both threads of the context so the future stays queued */
+    Blocker blocker = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, false };
+    void *args[2] = { ctx, &blocker };
+    pthread_t thread;
+    ASSERT_EQ(pthread_create(&thread, NULL, run_blocker, args), 0);
+    pthread_mutex_lock(&blocker.lock);
+    while (blocker.started < 2) {
+        pthread_cond_wait(&blocker.cond, &blocker.lock);
+    }
+    pthread_mutex_unlock(&blocker.lock);
+
+    CallbackLog log = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, TAGUCHI_FUTURE_PENDING };
+    taguchi_future_t *future = taguchi_generate_runs_async(ctx, def, record_completion, &log, error);
+    ASSERT_NOT_NULL(future);
+    ASSERT_EQ(taguchi_future_wait(future, 10), TAGUCHI_FUTURE_PENDING);
+    ASSERT_EQ(taguchi_future_cancel(future), 0);
+
+    pthread_mutex_lock(&blocker.lock);
+    blocker.release = true;
+    pthread_cond_broadcast(&blocker.cond);
+    pthread_mutex_unlock(&blocker.lock);
+    pthread_join(thread, NULL);
+
+    ASSERT_EQ(taguchi_future_wait(future, -1), TAGUCHI_FUTURE_CANCELLED);
+    wait_for_callback(&log);
+    ASSERT_EQ(log.seen, TAGUCHI_FUTURE_CANCELLED);
+    ASSERT_EQ(taguchi_future_cancel(future), -1);
+
+    taguchi_experiment_run_t **runs = NULL;
+    size_t count = 0;
+    ASSERT_EQ(taguchi_future_take_runs(future, &runs, &count, error), -1);
+
+    taguchi_future_free(future);
+    taguchi_free_definition(def);
+    taguchi_context_free(ctx);
+}
+
+static void free_in_callback(taguchi_future_t *future, void *user) {
+    taguchi_experiment_run_t **runs = NULL;
+    size_t count = 0;
+    char error[TAGUCHI_ERROR_SIZE];
+    if (taguchi_future_take_runs(future, &runs, &count, error) == 0) {
+        taguchi_free_runs(runs, count);
+    }
+    taguchi_future_free(future);
+    record_completion(future, user);
+}
+
+TEST(future_free_from_callback) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(future_l9_def, error);
+    ASSERT_NOT_NULL(def);
+
+    CallbackLog log = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, TAGUCHI_FUTURE_PENDING };
+    ASSERT_NOT_NULL(taguchi_generate_runs_async(NULL, def, free_in_callback, &log, error));
+    wait_for_callback(&log);
+    ASSERT_EQ(log.calls, 1);
+    /* Still valid: the task holds its reference until the callback returns */
+    ASSERT_EQ(log.seen, TAGUCHI_FUTURE_DONE);
+    taguchi_free_definition(def);
+}
@@ -0,0 +1,181 @@
+#include "test_framework.h"
+#include "include/taguchi.h"
+#include <pthread.h>
+#include <sched.h>
+
+static const char *ingest_l9_def =
+    "factors:\n"
+    "  a: 1, 2, 3\n"
+    "  b: x, y, z\n"
+    "  c: lo, mid, hi\n"
+    "array: L9\n";
+
+TEST(ingest_effects_match_result_set) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(ingest_l9_def, error);
+    ASSERT_NOT_NULL(def);
+    taguchi_ingest_t *ingest = taguchi_ingest_create(def, 64, error);
+    ASSERT_NOT_NULL(ingest);
+
+    /* Two replicates of every run plus one result for a run that does not exist */
+    for (size_t rep = 0; rep < 2; rep++) {
+        for (size_t id = 1; id <= 9; id++) {
+            ASSERT_EQ(taguchi_ingest_push(ingest, id, (double)(id * 3 + rep)), 0);
+        }
+    }
+    ASSERT_EQ(taguchi_ingest_push(ingest, 42, 1.0), 0);
+    ASSERT_EQ(taguchi_ingest_drain(ingest, 0), 19);
+    ASSERT_EQ(taguchi_ingest_rejected(ingest), 1);
+
+    double mean = 0.0;
+    size_t count = 0;
+    ASSERT_EQ(taguchi_ingest_run_stats(ingest, 4, &mean, &count), 0);
+    ASSERT_EQ(count, 2);
+    ASSERT_DOUBLE_EQ(mean, 12.5, 1e-12);
+    ASSERT_EQ(taguchi_ingest_run_stats(ingest, 10, &mean, &count), -1);
+
+    taguchi_main_effect_t **live = NULL, **batch = NULL;
+    size_t nl = 0, nb = 0, observations = 0;
+    ASSERT_EQ(taguchi_ingest_snapshot_effects(ingest, &live, &nl, &observations, error), 0);
+    ASSERT_EQ(observations, 18);
+
+    taguchi_result_set_t *results = taguchi_ingest_to_result_set(ingest, "y");
+    ASSERT_NOT_NULL(results);
+    ASSERT_EQ(taguchi_calculate_main_effects(results, &batch, &nb, error), 0);
+    ASSERT_EQ(nl, nb);
+    for (size_t i = 0; i < nl; i++) {
+        size_t ll = 0, lb = 0;
+        const double *ml = taguchi_effect_get_level_means(live[i], &ll);
+        const double *mb = taguchi_effect_get_level_means(batch[i], &lb);
+        ASSERT_EQ(ll, lb);
+        for (size_t lv = 0; lv < ll; lv++) {
+            ASSERT_DOUBLE_EQ(ml[lv], mb[lv], 1e-9);
+        }
+        ASSERT_DOUBLE_EQ(taguchi_effect_get_range(live[i]), taguchi_effect_get_range(batch[i]), 1e-9);
+    }
+
+    taguchi_free_effects(live, nl);
+    taguchi_free_effects(batch, nb);
+    taguchi_free_result_set(results);
+    taguchi_ingest_free(ingest);
+    taguchi_free_definition(def);
+}
+
+TEST(ingest_full_ring_drops) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(ingest_l9_def, error);
+    ASSERT_NOT_NULL(def);
+    taguchi_ingest_t *ingest = taguchi_ingest_create(def, 3, error);   /* rounds up to 4 */
+    ASSERT_NOT_NULL(ingest);
+
+    for (size_t i = 0; i < 4; i++) {
+        ASSERT_EQ(taguchi_ingest_push(ingest, 1, 1.0), 0);
+    }
+    ASSERT_EQ(taguchi_ingest_push(ingest, 1, 1.0), -1);
+    ASSERT_EQ(taguchi_ingest_dropped(ingest), 1);
+
+    /* Partial drains free slots for producers again */
+    ASSERT_EQ(taguchi_ingest_drain(ingest, 2), 2);
+    ASSERT_EQ(taguchi_ingest_push(ingest, 2, 1.0), 0);
+    ASSERT_EQ(taguchi_ingest_drain(ingest, 0), 3);
+    ASSERT_EQ(taguchi_ingest_drain(ingest, 0), 0);
+
+    taguchi_ingest_free(ingest);
+    taguchi_free_definition(def);
+}
+
+#define INGEST_PRODUCERS 4
+#define INGEST_PER_PRODUCER 20000
+
+typedef struct {
+    taguchi_ingest_t *ingest;
+    size_t producers_done;      /* atomic */
+    size_t snapshots;
+    int reader_error;
+} IngestStress;
+
+static void *ingest_producer(void *arg) {
+    IngestStress *st = arg;
+    for (size_t i = 0; i < INGEST_PER_PRODUCER; i++) {
+        size_t run_id = i % 9 + 1;
+        while (taguchi_ingest_push(st->ingest, run_id, (double)run_id) != 0) {
+            sched_yield();
+        }
+    }
+    __atomic_add_fetch(&st->producers_done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/* Snapshots must only ever grow and stay within the pushed response range */
+static void *ingest_reader(void *arg) {
+    IngestStress *st = arg;
+    size_t last = 0;
+    char error[TAGUCHI_ERROR_SIZE];
+    while (__atomic_load_n(&st->producers_done, __ATOMIC_ACQUIRE) < INGEST_PRODUCERS) {
+        taguchi_main_effect_t **effects = NULL;
+        size_t count = 0, observations = 0;
+        if (taguchi_ingest_snapshot_effects(st->ingest, &effects, &count, &observations, error) != 0) {
+            st->reader_error = 1;
+            break;
+        }
+        if (observations < last) st->reader_error = 1;
+        last = observations;
+        for (size_t i = 0; i < count; i++) {
+            size_t levels = 0;
+            const double *means = taguchi_effect_get_level_means(effects[i], &levels);
+            for (size_t lv = 0; lv < levels; lv++) {
+                if (means[lv] < 0.0 || means[lv] > 9.0) st->reader_error = 1;
+            }
+        }
+        taguchi_free_effects(effects, count);
+        st->snapshots++;
+    }
+    return NULL;
+}
+
+TEST(ingest_concurrent_producers_and_reader) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(ingest_l9_def, error);
+    ASSERT_NOT_NULL(def);
+
+    IngestStress st;
+    memset(&st, 0, sizeof(st));
+    st.ingest = taguchi_ingest_create(def, 1024, error);
+    ASSERT_NOT_NULL(st.ingest);
+
+    pthread_t producers[INGEST_PRODUCERS], reader;
+    for (size_t i = 0; i < INGEST_PRODUCERS; i++) {
+        ASSERT_EQ(pthread_create(&producers[i], NULL, ingest_producer, &st), 0);
+    }
+    ASSERT_EQ(pthread_create(&reader, NULL, ingest_reader, &st), 0);
+
+    /* This thread is the single consumer */
+    size_t drained = 0;
+    while (__atomic_load_n(&st.producers_done, __ATOMIC_ACQUIRE) < INGEST_PRODUCERS) {
+        drained += taguchi_ingest_drain(st.ingest, 0);
+    }
+    for (size_t i = 0; i < INGEST_PRODUCERS; i++) {
+        pthread_join(producers[i], NULL);
+    }
+    drained += taguchi_ingest_drain(st.ingest, 0);
+    pthread_join(reader, NULL);
+
+    ASSERT_EQ(st.reader_error, 0);
+    ASSERT_EQ(drained, INGEST_PRODUCERS * INGEST_PER_PRODUCER);
+
+    /* Every response equals its run ID, so each run's mean is exact */
+    for (size_t id = 1; id <= 9; id++) {
+        double mean = 0.0;
+        size_t count = 0;
+        ASSERT_EQ(taguchi_ingest_run_stats(st.ingest, id, &mean, &count), 0);
+        ASSERT_DOUBLE_EQ(mean, (double)id, 1e-9);
+    }
+    taguchi_main_effect_t **effects = NULL;
+    size_t count = 0, observations = 0;
+    ASSERT_EQ(taguchi_ingest_snapshot_effects(st.ingest, &effects, &count, &observations, error), 0);
+    ASSERT_EQ(observations, INGEST_PRODUCERS * INGEST_PER_PRODUCER);
+    taguchi_free_effects(effects, count);
+
+    taguchi_ingest_free(st.ingest);
+    taguchi_free_definition(def);
+}
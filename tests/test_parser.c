@@ -127,4 +127,63 @@ TEST(validate_empty_factor_name) {
     char error[TAGUCHI_ERROR_SIZE];
     bool valid = validate_experiment_def(&def, error);
     ASSERT_FALSE(valid);
-}
\ No newline at end of file
+}
+
+TEST(level_types_parsed_once) {
+    int64_t i = 0;
+    bool b = false;
+    ASSERT_TRUE(parse_int_level("64M", &i));
+    ASSERT_EQ(i, 64LL << 20);
+    ASSERT_TRUE(parse_int_level("-3", &i));
+    ASSERT_EQ(i, -3);
+    ASSERT_FALSE(parse_int_level("1e3", &i));
+    ASSERT_FALSE(parse_int_level("0.5", &i));
+    ASSERT_FALSE(parse_int_level("9223372036854775807K", &i));
+    ASSERT_TRUE(parse_bool_level("On", &b));
+    ASSERT_TRUE(b);
+    ASSERT_TRUE(parse_bool_level("FALSE", &b));
+    ASSERT_FALSE(b);
+    ASSERT_FALSE(parse_bool_level("1", &b));
+
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(
+        "factors:\n"
+        "  threads: 2, 4, 8\n"
+        "  cache: 64M, 128M, 1G\n"
+        "  rate: 1, 0.5, 1e-3\n"
+        "  turbo: yes, no\n"
+        "  codec: lz4, zstd, 7\n"
+        "array: L27\n", error);
+    ASSERT_NOT_NULL(def);
+    ASSERT_EQ(taguchi_def_get_level_type(def, 0), TAGUCHI_LEVEL_INT);
+    ASSERT_EQ(taguchi_def_get_level_type(def, 1), TAGUCHI_LEVEL_INT);
+    ASSERT_EQ(taguchi_def_get_level_type(def, 2), TAGUCHI_LEVEL_FLOAT);
+    ASSERT_EQ(taguchi_def_get_level_type(def, 3), TAGUCHI_LEVEL_BOOL);
+    ASSERT_EQ(taguchi_def_get_level_type(def, 4), TAGUCHI_LEVEL_STRING);
+    ASSERT_EQ(taguchi_def_get_level_type(def, 5), TAGUCHI_LEVEL_STRING);
+    ASSERT_STR_EQ(taguchi_level_type_name(TAGUCHI_LEVEL_FLOAT), "float");
+
+    ASSERT_EQ(taguchi_def_get_int_levels(def, 1)[2], 1LL << 30);
+    ASSERT_EQ(taguchi_def_get_int_levels(def, 3)[1], 0);
+    ASSERT_TRUE(taguchi_def_get_int_levels(def, 2) == NULL);
+    ASSERT_EQ(taguchi_def_get_numeric_levels(def, 2)[2], 1e-3);
+    ASSERT_TRUE(taguchi_def_get_numeric_levels(def, 3) == NULL);
+    ASSERT_TRUE(taguchi_def_get_numeric_levels(def, 4) == NULL);
+
+    /* Typed export: numbers and booleans unquoted, strings as before */
+    taguchi_experiment_run_t **runs = NULL;
+    size_t count = 0;
+    ASSERT_EQ(taguchi_generate_runs(def, &runs, &count, error), 0);
+    const taguchi_experiment_run_t **view = (const taguchi_experiment_run_t **)runs;
+    char *json = taguchi_runs_to_typed_json(def, view, count);
+    ASSERT_NOT_NULL(strstr(json, "{\"run_id\": 1, \"threads\": 2, \"cache\": 67108864, "
+                                 "\"rate\": 1, \"turbo\": true, \"codec\": \"lz4\"}"));
+    ASSERT_NOT_NULL(strstr(json, "\"rate\": 0.001,"));
+    ASSERT_NOT_NULL(strstr(json, "\"turbo\": false,"));
+    taguchi_free_string(json);
+    json = taguchi_runs_to_json(view, count);
+    ASSERT_NOT_NULL(strstr(json, "\"cache\": \"64M\""));
+    taguchi_free_string(json);
+    taguchi_free_runs(runs, count);
+    taguchi_free_definition(def);
+}
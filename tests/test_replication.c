@@ -0,0 +1,163 @@
+#include "test_framework.h"
+#include "src/lib/stats.h"
+#include "include/taguchi.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *replication_l4_def =
+    "factors:\n"
+    "  a: 1, 2\n"
+    "  b: 1, 2\n"
+    "  c: 1, 2\n"
+    "array: L4\n";
+
+/* Noise-free response: a adds 4 at level 2, b adds 1 */
+static double l4_response(const taguchi_experiment_run_t *run) {
+    double y = 10.0;
+    if (strcmp(taguchi_run_get_value(run, "a"), "2") == 0) y += 4.0;
+    if (strcmp(taguchi_run_get_value(run, "b"), "2") == 0) y += 1.0;
+    return y;
+}
+
+TEST(t_distribution_quantiles) {
+    /* Tabulated two-sided 95% points */
+    ASSERT_DOUBLE_EQ(t_distribution_quantile(0.975, 10.0), 2.228, 1e-3);
+    ASSERT_DOUBLE_EQ(t_distribution_quantile(0.975, 1.0), 12.706, 1e-3);
+    ASSERT_DOUBLE_EQ(t_distribution_quantile(0.5, 4.0), 0.0, 1e-9);
+    ASSERT_DOUBLE_EQ(t_distribution_quantile(0.025, 10.0), -2.228, 1e-3);
+    ASSERT_DOUBLE_EQ(t_distribution_sf(2.228, 10.0), 0.025, 1e-4);
+}
+
+TEST(main_effects_weigh_runs_equally) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(replication_l4_def, error);
+    ASSERT_NOT_NULL(def);
+    taguchi_result_set_t *results = taguchi_create_result_set(def, "y");
+    /* L4 row 1 is a=1, rows 3 and 4 are a=2; run 1 replicated three times */
+    ASSERT_EQ(taguchi_add_result(results, 1, 1.0, error), 0);
+    ASSERT_EQ(taguchi_add_result(results, 1, 2.0, error), 0);
+    ASSERT_EQ(taguchi_add_result(results, 1, 3.0, error), 0);
+    ASSERT_EQ(taguchi_add_result(results, 2, 10.0, error), 0);
+    ASSERT_EQ(taguchi_add_result(results, 3, 20.0, error), 0);
+    ASSERT_EQ(taguchi_add_result(results, 4, 30.0, error), 0);
+
+    taguchi_main_effect_t **effects = NULL;
+    size_t count = 0;
+    ASSERT_EQ(taguchi_calculate_main_effects(results, &effects, &count, error), 0);
+    size_t levels = 0;
+    const double *means = taguchi_effect_get_level_means(effects[0], &levels);
+    ASSERT_DOUBLE_EQ(means[0], (2.0 + 10.0) / 2.0, 1e-12);
+    ASSERT_DOUBLE_EQ(means[1], 25.0, 1e-12);
+
+    taguchi_free_effects(effects, count);
+    taguchi_free_result_set(results);
+    taguchi_free_definition(def);
+}
+
+TEST(plan_replicates_fills_design_first) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(replication_l4_def, error);
+    ASSERT_NOT_NULL(def);
+    taguchi_result_set_t *results = taguchi_create_result_set(def, "y");
+
+    size_t ids[8], count = 0;
+    taguchi_replication_status_t status;
+    ASSERT_EQ(taguchi_plan_replicates(results, NULL, ids, 8, &count, &status, error), 0);
+    ASSERT_EQ(count, 4);
+    ASSERT_EQ(ids[0], 1);
+    ASSERT_EQ(ids[3], 4);
+    ASSERT_FALSE(status.stable);
+
+    /* One result per run: replicates are needed for a variance */
+    for (size_t id = 1; id <= 4; id++) {
+        ASSERT_EQ(taguchi_add_result(results, id, (double)id, error), 0);
+    }
+    ASSERT_EQ(taguchi_plan_replicates(results, NULL, ids, 2, &count, &status, error), 0);
+    ASSERT_EQ(count, 2);
+    ASSERT_EQ(status.error_df, 0);
+
+    double means[2], half_widths[2];
+    ASSERT_EQ(taguchi_level_intervals(results, 0, 0.95, means, half_widths, 2, error), -1);
+    ASSERT_NOT_NULL(strstr(error, "replicated"));
+
+    taguchi_free_result_set(results);
+    taguchi_free_definition(def);
+}
+
+TEST(plan_replicates_stops_when_resolved) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(replication_l4_def, error);
+    ASSERT_NOT_NULL(def);
+    taguchi_experiment_run_t **runs = NULL;
+    size_t run_count = 0;
+    ASSERT_EQ(taguchi_generate_runs(def, &runs, &run_count, error), 0);
+
+    /* Two replicates with small noise: a and b clearly separated */
+    taguchi_result_set_t *results = taguchi_create_result_set(def, "y");
+    for (size_t i = 0; i < run_count; i++) {
+        double y = l4_response(runs[i]);
+        ASSERT_EQ(taguchi_add_result(results, i + 1, y + 0.01, error), 0);
+        ASSERT_EQ(taguchi_add_result(results, i + 1, y - 0.01, error), 0);
+    }
+
+    taguchi_replication_options_t opts;
+    taguchi_replication_options_init(&opts);
+    opts.top_factors = 2;
+    size_t ids[4], count = 99;
+    taguchi_replication_status_t status;
+    ASSERT_EQ(taguchi_plan_replicates(results, &opts, ids, 4, &count, &status, error), 0);
+    ASSERT_TRUE(status.stable);
+    ASSERT_EQ(count, 0);
+    ASSERT_EQ(status.resolved, 2);
+    ASSERT_EQ(status.error_df, 4);
+
+    /* Pooled sd of +/-0.01 pairs; interval t(0.975, 4) * sd / sqrt(4) */
+    double means[2], half_widths[2];
+    ASSERT_EQ(taguchi_level_intervals(results, 0, 0.95, means, half_widths, 2, error), 0);
+    ASSERT_DOUBLE_EQ(status.pooled_sd, sqrt(0.0002), 1e-9);
+    ASSERT_DOUBLE_EQ(half_widths[0], 2.776 * sqrt(0.0002) / 2.0, 1e-5);
+    ASSERT_DOUBLE_EQ(means[1] - means[0], 4.0, 1e-9);
+
+    taguchi_free_result_set(results);
+    taguchi_free_runs(runs, run_count);
+    taguchi_free_definition(def);
+}
+
+TEST(plan_replicates_targets_contested_levels) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(replication_l4_def, error);
+    ASSERT_NOT_NULL(def);
+
+    /* Runs 1-2 (a=1) are noisy, 3-4 (a=2) agree; a barely differs */
+    taguchi_result_set_t *results = taguchi_create_result_set(def, "y");
+    static const double first[4] = { 9.0, 11.0, 10.5, 10.5 };
+    static const double second[4] = { 11.0, 9.0, 10.6, 10.6 };
+    for (size_t i = 0; i < 4; i++) {
+        ASSERT_EQ(taguchi_add_result(results, i + 1, first[i], error), 0);
+        ASSERT_EQ(taguchi_add_result(results, i + 1, second[i], error), 0);
+    }
+    ASSERT_EQ(taguchi_add_result(results, 1, 10.0, error), 0);
+    ASSERT_EQ(taguchi_add_result(results, 2, 10.0, error), 0);
+    ASSERT_EQ(taguchi_add_result(results, 3, 10.55, error), 0);
+
+    taguchi_replication_options_t opts;
+    taguchi_replication_options_init(&opts);
+    opts.top_factors = 1;
+    size_t ids[4], count = 0;
+    taguchi_replication_status_t status;
+    ASSERT_EQ(taguchi_plan_replicates(results, &opts, ids, 1, &count, &status, error), 0);
+    ASSERT_FALSE(status.stable);
+    ASSERT_EQ(count, 1);
+    /* Only run 4 lacks a third replicate, so its next result helps most */
+    ASSERT_EQ(ids[0], 4);
+
+    ASSERT_EQ(taguchi_plan_replicates(results, &opts, ids, 4, &count, &status, error), 0);
+    ASSERT_EQ(count, 4);
+
+    opts.confidence = 1.0;
+    ASSERT_EQ(taguchi_plan_replicates(results, &opts, ids, 4, &count, &status, error), -1);
+
+    taguchi_free_result_set(results);
+    taguchi_free_definition(def);
+}
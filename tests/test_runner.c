@@ -60,6 +60,7 @@ extern void test_parse_invalid_no_factors(void);
 extern void test_parse_invalid_no_array(void);
 extern void test_validate_correct_definition(void);
 extern void test_validate_empty_factor_name(void);
+extern void test_level_types_parsed_once(void);
 
 /* Declare test functions from test_auto_select.c */
 extern void test_suggest_optimal_array_basic_2level(void);
@@ -88,6 +89,7 @@ extern void test_analyzer_create_result_set(void);
 extern void test_analyzer_create_null_inputs(void);
 extern void test_analyzer_add_result_null(void);
 extern void test_analyzer_result_set_grows(void);
+extern void test_analyzer_result_accessors(void);
 extern void test_analyzer_main_effects_l9(void);
 extern void test_analyzer_main_effects_null(void);
 extern void test_analyzer_recommend_higher_is_better(void);
@@ -133,6 +135,65 @@ extern void test_nine_level_balance_in_l81(void);
 extern void test_auto_select_prefers_smallest(void);
 extern void test_auto_select_l27_for_5_3level_factors(void);
 
+/* Declare test functions from test_design_cache.c */
+extern void test_compiled_design_matches_generated_runs(void);
+extern void test_compiled_design_kernels_match_reference(void);
+extern void test_cache_key_ignores_names_and_values(void);
+extern void test_cache_roundtrip_maps_stored_design(void);
+extern void test_cache_rejects_corrupt_entry(void);
+
+/* Declare test functions from test_context.c */
+extern void test_parallel_for_covers_each_index_once(void);
+extern void test_parallel_for_nested_calls_complete(void);
+extern void test_single_worker_context_runs_inline(void);
+extern void test_context_allocator_and_effects_match_default(void);
+extern void test_generate_runs_ctx_matches_default(void);
+extern void test_context_create_rejects_half_allocator(void);
+
+/* Declare test functions from test_future.c */
+extern void test_future_generate_signals_fd_and_callback(void);
+extern void test_future_effects_match_sync(void);
+extern void test_future_cancel_before_start(void);
+extern void test_future_free_from_callback(void);
+
+/* Declare test functions from test_ingest.c */
+extern void test_ingest_effects_match_result_set(void);
+extern void test_ingest_full_ring_drops(void);
+extern void test_ingest_concurrent_producers_and_reader(void);
+
+/* Declare test functions from test_changeover.c */
+extern void test_parse_changeover_costs(void);
+extern void test_parse_changeover_rejects_bad_entries(void);
+extern void test_changeover_order_beats_array_order(void);
+extern void test_changeover_order_keeps_array_order_without_costs(void);
+extern void test_plan_run_order_large_design(void);
+extern void test_parse_whole_plot_factors(void);
+extern void test_parse_whole_plot_rejects_bad_entries(void);
+extern void test_crossed_design_groups_whole_plots(void);
+extern void test_nested_design_sorts_by_whole_plot(void);
+extern void test_f_distribution_tail(void);
+extern void test_split_plot_anova_strata(void);
+extern void test_split_plot_anova_rejects_plain_designs(void);
+extern void test_t_distribution_quantiles(void);
+extern void test_main_effects_weigh_runs_equally(void);
+extern void test_plan_replicates_fills_design_first(void);
+extern void test_plan_replicates_stops_when_resolved(void);
+extern void test_plan_replicates_targets_contested_levels(void);
+
+/* Declare test functions from test_compare.c */
+extern void test_compare_ranks_changed_factor(void);
+extern void test_compare_permutations_are_deterministic(void);
+extern void test_compare_rejects_mismatched_campaigns(void);
+
+/* Declare test functions from test_curves.c */
+extern void test_numeric_levels_detected_at_parse(void);
+extern void test_curve_interpolates_peak_between_levels(void);
+extern void test_cubic_curve_recovers_polynomial(void);
+
+/* Declare test functions from test_bitmap.c */
+extern void test_run_index_matches_generated_runs(void);
+extern void test_run_index_select_combines_queries(void);
+extern void test_conditional_effects_match_filtered_results(void);
 
 int main(void) {
     printf("=== Taguchi Library Test Suite ===\\n\\n");
@@ -197,6 +258,7 @@ int main(void) {
     RUN_TEST(parse_invalid_no_array);
     RUN_TEST(validate_correct_definition);
     RUN_TEST(validate_empty_factor_name);
+    RUN_TEST(level_types_parsed_once);
 
     printf("\\nAuto-Selection Tests:\\n");
     RUN_TEST(suggest_optimal_array_basic_2level);
@@ -225,6 +287,7 @@ int main(void) {
     RUN_TEST(analyzer_create_null_inputs);
     RUN_TEST(analyzer_add_result_null);
     RUN_TEST(analyzer_result_set_grows);
+    RUN_TEST(analyzer_result_accessors);
     RUN_TEST(analyzer_main_effects_l9);
     RUN_TEST(analyzer_main_effects_null);
     RUN_TEST(analyzer_recommend_higher_is_better);
@@ -252,6 +315,70 @@ int main(void) {
     RUN_TEST(auto_select_prefers_smallest);
     RUN_TEST(auto_select_l27_for_5_3level_factors);
 
+    printf("\\nDesign Cache Tests:\\n");
+    RUN_TEST(compiled_design_matches_generated_runs);
+    RUN_TEST(compiled_design_kernels_match_reference);
+    RUN_TEST(cache_key_ignores_names_and_values);
+    RUN_TEST(cache_roundtrip_maps_stored_design);
+    RUN_TEST(cache_rejects_corrupt_entry);
+
+    printf("\\nContext Tests:\\n");
+    RUN_TEST(parallel_for_covers_each_index_once);
+    RUN_TEST(parallel_for_nested_calls_complete);
+    RUN_TEST(single_worker_context_runs_inline);
+    RUN_TEST(context_allocator_and_effects_match_default);
+    RUN_TEST(generate_runs_ctx_matches_default);
+    RUN_TEST(context_create_rejects_half_allocator);
+
+    printf("\\nAsync Tests:\\n");
+    RUN_TEST(future_generate_signals_fd_and_callback);
+    RUN_TEST(future_effects_match_sync);
+    RUN_TEST(future_cancel_before_start);
+    RUN_TEST(future_free_from_callback);
+
+    printf("\\nIngestion Tests:\\n");
+    RUN_TEST(ingest_effects_match_result_set);
+    RUN_TEST(ingest_full_ring_drops);
+    RUN_TEST(ingest_concurrent_producers_and_reader);
+
+    printf("\\nChangeover Tests:\\n");
+    RUN_TEST(parse_changeover_costs);
+    RUN_TEST(parse_changeover_rejects_bad_entries);
+    RUN_TEST(changeover_order_beats_array_order);
+    RUN_TEST(changeover_order_keeps_array_order_without_costs);
+    RUN_TEST(plan_run_order_large_design);
+
+    printf("\\nSplit-Plot Tests:\\n");
+    RUN_TEST(parse_whole_plot_factors);
+    RUN_TEST(parse_whole_plot_rejects_bad_entries);
+    RUN_TEST(crossed_design_groups_whole_plots);
+    RUN_TEST(nested_design_sorts_by_whole_plot);
+    RUN_TEST(f_distribution_tail);
+    RUN_TEST(split_plot_anova_strata);
+    RUN_TEST(split_plot_anova_rejects_plain_designs);
+
+    printf("\\nReplication Tests:\\n");
+    RUN_TEST(t_distribution_quantiles);
+    RUN_TEST(main_effects_weigh_runs_equally);
+    RUN_TEST(plan_replicates_fills_design_first);
+    RUN_TEST(plan_replicates_stops_when_resolved);
+    RUN_TEST(plan_replicates_targets_contested_levels);
+
+    printf("\\nCompare Tests:\\n");
+    RUN_TEST(compare_ranks_changed_factor);
+    RUN_TEST(compare_permutations_are_deterministic);
+    RUN_TEST(compare_rejects_mismatched_campaigns);
+
+    printf("\\nResponse Curve Tests:\\n");
+    RUN_TEST(numeric_levels_detected_at_parse);
+    RUN_TEST(curve_interpolates_peak_between_levels);
+    RUN_TEST(cubic_curve_recovers_polynomial);
+
+    printf("\\nRun Index Tests:\\n");
+    RUN_TEST(run_index_matches_generated_runs);
+    RUN_TEST(run_index_select_combines_queries);
+    RUN_TEST(conditional_effects_match_filtered_results);
+
     printf("\\nSecurity Tests:\\n");
     RUN_TEST(parse_oversized_factor_name);
     RUN_TEST(parse_max_valid_factor_name);
@@ -0,0 +1,196 @@
+#include "test_framework.h"
+#include "src/lib/splitplot.h"
+#include "src/lib/stats.h"
+#include "src/lib/analyzer.h"
+#include "src/lib/generator.h"
+#include "src/lib/parser.h"
+#include "include/taguchi.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *crossed_def =
+    "factors:\n"
+    "  flags: O0, O2, O3\n"
+    "  alloc: glibc, jemalloc, tcmalloc\n"
+    "  threads: 1, 2, 4\n"
+    "  batch: 8, 16, 32\n"
+    "whole_plot: flags\n"
+    "whole_plot_array: L9\n"
+    "array: L9\n";
+
+TEST(parse_whole_plot_factors) {
+    ExperimentDef def;
+    char error[256];
+    ASSERT_EQ(parse_experiment_def_from_string(crossed_def, &def, error), 0);
+    ASSERT_TRUE(def.factors[0].whole_plot);
+    ASSERT_FALSE(def.factors[1].whole_plot);
+    ASSERT_STR_EQ(def.whole_plot_array, "L9");
+    ASSERT_EQ(def.split_plot_layout, SPLIT_PLOT_CROSSED);
+    ASSERT_TRUE(def_is_split_plot(&def));
+
+    /* whole_plot may name factors defined later in the file */
+    ASSERT_EQ(parse_experiment_def_from_string(
+        "whole_plot: b\nsplit_plot: nested\nfactors:\n  a: 1, 2\n  b: x, y\narray: L4\n",
+        &def, error), 0);
+    ASSERT_TRUE(def.factors[1].whole_plot);
+    ASSERT_EQ(def.split_plot_layout, SPLIT_PLOT_NESTED);
+}
+
+TEST(parse_whole_plot_rejects_bad_entries) {
+    ExperimentDef def;
+    char error[256];
+    ASSERT_EQ(parse_experiment_def_from_string(
+        "factors:\n  a: 1, 2\nwhole_plot: b\narray: L4\n", &def, error), -1);
+    ASSERT_NOT_NULL(strstr(error, "'b' is not defined"));
+    ASSERT_EQ(parse_experiment_def_from_string(
+        "factors:\n  a: 1, 2\nsplit_plot: nested\narray: L4\n", &def, error), -1);
+    ASSERT_NOT_NULL(strstr(error, "require a whole_plot factor list"));
+    ASSERT_EQ(parse_experiment_def_from_string(
+        "factors:\n  a: 1, 2\nwhole_plot: a\nsplit_plot: mixed\narray: L4\n", &def, error), -1);
+    ASSERT_NOT_NULL(strstr(error, "Invalid split_plot layout"));
+}
+
+TEST(crossed_design_groups_whole_plots) {
+    ExperimentDef def;
+    char error[256];
+    ASSERT_EQ(parse_experiment_def_from_string(crossed_def, &def, error), 0);
+    CompiledDesign design;
+    ASSERT_EQ(acquire_design(NULL, &def, &design, error), 0);
+    ASSERT_EQ(design.rows, 81);
+    ASSERT_EQ(design.plot_rows, 9);
+
+    size_t plots[81];
+    ASSERT_EQ(split_plot_whole_plots(&def, &design, plots), 9);
+    for (size_t r = 0; r < design.rows; r++) {
+        ASSERT_EQ(plots[r], r / 9);
+        /* flags is constant within a whole plot */
+        ASSERT_EQ(design.levels[r * design.factor_count],
+                  design.levels[(r / 9) * 9 * design.factor_count]);
+    }
+    free_compiled_design(&design);
+
+    ASSERT_EQ(parse_experiment_def_from_string(
+        "factors:\n  a: 1, 2\nwhole_plot: a\narray: L4\n", &def, error), 0);
+    ASSERT_EQ(acquire_design(NULL, &def, &design, error), -1);
+    ASSERT_NOT_NULL(strstr(error, "at least one sub-plot factor"));
+}
+
+TEST(nested_design_sorts_by_whole_plot) {
+    ExperimentDef def;
+    char error[256];
+    ASSERT_EQ(parse_experiment_def_from_string(
+        "factors:\n  a: 1, 2, 3\n  b: 1, 2, 3\n  c: 1, 2, 3\n"
+        "whole_plot: a\nsplit_plot: nested\narray: L9\n", &def, error), 0);
+    CompiledDesign design;
+    ASSERT_EQ(acquire_design(NULL, &def, &design, error), 0);
+    ASSERT_EQ(design.rows, 9);
+    ASSERT_EQ(design.plot_rows, 0);
+
+    size_t plots[9];
+    ASSERT_EQ(split_plot_whole_plots(&def, &design, plots), 3);
+    for (size_t r = 1; r < design.rows; r++) {
+        ASSERT_TRUE(design.levels[r * design.factor_count] >=
+                    design.levels[(r - 1) * design.factor_count]);
+        ASSERT_EQ(plots[r], (size_t)design.levels[r * design.factor_count]);
+    }
+    free_compiled_design(&design);
+}
+
+TEST(f_distribution_tail) {
+    /* F(2, 2) has survival 1 / (1 + f) */
+    ASSERT_DOUBLE_EQ(f_distribution_sf(1.0, 2.0, 2.0), 0.5, 1e-9);
+    ASSERT_DOUBLE_EQ(f_distribution_sf(3.0, 2.0, 2.0), 0.25, 1e-9);
+    /* Tabulated 1% point of F(2, 6) */
+    ASSERT_DOUBLE_EQ(f_distribution_sf(10.925, 2.0, 6.0), 0.01, 1e-4);
+    ASSERT_DOUBLE_EQ(f_distribution_sf(0.0, 3.0, 7.0), 1.0, 1e-12);
+    ASSERT_DOUBLE_EQ(incomplete_beta(0.5, 2.0, 2.0), 0.5, 1e-9);
+}
+
+TEST(split_plot_anova_strata) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(crossed_def, error);
+    ASSERT_NOT_NULL(def);
+    ASSERT_TRUE(taguchi_def_is_split_plot(def));
+    ASSERT_TRUE(taguchi_def_is_whole_plot_factor(def, 0));
+    ASSERT_FALSE(taguchi_def_is_whole_plot_factor(def, 1));
+
+    size_t plots[81];
+    ASSERT_EQ(taguchi_get_whole_plots(def, plots, 80, error), 0);
+    ASSERT_EQ(taguchi_get_whole_plots(def, plots, 81, error), 9);
+    ASSERT_EQ(plots[0], 1);
+    ASSERT_EQ(plots[80], 9);
+
+    taguchi_experiment_run_t **runs = NULL;
+    size_t run_count = 0;
+    ASSERT_EQ(taguchi_generate_runs(def, &runs, &run_count, error), 0);
+    ASSERT_EQ(run_count, 81);
+
+    /* Additive response with whole-plot noise and smaller sub-plot noise */
+    static const double plot_noise[9] = { 0.9, -1.1, 0.3, -0.4, 1.2, -0.8, 0.1, 0.5, -0.7 };
+    double responses[81];
+    taguchi_result_set_t *results = taguchi_create_result_set(def, "time");
+    ASSERT_NOT_NULL(results);
+    for (size_t i = 0; i < run_count; i++) {
+        const char *flags = taguchi_run_get_value(runs[i], "flags");
+        const char *alloc = taguchi_run_get_value(runs[i], "alloc");
+        double y = 10.0 + plot_noise[plots[i] - 1] + 0.05 * (double)(i % 7);
+        if (strcmp(flags, "O3") == 0) y -= 4.0;
+        if (strcmp(alloc, "jemalloc") == 0) y -= 2.0;
+        responses[i] = y;
+        ASSERT_EQ(taguchi_add_result(results, i + 1, y, error), 0);
+    }
+
+    taguchi_anova_row_t *rows = NULL;
+    size_t row_count = 0;
+    ASSERT_EQ(taguchi_split_plot_anova(results, &rows, &row_count, error), 0);
+    ASSERT_EQ(row_count, 6);
+
+    /* Whole-plot stratum: flags then its error, 9 plots - 1 - 2 = 6 df */
+    ASSERT_STR_EQ(rows[0].source, "flags");
+    ASSERT_EQ(rows[0].stratum, TAGUCHI_STRATUM_WHOLE_PLOT);
+    ASSERT_EQ(rows[0].df, 2);
+    ASSERT_TRUE(rows[1].is_error);
+    ASSERT_EQ(rows[1].df, 6);
+    ASSERT_LT(rows[0].p_value, 0.05);
+
+    /* Sub-plot stratum: alloc, threads, batch, then 81 - 9 - 6 = 66 df */
+    ASSERT_STR_EQ(rows[2].source, "alloc");
+    ASSERT_EQ(rows[2].stratum, TAGUCHI_STRATUM_SUB_PLOT);
+    ASSERT_LT(rows[2].p_value, 1e-6);
+    ASSERT_TRUE(rows[5].is_error);
+    ASSERT_EQ(rows[5].df, 66);
+    ASSERT_TRUE(isnan(rows[5].f_ratio));
+
+    /* Sums of squares partition the total */
+    double total = 0.0, mean = 0.0;
+    for (size_t i = 0; i < run_count; i++) mean += responses[i];
+    mean /= (double)run_count;
+    for (size_t i = 0; i < run_count; i++) {
+        double d = responses[i] - mean;
+        total += d * d;
+    }
+    double ss = 0.0;
+    for (size_t i = 0; i < row_count; i++) ss += rows[i].sum_squares;
+    ASSERT_DOUBLE_EQ(ss, total, 1e-6);
+
+    taguchi_free_anova(rows);
+    taguchi_free_result_set(results);
+    taguchi_free_runs(runs, run_count);
+    taguchi_free_definition(def);
+}
+
+TEST(split_plot_anova_rejects_plain_designs) {
+    char error[TAGUCHI_ERROR_SIZE];
+    taguchi_experiment_def_t *def = taguchi_parse_definition(
+        "factors:\n  a: 1, 2\n  b: 1, 2\narray: L4\n", error);
+    ASSERT_NOT_NULL(def);
+    taguchi_result_set_t *results = taguchi_create_result_set(def, "time");
+    ASSERT_EQ(taguchi_add_result(results, 1, 1.0, error), 0);
+    taguchi_anova_row_t *rows = NULL;
+    size_t row_count = 0;
+    ASSERT_EQ(taguchi_split_plot_anova(results, &rows, &row_count, error), -1);
+    ASSERT_NOT_NULL(strstr(error, "Not a split-plot design"));
+    taguchi_free_result_set(results);
+    taguchi_free_definition(def);
+}